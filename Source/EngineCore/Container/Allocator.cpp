@@ -22,6 +22,12 @@
 
 #include "../Precompiled.h"
 #include "./TypeTraits.h"
+#include "../Container/Vector.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+
+#include <atomic>
+
 #include "../DebugNew.h"
 
 namespace Atomic
@@ -119,4 +125,283 @@ void AllocatorFree(AllocatorBlock* allocator, void* ptr)
     allocator->free_ = node;
 }
 
+/// Default size of a frame arena block.
+static const unsigned FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+
+/// Frame arena memory block.
+struct FrameArenaBlock
+{
+    /// Next block.
+    FrameArenaBlock* next_;
+    /// Size of the data.
+    unsigned size_;
+    /// Data follows.
+};
+
+/// Header stored in front of each frame allocation. Holds the arena position before the allocation, so that releasing
+/// the allocations in reverse order moves the arena back down.
+struct FrameAllocation
+{
+    /// Allocation below this one.
+    FrameAllocation* previous_;
+    /// Block that was being allocated from before this allocation.
+    FrameArenaBlock* block_;
+    /// Next free byte before this allocation.
+    unsigned char* top_;
+    /// Whether the allocation has been released. It is reclaimed once the allocations above it are.
+    bool released_;
+};
+
+/// Bump allocator of a single thread.
+struct FrameArena
+{
+    /// Construct and register.
+    FrameArena();
+    /// Unregister and free all blocks.
+    ~FrameArena();
+
+    /// Allocate memory.
+    void* Allocate(unsigned size, unsigned alignment);
+    /// Grow the most recent allocation in place.
+    bool Extend(void* ptr, unsigned oldSize, unsigned newSize);
+    /// Release an allocation. The memory is reclaimed once the allocations made after it have been released too.
+    void Release(void* ptr);
+    /// Rewind to the start, reclaiming all allocations.
+    void Rewind();
+    /// Move to the next block that can hold a size, allocating it if necessary.
+    void NextBlock(unsigned size);
+
+    /// Return start of a block's data.
+    static unsigned char* GetData(FrameArenaBlock* block) { return reinterpret_cast<unsigned char*>(block + 1); }
+
+    /// First block.
+    FrameArenaBlock* first_;
+    /// Block being allocated from.
+    FrameArenaBlock* current_;
+    /// Next free byte in the current block.
+    unsigned char* top_;
+    /// Most recent allocation that has not been reclaimed.
+    FrameAllocation* last_;
+    /// Number of allocations since the statistics were last collected.
+    std::atomic<unsigned> numAllocations_;
+    /// Number of bytes allocated since the statistics were last collected.
+    std::atomic<unsigned> allocatedBytes_;
+    /// Number of bytes reserved.
+    std::atomic<unsigned> reservedBytes_;
+};
+
+/// Statistics of the last completed frame.
+static FrameArenaStats frameArenaStats = { 0, 0, 0, 0 };
+
+/// Return the frame arena registry mutex.
+static Mutex& GetFrameArenaMutex()
+{
+    static Mutex mutex;
+    return mutex;
+}
+
+/// Return the frame arenas of all threads.
+static PODVector<FrameArena*>& GetFrameArenas()
+{
+    static PODVector<FrameArena*> arenas;
+    return arenas;
+}
+
+/// Return the frame arena of the calling thread.
+static FrameArena& GetThreadFrameArena()
+{
+    static thread_local FrameArena arena;
+    return arena;
+}
+
+FrameArena::FrameArena() :
+    first_(0),
+    current_(0),
+    top_(0),
+    last_(0),
+    numAllocations_(0),
+    allocatedBytes_(0),
+    reservedBytes_(0)
+{
+    MutexLock lock(GetFrameArenaMutex());
+    GetFrameArenas().Push(this);
+}
+
+FrameArena::~FrameArena()
+{
+    {
+        MutexLock lock(GetFrameArenaMutex());
+        GetFrameArenas().Remove(this);
+    }
+
+    while (first_)
+    {
+        FrameArenaBlock* next = first_->next_;
+        delete[] reinterpret_cast<unsigned char*>(first_);
+        first_ = next;
+    }
+}
+
+void FrameArena::Rewind()
+{
+    // If the last frame needed several blocks, replace them with one block large enough for all of them
+    if (first_ && first_->next_)
+    {
+        unsigned totalSize = 0;
+        while (first_)
+        {
+            FrameArenaBlock* next = first_->next_;
+            totalSize += first_->size_;
+            delete[] reinterpret_cast<unsigned char*>(first_);
+            first_ = next;
+        }
+
+        first_ = reinterpret_cast<FrameArenaBlock*>(new unsigned char[sizeof(FrameArenaBlock) + totalSize]);
+        first_->next_ = 0;
+        first_->size_ = totalSize;
+        reservedBytes_.store(totalSize, std::memory_order_relaxed);
+    }
+
+    current_ = first_;
+    top_ = current_ ? GetData(current_) : 0;
+    last_ = 0;
+}
+
+void FrameArena::NextBlock(unsigned size)
+{
+    FrameArenaBlock* next = current_ ? current_->next_ : first_;
+    if (!next || next->size_ < size)
+    {
+        unsigned blockSize = size > FRAME_ARENA_BLOCK_SIZE ? size : FRAME_ARENA_BLOCK_SIZE;
+        FrameArenaBlock* newBlock = reinterpret_cast<FrameArenaBlock*>(new unsigned char[sizeof(FrameArenaBlock) + blockSize]);
+        newBlock->next_ = next;
+        newBlock->size_ = blockSize;
+        if (current_)
+            current_->next_ = newBlock;
+        else
+            first_ = newBlock;
+
+        next = newBlock;
+        reservedBytes_.store(reservedBytes_.load(std::memory_order_relaxed) + blockSize, std::memory_order_relaxed);
+    }
+
+    current_ = next;
+    top_ = GetData(current_);
+}
+
+void* FrameArena::Allocate(unsigned size, unsigned alignment)
+{
+    if (alignment < alignof(FrameAllocation))
+        alignment = alignof(FrameAllocation);
+
+    FrameArenaBlock* block = current_;
+    unsigned char* top = top_;
+
+    size_t mask = (size_t)alignment - 1;
+    unsigned char* ptr = reinterpret_cast<unsigned char*>(((size_t)top_ + sizeof(FrameAllocation) + mask) & ~mask);
+    if (!current_ || ptr + size > GetData(current_) + current_->size_)
+    {
+        NextBlock(size + alignment + sizeof(FrameAllocation));
+        ptr = reinterpret_cast<unsigned char*>(((size_t)top_ + sizeof(FrameAllocation) + mask) & ~mask);
+    }
+
+    FrameAllocation* allocation = reinterpret_cast<FrameAllocation*>(ptr) - 1;
+    allocation->previous_ = last_;
+    allocation->block_ = block;
+    allocation->top_ = top;
+    allocation->released_ = false;
+
+    last_ = allocation;
+    top_ = ptr + size;
+    numAllocations_.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes_.fetch_add(size, std::memory_order_relaxed);
+    return ptr;
+}
+
+bool FrameArena::Extend(void* ptr, unsigned oldSize, unsigned newSize)
+{
+    unsigned char* data = static_cast<unsigned char*>(ptr);
+    if (!data || !last_ || data != reinterpret_cast<unsigned char*>(last_ + 1) || top_ != data + oldSize || newSize < oldSize)
+        return false;
+    if (data + newSize > GetData(current_) + current_->size_)
+        return false;
+
+    top_ = data + newSize;
+    allocatedBytes_.fetch_add(newSize - oldSize, std::memory_order_relaxed);
+    return true;
+}
+
+void FrameArena::Release(void* ptr)
+{
+    if (!ptr || !last_)
+        return;
+
+    reinterpret_cast<FrameAllocation*>(ptr)[-1].released_ = true;
+
+    // Move back down past every released allocation at the top
+    while (last_ && last_->released_)
+    {
+        current_ = last_->block_;
+        top_ = last_->top_;
+        last_ = last_->previous_;
+    }
+
+    // With nothing left allocated the arena can be reclaimed here already, so that it does not keep growing on a thread
+    // whose frame never ends, such as the main thread of a tool that does not run Time::EndFrame()
+    if (!last_)
+        Rewind();
+}
+
+void* FrameAllocate(unsigned size, unsigned alignment)
+{
+    if (!alignment)
+        alignment = 1;
+    return GetThreadFrameArena().Allocate(size ? size : 1, alignment);
+}
+
+bool FrameExtend(void* ptr, unsigned oldSize, unsigned newSize)
+{
+    return GetThreadFrameArena().Extend(ptr, oldSize, newSize);
+}
+
+void FrameRelease(void* ptr, unsigned size)
+{
+    GetThreadFrameArena().Release(ptr);
+}
+
+void FrameArenaReset()
+{
+    FrameArenaStats stats = { 0, 0, 0, 0 };
+
+    {
+        MutexLock lock(GetFrameArenaMutex());
+        const PODVector<FrameArena*>& arenas = GetFrameArenas();
+        for (unsigned i = 0; i < arenas.Size(); ++i)
+        {
+            FrameArena* arena = arenas[i];
+            stats.numAllocations_ += arena->numAllocations_.exchange(0, std::memory_order_relaxed);
+            stats.allocatedBytes_ += arena->allocatedBytes_.exchange(0, std::memory_order_relaxed);
+            stats.reservedBytes_ += arena->reservedBytes_.load(std::memory_order_relaxed);
+        }
+        stats.numArenas_ = arenas.Size();
+    }
+
+    frameArenaStats = stats;
+
+    // Only the main thread's arena is reclaimed here. Other threads may be in the middle of work that holds frame memory
+    // of theirs, so they reclaim their own arenas with FrameArenaRewindThread()
+    GetThreadFrameArena().Rewind();
+}
+
+void FrameArenaRewindThread()
+{
+    if (!Thread::IsMainThread())
+        GetThreadFrameArena().Rewind();
+}
+
+const FrameArenaStats& GetFrameArenaStats()
+{
+    return frameArenaStats;
+}
+
 }
@@ -25,6 +25,7 @@
 #include "../EngineCore.h"
 
 #include <stddef.h>
+#include <string.h>
 
 namespace Atomic
 {
@@ -120,4 +121,160 @@ private:
     AllocatorBlock* allocator_;
 };
 
+/// Frame arena statistics.
+struct FrameArenaStats
+{
+    /// Number of allocations made during the frame.
+    unsigned numAllocations_;
+    /// Number of bytes allocated during the frame.
+    unsigned allocatedBytes_;
+    /// Number of bytes reserved by the arenas of all threads.
+    unsigned reservedBytes_;
+    /// Number of threads that have a frame arena.
+    unsigned numArenas_;
+};
+
+/// Allocate transient memory from the calling thread's frame arena. On the main thread the memory is valid until the end
+/// of the frame. On other threads it is valid until the thread calls FrameArenaRewindThread(), which the WorkQueue
+/// threads do after each work item. The memory must not be held past those points. Releasing it with FrameRelease() is
+/// optional, but lets the arena reuse it earlier.
+ATOMIC_API void* FrameAllocate(unsigned size, unsigned alignment = 16);
+/// Grow the calling thread's most recent frame allocation in place. Return true if successful.
+ATOMIC_API bool FrameExtend(void* ptr, unsigned oldSize, unsigned newSize);
+/// Release a frame allocation of the calling thread. Allocations are reclaimed in reverse order: the memory is reused
+/// once every allocation made after it has been released too, and when all have, the whole arena is reclaimed without
+/// waiting for the end of the frame.
+ATOMIC_API void FrameRelease(void* ptr, unsigned size);
+/// End the frame, collecting statistics and reclaiming the main thread's frame arena. Called by the Time subsystem on the
+/// main thread after E_ENDFRAME.
+ATOMIC_API void FrameArenaReset();
+/// Reclaim the calling thread's frame arena. Called by threads other than the main thread at a point where they hold no
+/// frame memory. Does nothing on the main thread, whose arena is reclaimed at the end of the frame.
+ATOMIC_API void FrameArenaRewindThread();
+/// Return frame arena statistics of the last completed frame. Allocations of other threads are counted in the frame in
+/// which the statistics were collected.
+ATOMIC_API const FrameArenaStats& GetFrameArenaStats();
+
+/// Growable array of POD elements allocated from the calling thread's frame arena. Used for transient per-frame data,
+/// such as temporary query and sort buffers, that would otherwise go through the heap. Must be used on one thread only.
+template <class T> class FramePODVector
+{
+public:
+    /// Construct empty.
+    FramePODVector() :
+        buffer_(0),
+        size_(0),
+        capacity_(0)
+    {
+    }
+
+    /// Construct with initial capacity.
+    explicit FramePODVector(unsigned capacity) :
+        buffer_(0),
+        size_(0),
+        capacity_(0)
+    {
+        Reserve(capacity);
+    }
+
+    /// Destruct. Returns the memory to the arena.
+    ~FramePODVector()
+    {
+        if (buffer_)
+            FrameRelease(buffer_, capacity_ * (unsigned)sizeof(T));
+    }
+
+    /// Add an element at the end.
+    void Push(const T& value)
+    {
+        if (size_ >= capacity_)
+            Reserve(capacity_ ? capacity_ + (capacity_ >> 1) + 1 : 8);
+        buffer_[size_++] = value;
+    }
+
+    /// Remove the last element.
+    void Pop()
+    {
+        if (size_)
+            --size_;
+    }
+
+    /// Resize the vector. New elements are left uninitialized.
+    void Resize(unsigned newSize)
+    {
+        if (newSize > capacity_)
+            Reserve(newSize);
+        size_ = newSize;
+    }
+
+    /// Set new capacity. Does not shrink.
+    void Reserve(unsigned newCapacity)
+    {
+        if (newCapacity <= capacity_)
+            return;
+
+        if (buffer_ && FrameExtend(buffer_, capacity_ * (unsigned)sizeof(T), newCapacity * (unsigned)sizeof(T)))
+        {
+            capacity_ = newCapacity;
+            return;
+        }
+
+        unsigned alignment = alignof(T) > 16 ? (unsigned)alignof(T) : 16;
+        T* newBuffer = static_cast<T*>(FrameAllocate(newCapacity * (unsigned)sizeof(T), alignment));
+        if (size_)
+            memcpy(newBuffer, buffer_, size_ * sizeof(T));
+        if (buffer_)
+            FrameRelease(buffer_, capacity_ * (unsigned)sizeof(T));
+
+        buffer_ = newBuffer;
+        capacity_ = newCapacity;
+    }
+
+    /// Clear the vector. Keeps the capacity.
+    void Clear() { size_ = 0; }
+
+    /// Return whether contains a specific value.
+    bool Contains(const T& value) const
+    {
+        for (unsigned i = 0; i < size_; ++i)
+        {
+            if (buffer_[i] == value)
+                return true;
+        }
+        return false;
+    }
+
+    /// Return element at index.
+    T& operator [](unsigned index) { return buffer_[index]; }
+    /// Return const element at index.
+    const T& operator [](unsigned index) const { return buffer_[index]; }
+    /// Return pointer to the first element.
+    T* Begin() { return buffer_; }
+    /// Return const pointer to the first element.
+    const T* Begin() const { return buffer_; }
+    /// Return pointer to one past the last element.
+    T* End() { return buffer_ + size_; }
+    /// Return const pointer to one past the last element.
+    const T* End() const { return buffer_ + size_; }
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+    /// Return capacity.
+    unsigned Capacity() const { return capacity_; }
+    /// Return whether is empty.
+    bool Empty() const { return size_ == 0; }
+
+private:
+    /// Prevent copy construction.
+    FramePODVector(const FramePODVector<T>& rhs);
+    /// Prevent assignment.
+    FramePODVector<T>& operator =(const FramePODVector<T>& rhs);
+
+    /// Element buffer.
+    T* buffer_;
+    /// Number of elements.
+    unsigned size_;
+    /// Capacity.
+    unsigned capacity_;
+};
+
 }
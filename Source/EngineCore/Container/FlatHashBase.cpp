@@ -0,0 +1,96 @@
+#include "../Precompiled.h"
+
+#include "../Container/FlatHashBase.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+signed char FlatHashBase::emptyCtrl = 0;
+
+unsigned FlatHashBase::FindFreeSlot(unsigned hash) const
+{
+    for (unsigned step = 0;; ++step)
+    {
+        unsigned group = ProbeGroup(hash, step);
+        unsigned mask = MatchFree(group);
+        if (mask)
+            return group * GROUP_SIZE + LowestBit(mask);
+    }
+}
+
+unsigned FlatHashBase::NextOccupied(unsigned index) const
+{
+    // The sentinel at capacity is occupied
+    do
+        ++index;
+    while (ctrl_[index] < 0);
+
+    return index;
+}
+
+void FlatHashBase::SetOccupied(unsigned index, unsigned hash)
+{
+    if (ctrl_[index] == CTRL_EMPTY)
+        --growthLeft_;
+
+    ctrl_[index] = ControlByte(hash);
+    ++size_;
+}
+
+void FlatHashBase::SetErased(unsigned index)
+{
+    // A slot can become empty again only if no probe sequence passes through its group, i.e. the group was never full
+    if (MatchGroup(index / GROUP_SIZE, CTRL_EMPTY))
+    {
+        ctrl_[index] = CTRL_EMPTY;
+        ++growthLeft_;
+    }
+    else
+        ctrl_[index] = CTRL_DELETED;
+
+    --size_;
+}
+
+signed char* FlatHashBase::AllocateControl(unsigned capacity)
+{
+    signed char* oldCtrl = ctrl_;
+
+    ctrl_ = new signed char[capacity + 1];
+    capacity_ = capacity;
+    ResetControl();
+
+    return oldCtrl;
+}
+
+void FlatHashBase::ResetControl()
+{
+    if (!capacity_)
+        return;
+
+    memset(ctrl_, CTRL_EMPTY, capacity_);
+    ctrl_[capacity_] = 0;
+    size_ = 0;
+    // Keep the load factor at most 7/8
+    growthLeft_ = capacity_ - capacity_ / 8;
+}
+
+void FlatHashBase::FreeControl(signed char* ctrl)
+{
+    if (ctrl != &emptyCtrl)
+        delete[] ctrl;
+}
+
+unsigned FlatHashBase::CapacityFor(unsigned numElements)
+{
+    unsigned capacity = GROUP_SIZE;
+    while (capacity - capacity / 8 < numElements)
+        capacity <<= 1;
+
+    return capacity;
+}
+
+}
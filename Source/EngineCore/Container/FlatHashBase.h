@@ -0,0 +1,160 @@
+#pragma once
+
+#include "../EngineCore.h"
+
+#include "../Container/Hash.h"
+#include "../Container/Swap.h"
+
+#ifdef ENGINE_SSE
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Atomic
+{
+
+/// Open addressing hash set/map base class. Slots are probed in groups of sixteen, using one control byte per slot: the
+/// low seven bits of the key hash for an occupied slot, or a negative marker for an empty or erased slot. A group's
+/// control bytes are compared at once, so that most lookups touch a single cache line of control bytes and one slot.
+/** Like %HashBase, %FlatHashBase intentionally does not declare a virtual destructor.
+  */
+class ATOMIC_API FlatHashBase
+{
+public:
+    /// Number of slots in a probing group.
+    static const unsigned GROUP_SIZE = 16;
+    /// Control byte of an empty slot.
+    static const signed char CTRL_EMPTY = -128;
+    /// Control byte of an erased slot.
+    static const signed char CTRL_DELETED = -2;
+
+    /// Construct.
+    FlatHashBase() :
+        ctrl_(&emptyCtrl),
+        capacity_(0),
+        size_(0),
+        growthLeft_(0)
+    {
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return size_; }
+
+    /// Return number of slots.
+    unsigned Capacity() const { return capacity_; }
+
+    /// Return whether has no elements.
+    bool Empty() const { return size_ == 0; }
+
+protected:
+    /// Swap the control state with another hash set or map.
+    void SwapBase(FlatHashBase& rhs)
+    {
+        Atomic::Swap(ctrl_, rhs.ctrl_);
+        Atomic::Swap(capacity_, rhs.capacity_);
+        Atomic::Swap(size_, rhs.size_);
+        Atomic::Swap(growthLeft_, rhs.growthLeft_);
+    }
+
+    /// Mix a key hash, so that both the control byte and the probe start get well distributed bits.
+    static unsigned Mix(unsigned hash)
+    {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        return hash;
+    }
+
+    /// Return control byte of a mixed hash.
+    static signed char ControlByte(unsigned hash) { return (signed char)(hash & 0x7f); }
+
+    /// Return index of the lowest set bit of a nonzero mask.
+    static unsigned LowestBit(unsigned mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(mask);
+#endif
+    }
+
+    /// Return the group probed at a step. Triangular steps visit every group once, as the group count is a power of two.
+    unsigned ProbeGroup(unsigned hash, unsigned step) const
+    {
+        return ((hash >> 7) + step * (step + 1) / 2) & (capacity_ / GROUP_SIZE - 1);
+    }
+
+    /// Return bitmask of the slots in a group whose control byte equals a value.
+    unsigned MatchGroup(unsigned group, signed char value) const
+    {
+        const signed char* ctrl = ctrl_ + group * GROUP_SIZE;
+#ifdef ENGINE_SSE
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < GROUP_SIZE; ++i)
+        {
+            if (ctrl[i] == value)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Return bitmask of the empty or erased slots in a group.
+    unsigned MatchFree(unsigned group) const
+    {
+        const signed char* ctrl = ctrl_ + group * GROUP_SIZE;
+#ifdef ENGINE_SSE
+        // Occupied slots have the sign bit clear
+        return (unsigned)_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)));
+#else
+        unsigned mask = 0;
+        for (unsigned i = 0; i < GROUP_SIZE; ++i)
+        {
+            if (ctrl[i] < 0)
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    /// Return index of the first free slot on the probe sequence of a hash. The table must not be full.
+    unsigned FindFreeSlot(unsigned hash) const;
+    /// Return index of the first slot after an index that is occupied, or capacity if none.
+    unsigned NextOccupied(unsigned index) const;
+    /// Mark a slot occupied.
+    void SetOccupied(unsigned index, unsigned hash);
+    /// Mark a slot erased.
+    void SetErased(unsigned index);
+    /// Allocate control bytes for a power of two capacity and mark all slots empty. Return the old control bytes, which
+    /// the caller must free with FreeControl() after moving the elements.
+    signed char* AllocateControl(unsigned capacity);
+    /// Mark all slots empty.
+    void ResetControl();
+    /// Free control bytes returned by AllocateControl().
+    static void FreeControl(signed char* ctrl);
+    /// Return capacity for holding a number of elements.
+    static unsigned CapacityFor(unsigned numElements);
+
+    /// Control bytes followed by an occupied sentinel, which stops iteration.
+    signed char* ctrl_;
+    /// Number of slots. Zero or a power of two multiple of the group size.
+    unsigned capacity_;
+    /// Number of elements.
+    unsigned size_;
+    /// Number of elements that can be inserted before rehashing.
+    unsigned growthLeft_;
+
+    /// Sentinel control byte of an unallocated table.
+    static signed char emptyCtrl;
+};
+
+}
@@ -0,0 +1,473 @@
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Pair.h"
+#include "../Container/Vector.h"
+
+#include <new>
+
+namespace Atomic
+{
+
+/// Open addressing hash map template class. Has the same interface as %HashMap where possible, but stores the pairs in
+/// one flat array without per-element allocation, which makes lookups and iteration cache friendly. Insertion and
+/// rehashing move the pairs, so unlike with %HashMap, inserting invalidates iterators and references to elements.
+/// Iteration order is unspecified.
+template <class T, class U> class FlatHashMap : public FlatHashBase
+{
+public:
+    typedef T KeyType;
+    typedef U ValueType;
+
+    /// Hash map key-value pair with const key.
+    class KeyValue
+    {
+    public:
+        /// Construct with key and value.
+        KeyValue(const T& first, const U& second) :
+            first_(first),
+            second_(second)
+        {
+        }
+
+        /// Copy-construct.
+        KeyValue(const KeyValue& value) :
+            first_(value.first_),
+            second_(value.second_)
+        {
+        }
+
+        /// Test for equality with another pair.
+        bool operator ==(const KeyValue& rhs) const { return first_ == rhs.first_ && second_ == rhs.second_; }
+
+        /// Test for inequality with another pair.
+        bool operator !=(const KeyValue& rhs) const { return first_ != rhs.first_ || second_ != rhs.second_; }
+
+        /// Key.
+        const T first_;
+        /// Value.
+        U second_;
+
+    private:
+        /// Prevent assignment.
+        KeyValue& operator =(const KeyValue& rhs);
+    };
+
+    /// Flat hash map iterator.
+    struct Iterator
+    {
+        /// Construct.
+        Iterator() :
+            ctrl_(0),
+            ptr_(0)
+        {
+        }
+
+        /// Construct with control byte and pair pointers.
+        Iterator(const signed char* ctrl, KeyValue* ptr) :
+            ctrl_(ctrl),
+            ptr_(ptr)
+        {
+        }
+
+        /// Preincrement the pointer.
+        Iterator& operator ++()
+        {
+            do
+            {
+                ++ctrl_;
+                ++ptr_;
+            } while (*ctrl_ < 0);
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        Iterator operator ++(int)
+        {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        /// Point to the pair.
+        KeyValue* operator ->() const { return ptr_; }
+
+        /// Dereference the pair.
+        KeyValue& operator *() const { return *ptr_; }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const Iterator& rhs) const { return ctrl_ == rhs.ctrl_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const Iterator& rhs) const { return ctrl_ != rhs.ctrl_; }
+
+        /// Control byte pointer.
+        const signed char* ctrl_;
+        /// Pair pointer.
+        KeyValue* ptr_;
+    };
+
+    /// Flat hash map const iterator.
+    struct ConstIterator
+    {
+        /// Construct.
+        ConstIterator() :
+            ctrl_(0),
+            ptr_(0)
+        {
+        }
+
+        /// Construct with control byte and pair pointers.
+        ConstIterator(const signed char* ctrl, const KeyValue* ptr) :
+            ctrl_(ctrl),
+            ptr_(ptr)
+        {
+        }
+
+        /// Construct from a non-const iterator.
+        ConstIterator(const Iterator& rhs) :
+            ctrl_(rhs.ctrl_),
+            ptr_(rhs.ptr_)
+        {
+        }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            do
+            {
+                ++ctrl_;
+                ++ptr_;
+            } while (*ctrl_ < 0);
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        /// Point to the pair.
+        const KeyValue* operator ->() const { return ptr_; }
+
+        /// Dereference the pair.
+        const KeyValue& operator *() const { return *ptr_; }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return ctrl_ == rhs.ctrl_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return ctrl_ != rhs.ctrl_; }
+
+        /// Control byte pointer.
+        const signed char* ctrl_;
+        /// Pair pointer.
+        const KeyValue* ptr_;
+    };
+
+    /// Construct empty.
+    FlatHashMap() :
+        slots_(0)
+    {
+    }
+
+    /// Copy-construct from another hash map.
+    FlatHashMap(const FlatHashMap<T, U>& map) :
+        slots_(0)
+    {
+        Reserve(map.Size());
+        Insert(map);
+    }
+
+    /// Destruct.
+    ~FlatHashMap()
+    {
+        DestructSlots();
+        FreeControl(ctrl_);
+        FreeSlots(slots_);
+    }
+
+    /// Assign a hash map.
+    FlatHashMap& operator =(const FlatHashMap<T, U>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Clear();
+            Reserve(rhs.Size());
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Index the map. Create a new pair if key not found.
+    U& operator [](const T& key)
+    {
+        unsigned hash = Mix(MakeHash(key));
+        unsigned index = FindIndex(key, hash);
+        if (index == capacity_)
+            index = InsertNew(key, U(), hash);
+        return slots_[index].second_;
+    }
+
+    /// Index the map. Return null if key is not found, does not create a new pair.
+    U* operator [](const T& key) const
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        return index != capacity_ ? &slots_[index].second_ : 0;
+    }
+
+    /// Insert a pair. Return an iterator to it. An existing value is overwritten.
+    Iterator Insert(const Pair<T, U>& pair)
+    {
+        bool exists;
+        return Insert(pair, exists);
+    }
+
+    /// Insert a pair. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const Pair<T, U>& pair, bool& exists)
+    {
+        unsigned hash = Mix(MakeHash(pair.first_));
+        unsigned index = FindIndex(pair.first_, hash);
+        exists = index != capacity_;
+        if (exists)
+            slots_[index].second_ = pair.second_;
+        else
+            index = InsertNew(pair.first_, pair.second_, hash);
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Insert a map.
+    void Insert(const FlatHashMap<T, U>& map)
+    {
+        for (ConstIterator i = map.Begin(); i != map.End(); ++i)
+            (*this)[i->first_] = i->second_;
+    }
+
+    /// Erase a pair by key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        if (index == capacity_)
+            return false;
+
+        EraseIndex(index);
+        return true;
+    }
+
+    /// Erase a pair by iterator. Return iterator to the next pair.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ctrl_ - ctrl_);
+        if (index >= capacity_)
+            return End();
+
+        EraseIndex(index);
+        index = NextOccupied(index);
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Clear the map. Keeps the allocated slots.
+    void Clear()
+    {
+        DestructSlots();
+        ResetControl();
+    }
+
+    /// Reserve room for a number of elements without rehashing.
+    void Reserve(unsigned numElements)
+    {
+        if (numElements > size_ + growthLeft_)
+            Rehash(CapacityFor(numElements));
+    }
+
+    /// Swap with another hash map.
+    void Swap(FlatHashMap<T, U>& map)
+    {
+        SwapBase(map);
+        Atomic::Swap(slots_, map.slots_);
+    }
+
+    /// Return iterator to the pair with key, or end iterator if not found.
+    Iterator Find(const T& key)
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return const iterator to the pair with key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        return ConstIterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return whether contains a pair with key.
+    bool Contains(const T& key) const { return FindIndex(key, Mix(MakeHash(key))) != capacity_; }
+
+    /// Try to copy value to output. Return true if was found.
+    bool TryGetValue(const T& key, U& out) const
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        if (index == capacity_)
+            return false;
+
+        out = slots_[index].second_;
+        return true;
+    }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->first_);
+        return result;
+    }
+
+    /// Return all the values.
+    Vector<U> Values() const
+    {
+        Vector<U> result;
+        result.Reserve(size_);
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(i->second_);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    Iterator Begin()
+    {
+        unsigned index = ctrl_[0] >= 0 ? 0 : NextOccupied(0);
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const
+    {
+        unsigned index = ctrl_[0] >= 0 ? 0 : NextOccupied(0);
+        return ConstIterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return iterator to the end.
+    Iterator End() { return Iterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+private:
+    /// Return slot index of a key, or capacity if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        if (!size_)
+            return capacity_;
+
+        signed char control = ControlByte(hash);
+        unsigned numGroups = capacity_ / GROUP_SIZE;
+        for (unsigned step = 0; step < numGroups; ++step)
+        {
+            unsigned group = ProbeGroup(hash, step);
+            for (unsigned mask = MatchGroup(group, control); mask; mask &= mask - 1)
+            {
+                unsigned index = group * GROUP_SIZE + LowestBit(mask);
+                if (slots_[index].first_ == key)
+                    return index;
+            }
+
+            // A group with an empty slot ends every probe sequence that reaches it
+            if (MatchGroup(group, CTRL_EMPTY))
+                break;
+        }
+
+        return capacity_;
+    }
+
+    /// Insert a key that does not exist yet. Return its slot index.
+    unsigned InsertNew(const T& key, const U& value, unsigned hash)
+    {
+        if (!growthLeft_)
+        {
+            // Purge erased slots if that frees enough room, otherwise grow
+            unsigned numElements = size_ + 1;
+            Rehash(capacity_ && numElements < capacity_ / 2 ? capacity_ : CapacityFor(numElements * 2));
+        }
+
+        unsigned index = FindFreeSlot(hash);
+        new(slots_ + index) KeyValue(key, value);
+        SetOccupied(index, hash);
+        return index;
+    }
+
+    /// Destruct the pair at an occupied slot and mark the slot erased.
+    void EraseIndex(unsigned index)
+    {
+        (slots_ + index)->~KeyValue();
+        SetErased(index);
+    }
+
+    /// Move the pairs into a new table.
+    void Rehash(unsigned newCapacity)
+    {
+        unsigned oldCapacity = capacity_;
+        KeyValue* oldSlots = slots_;
+        signed char* oldCtrl = AllocateControl(newCapacity);
+        slots_ = AllocateSlots(newCapacity);
+
+        for (unsigned i = 0; i < oldCapacity; ++i)
+        {
+            if (oldCtrl[i] < 0)
+                continue;
+
+            KeyValue* pair = oldSlots + i;
+            unsigned hash = Mix(MakeHash(pair->first_));
+            unsigned index = FindFreeSlot(hash);
+            new(slots_ + index) KeyValue(*pair);
+            SetOccupied(index, hash);
+            pair->~KeyValue();
+        }
+
+        FreeControl(oldCtrl);
+        FreeSlots(oldSlots);
+    }
+
+    /// Destruct all pairs.
+    void DestructSlots()
+    {
+        if (!size_)
+            return;
+
+        for (unsigned i = 0; i < capacity_; ++i)
+        {
+            if (ctrl_[i] >= 0)
+                (slots_ + i)->~KeyValue();
+        }
+    }
+
+    /// Allocate uninitialized slots.
+    static KeyValue* AllocateSlots(unsigned capacity)
+    {
+        return reinterpret_cast<KeyValue*>(new unsigned char[capacity * sizeof(KeyValue)]);
+    }
+
+    /// Free slots allocated with AllocateSlots().
+    static void FreeSlots(KeyValue* slots)
+    {
+        delete[] reinterpret_cast<unsigned char*>(slots);
+    }
+
+    /// Key-value pairs. Only the slots with an occupied control byte are constructed.
+    KeyValue* slots_;
+};
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::ConstIterator begin(const Atomic::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::ConstIterator end(const Atomic::FlatHashMap<T, U>& v) { return v.End(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::Iterator begin(Atomic::FlatHashMap<T, U>& v) { return v.Begin(); }
+
+template <class T, class U> typename Atomic::FlatHashMap<T, U>::Iterator end(Atomic::FlatHashMap<T, U>& v) { return v.End(); }
+
+}
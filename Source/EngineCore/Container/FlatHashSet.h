@@ -0,0 +1,308 @@
+#pragma once
+
+#include "../Container/FlatHashBase.h"
+#include "../Container/Vector.h"
+
+#include <new>
+
+namespace Atomic
+{
+
+/// Open addressing hash set template class. Has the same interface as %HashSet where possible, but stores the keys in one
+/// flat array without per-element allocation. Inserting invalidates iterators. Iteration order is unspecified.
+template <class T> class FlatHashSet : public FlatHashBase
+{
+public:
+    /// Flat hash set iterator. Keys can not be modified through it.
+    struct ConstIterator
+    {
+        /// Construct.
+        ConstIterator() :
+            ctrl_(0),
+            ptr_(0)
+        {
+        }
+
+        /// Construct with control byte and key pointers.
+        ConstIterator(const signed char* ctrl, const T* ptr) :
+            ctrl_(ctrl),
+            ptr_(ptr)
+        {
+        }
+
+        /// Preincrement the pointer.
+        ConstIterator& operator ++()
+        {
+            do
+            {
+                ++ctrl_;
+                ++ptr_;
+            } while (*ctrl_ < 0);
+            return *this;
+        }
+
+        /// Postincrement the pointer.
+        ConstIterator operator ++(int)
+        {
+            ConstIterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        /// Point to the key.
+        const T* operator ->() const { return ptr_; }
+
+        /// Dereference the key.
+        const T& operator *() const { return *ptr_; }
+
+        /// Test for equality with another iterator.
+        bool operator ==(const ConstIterator& rhs) const { return ctrl_ == rhs.ctrl_; }
+
+        /// Test for inequality with another iterator.
+        bool operator !=(const ConstIterator& rhs) const { return ctrl_ != rhs.ctrl_; }
+
+        /// Control byte pointer.
+        const signed char* ctrl_;
+        /// Key pointer.
+        const T* ptr_;
+    };
+
+    typedef ConstIterator Iterator;
+
+    /// Construct empty.
+    FlatHashSet() :
+        slots_(0)
+    {
+    }
+
+    /// Copy-construct from another hash set.
+    FlatHashSet(const FlatHashSet<T>& set) :
+        slots_(0)
+    {
+        Reserve(set.Size());
+        Insert(set);
+    }
+
+    /// Destruct.
+    ~FlatHashSet()
+    {
+        DestructSlots();
+        FreeControl(ctrl_);
+        FreeSlots(slots_);
+    }
+
+    /// Assign a hash set.
+    FlatHashSet& operator =(const FlatHashSet<T>& rhs)
+    {
+        if (&rhs != this)
+        {
+            Clear();
+            Reserve(rhs.Size());
+            Insert(rhs);
+        }
+        return *this;
+    }
+
+    /// Insert a key. Return an iterator to it.
+    Iterator Insert(const T& key)
+    {
+        bool exists;
+        return Insert(key, exists);
+    }
+
+    /// Insert a key. Return iterator and set exists flag according to whether the key already existed.
+    Iterator Insert(const T& key, bool& exists)
+    {
+        unsigned hash = Mix(MakeHash(key));
+        unsigned index = FindIndex(key, hash);
+        exists = index != capacity_;
+        if (!exists)
+        {
+            if (!growthLeft_)
+            {
+                // Purge erased slots if that frees enough room, otherwise grow
+                unsigned numElements = size_ + 1;
+                Rehash(capacity_ && numElements < capacity_ / 2 ? capacity_ : CapacityFor(numElements * 2));
+            }
+
+            index = FindFreeSlot(hash);
+            new(slots_ + index) T(key);
+            SetOccupied(index, hash);
+        }
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Insert a set.
+    void Insert(const FlatHashSet<T>& set)
+    {
+        for (ConstIterator i = set.Begin(); i != set.End(); ++i)
+            Insert(*i);
+    }
+
+    /// Erase a key. Return true if was found.
+    bool Erase(const T& key)
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        if (index == capacity_)
+            return false;
+
+        EraseIndex(index);
+        return true;
+    }
+
+    /// Erase a key by iterator. Return iterator to the next key.
+    Iterator Erase(const Iterator& it)
+    {
+        unsigned index = (unsigned)(it.ctrl_ - ctrl_);
+        if (index >= capacity_)
+            return End();
+
+        EraseIndex(index);
+        index = NextOccupied(index);
+        return Iterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Clear the set. Keeps the allocated slots.
+    void Clear()
+    {
+        DestructSlots();
+        ResetControl();
+    }
+
+    /// Reserve room for a number of elements without rehashing.
+    void Reserve(unsigned numElements)
+    {
+        if (numElements > size_ + growthLeft_)
+            Rehash(CapacityFor(numElements));
+    }
+
+    /// Swap with another hash set.
+    void Swap(FlatHashSet<T>& set)
+    {
+        SwapBase(set);
+        Atomic::Swap(slots_, set.slots_);
+    }
+
+    /// Return iterator to the key, or end iterator if not found.
+    ConstIterator Find(const T& key) const
+    {
+        unsigned index = FindIndex(key, Mix(MakeHash(key)));
+        return ConstIterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return whether contains a key.
+    bool Contains(const T& key) const { return FindIndex(key, Mix(MakeHash(key))) != capacity_; }
+
+    /// Return all the keys.
+    Vector<T> Keys() const
+    {
+        Vector<T> result;
+        result.Reserve(size_);
+        for (ConstIterator i = Begin(); i != End(); ++i)
+            result.Push(*i);
+        return result;
+    }
+
+    /// Return iterator to the beginning.
+    ConstIterator Begin() const
+    {
+        unsigned index = ctrl_[0] >= 0 ? 0 : NextOccupied(0);
+        return ConstIterator(ctrl_ + index, slots_ + index);
+    }
+
+    /// Return iterator to the end.
+    ConstIterator End() const { return ConstIterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+private:
+    /// Return slot index of a key, or capacity if not found.
+    unsigned FindIndex(const T& key, unsigned hash) const
+    {
+        if (!size_)
+            return capacity_;
+
+        signed char control = ControlByte(hash);
+        unsigned numGroups = capacity_ / GROUP_SIZE;
+        for (unsigned step = 0; step < numGroups; ++step)
+        {
+            unsigned group = ProbeGroup(hash, step);
+            for (unsigned mask = MatchGroup(group, control); mask; mask &= mask - 1)
+            {
+                unsigned index = group * GROUP_SIZE + LowestBit(mask);
+                if (slots_[index] == key)
+                    return index;
+            }
+
+            // A group with an empty slot ends every probe sequence that reaches it
+            if (MatchGroup(group, CTRL_EMPTY))
+                break;
+        }
+
+        return capacity_;
+    }
+
+    /// Destruct the key at an occupied slot and mark the slot erased.
+    void EraseIndex(unsigned index)
+    {
+        (slots_ + index)->~T();
+        SetErased(index);
+    }
+
+    /// Move the keys into a new table.
+    void Rehash(unsigned newCapacity)
+    {
+        unsigned oldCapacity = capacity_;
+        T* oldSlots = slots_;
+        signed char* oldCtrl = AllocateControl(newCapacity);
+        slots_ = AllocateSlots(newCapacity);
+
+        for (unsigned i = 0; i < oldCapacity; ++i)
+        {
+            if (oldCtrl[i] < 0)
+                continue;
+
+            T* key = oldSlots + i;
+            unsigned hash = Mix(MakeHash(*key));
+            unsigned index = FindFreeSlot(hash);
+            new(slots_ + index) T(*key);
+            SetOccupied(index, hash);
+            key->~T();
+        }
+
+        FreeControl(oldCtrl);
+        FreeSlots(oldSlots);
+    }
+
+    /// Destruct all keys.
+    void DestructSlots()
+    {
+        if (!size_)
+            return;
+
+        for (unsigned i = 0; i < capacity_; ++i)
+        {
+            if (ctrl_[i] >= 0)
+                (slots_ + i)->~T();
+        }
+    }
+
+    /// Allocate uninitialized slots.
+    static T* AllocateSlots(unsigned capacity)
+    {
+        return reinterpret_cast<T*>(new unsigned char[capacity * sizeof(T)]);
+    }
+
+    /// Free slots allocated with AllocateSlots().
+    static void FreeSlots(T* slots)
+    {
+        delete[] reinterpret_cast<unsigned char*>(slots);
+    }
+
+    /// Keys. Only the slots with an occupied control byte are constructed.
+    T* slots_;
+};
+
+template <class T> typename Atomic::FlatHashSet<T>::ConstIterator begin(const Atomic::FlatHashSet<T>& v) { return v.Begin(); }
+
+template <class T> typename Atomic::FlatHashSet<T>::ConstIterator end(const Atomic::FlatHashSet<T>& v) { return v.End(); }
+
+}
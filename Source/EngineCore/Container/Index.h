@@ -12,6 +12,9 @@
 #include <EngineCore/Container/HashBase.h>
 #include <EngineCore/Container/HashMap.h>
 #include <EngineCore/Container/HashSet.h>
+#include <EngineCore/Container/FlatHashBase.h>
+#include <EngineCore/Container/FlatHashMap.h>
+#include <EngineCore/Container/FlatHashSet.h>
 #include <EngineCore/Container/ListBase.h>
 #include <EngineCore/Container/List.h>
 #include <EngineCore/Container/VectorBase.h>
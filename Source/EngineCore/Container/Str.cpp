@@ -26,6 +26,10 @@
 
 #include <cstdio>
 
+#ifdef ENGINE_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 #ifdef _MSC_VER
@@ -39,6 +43,77 @@ char String::endZero = 0;
 
 const String String::EMPTY;
 
+/// Convert an ASCII capital to lowercase. Other characters are returned unchanged.
+static inline char ToLowerASCII(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+#ifdef ENGINE_SSE
+/// Convert the ASCII capitals of sixteen characters to lowercase.
+static inline __m128i ToLowerASCII(__m128i chars)
+{
+    __m128i capitals = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)),
+        _mm_cmplt_epi8(chars, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(chars, _mm_and_si128(capitals, _mm_set1_epi8('a' - 'A')));
+}
+#endif
+
+/// Return offset of the first occurrence of a character, or NPOS if not found.
+static unsigned FindChar(const char* str, unsigned length, char c, bool caseSensitive)
+{
+    char lower = ToLowerASCII(c);
+    char upper = (lower >= 'a' && lower <= 'z') ? (char)(lower - ('a' - 'A')) : lower;
+
+    if (caseSensitive || lower == upper)
+    {
+        const char* found = static_cast<const char*>(memchr(str, caseSensitive ? c : lower, length));
+        return found ? (unsigned)(found - str) : String::NPOS;
+    }
+
+    unsigned i = 0;
+#ifdef ENGINE_SSE
+    __m128i lowerChars = _mm_set1_epi8(lower);
+    __m128i upperChars = _mm_set1_epi8(upper);
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+        __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(chars, lowerChars), _mm_cmpeq_epi8(chars, upperChars));
+        if (_mm_movemask_epi8(matches))
+            break;
+    }
+#endif
+    for (; i < length; ++i)
+    {
+        if (str[i] == lower || str[i] == upper)
+            return i;
+    }
+
+    return String::NPOS;
+}
+
+/// Return offset of the first character that differs case-insensitively, or length if none.
+static unsigned MismatchIgnoreCase(const char* lhs, const char* rhs, unsigned length)
+{
+    unsigned i = 0;
+#ifdef ENGINE_SSE
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i l = ToLowerASCII(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)));
+        __m128i r = ToLowerASCII(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xffff)
+            break;
+    }
+#endif
+    for (; i < length; ++i)
+    {
+        if (ToLowerASCII(lhs[i]) != ToLowerASCII(rhs[i]))
+            return i;
+    }
+
+    return length;
+}
+
 String::String(const WString& str) :
     length_(0),
     capacity_(0),
@@ -570,25 +645,11 @@ void String::Join(const Vector<String>& subStrings, const String& glue)
 
 unsigned String::Find(char c, unsigned startPos, bool caseSensitive) const
 {
-    if (caseSensitive)
-    {
-        for (unsigned i = startPos; i < length_; ++i)
-        {
-            if (buffer_[i] == c)
-                return i;
-        }
-    }
-    else
-    {
-        c = (char)tolower(c);
-        for (unsigned i = startPos; i < length_; ++i)
-        {
-            if (tolower(buffer_[i]) == c)
-                return i;
-        }
-    }
+    if (startPos >= length_)
+        return NPOS;
 
-    return NPOS;
+    unsigned pos = FindChar(buffer_ + startPos, length_ - startPos, c, caseSensitive);
+    return pos != NPOS ? startPos + pos : NPOS;
 }
 
 unsigned String::Find(const String& str, unsigned startPos, bool caseSensitive) const
@@ -596,44 +657,20 @@ unsigned String::Find(const String& str, unsigned startPos, bool caseSensitive)
     if (!str.length_ || str.length_ > length_)
         return NPOS;
 
-    char first = str.buffer_[0];
-    if (!caseSensitive)
-        first = (char)tolower(first);
+    unsigned last = length_ - str.length_;
+    unsigned restLength = str.length_ - 1;
 
-    for (unsigned i = startPos; i <= length_ - str.length_; ++i)
+    // Scan for the first character, then compare the rest
+    for (unsigned i = startPos; i <= last; ++i)
     {
-        char c = buffer_[i];
-        if (!caseSensitive)
-            c = (char)tolower(c);
-
-        if (c == first)
-        {
-            unsigned skip = NPOS;
-            bool found = true;
-            for (unsigned j = 1; j < str.length_; ++j)
-            {
-                c = buffer_[i + j];
-                char d = str.buffer_[j];
-                if (!caseSensitive)
-                {
-                    c = (char)tolower(c);
-                    d = (char)tolower(d);
-                }
-
-                if (skip == NPOS && c == first)
-                    skip = i + j - 1;
+        unsigned pos = FindChar(buffer_ + i, last + 1 - i, str.buffer_[0], caseSensitive);
+        if (pos == NPOS)
+            return NPOS;
 
-                if (c != d)
-                {
-                    found = false;
-                    if (skip != NPOS)
-                        i = skip;
-                    break;
-                }
-            }
-            if (found)
-                return i;
-        }
+        i += pos;
+        if (caseSensitive ? !memcmp(buffer_ + i + 1, str.buffer_ + 1, restLength) :
+            MismatchIgnoreCase(buffer_ + i + 1, str.buffer_ + 1, restLength) == restLength)
+            return i;
     }
 
     return NPOS;
@@ -722,7 +759,20 @@ bool String::EndsWith(const String& str, bool caseSensitive) const
 
 int String::Compare(const String& str, bool caseSensitive) const
 {
-    return Compare(CString(), str.CString(), caseSensitive);
+    if (caseSensitive)
+        return strcmp(CString(), str.CString());
+
+    // Include the terminating zero of the shorter string
+    unsigned length = (length_ < str.length_ ? length_ : str.length_) + 1;
+    unsigned pos = MismatchIgnoreCase(CString(), str.CString(), length);
+    if (pos == length)
+        return 0;
+
+    char l = ToLowerASCII(CString()[pos]);
+    char r = ToLowerASCII(str.CString()[pos]);
+    if (!l || !r)
+        return l ? 1 : (r ? -1 : 0);
+    return l < r ? -1 : 1;
 }
 
 int String::Compare(const char* str, bool caseSensitive) const
@@ -1107,32 +1157,40 @@ String& String::AppendWithFormatArgs(const char* formatString, va_list args)
         case 'd':
         case 'i':
             {
+                char buf[CONVERSION_BUFFER_LENGTH];
                 int arg = va_arg(args, int);
-                Append(String(arg));
+                int arglen = ::sprintf(buf, "%d", arg);
+                Append(buf, (unsigned)arglen);
                 break;
             }
 
         // Unsigned
         case 'u':
             {
+                char buf[CONVERSION_BUFFER_LENGTH];
                 unsigned arg = va_arg(args, unsigned);
-                Append(String(arg));
+                int arglen = ::sprintf(buf, "%u", arg);
+                Append(buf, (unsigned)arglen);
                 break;
             }
 
         // Unsigned long
         case 'l':
             {
+                char buf[CONVERSION_BUFFER_LENGTH];
                 unsigned long arg = va_arg(args, unsigned long);
-                Append(String(arg));
+                int arglen = ::sprintf(buf, "%lu", arg);
+                Append(buf, (unsigned)arglen);
                 break;
             }
 
         // Real
         case 'f':
             {
+                char buf[CONVERSION_BUFFER_LENGTH];
                 double arg = va_arg(args, double);
-                Append(String(arg));
+                int arglen = ::sprintf(buf, "%.15g", arg);
+                Append(buf, (unsigned)arglen);
                 break;
             }
 
@@ -1196,8 +1254,8 @@ int String::Compare(const char* lhs, const char* rhs, bool caseSensitive)
     {
         for (;;)
         {
-            char l = (char)tolower(*lhs);
-            char r = (char)tolower(*rhs);
+            char l = ToLowerASCII(*lhs);
+            char r = ToLowerASCII(*rhs);
             if (!l || !r)
                 return l ? 1 : (r ? -1 : 0);
             if (l < r)
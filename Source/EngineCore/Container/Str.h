@@ -250,10 +250,10 @@ public:
     }
 
     /// Test for equality with another string.
-    bool operator ==(const String& rhs) const { return strcmp(CString(), rhs.CString()) == 0; }
+    bool operator ==(const String& rhs) const { return length_ == rhs.length_ && !memcmp(CString(), rhs.CString(), length_); }
 
     /// Test for inequality with another string.
-    bool operator !=(const String& rhs) const { return strcmp(CString(), rhs.CString()) != 0; }
+    bool operator !=(const String& rhs) const { return !(*this == rhs); }
 
     /// Test if string is less than another string.
     bool operator <(const String& rhs) const { return strcmp(CString(), rhs.CString()) < 0; }
@@ -37,7 +37,7 @@ public:
     /// Destruct.
     ~Condition();
 
-    /// Set the condition. Will be automatically reset once a waiting thread wakes up.
+    /// Set the condition. Will be automatically reset once a waiting thread wakes up. If no thread is waiting, the next thread to wait wakes up immediately.
     void Set();
 
     /// Wait on the condition.
@@ -47,6 +47,8 @@ private:
 #ifndef _WIN32
     /// Mutex for the event, necessary for pthreads-based implementation.
     void* mutex_;
+    /// Set flag, necessary for pthreads-based implementation to not lose a set while no thread is waiting.
+    bool signaled_;
 #endif
     /// Operating system specific event.
     void* event_;
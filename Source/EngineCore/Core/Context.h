@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
 #include "../Container/HashSet.h"
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
@@ -204,7 +205,7 @@ namespace Atomic
 		/// Return event receivers for a sender and event type, or null if they do not exist.
 		EventReceiverGroup* GetEventReceivers(Object* sender, StringHash eventType)
 		{
-			HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
+			FlatHashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > >::Iterator i = specificEventReceivers_.Find(sender);
 			if (i != specificEventReceivers_.End())
 			{
 				HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator j = i->second_.Find(eventType);
@@ -217,7 +218,7 @@ namespace Atomic
 		/// Return event receivers for an event type, or null if they do not exist.
 		EventReceiverGroup* GetEventReceivers(StringHash eventType)
 		{
-			HashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
+			FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> >::Iterator i = eventReceivers_.Find(eventType);
 			return i != eventReceivers_.End() ? i->second_ : (EventReceiverGroup*)0;
 		}
 
@@ -283,9 +284,9 @@ namespace Atomic
 		/// Network replication attribute descriptions per object type.
 		HashMap<StringHash, Vector<AttributeInfo> > networkAttributes_;
 		/// Event receivers for non-specific events.
-		HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
+		FlatHashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
 		/// Event receivers for specific senders' events.
-		HashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
+		FlatHashMap<Object*, HashMap<StringHash, SharedPtr<EventReceiverGroup> > > specificEventReceivers_;
 		/// Event sender stack.
 		PODVector<Object*> eventSenders_;
 		/// Event data stack.
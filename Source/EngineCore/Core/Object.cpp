@@ -35,6 +35,32 @@
 namespace Atomic
 {
 
+/// Add a receiver to an open addressing set of receivers, which has at least one empty slot.
+static void InsertReceiver(FramePODVector<Object*>& set, Object* receiver)
+{
+    unsigned mask = set.Size() - 1;
+    for (unsigned i = MakeHash(receiver) & mask; set[i] != receiver; i = (i + 1) & mask)
+    {
+        if (!set[i])
+        {
+            set[i] = receiver;
+            break;
+        }
+    }
+}
+
+/// Return whether an open addressing set of receivers contains a receiver.
+static bool ContainsReceiver(const FramePODVector<Object*>& set, Object* receiver)
+{
+    unsigned mask = set.Size() - 1;
+    for (unsigned i = MakeHash(receiver) & mask; set[i]; i = (i + 1) & mask)
+    {
+        if (set[i] == receiver)
+            return true;
+    }
+    return false;
+}
+
 TypeInfo::TypeInfo(const char* typeName, const TypeInfo* baseTypeInfo) :
     type_(typeName),
     typeName_(typeName),
@@ -354,7 +380,10 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
     // Make a weak pointer to self to check for destruction during event handling
     WeakPtr<Object> self(this);
     Context* context = context_;
-    HashSet<Object*> processed;
+    // Specific receivers that got the event, in an open addressing hash set in frame memory rather than a heap allocated
+    // set. It is sized for all of them, so that it never needs to grow
+    FramePODVector<Object*> processed;
+    bool anyProcessed = false;
 
 // ATOMIC BEGIN
     context->GlobalBeginSendEvent(this, eventType, eventData);
@@ -370,6 +399,12 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
         group->BeginSendEvent();
 
         const unsigned numReceivers = group->receivers_.Size();
+        if (numReceivers)
+        {
+            processed.Resize(NextPowerOfTwo(numReceivers * 2));
+            memset(processed.Begin(), 0, processed.Size() * sizeof(Object*));
+        }
+
         for (unsigned i = 0; i < numReceivers; ++i)
         {
             Object* receiver = group->receivers_[i];
@@ -387,7 +422,8 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
                 return;
             }
 
-            processed.Insert(receiver);
+            InsertReceiver(processed, receiver);
+            anyProcessed = true;
         }
 
         group->EndSendEvent();
@@ -399,7 +435,7 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
     {
         group->BeginSendEvent();
 
-        if (processed.Empty())
+        if (!anyProcessed)
         {
             const unsigned numReceivers = group->receivers_.Size();
             for (unsigned i = 0; i < numReceivers; ++i)
@@ -425,7 +461,7 @@ void Object::SendEventNonProfiled(StringHash eventType, VariantMap& eventData)
             for (unsigned i = 0; i < numReceivers; ++i)
             {
                 Object* receiver = group->receivers_[i];
-                if (!receiver || processed.Contains(receiver))
+                if (!receiver || ContainsReceiver(processed, receiver))
                     continue;
 
                 receiver->OnEvent(this, eventType, eventData);
@@ -589,10 +625,24 @@ void Object::RemoveEventSender(Object* sender)
 Atomic::StringHash EventNameRegistrar::RegisterEventName(const char* eventName)
 {
     StringHash id(eventName);
-    GetEventNameMap()[id] = eventName;
+    HashMap<StringHash, String>& eventNames = GetEventNameMap();
+    HashMap<StringHash, String>::ConstIterator i = eventNames.Find(id);
+    if (i == eventNames.End())
+        eventNames[id] = eventName;
+    else if (i->second_.Compare(eventName, false) != 0)
+    {
+        // Record the collision for the hash audit
+        StringHash::RegisterSignificantString(i->second_, id);
+        StringHash::RegisterSignificantString(eventName, id);
+    }
     return id;
 }
 
+EventParamRegistrar::EventParamRegistrar(const char* paramName)
+{
+    StringHash::RegisterSignificantString(paramName);
+}
+
 const String& EventNameRegistrar::GetEventName(StringHash eventID)
 {
     HashMap<StringHash, String>::ConstIterator it = GetEventNameMap().Find(eventID);
@@ -428,10 +428,22 @@ struct ATOMIC_API EventNameRegistrar
     static HashMap<StringHash, String>& GetEventNameMap();
 };
 
+/// Register event parameter names.
+struct ATOMIC_API EventParamRegistrar
+{
+    /// Construct and register a parameter name for hash reverse mapping and the hash audit.
+    EventParamRegistrar(const char* paramName);
+};
+
 /// Describe an event's hash ID and begin a namespace in which to define its parameters.
 #define ATOMIC_EVENT(eventID, eventName) static const Atomic::StringHash eventID(Atomic::EventNameRegistrar::RegisterEventName(#eventName)); namespace eventName
-/// Describe an event's parameter hash ID. Should be used inside an event namespace.
-#define ATOMIC_PARAM(paramID, paramName) static const Atomic::StringHash paramID(#paramName)
+/// Describe an event's parameter hash ID. Should be used inside an event namespace. The hash is calculated at compile time.
+/// Profiling and tool builds also register the name once per module for reverse lookup and the hash audit.
+#if ENGINE_PROFILING || ENGINE_TOOLS
+#define ATOMIC_PARAM(paramID, paramName) static constexpr Atomic::StringHash paramID(#paramName); inline const Atomic::EventParamRegistrar paramID##Registrar(#paramName)
+#else
+#define ATOMIC_PARAM(paramID, paramName) static constexpr Atomic::StringHash paramID(#paramName)
+#endif
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
 #define ATOMIC_HANDLER(className, function) (new Atomic::EventHandlerImpl<className>(this, &className::function))
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function, and also defines a userdata pointer.
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Allocator.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 
@@ -126,6 +127,12 @@ void Time::EndFrame()
     ATOMIC_PROFILE(EndFrame);
     // Frame end event
     SendEvent(E_ENDFRAME);
+
+    // Transient frame memory is no longer referenced after the end frame event
+    FrameArenaReset();
+    const FrameArenaStats& arenaStats = GetFrameArenaStats();
+    ATOMIC_PROFILE_PLOT("FrameArenaAllocations", static_cast<i64>(arenaStats.numAllocations_));
+    ATOMIC_PROFILE_PLOT("FrameArenaBytes", static_cast<i64>(arenaStats.allocatedBytes_));
 }
 // ATOMIC END
 
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Allocator.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
@@ -328,6 +329,8 @@ void WorkQueue::ProcessItems(unsigned threadIndex)
                 queue_.PopFront();
                 queueMutex_.Release();
                 item->workFunction_(item, threadIndex);
+                // Frame memory of the thread is only used within a work item
+                FrameArenaRewindThread();
                 item->completed_ = true;
             }
             else
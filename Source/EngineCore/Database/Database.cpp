@@ -22,20 +22,114 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Database/Database.h"
+#include "../Database/DatabaseEvents.h"
+#include "../IO/Log.h"
 
 namespace Atomic
 {
 
+/// Asynchronous query.
+struct DbQuery
+{
+    /// Query ID.
+    unsigned id_;
+    /// Connection that sends the completion event.
+    SharedPtr<DbConnection> connection_;
+    /// SQL statement.
+    String sql_;
+    /// SQL statement of each parameter set when they differ.
+    StringVector sqls_;
+    /// Parameter sets. A batch executes the statement once for each.
+    Vector<VariantVector> paramSets_;
+    /// Batch flag.
+    bool batch_;
+    /// Result, written by the worker thread.
+    DbResult result_;
+};
+
+/// Asynchronous queries of a connection, executed in order by one work item at a time.
+struct DbQueryQueue
+{
+    /// Construct.
+    DbQueryQueue(DbConnection* connection) :
+        connection_(connection),
+        running_(false)
+    {
+    }
+
+    /// Connection.
+    SharedPtr<DbConnection> connection_;
+    /// Guards the queues and the running flag.
+    Mutex mutex_;
+    /// Queries waiting to be executed.
+    List<DbQuery*> pending_;
+    /// Finished queries waiting for their completion events.
+    Vector<DbQuery*> completed_;
+    /// Work item executing the queries.
+    SharedPtr<WorkItem> item_;
+    /// Work queue the item was added to.
+    WeakPtr<WorkQueue> workQueue_;
+    /// True while a work item is executing the pending queries.
+    bool running_;
+};
+
+/// Work item priority of asynchronous queries. Lowest, so that waiting for frame work never waits for them.
+static const unsigned DB_QUERY_PRIORITY = 0;
+
+static void ExecuteQueries(DbQueryQueue* queue)
+{
+    for (;;)
+    {
+        DbQuery* query;
+        {
+            MutexLock lock(queue->mutex_);
+            if (queue->pending_.Empty())
+            {
+                queue->running_ = false;
+                return;
+            }
+            query = queue->pending_.Front();
+            queue->pending_.PopFront();
+        }
+
+        if (!query->sqls_.Empty())
+            query->result_ = queue->connection_->ExecuteBatch(query->sqls_, query->paramSets_);
+        else if (query->batch_)
+            query->result_ = queue->connection_->ExecuteBatch(query->sql_, query->paramSets_);
+        else
+            query->result_ = queue->connection_->Execute(query->sql_, query->paramSets_[0]);
+
+        MutexLock lock(queue->mutex_);
+        queue->completed_.Push(query);
+    }
+}
+
+static void ExecuteQueriesWork(const WorkItem* item, unsigned threadIndex)
+{
+    ExecuteQueries(reinterpret_cast<DbQueryQueue*>(item->aux_));
+}
+
 Database::Database(Context* context_) :
     Object(context_),
 #ifdef ODBC_3_OR_LATER
-    poolSize_(0)
+    poolSize_(0),
 #else
-    poolSize_(M_MAX_UNSIGNED)
+    poolSize_(M_MAX_UNSIGNED),
 #endif
+    lastQueryID_(0),
+    numPendingQueries_(0)
 {
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(Database, HandleBeginFrame));
+}
+
+Database::~Database()
+{
+    WaitForQueries();
 }
 
 DBAPI Database::GetAPI()
@@ -82,6 +176,9 @@ void Database::Disconnect(DbConnection* connection)
 
     ATOMIC_PROFILE(DatabaseDisconnect);
 
+    // Queued queries still use the connection
+    WaitForQueries(connection);
+
     SharedPtr<DbConnection> dbConnection(connection);
     connections_.Remove(dbConnection);
 
@@ -96,4 +193,213 @@ void Database::Disconnect(DbConnection* connection)
     }
 }
 
+unsigned Database::ExecuteAsync(DbConnection* connection, const String& sql, const VariantVector& params)
+{
+    if (!connection || !connection->IsConnected())
+    {
+        ATOMIC_LOGERROR("Could not queue query: not connected");
+        return 0;
+    }
+
+    DbQuery* query = new DbQuery();
+    query->sql_ = sql;
+    query->paramSets_.Push(params);
+    query->batch_ = false;
+    return QueueQuery(connection, query);
+}
+
+unsigned Database::ExecuteBatchAsync(DbConnection* connection, const String& sql, const Vector<VariantVector>& paramSets)
+{
+    if (!connection || !connection->IsConnected())
+    {
+        ATOMIC_LOGERROR("Could not queue query: not connected");
+        return 0;
+    }
+
+    DbQuery* query = new DbQuery();
+    query->sql_ = sql;
+    query->paramSets_ = paramSets;
+    query->batch_ = true;
+    return QueueQuery(connection, query);
+}
+
+unsigned Database::ExecuteBatchAsync(DbConnection* connection, const StringVector& sqls, const Vector<VariantVector>& paramSets)
+{
+    if (!connection || !connection->IsConnected())
+    {
+        ATOMIC_LOGERROR("Could not queue query: not connected");
+        return 0;
+    }
+    if (sqls.Size() != paramSets.Size())
+    {
+        ATOMIC_LOGERROR("Could not queue query: the number of statements and parameter sets differ");
+        return 0;
+    }
+
+    DbQuery* query = new DbQuery();
+    query->sqls_ = sqls;
+    query->paramSets_ = paramSets;
+    query->batch_ = true;
+    return QueueQuery(connection, query);
+}
+
+void Database::WaitForQueries(DbConnection* connection)
+{
+    if (queryQueues_.Empty())
+        return;
+
+    ATOMIC_PROFILE(DatabaseWaitForQueries);
+
+    Vector<DbQuery*> completed;
+    for (HashMap<DbConnection*, DbQueryQueue*>::Iterator i = queryQueues_.Begin(); i != queryQueues_.End(); ++i)
+    {
+        DbQueryQueue* queue = i->second_;
+        if (connection && queue->connection_ != connection)
+            continue;
+
+        // A work item that has not started yet is taken back and executed here instead
+        WorkQueue* workQueue = queue->workQueue_;
+        if (queue->item_ && workQueue && workQueue->RemoveWorkItem(queue->item_))
+            ExecuteQueries(queue);
+        else
+        {
+            for (;;)
+            {
+                {
+                    MutexLock lock(queue->mutex_);
+                    if (!queue->running_)
+                        break;
+                }
+                Time::Sleep(0);
+            }
+        }
+        queue->item_.Reset();
+
+        TakeCompletedQueries(queue, completed);
+    }
+
+    RemoveIdleQueues();
+    SendQueryEvents(completed);
+}
+
+unsigned Database::QueueQuery(DbConnection* connection, DbQuery* query)
+{
+    query->id_ = ++lastQueryID_;
+    if (!query->id_)
+        query->id_ = ++lastQueryID_;
+    query->connection_ = connection;
+    ++numPendingQueries_;
+
+    DbQueryQueue* queue;
+    HashMap<DbConnection*, DbQueryQueue*>::Iterator i = queryQueues_.Find(connection);
+    if (i != queryQueues_.End())
+        queue = i->second_;
+    else
+    {
+        queue = new DbQueryQueue(connection);
+        queryQueues_[connection] = queue;
+    }
+
+    WorkQueue* workQueue = GetSubsystem<WorkQueue>();
+
+    {
+        MutexLock lock(queue->mutex_);
+        queue->pending_.Push(query);
+        if (queue->running_)
+            return query->id_;
+        queue->running_ = true;
+    }
+
+    if (!workQueue)
+    {
+        ExecuteQueries(queue);
+        return query->id_;
+    }
+
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->priority_ = DB_QUERY_PRIORITY;
+    item->workFunction_ = ExecuteQueriesWork;
+    item->aux_ = queue;
+    queue->item_ = item;
+    queue->workQueue_ = workQueue;
+    workQueue->AddWorkItem(item);
+
+    return query->id_;
+}
+
+void Database::TakeCompletedQueries(DbQueryQueue* queue, Vector<DbQuery*>& completed)
+{
+    MutexLock lock(queue->mutex_);
+    completed.Push(queue->completed_);
+    queue->completed_.Clear();
+}
+
+void Database::RemoveIdleQueues()
+{
+    // Only the main thread queues queries, so a queue found idle here stays idle and no work item refers to it
+    for (HashMap<DbConnection*, DbQueryQueue*>::Iterator i = queryQueues_.Begin(); i != queryQueues_.End();)
+    {
+        DbQueryQueue* queue = i->second_;
+        bool idle;
+        {
+            MutexLock lock(queue->mutex_);
+            idle = !queue->running_ && queue->pending_.Empty() && queue->completed_.Empty();
+        }
+
+        if (idle)
+        {
+            delete queue;
+            i = queryQueues_.Erase(i);
+        }
+        else
+            ++i;
+    }
+}
+
+void Database::SendQueryEvents(const Vector<DbQuery*>& completed)
+{
+    // Handlers may queue or wait for queries, so the queues are not accessed here
+    for (unsigned i = 0; i < completed.Size(); ++i)
+    {
+        DbQuery* query = completed[i];
+        const DbResult& result = query->result_;
+        SharedPtr<DbConnection> connection = query->connection_;
+
+        using namespace DbQueryCompleted;
+
+        VariantVector rows(result.GetNumRows());
+        for (unsigned j = 0; j < rows.Size(); ++j)
+            rows[j] = result.GetRows()[j];
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_DBCONNECTION] = connection.Get();
+        eventData[P_QUERYID] = query->id_;
+        eventData[P_SQL] = query->sql_;
+        eventData[P_SUCCESS] = result.IsSuccess();
+        eventData[P_NUMAFFECTEDROWS] = (int)result.GetNumAffectedRows();
+        eventData[P_COLHEADERS] = result.GetColumns();
+        eventData[P_ROWS] = rows;
+
+        delete query;
+        --numPendingQueries_;
+
+        connection->SendEvent(E_DBQUERYCOMPLETED, eventData);
+    }
+}
+
+void Database::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (queryQueues_.Empty())
+        return;
+
+    ATOMIC_PROFILE(SendDatabaseQueryEvents);
+
+    Vector<DbQuery*> completed;
+    for (HashMap<DbConnection*, DbQueryQueue*>::Iterator i = queryQueues_.Begin(); i != queryQueues_.End(); ++i)
+        TakeCompletedQueries(i->second_, completed);
+
+    RemoveIdleQueues();
+    SendQueryEvents(completed);
+}
+
 }
@@ -36,6 +36,8 @@ enum DBAPI
 };
 
 class DbConnection;
+struct DbQuery;
+struct DbQueryQueue;
 
 /// %Database subsystem. Manage database connections.
 class ATOMIC_API Database : public Object
@@ -45,6 +47,8 @@ class ATOMIC_API Database : public Object
 public:
     /// Construct.
     Database(Context* context_);
+    /// Destruct. Wait for queued asynchronous queries.
+    virtual ~Database();
     /// Return the underlying database API.
     static DBAPI GetAPI();
 
@@ -62,13 +66,41 @@ public:
     /// Set internal database connection pool size.
     void SetPoolSize(unsigned poolSize) { poolSize_ = poolSize; }
 
+    /// Execute an SQL statement with parameters on a worker thread. E_DBQUERYCOMPLETED is sent by the connection on the main thread when it has finished. Queries of a connection are executed in the order they were queued. Return the query ID, or 0 if failed.
+    unsigned ExecuteAsync(DbConnection* connection, const String& sql, const VariantVector& params = Variant::emptyVariantVector);
+    /// Execute an SQL statement once for each parameter set within a single transaction on a worker thread. E_DBQUERYCOMPLETED is sent by the connection on the main thread when the batch has finished. Return the query ID, or 0 if failed.
+    unsigned ExecuteBatchAsync(DbConnection* connection, const String& sql, const Vector<VariantVector>& paramSets);
+    /// Execute a different SQL statement for each parameter set within a single transaction on a worker thread. The SQL parameter of the completion event is empty. Return the query ID, or 0 if failed.
+    unsigned ExecuteBatchAsync(DbConnection* connection, const StringVector& sqls, const Vector<VariantVector>& paramSets);
+    /// Wait for the queued asynchronous queries of a connection, or of all connections when null, and send their completion events.
+    void WaitForQueries(DbConnection* connection = 0);
+    /// Return number of asynchronous queries that have not sent their completion event yet.
+    unsigned GetNumPendingQueries() const { return numPendingQueries_; }
+
 private:
+    /// Queue an asynchronous query and start executing the queries of its connection if not yet running.
+    unsigned QueueQuery(DbConnection* connection, DbQuery* query);
+    /// Move the finished queries of a connection to a vector.
+    void TakeCompletedQueries(DbQueryQueue* queue, Vector<DbQuery*>& completed);
+    /// Delete the queues of connections that have no more queries.
+    void RemoveIdleQueues();
+    /// Send completion events of finished queries and delete them.
+    void SendQueryEvents(const Vector<DbQuery*>& completed);
+    /// Send completion events of finished queries.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
     /// %Database connection pool size. Default to 0 when using ODBC 3.0 or later as ODBC 3.0 driver manager could manage its own database connection pool.
     unsigned poolSize_;
     /// Active database connections.
     Vector<SharedPtr<DbConnection> > connections_;
     ///%Database connections pool.
     HashMap<String, Vector<SharedPtr<DbConnection> > > connectionsPool_;
+    /// Asynchronous query queues of connections.
+    HashMap<DbConnection*, DbQueryQueue*> queryQueues_;
+    /// Last assigned asynchronous query ID.
+    unsigned lastQueryID_;
+    /// Number of asynchronous queries that have not sent their completion event yet.
+    unsigned numPendingQueries_;
 };
 
 }
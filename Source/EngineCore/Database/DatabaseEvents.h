@@ -41,4 +41,24 @@ ATOMIC_EVENT(E_DBCURSOR, DbCursor)
     ATOMIC_PARAM(P_ABORT, Abort);                  // bool [in]
 }
 
+/// Asynchronous query finished. Sent on the main thread by the DbConnection the query was executed on.
+ATOMIC_EVENT(E_DBQUERYCOMPLETED, DbQueryCompleted)
+{
+    ATOMIC_PARAM(P_DBCONNECTION, DbConnection);    // DbConnection pointer
+    ATOMIC_PARAM(P_QUERYID, QueryID);              // unsigned
+    ATOMIC_PARAM(P_SQL, SQL);                      // String
+    ATOMIC_PARAM(P_SUCCESS, Success);              // bool
+    ATOMIC_PARAM(P_NUMAFFECTEDROWS, NumAffectedRows); // int
+    ATOMIC_PARAM(P_COLHEADERS, ColHeaders);        // StringVector
+    ATOMIC_PARAM(P_ROWS, Rows);                    // VariantVector of VariantVector
+}
+
+/// DbWriteQueue write failed the retry limit and was moved to the failed writes file.
+ATOMIC_EVENT(E_DBWRITEFAILED, DbWriteFailed)
+{
+    ATOMIC_PARAM(P_SQL, SQL);                      // String
+    ATOMIC_PARAM(P_KEY, Key);                      // String
+    ATOMIC_PARAM(P_PARAMS, Params);                // VariantVector
+}
+
 }
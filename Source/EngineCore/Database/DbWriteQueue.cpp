@@ -0,0 +1,446 @@
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Database/Database.h"
+#include "../Database/DatabaseEvents.h"
+#include "../Database/DbWriteQueue.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+/// Default seconds between flushes.
+static const float DEFAULT_FLUSH_INTERVAL = 1.0f;
+/// Default number of pending writes that starts a flush early.
+static const unsigned DEFAULT_MAX_PENDING_WRITES = 4096;
+/// Default number of failed flushes of a write alone before it is given up.
+static const unsigned DEFAULT_MAX_FLUSH_RETRIES = 3;
+
+/// Write a size-prefixed journal record.
+static void WriteRecord(Serializer& dest, const String& sql, const String& key, const VariantVector& params)
+{
+    // The size prefix allows detecting a record cut short by a crash
+    VectorBuffer record;
+    record.WriteString(sql);
+    record.WriteString(key);
+    record.WriteVariantVector(params);
+
+    dest.WriteUInt(record.GetSize());
+    dest.Write(record.GetData(), record.GetSize());
+}
+
+DbWriteQueue::DbWriteQueue(Context* context) :
+    Object(context),
+    connection_(0),
+    numPendingWrites_(0),
+    retryBatchSize_(0),
+    flushQueryID_(0),
+    flushTimer_(0.0f),
+    flushInterval_(DEFAULT_FLUSH_INTERVAL),
+    maxPendingWrites_(DEFAULT_MAX_PENDING_WRITES),
+    maxFlushRetries_(DEFAULT_MAX_FLUSH_RETRIES)
+{
+}
+
+DbWriteQueue::~DbWriteQueue()
+{
+    Close();
+}
+
+bool DbWriteQueue::Open(const String& connectionString, const String& journalFileName)
+{
+    Close();
+
+    Database* database = GetSubsystem<Database>();
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    if (!database || !fileSystem)
+        return false;
+
+    connection_ = database->Connect(connectionString);
+    if (!connection_)
+        return false;
+
+    journalFileName_ = journalFileName;
+    String flushingName = GetFlushingJournalName();
+    String tempName = journalFileName_ + ".tmp";
+
+    // A compacted journal is written to a temporary file and then moved over the journal. If interrupted after the
+    // journal was removed, the temporary file is complete, otherwise it may not be
+    if (fileSystem->FileExists(tempName))
+    {
+        if (fileSystem->FileExists(journalFileName_))
+            fileSystem->Delete(tempName);
+        else
+            fileSystem->Rename(tempName, journalFileName_);
+    }
+
+    // Replay the writes of an unfinished flush first, as the journal has the later writes
+    unsigned numRecovered = ReadJournal(flushingName) + ReadJournal(journalFileName_);
+
+    if (numRecovered)
+    {
+        ATOMIC_LOGINFOF("Recovered %u writes from journal %s", numRecovered, journalFileName_.CString());
+        stats_.numRecovered_ += numRecovered;
+
+        for (unsigned i = 0; i < writes_.Size(); ++i)
+        {
+            if (!writes_[i].sql_.Empty())
+                JournalWrite(writes_[i].sql_, writes_[i].key_, writes_[i].params_);
+        }
+
+        File tempFile(context_);
+        if (!tempFile.Open(tempName, FILE_WRITE) ||
+            tempFile.Write(journalBuffer_.GetData(), journalBuffer_.GetSize()) != journalBuffer_.GetSize())
+        {
+            ATOMIC_LOGERROR("Could not write journal " + tempName);
+            database->Disconnect(connection_);
+            connection_ = 0;
+            writes_.Clear();
+            writeIndices_.Clear();
+            numPendingWrites_ = 0;
+            journalBuffer_.Clear();
+            return false;
+        }
+        tempFile.Close();
+        journalBuffer_.Clear();
+
+        fileSystem->Delete(journalFileName_);
+        fileSystem->Delete(flushingName);
+        fileSystem->Rename(tempName, journalFileName_);
+    }
+    else
+        fileSystem->Delete(flushingName);
+
+    journal_ = new File(context_);
+    if (!journal_->Open(journalFileName_, FILE_APPEND))
+    {
+        ATOMIC_LOGERROR("Could not open journal " + journalFileName_);
+        journal_.Reset();
+        database->Disconnect(connection_);
+        connection_ = 0;
+        return false;
+    }
+
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(DbWriteQueue, HandleBeginFrame));
+    SubscribeToEvent(connection_, E_DBQUERYCOMPLETED, ATOMIC_HANDLER(DbWriteQueue, HandleQueryCompleted));
+
+    flushTimer_ = 0.0f;
+    if (numPendingWrites_)
+        Flush();
+
+    return true;
+}
+
+void DbWriteQueue::Close()
+{
+    if (!connection_)
+        return;
+
+    bool committed = FlushAndWait();
+
+    UnsubscribeFromAllEvents();
+
+    GetSubsystem<Database>()->Disconnect(connection_);
+    connection_ = 0;
+
+    journal_->Close();
+    journal_.Reset();
+
+    // Keep the journal of writes that could not be committed for the next time the queue is opened
+    if (committed)
+        GetSubsystem<FileSystem>()->Delete(journalFileName_);
+    else
+        ATOMIC_LOGERRORF("Closed with %u uncommitted writes kept in journal %s", numPendingWrites_ + retryWrites_.Size(),
+            journalFileName_.CString());
+
+    writes_.Clear();
+    retryWrites_.Clear();
+    retryBatchSize_ = 0;
+    writeIndices_.Clear();
+    numPendingWrites_ = 0;
+}
+
+void DbWriteQueue::Write(const String& sql, const String& key, const VariantVector& params)
+{
+    if (!connection_)
+    {
+        ATOMIC_LOGERROR("Could not queue write: not open");
+        return;
+    }
+
+    ++stats_.numWrites_;
+    AddWrite(sql, key, params);
+    JournalWrite(sql, key, params);
+
+    if (numPendingWrites_ >= maxPendingWrites_)
+        Flush();
+}
+
+void DbWriteQueue::Flush()
+{
+    if (!connection_ || flushQueryID_ || (!numPendingWrites_ && retryWrites_.Empty()))
+        return;
+
+    ATOMIC_PROFILE(DbWriteQueueFlush);
+
+    flushTimer_ = 0.0f;
+
+    flushingWrites_.Clear();
+
+    // A failed write replaced by a later write is not retried
+    for (unsigned i = retryWrites_.Size(); i-- > 0;)
+    {
+        if (writeIndices_.Contains(MakePair(retryWrites_[i].sql_, retryWrites_[i].key_)))
+            retryWrites_.Erase(i);
+    }
+
+    if (retryWrites_.Size())
+    {
+        // Writes of failed flushes go first so that later writes of the same rows are not overwritten by them
+        unsigned count = Min(retryBatchSize_, retryWrites_.Size());
+        flushingWrites_.Insert(flushingWrites_.End(), retryWrites_.Begin(), retryWrites_.Begin() + count);
+        retryWrites_.Erase(0, count);
+    }
+    else
+    {
+        flushingWrites_.Reserve(numPendingWrites_);
+        for (unsigned i = 0; i < writes_.Size(); ++i)
+        {
+            if (!writes_[i].sql_.Empty())
+                flushingWrites_.Push(writes_[i]);
+        }
+
+        writes_.Clear();
+        writeIndices_.Clear();
+        numPendingWrites_ = 0;
+    }
+
+    StringVector sqls;
+    Vector<VariantVector> paramSets;
+    sqls.Reserve(flushingWrites_.Size());
+    paramSets.Reserve(flushingWrites_.Size());
+    for (unsigned i = 0; i < flushingWrites_.Size(); ++i)
+    {
+        sqls.Push(flushingWrites_[i].sql_);
+        paramSets.Push(flushingWrites_[i].params_);
+    }
+
+    // The journal up to here covers the flushed writes and is kept until they have been committed, while later writes go
+    // to a new journal. The writes left for later flushes are journaled again
+    WriteJournal();
+    journal_->Close();
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    fileSystem->Rename(journalFileName_, GetFlushingJournalName());
+    if (!journal_->Open(journalFileName_, FILE_APPEND))
+        ATOMIC_LOGERROR("Could not open journal " + journalFileName_);
+
+    for (unsigned i = 0; i < retryWrites_.Size(); ++i)
+        JournalWrite(retryWrites_[i].sql_, retryWrites_[i].key_, retryWrites_[i].params_);
+    for (unsigned i = 0; i < writes_.Size(); ++i)
+    {
+        if (!writes_[i].sql_.Empty())
+            JournalWrite(writes_[i].sql_, writes_[i].key_, writes_[i].params_);
+    }
+    WriteJournal();
+
+    flushQueryID_ = GetSubsystem<Database>()->ExecuteBatchAsync(connection_, sqls, paramSets);
+}
+
+bool DbWriteQueue::FlushAndWait()
+{
+    if (!connection_)
+        return false;
+
+    Database* database = GetSubsystem<Database>();
+
+    // Finish a flush in progress, after which its failed writes are retried. Keep flushing while failed batches are split,
+    // but not after a write has failed on its own, as it is only retried after the flush interval
+    database->WaitForQueries(connection_);
+    while (numPendingWrites_ || retryWrites_.Size())
+    {
+        unsigned numFailedFlushes = stats_.numFailedFlushes_;
+        Flush();
+        database->WaitForQueries(connection_);
+        if (stats_.numFailedFlushes_ != numFailedFlushes && retryBatchSize_ <= 1)
+            break;
+    }
+
+    WriteJournal();
+    return !numPendingWrites_ && retryWrites_.Empty();
+}
+
+void DbWriteQueue::AddWrite(const String& sql, const String& key, const VariantVector& params)
+{
+    Pair<String, String> writeKey(sql, key);
+
+    // The replaced write is left in place as empty, as moving the write to the end keeps it after other writes that were
+    // queued in between
+    HashMap<Pair<String, String>, unsigned>::Iterator i = writeIndices_.Find(writeKey);
+    if (i != writeIndices_.End())
+    {
+        DbWrite& replaced = writes_[i->second_];
+        replaced.sql_.Clear();
+        replaced.params_.Clear();
+        --numPendingWrites_;
+        ++stats_.numCoalesced_;
+        i->second_ = writes_.Size();
+    }
+    else
+        writeIndices_[writeKey] = writes_.Size();
+
+    writes_.Resize(writes_.Size() + 1);
+    DbWrite& write = writes_.Back();
+    write.sql_ = sql;
+    write.key_ = key;
+    write.params_ = params;
+    write.numFailures_ = 0;
+    ++numPendingWrites_;
+}
+
+void DbWriteQueue::JournalWrite(const String& sql, const String& key, const VariantVector& params)
+{
+    WriteRecord(journalBuffer_, sql, key, params);
+}
+
+void DbWriteQueue::WriteJournal()
+{
+    if (!journalBuffer_.GetSize() || !journal_ || !journal_->IsOpen())
+        return;
+
+    if (journal_->Write(journalBuffer_.GetData(), journalBuffer_.GetSize()) != journalBuffer_.GetSize())
+        ATOMIC_LOGERROR("Could not write journal " + journalFileName_);
+    journal_->Flush();
+    journalBuffer_.Clear();
+}
+
+void DbWriteQueue::FailWrite(const DbWrite& write)
+{
+    ATOMIC_LOGERRORF("Giving up write of key %s after %u failed flushes: %s", write.key_.CString(), write.numFailures_,
+        write.sql_.CString());
+    ++stats_.numFailedWrites_;
+
+    String fileName = GetFailedWritesFileName();
+    File file(context_);
+    if (file.Open(fileName, FILE_APPEND))
+        WriteRecord(file, write.sql_, write.key_, write.params_);
+    else
+        ATOMIC_LOGERROR("Could not write failed writes file " + fileName);
+
+    using namespace DbWriteFailed;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SQL] = write.sql_;
+    eventData[P_KEY] = write.key_;
+    eventData[P_PARAMS] = write.params_;
+    SendEvent(E_DBWRITEFAILED, eventData);
+}
+
+unsigned DbWriteQueue::ReadJournal(const String& fileName)
+{
+    if (!GetSubsystem<FileSystem>()->FileExists(fileName))
+        return 0;
+
+    File file(context_);
+    if (!file.Open(fileName, FILE_READ))
+        return 0;
+
+    unsigned numRead = 0;
+    while (file.GetSize() - file.GetPosition() >= sizeof(unsigned))
+    {
+        unsigned size = file.ReadUInt();
+        if (file.GetSize() - file.GetPosition() < size)
+        {
+            ATOMIC_LOGWARNING("Ignoring incomplete record at the end of journal " + fileName);
+            break;
+        }
+
+        VectorBuffer record(file, size);
+        String sql = record.ReadString();
+        String key = record.ReadString();
+        VariantVector params = record.ReadVariantVector();
+        AddWrite(sql, key, params);
+        ++numRead;
+    }
+
+    return numRead;
+}
+
+void DbWriteQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    using namespace BeginFrame;
+
+    WriteJournal();
+
+    flushTimer_ += eventData[P_TIMESTEP].GetFloat();
+    if (flushTimer_ >= flushInterval_)
+        Flush();
+}
+
+void DbWriteQueue::HandleQueryCompleted(StringHash eventType, VariantMap& eventData)
+{
+    using namespace DbQueryCompleted;
+
+    if (!flushQueryID_ || eventData[P_QUERYID].GetUInt() != flushQueryID_)
+        return;
+
+    flushQueryID_ = 0;
+
+    if (eventData[P_SUCCESS].GetBool())
+    {
+        ++stats_.numFlushes_;
+        stats_.numFlushedWrites_ += flushingWrites_.Size();
+
+        // Retry the rest of the failed writes in larger batches again
+        if (retryWrites_.Size())
+            retryBatchSize_ *= 2;
+    }
+    else
+    {
+        ++stats_.numFailedFlushes_;
+
+        Vector<DbWrite> failedWrites;
+        if (flushingWrites_.Size() > 1)
+        {
+            // Split the batch to isolate the failing write, retrying the first half on the next frame
+            ATOMIC_LOGWARNINGF("Could not flush %u writes, retrying in smaller batches", flushingWrites_.Size());
+            failedWrites = flushingWrites_;
+            retryBatchSize_ = (flushingWrites_.Size() + 1) / 2;
+            flushTimer_ = flushInterval_;
+        }
+        else
+        {
+            DbWrite& write = flushingWrites_[0];
+            if (++write.numFailures_ >= maxFlushRetries_)
+                FailWrite(write);
+            else
+            {
+                ATOMIC_LOGWARNINGF("Could not flush write of key %s, retrying with the next flush", write.key_.CString());
+                failedWrites.Push(write);
+            }
+            retryBatchSize_ = 1;
+        }
+
+        // Retry the writes unless replaced by a later write, and move them to the current journal
+        unsigned count = 0;
+        for (unsigned i = 0; i < failedWrites.Size(); ++i)
+        {
+            const DbWrite& write = failedWrites[i];
+            if (!writeIndices_.Contains(MakePair(write.sql_, write.key_)))
+            {
+                retryWrites_.Insert(count++, write);
+                JournalWrite(write.sql_, write.key_, write.params_);
+            }
+        }
+        WriteJournal();
+    }
+
+    flushingWrites_.Clear();
+    GetSubsystem<FileSystem>()->Delete(GetFlushingJournalName());
+}
+
+}
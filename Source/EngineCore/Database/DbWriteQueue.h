@@ -0,0 +1,169 @@
+#pragma once
+
+#include "../Core/Object.h"
+#include "../IO/VectorBuffer.h"
+
+namespace Atomic
+{
+
+class DbConnection;
+class File;
+
+/// Write-behind queue statistics.
+struct DbWriteQueueStats
+{
+    /// Construct.
+    DbWriteQueueStats() :
+        numWrites_(0),
+        numCoalesced_(0),
+        numFlushes_(0),
+        numFlushedWrites_(0),
+        numFailedFlushes_(0),
+        numFailedWrites_(0),
+        numRecovered_(0)
+    {
+    }
+
+    /// Number of queued writes.
+    unsigned numWrites_;
+    /// Number of queued writes replaced by a later write of the same statement and key before being flushed.
+    unsigned numCoalesced_;
+    /// Number of committed flushes.
+    unsigned numFlushes_;
+    /// Number of writes executed by committed flushes.
+    unsigned numFlushedWrites_;
+    /// Number of flushes that failed and were queued again.
+    unsigned numFailedFlushes_;
+    /// Number of writes that failed the retry limit and were moved to the failed writes file.
+    unsigned numFailedWrites_;
+    /// Number of writes replayed from the journal when opened.
+    unsigned numRecovered_;
+};
+
+/// Write-behind queue for frequent row updates, such as persisting entity state every frame. Writes are collected for a
+/// flush interval, and a write replacing a pending write of the same SQL statement and row key is coalesced so that only
+/// the latest one is executed. Each flush executes the pending writes in order within one transaction on a background
+/// connection, using the asynchronous queries of the Database subsystem. Writes are also appended to a journal file once
+/// per frame, and the writes that were not committed are replayed when the queue is opened again after a crash. Replayed
+/// writes may already have been committed, so they should be idempotent, such as updates or INSERT OR REPLACE.
+///
+/// The writes of a failed flush are retried before any pending writes, in batches halved on each failure, so that a write
+/// that fails on its own is isolated from the others. A write that has failed on its own for the retry limit is moved to
+/// the failed writes file next to the journal, in the journal record format, and E_DBWRITEFAILED is sent.
+class ATOMIC_API DbWriteQueue : public Object
+{
+    ATOMIC_OBJECT(DbWriteQueue, Object);
+
+public:
+    /// Construct.
+    DbWriteQueue(Context* context);
+    /// Destruct. Close if open.
+    virtual ~DbWriteQueue();
+
+    /// Connect to a database and open the journal, replaying writes left in it. Return true if successful.
+    bool Open(const String& connectionString, const String& journalFileName);
+    /// Flush the pending writes and wait for them, then disconnect. The journal is removed if everything was committed.
+    void Close();
+
+    /// Queue a write of a row. A pending write with the same SQL statement and key is replaced.
+    void Write(const String& sql, const String& key, const VariantVector& params);
+    /// Start flushing the pending writes now. Does nothing while a flush is in progress.
+    void Flush();
+    /// Flush the pending writes and wait until they have been committed, retrying failed writes that can be isolated. Return true if no writes are left.
+    bool FlushAndWait();
+
+    /// Set seconds between flushes. Default 1.
+    void SetFlushInterval(float interval) { flushInterval_ = Max(interval, 0.0f); }
+    /// Set number of pending writes that starts a flush before the interval has passed. Default 4096.
+    void SetMaxPendingWrites(unsigned count) { maxPendingWrites_ = Max(count, 1U); }
+    /// Set number of flushes a write may fail on its own before it is moved to the failed writes file. Default 3.
+    void SetMaxFlushRetries(unsigned count) { maxFlushRetries_ = Max(count, 1U); }
+
+    /// Return seconds between flushes.
+    float GetFlushInterval() const { return flushInterval_; }
+    /// Return number of pending writes that starts a flush before the interval has passed.
+    unsigned GetMaxPendingWrites() const { return maxPendingWrites_; }
+    /// Return number of flushes a write may fail on its own before it is moved to the failed writes file.
+    unsigned GetMaxFlushRetries() const { return maxFlushRetries_; }
+    /// Return number of writes waiting for the next flush.
+    unsigned GetNumPendingWrites() const { return numPendingWrites_; }
+    /// Return number of writes of failed flushes waiting to be retried.
+    unsigned GetNumRetryWrites() const { return retryWrites_.Size(); }
+    /// Return true while a flush is in progress.
+    bool IsFlushing() const { return flushQueryID_ != 0; }
+    /// Return true when open.
+    bool IsOpen() const { return connection_ != 0; }
+    /// Return the background connection.
+    DbConnection* GetConnection() const { return connection_; }
+    /// Return file name of the writes that failed the retry limit.
+    String GetFailedWritesFileName() const { return journalFileName_ + ".failed"; }
+    /// Return statistics.
+    const DbWriteQueueStats& GetStats() const { return stats_; }
+
+private:
+    /// Queued write.
+    struct DbWrite
+    {
+        /// SQL statement, empty when replaced by a later write.
+        String sql_;
+        /// Row key.
+        String key_;
+        /// Statement parameters.
+        VariantVector params_;
+        /// Number of flushes of this write alone that failed.
+        unsigned numFailures_;
+    };
+
+    /// Add a write to the pending writes, replacing a pending write of the same statement and key.
+    void AddWrite(const String& sql, const String& key, const VariantVector& params);
+    /// Append a write to the journal buffer.
+    void JournalWrite(const String& sql, const String& key, const VariantVector& params);
+    /// Write the journal buffer to the journal file.
+    void WriteJournal();
+    /// Move a write that failed the retry limit to the failed writes file and send E_DBWRITEFAILED.
+    void FailWrite(const DbWrite& write);
+    /// Read writes from a journal file into the pending writes. Return number of writes read.
+    unsigned ReadJournal(const String& fileName);
+    /// Return file name of the journal of the flush in progress.
+    String GetFlushingJournalName() const { return journalFileName_ + ".flushing"; }
+
+    /// Write the journal and start a flush when due.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+    /// Finish a flush.
+    void HandleQueryCompleted(StringHash eventType, VariantMap& eventData);
+
+    /// Background connection.
+    DbConnection* connection_;
+    /// Journal file name.
+    String journalFileName_;
+    /// Journal file.
+    SharedPtr<File> journal_;
+    /// Journal records not yet written to the file.
+    VectorBuffer journalBuffer_;
+    /// Pending writes in the order they were queued.
+    Vector<DbWrite> writes_;
+    /// Index of the pending write of each statement and key.
+    HashMap<Pair<String, String>, unsigned> writeIndices_;
+    /// Number of pending writes that have not been replaced.
+    unsigned numPendingWrites_;
+    /// Writes of failed flushes to retry before the pending writes, in the order they were queued.
+    Vector<DbWrite> retryWrites_;
+    /// Number of writes retried in one flush.
+    unsigned retryBatchSize_;
+    /// Writes of the flush in progress.
+    Vector<DbWrite> flushingWrites_;
+    /// Asynchronous query ID of the flush in progress, or 0.
+    unsigned flushQueryID_;
+    /// Seconds since the last flush.
+    float flushTimer_;
+    /// Seconds between flushes.
+    float flushInterval_;
+    /// Pending writes that start a flush early.
+    unsigned maxPendingWrites_;
+    /// Failed flushes of a write alone before it is given up.
+    unsigned maxFlushRetries_;
+    /// Statistics.
+    DbWriteQueueStats stats_;
+};
+
+}
@@ -2,4 +2,5 @@
 #include "./Database.h"
 #include "./DatabaseEvents.h"
 #include "./DbConnection.h"
-#include "./DbResult.h"
\ No newline at end of file
+#include "./DbResult.h"
+#include "./DbWriteQueue.h"
\ No newline at end of file
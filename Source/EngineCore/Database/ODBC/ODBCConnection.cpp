@@ -36,9 +36,63 @@
 namespace Atomic
 {
 
+/// Default maximum number of cached prepared statements.
+static const unsigned DEFAULT_STATEMENT_CACHE_SIZE = 64;
+
+/// Storage for bound parameter values, which nanodbc reads through pointers when the statement is executed.
+struct ODBCParameter
+{
+    /// Integer value.
+    int64_t int_;
+    /// Floating point value.
+    double double_;
+    /// String value.
+    nanodbc::string_type string_;
+    /// Length of a binary value.
+    SQLLEN length_;
+};
+
+static Variant GetColumnValue(nanodbc::result& result, short index)
+{
+    Variant value;
+    if (result.is_null(index))
+        return value;
+
+    // We can only bind primitive data type that our Variant class supports
+    switch (result.column_c_datatype(index))
+    {
+    case SQL_C_LONG:
+        value = result.get<int>(index);
+        if (result.column_datatype(index) == SQL_BIT)
+            value = value != 0;
+        break;
+
+    case SQL_C_SBIGINT:
+        value = (long long)result.get<int64_t>(index);
+        break;
+
+    case SQL_C_FLOAT:
+        value = result.get<float>(index);
+        break;
+
+    case SQL_C_DOUBLE:
+        value = result.get<double>(index);
+        break;
+
+    default:
+        // All other types are stored using their string representation in the Variant
+        value = result.get<nanodbc::string_type>(index).c_str();
+        break;
+    }
+
+    return value;
+}
+
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
-    connectionString_(connectionString)
+    connectionString_(connectionString),
+    transactionImpl_(0),
+    statementCacheSize_(DEFAULT_STATEMENT_CACHE_SIZE)
 {
     try
     {
@@ -67,16 +121,38 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    MutexLock lock(mutex_);
+
+    // Cursors still open return their statements to the cache, which is emptied next
+    while (!cursors_.Empty())
+        cursors_.Back()->Close();
+
+    statements_.Clear();
+
+    if (transactionImpl_)
+    {
+        ATOMIC_LOGWARNING("Rolling back unfinished transaction");
+        RollbackTransaction();
+    }
 }
 
 DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    return Execute(sql, Variant::emptyVariantVector, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(const String& sql, const VariantVector& params, bool useCursorEvent)
 {
     DbResult result;
 
+    MutexLock lock(mutex_);
+
+    String trimmedSqlStr = sql.Trimmed();
+    nanodbc::statement statement;
+
     try
     {
-        result.resultImpl_ = nanodbc::execute(connectionImpl_, sql.Trimmed().CString());
+        result.resultImpl_ = ExecuteStatement(statement, trimmedSqlStr, params);
         unsigned numCols = (unsigned)result.resultImpl_.columns();
         if (numCols)
         {
@@ -91,33 +167,7 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
             {
                 VariantVector colValues(numCols);
                 for (unsigned i = 0; i < numCols; ++i)
-                {
-                    if (!result.resultImpl_.is_null((short)i))
-                    {
-                        // We can only bind primitive data type that our Variant class supports
-                        switch (result.resultImpl_.column_c_datatype((short)i))
-                        {
-                        case SQL_C_LONG:
-                            colValues[i] = result.resultImpl_.get<int>((short)i);
-                            if (result.resultImpl_.column_datatype((short)i) == SQL_BIT)
-                                colValues[i] = colValues[i] != 0;
-                            break;
-
-                        case SQL_C_FLOAT:
-                            colValues[i] = result.resultImpl_.get<float>((short)i);
-                            break;
-
-                        case SQL_C_DOUBLE:
-                            colValues[i] = result.resultImpl_.get<double>((short)i);
-                            break;
-
-                        default:
-                            // All other types are stored using their string representation in the Variant
-                            colValues[i] = result.resultImpl_.get<nanodbc::string_type>((short)i).c_str();
-                            break;
-                        }
-                    }
-                }
+                    colValues[i] = GetColumnValue(result.resultImpl_, (short)i);
 
                 if (useCursorEvent)
                 {
@@ -146,19 +196,355 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
             }
         }
         result.numAffectedRows_ = numCols ? -1 : result.resultImpl_.affected_rows();
+        result.success_ = true;
     }
     catch (std::runtime_error& e)
     {
         HandleRuntimeError("Could not execute", e.what());
     }
 
+    ReleaseStatement(trimmedSqlStr, statement);
     return result;
 }
 
+DbResult DbConnection::ExecuteBatch(const String& sql, const Vector<VariantVector>& paramSets)
+{
+    return ExecuteBatchInternal(StringVector(), sql, paramSets);
+}
+
+DbResult DbConnection::ExecuteBatch(const StringVector& sqls, const Vector<VariantVector>& paramSets)
+{
+    if (sqls.Size() != paramSets.Size())
+    {
+        ATOMIC_LOGERROR("Could not execute: the number of statements and parameter sets differ");
+        return DbResult();
+    }
+
+    return ExecuteBatchInternal(sqls, String::EMPTY, paramSets);
+}
+
+SharedPtr<DbRowCursor> DbConnection::OpenCursor(const String& sql, const VariantVector& params)
+{
+    MutexLock lock(mutex_);
+
+    String trimmedSqlStr = sql.Trimmed();
+    nanodbc::statement statement;
+
+    try
+    {
+        nanodbc::result result = ExecuteStatement(statement, trimmedSqlStr, params);
+        SharedPtr<DbRowCursor> cursor(new DbRowCursor(this, trimmedSqlStr, statement, result));
+        cursors_.Push(cursor);
+        return cursor;
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not execute", e.what());
+    }
+
+    ReleaseStatement(trimmedSqlStr, statement);
+    return SharedPtr<DbRowCursor>();
+}
+
+bool DbConnection::BeginTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (transactionImpl_)
+    {
+        ATOMIC_LOGERROR("Could not begin transaction: a transaction is already active");
+        return false;
+    }
+
+    try
+    {
+        transactionImpl_ = new nanodbc::transaction(connectionImpl_);
+        return true;
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not begin transaction", e.what());
+        return false;
+    }
+}
+
+bool DbConnection::CommitTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!transactionImpl_)
+        return false;
+
+    bool success = true;
+    try
+    {
+        transactionImpl_->commit();
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not commit transaction", e.what());
+        success = false;
+    }
+
+    // An uncommitted transaction is rolled back when destroyed
+    delete transactionImpl_;
+    transactionImpl_ = 0;
+    return success;
+}
+
+bool DbConnection::RollbackTransaction()
+{
+    MutexLock lock(mutex_);
+
+    if (!transactionImpl_)
+        return false;
+
+    transactionImpl_->rollback();
+    delete transactionImpl_;
+    transactionImpl_ = 0;
+    return true;
+}
+
+void DbConnection::SetStatementCacheSize(unsigned size)
+{
+    MutexLock lock(mutex_);
+
+    statementCacheSize_ = size;
+    while (statements_.Size() > statementCacheSize_)
+        statements_.Erase(statements_.Begin());
+}
+
+DbResult DbConnection::ExecuteBatchInternal(const StringVector& sqls, const String& sql, const Vector<VariantVector>& paramSets)
+{
+    DbResult result;
+
+    MutexLock lock(mutex_);
+
+    // Join the transaction of the caller if there is one, otherwise commit once for the whole batch
+    bool ownTransaction = !transactionImpl_;
+    if (ownTransaction && !BeginTransaction())
+        return result;
+
+    String trimmedSqlStr = sql.Trimmed();
+    nanodbc::statement statement;
+    long numAffectedRows = 0;
+    bool success = true;
+
+    try
+    {
+        for (unsigned i = 0; i < paramSets.Size(); ++i)
+        {
+            // Consecutive entries with the same SQL text reuse the statement
+            if (!sqls.Empty())
+            {
+                String entrySqlStr = sqls[i].Trimmed();
+                if (entrySqlStr != trimmedSqlStr)
+                {
+                    ReleaseStatement(trimmedSqlStr, statement);
+                    trimmedSqlStr = entrySqlStr;
+                }
+            }
+
+            nanodbc::result batchResult = ExecuteStatement(statement, trimmedSqlStr, paramSets[i]);
+            numAffectedRows += batchResult.affected_rows();
+        }
+    }
+    catch (std::runtime_error& e)
+    {
+        HandleRuntimeError("Could not execute", e.what());
+        success = false;
+    }
+
+    ReleaseStatement(trimmedSqlStr, statement);
+
+    if (ownTransaction)
+    {
+        if (success)
+            success = CommitTransaction();
+        else
+            RollbackTransaction();
+    }
+
+    result.numAffectedRows_ = numAffectedRows;
+    result.success_ = success;
+    return result;
+}
+
+nanodbc::result DbConnection::ExecuteStatement(nanodbc::statement& statement, const String& sql, const VariantVector& params)
+{
+    // A cached statement is taken out of the cache while in use, so that an open cursor and a query of the same SQL
+    // text do not share it
+    if (!statement.open())
+    {
+        HashMap<String, nanodbc::statement>::Iterator i = statements_.Find(sql);
+        if (i != statements_.End())
+        {
+            statement = i->second_;
+            statements_.Erase(i);
+        }
+        else
+            statement.prepare(connectionImpl_, sql.CString());
+    }
+
+    statement.reset_parameters();
+
+    // The values must stay in place until the statement has been executed
+    Vector<ODBCParameter> values(params.Size());
+    for (unsigned i = 0; i < params.Size(); ++i)
+    {
+        const Variant& param = params[i];
+        ODBCParameter& value = values[i];
+        short index = (short)i;
+
+        switch (param.GetType())
+        {
+        case VAR_NONE:
+            statement.bind_null(index);
+            break;
+
+        case VAR_BOOL:
+        case VAR_INT:
+        case VAR_INT64:
+            value.int_ = param.GetInt64();
+            statement.bind(index, &value.int_);
+            break;
+
+        case VAR_FLOAT:
+        case VAR_DOUBLE:
+            value.double_ = param.GetDouble();
+            statement.bind(index, &value.double_);
+            break;
+
+        case VAR_BUFFER:
+            {
+                // nanodbc can not bind binary data, so the buffer is bound through ODBC directly
+                static unsigned char emptyData = 0;
+                const PODVector<unsigned char>& buffer = param.GetBuffer();
+                value.length_ = (SQLLEN)buffer.Size();
+                SQLRETURN rc = SQLBindParameter((SQLHSTMT)statement.native_statement_handle(), (SQLUSMALLINT)(index + 1),
+                    SQL_PARAM_INPUT, SQL_C_BINARY, SQL_VARBINARY, Max(buffer.Size(), 1U), 0,
+                    buffer.Size() ? (SQLPOINTER)&buffer[0] : (SQLPOINTER)&emptyData, value.length_, &value.length_);
+                if (!SQL_SUCCEEDED(rc))
+                    throw nanodbc::programming_error("Could not bind binary parameter " + std::to_string(i + 1));
+            }
+            break;
+
+        default:
+            // All other types are bound using their string representation
+            value.string_ = param.ToString().CString();
+            statement.bind(index, value.string_.c_str());
+            break;
+        }
+    }
+
+    return statement.execute();
+}
+
+void DbConnection::ReleaseStatement(const String& sql, nanodbc::statement& statement)
+{
+    if (!statement.open())
+        return;
+
+    statement.reset_parameters();
+
+    // Statements are taken out while in use and inserted back at the end, so the cache is ordered from least to most
+    // recently used, and the least recently used statement is evicted when full
+    if (statementCacheSize_ && !statements_.Contains(sql))
+    {
+        statements_[sql] = statement;
+        while (statements_.Size() > statementCacheSize_)
+            statements_.Erase(statements_.Begin());
+    }
+    statement = nanodbc::statement();
+}
+
 void DbConnection::HandleRuntimeError(const char* message, const char* cause)
 {
     StringVector tokens = (String(cause) + "::").Split(':');      // Added "::" as sentinels against unexpected cause format
     ATOMIC_LOGERRORF("%s: nanodbc:%s:%s", message, tokens[1].CString(), tokens[2].CString());
 }
 
+DbRowCursor::DbRowCursor(DbConnection* connection, const String& sql, const nanodbc::statement& statementImpl,
+    const nanodbc::result& resultImpl) :
+    connection_(connection),
+    sql_(sql),
+    statementImpl_(statementImpl),
+    resultImpl_(resultImpl),
+    hasRow_(false)
+{
+    unsigned numCols = (unsigned)resultImpl_.columns();
+    columns_.Resize(numCols);
+    for (unsigned i = 0; i < numCols; ++i)
+        columns_[i] = resultImpl_.column_name((short)i).c_str();
+}
+
+DbRowCursor::~DbRowCursor()
+{
+    Close();
+}
+
+bool DbRowCursor::Next()
+{
+    if (!connection_)
+        return false;
+
+    MutexLock lock(connection_->mutex_);
+
+    try
+    {
+        hasRow_ = resultImpl_.next();
+    }
+    catch (std::runtime_error& e)
+    {
+        connection_->HandleRuntimeError("Could not fetch", e.what());
+        hasRow_ = false;
+    }
+
+    return hasRow_;
+}
+
+void DbRowCursor::Close()
+{
+    if (!connection_)
+        return;
+
+    MutexLock lock(connection_->mutex_);
+
+    resultImpl_ = nanodbc::result();
+    connection_->cursors_.Remove(this);
+    connection_->ReleaseStatement(sql_, statementImpl_);
+    connection_ = 0;
+    hasRow_ = false;
+}
+
+Variant DbRowCursor::GetValue(unsigned index) const
+{
+    return hasRow_ && index < columns_.Size() ? GetColumnValue(resultImpl_, (short)index) : Variant::EMPTY;
+}
+
+bool DbRowCursor::IsNull(unsigned index) const
+{
+    return !hasRow_ || index >= columns_.Size() || resultImpl_.is_null((short)index);
+}
+
+int DbRowCursor::GetInt(unsigned index) const
+{
+    return IsNull(index) ? 0 : resultImpl_.get<int>((short)index);
+}
+
+long long DbRowCursor::GetInt64(unsigned index) const
+{
+    return IsNull(index) ? 0 : (long long)resultImpl_.get<int64_t>((short)index);
+}
+
+double DbRowCursor::GetDouble(unsigned index) const
+{
+    return IsNull(index) ? 0.0 : resultImpl_.get<double>((short)index);
+}
+
+String DbRowCursor::GetString(unsigned index) const
+{
+    return IsNull(index) ? String::EMPTY : String(resultImpl_.get<nanodbc::string_type>((short)index).c_str());
+}
+
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../../Core/Mutex.h"
 #include "../../Core/Object.h"
 #include "../../Database/DbResult.h"
 
@@ -45,6 +46,30 @@ public:
 
     /// Execute an SQL statements immediately. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
     DbResult Execute(const String& sql, bool useCursorEvent = false);
+    /// Execute an SQL statement with parameters bound to its ? placeholders in order. The statement is prepared once and reused by later calls with the same SQL text. Send E_DBCURSOR event for each row in the resultset when useCursorEvent parameter is set to true.
+    DbResult Execute(const String& sql, const VariantVector& params, bool useCursorEvent = false);
+    /// Execute an SQL statement once for each parameter set within a single transaction, or within the current transaction if one is active. The number of affected rows is the total of all executions. Stop at the first failure, rolling back the batch's own transaction but leaving a current transaction to the caller.
+    DbResult ExecuteBatch(const String& sql, const Vector<VariantVector>& paramSets);
+    /// Execute a different SQL statement for each parameter set within a single transaction, in the same way as above. The statement and parameter set counts must match.
+    DbResult ExecuteBatch(const StringVector& sqls, const Vector<VariantVector>& paramSets);
+    /// Execute an SQL statement with parameters and return a cursor to step through its rows without fetching them all. Return null if failed.
+    SharedPtr<DbRowCursor> OpenCursor(const String& sql, const VariantVector& params = Variant::emptyVariantVector);
+
+    /// Begin a transaction. Return true if successful.
+    bool BeginTransaction();
+    /// Commit the current transaction. Return true if successful.
+    bool CommitTransaction();
+    /// Roll back the current transaction. Return true if successful.
+    bool RollbackTransaction();
+    /// Return true when a transaction is active.
+    bool IsInTransaction() const { return transactionImpl_ != 0; }
+
+    /// Set maximum number of prepared statements kept for reuse. Default 64.
+    void SetStatementCacheSize(unsigned size);
+    /// Return maximum number of prepared statements kept for reuse.
+    unsigned GetStatementCacheSize() const { return statementCacheSize_; }
+    /// Return number of prepared statements kept for reuse.
+    unsigned GetNumCachedStatements() const { return statements_.Size(); }
 
     /// Return database connection string. The connection string for SQLite3 is using the URI format described in https://www.sqlite.org/uri.html, while the connection string for ODBC is using DSN format as per ODBC standard.
     const String& GetConnectionString() const { return connectionString_; }
@@ -56,6 +81,15 @@ public:
     bool IsConnected() const { return connectionImpl_.connected(); }
 
 private:
+    friend class DbRowCursor;
+
+    /// Execute a batch of parameter sets with either one SQL statement for each, or the same SQL statement for all when the statement collection is empty.
+    DbResult ExecuteBatchInternal(const StringVector& sqls, const String& sql, const Vector<VariantVector>& paramSets);
+    /// Take a prepared statement from the cache or prepare a new one, then bind parameters and execute it. Throw on error.
+    nanodbc::result ExecuteStatement(nanodbc::statement& statement, const String& sql, const VariantVector& params);
+    /// Return a statement to the cache, or drop it if the cache is full.
+    void ReleaseStatement(const String& sql, nanodbc::statement& statement);
+
     /// Internal helper method to handle runtime exception by logging it to stderr stream.
     void HandleRuntimeError(const char* message, const char* cause);
 
@@ -63,6 +97,16 @@ private:
     String connectionString_;
     /// The underlying implementation connection object.
     nanodbc::connection connectionImpl_;
+    /// The current transaction, or null.
+    nanodbc::transaction* transactionImpl_;
+    /// Prepared statements not in use, keyed by SQL text, from least to most recently used.
+    HashMap<String, nanodbc::statement> statements_;
+    /// Open cursors, closed when the connection is finalized.
+    PODVector<DbRowCursor*> cursors_;
+    /// Maximum number of cached statements.
+    unsigned statementCacheSize_;
+    /// Serializes use of the connection between the main thread and the asynchronous queries of the Database subsystem.
+    mutable Mutex mutex_;
 };
 
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../../Container/RefCounted.h"
 #include "../../Core/Variant.h"
 
 #include <nanodbc.h>
@@ -37,10 +38,14 @@ class ATOMIC_API DbResult
 public:
     /// Default constructor constructs an empty result object.
     DbResult() :
-        numAffectedRows_(-1)
+        numAffectedRows_(-1),
+        success_(false)
     {
     }
 
+    /// Return true when the SQL statement was executed without error.
+    bool IsSuccess() const { return success_; }
+
     /// Return number of columns in the resultset or 0 if there is no resultset.
     unsigned GetNumColumns() const { return columns_.Size(); }
 
@@ -68,6 +73,69 @@ private:
     Vector<VariantVector> rows_;
     /// Number of affected rows by recent DML query.
     long numAffectedRows_;
+    /// Success flag.
+    bool success_;
+};
+
+class DbConnection;
+
+/// Forward-only cursor over the resultset of a prepared SQL statement. Rows are fetched one at a time as the cursor advances instead of being collected into a DbResult.
+class ATOMIC_API DbRowCursor : public RefCounted
+{
+    ATOMIC_REFCOUNTED(DbRowCursor)
+
+    friend class DbConnection;
+
+public:
+    /// Destruct. Return the statement to the connection.
+    ~DbRowCursor();
+
+    /// Advance to the next row. Return false when there are no more rows or on error.
+    bool Next();
+    /// Release the statement before the cursor is destroyed.
+    void Close();
+
+    /// Return true while the statement is held by the cursor.
+    bool IsOpen() const { return connection_ != 0; }
+
+    /// Return number of columns in the resultset.
+    unsigned GetNumColumns() const { return columns_.Size(); }
+
+    /// Return the column headers string collection.
+    const StringVector& GetColumns() const { return columns_; }
+
+    /// Return the value of a column in the current row, converted the same way as in DbResult. Return empty if the column is null.
+    Variant GetValue(unsigned index) const;
+    /// Return true if a column in the current row is null.
+    bool IsNull(unsigned index) const;
+    /// Return a column in the current row as an integer.
+    int GetInt(unsigned index) const;
+    /// Return a column in the current row as a 64-bit integer.
+    long long GetInt64(unsigned index) const;
+    /// Return a column in the current row as a double.
+    double GetDouble(unsigned index) const;
+    /// Return a column in the current row as a string.
+    String GetString(unsigned index) const;
+
+    /// Return the underlying implementation result object.
+    const nanodbc::result& GetResultImpl() const { return resultImpl_; }
+
+private:
+    /// Construct. Called by DbConnection.
+    DbRowCursor(DbConnection* connection, const String& sql, const nanodbc::statement& statementImpl, const nanodbc::result& resultImpl);
+
+    /// Connection owning the statement.
+    DbConnection* connection_;
+    /// SQL text the statement is cached by.
+    String sql_;
+    /// The underlying implementation statement object.
+    nanodbc::statement statementImpl_;
+    /// The underlying implementation result object.
+    mutable nanodbc::result resultImpl_;
+    /// Column headers from the resultset.
+    StringVector columns_;
+    /// True when positioned on a row.
+    bool hasRow_;
 };
 
 }
@@ -28,10 +28,99 @@
 namespace Atomic
 {
 
+/// Default maximum number of cached prepared statements.
+static const unsigned DEFAULT_STATEMENT_CACHE_SIZE = 64;
+
+static Variant GetColumnValue(sqlite3_stmt* pStmt, int index)
+{
+    Variant value;
+
+    // We can only bind primitive data type that our Variant class supports
+    switch (sqlite3_column_type(pStmt, index))
+    {
+    case SQLITE_NULL:
+        break;
+
+    case SQLITE_INTEGER:
+        {
+            sqlite3_int64 intValue = sqlite3_column_int64(pStmt, index);
+            if (intValue >= M_MIN_INT && intValue <= M_MAX_INT)
+                value = (int)intValue;
+            else
+                value = (long long)intValue;
+            const char* declType = sqlite3_column_decltype(pStmt, index);
+            if (declType && String(declType).Compare("BOOLEAN", false) == 0)
+                value = intValue != 0;
+        }
+        break;
+
+    case SQLITE_FLOAT:
+        value = sqlite3_column_double(pStmt, index);
+        break;
+
+    case SQLITE_BLOB:
+        {
+            const unsigned char* data = (const unsigned char*)sqlite3_column_blob(pStmt, index);
+            PODVector<unsigned char> buffer((unsigned)sqlite3_column_bytes(pStmt, index));
+            if (buffer.Size())
+                memcpy(&buffer[0], data, buffer.Size());
+            value = buffer;
+        }
+        break;
+
+    default:
+        // All other types are stored using their string representation in the Variant
+        value = (const char*)sqlite3_column_text(pStmt, index);
+        break;
+    }
+
+    return value;
+}
+
+static int BindParameter(sqlite3_stmt* pStmt, int index, const Variant& value)
+{
+    switch (value.GetType())
+    {
+    case VAR_NONE:
+        return sqlite3_bind_null(pStmt, index);
+
+    case VAR_BOOL:
+    case VAR_INT:
+        return sqlite3_bind_int(pStmt, index, value.GetInt());
+
+    case VAR_INT64:
+        return sqlite3_bind_int64(pStmt, index, value.GetInt64());
+
+    case VAR_FLOAT:
+    case VAR_DOUBLE:
+        return sqlite3_bind_double(pStmt, index, value.GetDouble());
+
+    case VAR_STRING:
+        {
+            const String& str = value.GetString();
+            return sqlite3_bind_text(pStmt, index, str.CString(), (int)str.Length(), SQLITE_TRANSIENT);
+        }
+
+    case VAR_BUFFER:
+        {
+            const PODVector<unsigned char>& buffer = value.GetBuffer();
+            return sqlite3_bind_blob(pStmt, index, buffer.Size() ? &buffer[0] : 0, (int)buffer.Size(), SQLITE_TRANSIENT);
+        }
+
+    default:
+        // All other types are bound using their string representation
+        {
+            String str = value.ToString();
+            return sqlite3_bind_text(pStmt, index, str.CString(), (int)str.Length(), SQLITE_TRANSIENT);
+        }
+    }
+}
+
 DbConnection::DbConnection(Context* context, const String& connectionString) :
     Object(context),
     connectionString_(connectionString),
-    connectionImpl_(0)
+    connectionImpl_(0),
+    statementCacheSize_(DEFAULT_STATEMENT_CACHE_SIZE)
 {
     if (sqlite3_open(connectionString.CString(), &connectionImpl_) != SQLITE_OK)
     {
@@ -55,33 +144,247 @@ DbConnection::~DbConnection()
 
 void DbConnection::Finalize()
 {
-    // TODO
+    MutexLock lock(mutex_);
+
+    // Cursors still open return their statements to the cache, which is emptied next
+    while (!cursors_.Empty())
+        cursors_.Back()->Close();
+
+    for (HashMap<String, sqlite3_stmt*>::Iterator i = statements_.Begin(); i != statements_.End(); ++i)
+        sqlite3_finalize(i->second_);
+    statements_.Clear();
+
+    if (connectionImpl_ && !sqlite3_get_autocommit(connectionImpl_))
+    {
+        ATOMIC_LOGWARNING("Rolling back unfinished transaction");
+        ExecuteCommand("ROLLBACK");
+    }
 }
 
 DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
+{
+    return Execute(sql, Variant::emptyVariantVector, useCursorEvent);
+}
+
+DbResult DbConnection::Execute(const String& sql, const VariantVector& params, bool useCursorEvent)
 {
     DbResult result;
-    const char* zLeftover = 0;
-    sqlite3_stmt* pStmt = 0;
     assert(connectionImpl_);
 
+    MutexLock lock(mutex_);
+
     // 2016-10-09: Prevent string corruption when trimmed is returned.
     String trimmedSqlStr = sql.Trimmed();
 
-    int rc = sqlite3_prepare_v2(connectionImpl_, trimmedSqlStr.CString(), -1, &pStmt, &zLeftover);
-    if (rc != SQLITE_OK)
-    {
-        ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        assert(!pStmt);
+    sqlite3_stmt* pStmt = AcquireStatement(trimmedSqlStr, params);
+    if (!pStmt)
         return result;
+
+    ExecuteStatement(result, sql, pStmt, useCursorEvent);
+    ReleaseStatement(trimmedSqlStr, pStmt);
+    return result;
+}
+
+DbResult DbConnection::ExecuteBatch(const String& sql, const Vector<VariantVector>& paramSets)
+{
+    return ExecuteBatchInternal(StringVector(), sql, paramSets);
+}
+
+DbResult DbConnection::ExecuteBatch(const StringVector& sqls, const Vector<VariantVector>& paramSets)
+{
+    if (sqls.Size() != paramSets.Size())
+    {
+        ATOMIC_LOGERROR("Could not execute: the number of statements and parameter sets differ");
+        return DbResult();
+    }
+
+    return ExecuteBatchInternal(sqls, String::EMPTY, paramSets);
+}
+
+SharedPtr<DbRowCursor> DbConnection::OpenCursor(const String& sql, const VariantVector& params)
+{
+    assert(connectionImpl_);
+
+    MutexLock lock(mutex_);
+
+    String trimmedSqlStr = sql.Trimmed();
+    sqlite3_stmt* pStmt = AcquireStatement(trimmedSqlStr, params);
+    if (!pStmt)
+        return SharedPtr<DbRowCursor>();
+
+    SharedPtr<DbRowCursor> cursor(new DbRowCursor(this, trimmedSqlStr, pStmt));
+    cursors_.Push(cursor);
+    return cursor;
+}
+
+bool DbConnection::BeginTransaction()
+{
+    MutexLock lock(mutex_);
+    return ExecuteCommand("BEGIN");
+}
+
+bool DbConnection::CommitTransaction()
+{
+    MutexLock lock(mutex_);
+    return ExecuteCommand("COMMIT");
+}
+
+bool DbConnection::RollbackTransaction()
+{
+    MutexLock lock(mutex_);
+    return ExecuteCommand("ROLLBACK");
+}
+
+bool DbConnection::IsInTransaction() const
+{
+    return connectionImpl_ && !sqlite3_get_autocommit(connectionImpl_);
+}
+
+void DbConnection::SetStatementCacheSize(unsigned size)
+{
+    MutexLock lock(mutex_);
+
+    statementCacheSize_ = size;
+    while (statements_.Size() > statementCacheSize_)
+    {
+        HashMap<String, sqlite3_stmt*>::Iterator i = statements_.Begin();
+        sqlite3_finalize(i->second_);
+        statements_.Erase(i);
     }
-    if (*zLeftover)
+}
+
+sqlite3_stmt* DbConnection::AcquireStatement(const String& sql, const VariantVector& params)
+{
+    sqlite3_stmt* pStmt = 0;
+
+    // A cached statement is taken out of the cache while in use, so that an open cursor and a query of the same SQL
+    // text do not share it
+    HashMap<String, sqlite3_stmt*>::Iterator i = statements_.Find(sql);
+    if (i != statements_.End())
+    {
+        pStmt = i->second_;
+        statements_.Erase(i);
+    }
+    else
+    {
+        const char* zLeftover = 0;
+        int rc = sqlite3_prepare_v2(connectionImpl_, sql.CString(), -1, &pStmt, &zLeftover);
+        if (rc != SQLITE_OK)
+        {
+            ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
+            assert(!pStmt);
+            return 0;
+        }
+        if (*zLeftover)
+        {
+            ATOMIC_LOGERROR("Could not execute: only one SQL statement is allowed");
+            sqlite3_finalize(pStmt);
+            return 0;
+        }
+    }
+
+    if ((int)params.Size() != sqlite3_bind_parameter_count(pStmt))
+    {
+        ATOMIC_LOGERRORF("Could not execute: expected %d parameters but %u were given", sqlite3_bind_parameter_count(pStmt),
+            params.Size());
+        ReleaseStatement(sql, pStmt);
+        return 0;
+    }
+
+    for (unsigned j = 0; j < params.Size(); ++j)
+    {
+        if (BindParameter(pStmt, (int)j + 1, params[j]) != SQLITE_OK)
+        {
+            ATOMIC_LOGERRORF("Could not bind parameter %u: %s", j + 1, sqlite3_errmsg(connectionImpl_));
+            ReleaseStatement(sql, pStmt);
+            return 0;
+        }
+    }
+
+    return pStmt;
+}
+
+void DbConnection::ReleaseStatement(const String& sql, sqlite3_stmt* pStmt)
+{
+    sqlite3_reset(pStmt);
+    sqlite3_clear_bindings(pStmt);
+
+    // A statement of the same SQL text may have been cached while this one was in use
+    if (!statementCacheSize_ || statements_.Contains(sql))
     {
-        ATOMIC_LOGERROR("Could not execute: only one SQL statement is allowed");
         sqlite3_finalize(pStmt);
+        return;
+    }
+
+    // Statements are taken out while in use and inserted back at the end, so the cache is ordered from least to most
+    // recently used, and the least recently used statement is evicted when full
+    statements_[sql] = pStmt;
+    while (statements_.Size() > statementCacheSize_)
+    {
+        HashMap<String, sqlite3_stmt*>::Iterator i = statements_.Begin();
+        sqlite3_finalize(i->second_);
+        statements_.Erase(i);
+    }
+}
+
+DbResult DbConnection::ExecuteBatchInternal(const StringVector& sqls, const String& sql, const Vector<VariantVector>& paramSets)
+{
+    DbResult result;
+    assert(connectionImpl_);
+
+    MutexLock lock(mutex_);
+
+    // Join the transaction of the caller if there is one, otherwise commit once for the whole batch
+    bool ownTransaction = sqlite3_get_autocommit(connectionImpl_) != 0;
+    if (ownTransaction && !ExecuteCommand("BEGIN"))
         return result;
+
+    String trimmedSqlStr = sql.Trimmed();
+    long numAffectedRows = 0;
+    bool success = true;
+    for (unsigned i = 0; i < paramSets.Size(); ++i)
+    {
+        if (!sqls.Empty())
+            trimmedSqlStr = sqls[i].Trimmed();
+
+        sqlite3_stmt* pStmt = AcquireStatement(trimmedSqlStr, paramSets[i]);
+        if (!pStmt)
+        {
+            success = false;
+            break;
+        }
+
+        int rc;
+        while ((rc = sqlite3_step(pStmt)) == SQLITE_ROW)
+            ;
+        if (rc == SQLITE_DONE)
+            numAffectedRows += sqlite3_changes(connectionImpl_);
+        else
+        {
+            ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
+            success = false;
+        }
+
+        ReleaseStatement(trimmedSqlStr, pStmt);
+        if (!success)
+            break;
     }
 
+    if (ownTransaction)
+    {
+        if (success)
+            success = ExecuteCommand("COMMIT");
+        if (!success)
+            ExecuteCommand("ROLLBACK");
+    }
+
+    result.numAffectedRows_ = numAffectedRows;
+    result.success_ = success;
+    return result;
+}
+
+void DbConnection::ExecuteStatement(DbResult& result, const String& sql, sqlite3_stmt* pStmt, bool useCursorEvent)
+{
     unsigned numCols = (unsigned)sqlite3_column_count(pStmt);
     result.columns_.Resize(numCols);
     for (unsigned i = 0; i < numCols; ++i)
@@ -92,35 +395,12 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
 
     while (1)
     {
-        rc = sqlite3_step(pStmt);
+        int rc = sqlite3_step(pStmt);
         if (rc == SQLITE_ROW)
         {
             VariantVector colValues(numCols);
             for (unsigned i = 0; i < numCols; ++i)
-            {
-                int type = sqlite3_column_type(pStmt, i);
-                if (type != SQLITE_NULL)
-                {
-                    // We can only bind primitive data type that our Variant class supports
-                    switch (type)
-                    {
-                    case SQLITE_INTEGER:
-                        colValues[i] = sqlite3_column_int(pStmt, i);
-                        if (String(sqlite3_column_decltype(pStmt, i)).Compare("BOOLEAN", false) == 0)
-                            colValues[i] = colValues[i] != 0;
-                        break;
-
-                    case SQLITE_FLOAT:
-                        colValues[i] = sqlite3_column_double(pStmt, i);
-                        break;
-
-                    default:
-                        // All other types are stored using their string representation in the Variant
-                        colValues[i] = (const char*)sqlite3_column_text(pStmt, i);
-                        break;
-                    }
-                }
-            }
+                colValues[i] = GetColumnValue(pStmt, i);
 
             if (useCursorEvent)
             {
@@ -146,21 +426,111 @@ DbResult DbConnection::Execute(const String& sql, bool useCursorEvent)
                 result.rows_.Push(colValues);
             if (aborted)
             {
-                sqlite3_finalize(pStmt);
+                result.success_ = true;
                 break;
             }
         }
-        else if (rc != SQLITE_DONE)
-            ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
-        if (rc != SQLITE_ROW)
+        else
         {
-            sqlite3_finalize(pStmt);
+            if (rc == SQLITE_DONE)
+                result.success_ = true;
+            else
+                ATOMIC_LOGERRORF("Could not execute: %s", sqlite3_errmsg(connectionImpl_));
             break;
         }
     }
 
     result.numAffectedRows_ = numCols ? -1 : sqlite3_changes(connectionImpl_);
-    return result;
+}
+
+bool DbConnection::ExecuteCommand(const char* sql)
+{
+    sqlite3_stmt* pStmt = AcquireStatement(sql, Variant::emptyVariantVector);
+    if (!pStmt)
+        return false;
+
+    int rc = sqlite3_step(pStmt);
+    if (rc != SQLITE_DONE)
+        ATOMIC_LOGERRORF("Could not execute %s: %s", sql, sqlite3_errmsg(connectionImpl_));
+
+    ReleaseStatement(sql, pStmt);
+    return rc == SQLITE_DONE;
+}
+
+DbRowCursor::DbRowCursor(DbConnection* connection, const String& sql, sqlite3_stmt* statementImpl) :
+    connection_(connection),
+    sql_(sql),
+    statementImpl_(statementImpl),
+    hasRow_(false)
+{
+    unsigned numCols = (unsigned)sqlite3_column_count(statementImpl_);
+    columns_.Resize(numCols);
+    for (unsigned i = 0; i < numCols; ++i)
+        columns_[i] = sqlite3_column_name(statementImpl_, i);
+}
+
+DbRowCursor::~DbRowCursor()
+{
+    Close();
+}
+
+bool DbRowCursor::Next()
+{
+    if (!statementImpl_)
+        return false;
+
+    MutexLock lock(connection_->mutex_);
+
+    int rc = sqlite3_step(statementImpl_);
+    hasRow_ = rc == SQLITE_ROW;
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE)
+        ATOMIC_LOGERRORF("Could not fetch: %s", sqlite3_errmsg(connection_->connectionImpl_));
+
+    return hasRow_;
+}
+
+void DbRowCursor::Close()
+{
+    if (!statementImpl_)
+        return;
+
+    MutexLock lock(connection_->mutex_);
+
+    connection_->cursors_.Remove(this);
+    connection_->ReleaseStatement(sql_, statementImpl_);
+    statementImpl_ = 0;
+    hasRow_ = false;
+}
+
+Variant DbRowCursor::GetValue(unsigned index) const
+{
+    return hasRow_ && index < columns_.Size() ? GetColumnValue(statementImpl_, index) : Variant::EMPTY;
+}
+
+bool DbRowCursor::IsNull(unsigned index) const
+{
+    return !hasRow_ || index >= columns_.Size() || sqlite3_column_type(statementImpl_, index) == SQLITE_NULL;
+}
+
+int DbRowCursor::GetInt(unsigned index) const
+{
+    return hasRow_ && index < columns_.Size() ? sqlite3_column_int(statementImpl_, index) : 0;
+}
+
+long long DbRowCursor::GetInt64(unsigned index) const
+{
+    return hasRow_ && index < columns_.Size() ? sqlite3_column_int64(statementImpl_, index) : 0;
+}
+
+double DbRowCursor::GetDouble(unsigned index) const
+{
+    return hasRow_ && index < columns_.Size() ? sqlite3_column_double(statementImpl_, index) : 0.0;
+}
+
+String DbRowCursor::GetString(unsigned index) const
+{
+    const char* text = hasRow_ && index < columns_.Size() ? (const char*)sqlite3_column_text(statementImpl_, index) : 0;
+    return text ? String(text) : String::EMPTY;
 }
 
 }
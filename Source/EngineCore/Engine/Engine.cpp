@@ -36,6 +36,7 @@
 #include "../Engine/EngineDefs.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/DrawCommandQueue.h"
 #include "../Input/Input.h"
 #include "../IO/FileSystem.h"
@@ -326,6 +327,10 @@ bool Engine::Initialize(const VariantMap& parameters)
             return false;
 
         graphics->SetShaderCacheDir(GetParameter(parameters, EP_SHADER_CACHE_DIR, fileSystem->GetAppPreferencesDir(ENGINE_NAME, "shadercache")).GetString());
+        graphics->SetAsyncShaderCompile(GetParameter(parameters, EP_ASYNC_SHADER_COMPILE, false).GetBool());
+        String shaderCacheArchive = GetParameter(parameters, EP_SHADER_CACHE_ARCHIVE, "Shaders/ShaderCache.rsca").GetString();
+        if (!shaderCacheArchive.Empty() && cache->Exists(shaderCacheArchive))
+            graphics->LoadShaderCacheArchive(shaderCacheArchive);
 
         if (HasParameter(parameters, EP_DUMP_SHADERS))
             graphics->BeginDumpShaders(GetParameter(parameters, EP_DUMP_SHADERS, String::EMPTY).GetString());
@@ -339,6 +344,7 @@ bool Engine::Initialize(const VariantMap& parameters)
         renderer->SetTextureQuality(GetParameter(parameters, EP_TEXTURE_QUALITY, QUALITY_HIGH).GetInt());
         renderer->SetTextureFilterMode((TextureFilterMode)GetParameter(parameters, EP_TEXTURE_FILTER_MODE, FILTER_TRILINEAR).GetInt());
         renderer->SetTextureAnisotropy(GetParameter(parameters, EP_TEXTURE_ANISOTROPY, 4).GetInt());
+        renderer->GetTextureStreamer()->SetEnabled(GetParameter(parameters, EP_TEXTURE_STREAMING, false).GetBool());
 
         if (GetParameter(parameters, EP_SOUND, true).GetBool())
         {
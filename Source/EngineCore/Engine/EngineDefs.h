@@ -26,6 +26,7 @@ namespace Atomic
 {
 
 // Engine parameters
+static const String EP_ASYNC_SHADER_COMPILE = "AsyncShaderCompile";
 static const String EP_AUTOLOAD_PATHS = "AutoloadPaths";
 static const String EP_BORDERLESS = "Borderless";
 static const String EP_DUMP_SHADERS = "DumpShaders";
@@ -51,6 +52,7 @@ static const String EP_REFRESH_RATE = "RefreshRate";
 static const String EP_RESOURCE_PACKAGES = "ResourcePackages";
 static const String EP_RESOURCE_PATHS = "ResourcePaths";
 static const String EP_RESOURCE_PREFIX_PATHS = "ResourcePrefixPaths";
+static const String EP_SHADER_CACHE_ARCHIVE = "ShaderCacheArchive";
 static const String EP_SHADER_CACHE_DIR = "ShaderCacheDir";
 static const String EP_SHADOWS = "Shadows";
 static const String EP_SOUND = "Sound";
@@ -61,6 +63,7 @@ static const String EP_SOUND_STEREO = "SoundStereo";
 static const String EP_TEXTURE_ANISOTROPY = "TextureAnisotropy";
 static const String EP_TEXTURE_FILTER_MODE = "TextureFilterMode";
 static const String EP_TEXTURE_QUALITY = "TextureQuality";
+static const String EP_TEXTURE_STREAMING = "TextureStreaming";
 static const String EP_TIME_OUT = "TimeOut";
 static const String EP_TOUCH_EMULATION = "TouchEmulation";
 static const String EP_TRIPLE_BUFFER = "TripleBuffer";
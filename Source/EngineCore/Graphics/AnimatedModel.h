@@ -53,6 +53,8 @@ public:
     virtual bool LoadXML(const XMLElement& source, bool setInstanceDefault = false);
     /// Load from JSON data. Return true if successful.
     virtual bool LoadJSON(const JSONValue& source, bool setInstanceDefault = false);
+    /// Return true, as loading must not create the bone nodes that are loaded as child nodes.
+    virtual bool HasCustomLoad() const { return true; }
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     virtual void ApplyAttributes();
     /// Process octree raycast. May be called from a worker thread.
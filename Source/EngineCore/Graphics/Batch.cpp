@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/Allocator.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
@@ -40,46 +41,147 @@
 namespace Atomic
 {
 
-inline bool CompareBatchesState(Batch* lhs, Batch* rhs)
+inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->sortKey_ != rhs->sortKey_)
-        return lhs->sortKey_ < rhs->sortKey_;
-    else
-        return lhs->distance_ < rhs->distance_;
+    return lhs.distance_ < rhs.distance_;
 }
 
-inline bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+/// Number of batches below which an insertion sort is used instead of radix sort passes.
+static const unsigned RADIX_SORT_THRESHOLD = 128;
+
+/// Batch with a radix sort key.
+struct BatchSortEntry
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    /// Sort key.
+    unsigned long long key_;
+    /// Batch.
+    Batch* batch_;
+};
+
+/// Return a distance as an unsigned key with the same ordering.
+inline unsigned long long GetDistanceKey(float distance)
+{
+    unsigned bits;
+    memcpy(&bits, &distance, sizeof bits);
+    return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
 }
 
-inline bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
+/// Return a key ordering batches by render order, then by distance front to back.
+inline unsigned long long GetFrontToBackKey(const Batch* batch)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    return ((unsigned long long)batch->renderOrder_ << 32) | GetDistanceKey(batch->distance_);
 }
 
-inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
+/// Return a key ordering batches by render order, then by distance back to front.
+inline unsigned long long GetBackToFrontKey(const Batch* batch)
 {
-    return lhs.distance_ < rhs.distance_;
+    return ((unsigned long long)batch->renderOrder_ << 32) | (~GetDistanceKey(batch->distance_) & 0xffffffff);
+}
+
+/// Return the state sort key of a batch.
+inline unsigned long long GetStateKey(const Batch* batch)
+{
+    return batch->sortKey_;
 }
 
-inline bool CompareBatchGroupOrder(BatchGroup* lhs, BatchGroup* rhs)
+/// Return the render order of a batch.
+inline unsigned long long GetRenderOrderKey(const Batch* batch)
 {
-    return lhs->renderOrder_ < rhs->renderOrder_;
+    return batch->renderOrder_;
 }
 
+/// Stable least significant digit radix sort of batches by 64-bit keys, one byte per pass. Passes over a byte that is the
+/// same in all keys are skipped, and few batches are insertion sorted. Sorting by several keys from the least to the most significant orders by all of them, with
+/// batches that compare equal keeping their original order. The buffers come from the calling thread's frame arena.
+class BatchRadixSort
+{
+public:
+    /// Construct from batches in their current order.
+    BatchRadixSort(Batch** batches, unsigned count) :
+        entries_(count),
+        temp_(count),
+        count_(count)
+    {
+        entries_.Resize(count);
+        temp_.Resize(count);
+        for (unsigned i = 0; i < count; ++i)
+            entries_[i].batch_ = batches[i];
+    }
+
+    /// Sort by a key, keeping the order of batches with equal keys.
+    template <class KeyFunction> void Sort(KeyFunction getKey)
+    {
+        BatchSortEntry* src = entries_.Begin();
+        if (count_ < RADIX_SORT_THRESHOLD)
+        {
+            for (unsigned i = 0; i < count_; ++i)
+                src[i].key_ = getKey(src[i].batch_);
+
+            for (unsigned i = 1; i < count_; ++i)
+            {
+                BatchSortEntry entry = src[i];
+                unsigned j = i;
+                for (; j > 0 && src[j - 1].key_ > entry.key_; --j)
+                    src[j] = src[j - 1];
+                src[j] = entry;
+            }
+            return;
+        }
+
+        unsigned histograms[8][256];
+        memset(histograms, 0, sizeof histograms);
+
+        for (unsigned i = 0; i < count_; ++i)
+        {
+            unsigned long long key = getKey(src[i].batch_);
+            src[i].key_ = key;
+            for (unsigned j = 0; j < 8; ++j)
+                ++histograms[j][(key >> (j * 8)) & 0xff];
+        }
+
+        BatchSortEntry* dest = temp_.Begin();
+        for (unsigned j = 0; j < 8; ++j)
+        {
+            unsigned shift = j * 8;
+            unsigned* histogram = histograms[j];
+            if (histogram[(src[0].key_ >> shift) & 0xff] == count_)
+                continue;
+
+            unsigned offset = 0;
+            for (unsigned k = 0; k < 256; ++k)
+            {
+                unsigned digitCount = histogram[k];
+                histogram[k] = offset;
+                offset += digitCount;
+            }
+
+            for (unsigned i = 0; i < count_; ++i)
+                dest[histogram[(src[i].key_ >> shift) & 0xff]++] = src[i];
+
+            Swap(src, dest);
+        }
+
+        // Keep the sorted entries in the entry buffer for the next sort
+        if (src != entries_.Begin())
+            memcpy(entries_.Begin(), src, count_ * sizeof(BatchSortEntry));
+    }
+
+    /// Copy the sorted batches back.
+    void Store(Batch** batches) const
+    {
+        for (unsigned i = 0; i < count_; ++i)
+            batches[i] = entries_[i].batch_;
+    }
+
+private:
+    /// Batches and their keys in sorted order.
+    FramePODVector<BatchSortEntry> entries_;
+    /// Buffer for every other pass.
+    FramePODVector<BatchSortEntry> temp_;
+    /// Number of batches.
+    unsigned count_;
+};
+
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
 {
     Camera* shadowCamera = queue->shadowSplits_[split].shadowCamera_;
@@ -664,8 +766,8 @@ void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 
 void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
-    // Do not use up buffer space if not going to draw as instanced
-    if (geometryType_ != GEOM_INSTANCED)
+    // Do not use up buffer space if not going to draw as instanced, or if the transforms are already in a persistent buffer
+    if (geometryType_ != GEOM_INSTANCED || instanceBuffer_)
         return;
 
     startIndex_ = freeIndex;
@@ -696,7 +798,14 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
     {
         // Draw as individual objects if instancing not supported or could not fill the instancing buffer
         VertexBuffer* instance_buffer = renderer->GetInstancingBuffer();
-        if (!instance_buffer || geometryType_ != GEOM_INSTANCED || startIndex_ == M_MAX_UNSIGNED)
+        unsigned start_index = startIndex_;
+        if (instance_buffer && instanceBuffer_)
+        {
+            instance_buffer = instanceBuffer_;
+            start_index = instanceBuffer_->GetVertexCount() >= instances_.Size() ? 0 : M_MAX_UNSIGNED;
+        }
+
+        if (!instance_buffer || geometryType_ != GEOM_INSTANCED || start_index == M_MAX_UNSIGNED)
         {
             Batch::Prepare(view, camera, false, allowDepthWrite);
             draw_cmd->SetIndexBuffer(geometry_->GetIndexBuffer());
@@ -734,7 +843,7 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
             s_vertex_buffers[++next_idx] = instance_buffer;
 
             draw_cmd->SetIndexBuffer(geometry_->GetIndexBuffer());
-            draw_cmd->SetVertexBuffers(s_vertex_buffers.data(), ++next_idx, startIndex_);
+            draw_cmd->SetVertexBuffers(s_vertex_buffers.data(), ++next_idx, start_index);
 
             DrawCommandInstancedDrawDesc draw_desc;
             draw_desc.index_start = geometry_->GetIndexStart();
@@ -752,7 +861,8 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 unsigned BatchGroupKey::ToHash() const
 {
     return (unsigned)((size_t)zone_ / sizeof(Zone) + (size_t)lightQueue_ / sizeof(LightBatchQueue) + (size_t)pass_ / sizeof(Pass) +
-                      (size_t)material_ / sizeof(Material) + (size_t)geometry_ / sizeof(Geometry)) + renderOrder_;
+                      (size_t)material_ / sizeof(Material) + (size_t)geometry_ / sizeof(Geometry) +
+                      (size_t)instanceBuffer_ / sizeof(VertexBuffer)) + renderOrder_;
 }
 
 void BatchQueue::Clear(int maxSortedInstances)
@@ -770,7 +880,13 @@ void BatchQueue::SortBackToFront()
     for (unsigned i = 0; i < batches_.Size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    Sort(sortedBatches_.Begin(), sortedBatches_.End(), CompareBatchesBackToFront);
+    if (sortedBatches_.Size() > 1)
+    {
+        BatchRadixSort sort(sortedBatches_.Buffer(), sortedBatches_.Size());
+        sort.Sort(GetStateKey);
+        sort.Sort(GetBackToFrontKey);
+        sort.Store(sortedBatches_.Buffer());
+    }
 
     sortedBatchGroups_.Resize(batchGroups_.Size());
     
@@ -778,7 +894,13 @@ void BatchQueue::SortBackToFront()
     for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
         sortedBatchGroups_[index++] = &i->second_;
     
-    Sort(sortedBatchGroups_.Begin(), sortedBatchGroups_.End(), CompareBatchGroupOrder);
+    if (sortedBatchGroups_.Size() > 1)
+    {
+        Batch** groups = reinterpret_cast<Batch**>(sortedBatchGroups_.Buffer());
+        BatchRadixSort sort(groups, sortedBatchGroups_.Size());
+        sort.Sort(GetRenderOrderKey);
+        sort.Store(groups);
+    }
 }
 
 void BatchQueue::SortFrontToBack(GraphicsBackend backend)
@@ -790,10 +912,10 @@ void BatchQueue::SortFrontToBack(GraphicsBackend backend)
 
     SortFrontToBack2Pass(sortedBatches_, backend);
 
-    // Sort each group front to back
+    // Sort each group front to back. Instances in a persistent buffer are drawn in buffer order, so are not sorted
     for (HashMap<BatchGroupKey, BatchGroup>::Iterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.instances_.Size() <= maxSortedInstances_)
+        if (i->second_.instances_.Size() <= maxSortedInstances_ && !i->second_.instanceBuffer_)
         {
             Sort(i->second_.instances_.Begin(), i->second_.instances_.End(), CompareInstancesFrontToBack);
             if (i->second_.instances_.Size())
@@ -819,16 +941,26 @@ void BatchQueue::SortFrontToBack(GraphicsBackend backend)
 
 void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, GraphicsBackend backend)
 {
+    if (batches.Size() < 2)
+        return;
+
+    BatchRadixSort sort(batches.Buffer(), batches.Size());
+
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
     // method is also time consuming, so just sort with state having priority
     if(backend == GraphicsBackend::OpenGLES)
     {
-        Sort(batches.Begin(), batches.End(), CompareBatchesState);
+        sort.Sort(GetFrontToBackKey);
+        sort.Sort(GetStateKey);
+        sort.Sort(GetRenderOrderKey);
+        sort.Store(batches.Buffer());
         return;
     }
 
-    // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+    // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key. Batches at the same
+    // distance keep their queue order
+    sort.Sort(GetFrontToBackKey);
+    sort.Store(batches.Buffer());
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
@@ -848,7 +980,7 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, GraphicsBacken
             ++freeShaderID;
         }
 
-        unsigned short materialID = (unsigned short)(batch->sortKey_ & 0xffff0000);
+        unsigned short materialID = (unsigned short)(batch->sortKey_ >> 16);
         HashMap<unsigned short, unsigned short>::ConstIterator k = materialRemapping_.Find(materialID);
         if (k != materialRemapping_.End())
             materialID = k->second_;
@@ -875,8 +1007,11 @@ void BatchQueue::SortFrontToBack2Pass(PODVector<Batch*>& batches, GraphicsBacken
     materialRemapping_.Clear();
     geometryRemapping_.Clear();
 
-    // Finally sort again with the rewritten ID's
-    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    // Finally sort again with the rewritten ID's. The batches are already in distance order, which the stable sorts keep
+    // among batches with the same state
+    sort.Sort(GetStateKey);
+    sort.Sort(GetRenderOrderKey);
+    sort.Store(batches.Buffer());
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
@@ -934,7 +1069,7 @@ unsigned BatchQueue::GetNumInstances() const
 
     for (HashMap<BatchGroupKey, BatchGroup>::ConstIterator i = batchGroups_.Begin(); i != batchGroups_.End(); ++i)
     {
-        if (i->second_.geometryType_ == GEOM_INSTANCED)
+        if (i->second_.geometryType_ == GEOM_INSTANCED && !i->second_.instanceBuffer_)
             total += i->second_.instances_.Size();
     }
 
@@ -52,6 +52,7 @@ struct Batch
     /// Construct with defaults.
     Batch() :
         isBase_(false),
+        instanceBuffer_(0),
         lightQueue_(0)
     {
     }
@@ -66,6 +67,7 @@ struct Batch
         worldTransform_(rhs.worldTransform_),
         numWorldTransforms_(rhs.numWorldTransforms_),
         instancingData_(rhs.instancingData_),
+        instanceBuffer_(rhs.instanceBuffer_),
         lightQueue_(0),
         geometryType_(rhs.geometryType_)
     {
@@ -98,6 +100,8 @@ struct Batch
     unsigned numWorldTransforms_;
     /// Per-instance data. If not null, must contain enough data to fill instancing buffer.
     void* instancingData_;
+    /// Persistent instancing buffer holding the world transforms, or null to use the renderer's instancing buffer.
+    VertexBuffer* instanceBuffer_;
     /// Zone.
     Zone* zone_;
     /// Light properties.
@@ -171,7 +175,8 @@ struct BatchGroup : public Batch
         }
     }
 
-    /// Pre-set the instance data. Buffer must be big enough to hold all data.
+    /// Pre-set the instance data. Buffer must be big enough to hold all data. Skipped when drawing from a persistent
+    /// instancing buffer.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
@@ -197,6 +202,7 @@ struct BatchGroupKey
         pass_(batch.pass_),
         material_(batch.material_),
         geometry_(batch.geometry_),
+        instanceBuffer_(batch.instanceBuffer_),
         renderOrder_(batch.renderOrder_)
     {
     }
@@ -211,6 +217,8 @@ struct BatchGroupKey
     Material* material_;
     /// Geometry.
     Geometry* geometry_;
+    /// Persistent instancing buffer.
+    VertexBuffer* instanceBuffer_;
     /// 8-bit render order modifier from material.
     unsigned char renderOrder_;
 
@@ -218,14 +226,14 @@ struct BatchGroupKey
     bool operator ==(const BatchGroupKey& rhs) const
     {
         return zone_ == rhs.zone_ && lightQueue_ == rhs.lightQueue_ && pass_ == rhs.pass_ && material_ == rhs.material_ &&
-               geometry_ == rhs.geometry_ && renderOrder_ == rhs.renderOrder_;
+               geometry_ == rhs.geometry_ && instanceBuffer_ == rhs.instanceBuffer_ && renderOrder_ == rhs.renderOrder_;
     }
 
     /// Test for inequality with another batch group key.
     bool operator !=(const BatchGroupKey& rhs) const
     {
         return zone_ != rhs.zone_ || lightQueue_ != rhs.lightQueue_ || pass_ != rhs.pass_ || material_ != rhs.material_ ||
-               geometry_ != rhs.geometry_ || renderOrder_ != rhs.renderOrder_;
+               geometry_ != rhs.geometry_ || instanceBuffer_ != rhs.instanceBuffer_ || renderOrder_ != rhs.renderOrder_;
     }
 
     /// Return hash value.
@@ -248,7 +256,7 @@ public:
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Draw.
     void Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const;
-    /// Return the combined amount of instances.
+    /// Return the combined amount of instances to be stored in the renderer's instancing buffer.
     unsigned GetNumInstances() const;
 
     /// Return whether the batch group is empty.
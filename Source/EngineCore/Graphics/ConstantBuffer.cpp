@@ -34,6 +34,11 @@ namespace Atomic
 ConstantBuffer::ConstantBuffer(Context* context) :
     Object(context),
     GPUObject(GetSubsystem<Graphics>()),
+    size_(0),
+    ringSize_(0),
+    ringStride_(0),
+    ringOffset_(0),
+    bindOffset_(0),
     dirty_(true)
 {
 }
@@ -45,8 +45,10 @@ public:
     /// Release the buffer.
     virtual void Release();
 
-    /// Set size and create GPU-side buffer. Return true on success.
-    bool SetSize(unsigned size);
+    /// Set size and create GPU-side buffer. With a ring of more than one entry, each apply writes the data to the next
+    /// entry of a larger buffer and is bound at a dynamic offset, instead of discarding the whole buffer. Return true on
+    /// success.
+    bool SetSize(unsigned size, unsigned ringEntries = 0);
     /// Set a generic parameter and mark buffer dirty.
     void SetParameter(unsigned offset, unsigned size, const void* data);
     /// Get Write Buffer. The caller is responsible to dirty buffer.
@@ -55,9 +57,15 @@ public:
     void SetVector3ArrayParameter(unsigned offset, unsigned rows, const void* data);
     /// Apply to GPU.
     void Apply();
+    /// Discard the ring on the next apply. Called at the start of each frame, as dynamic buffer data only lasts a frame.
+    void ResetRing() { ringOffset_ = ringSize_; }
 
     /// Return size.
     unsigned GetSize() const { return size_; }
+    /// Return whether data is written to a ring and bound at a dynamic offset.
+    bool IsRing() const { return ringSize_ != 0; }
+    /// Return offset of the last applied data in the ring.
+    unsigned GetRingOffset() const { return bindOffset_; }
 
     /// Return whether has unapplied data.
     bool IsDirty() const { return dirty_; }
@@ -72,6 +80,14 @@ private:
     SharedArrayPtr<unsigned char> shadowData_;
     /// Buffer byte size.
     unsigned size_;
+    /// Ring byte size, or 0 if not a ring.
+    unsigned ringSize_;
+    /// Byte size of a ring entry, aligned to the device's constant buffer offset alignment.
+    unsigned ringStride_;
+    /// Offset of the next ring entry.
+    unsigned ringOffset_;
+    /// Offset of the last applied ring entry.
+    unsigned bindOffset_;
     /// Dirty flag.
     bool dirty_;
 
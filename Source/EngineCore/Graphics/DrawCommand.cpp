@@ -51,6 +51,8 @@ namespace REngine
 			graphics_(graphics),
 			renderer_(renderer),
 			context_(context),
+			bound_cbuffers_({}),
+			cbuffer_offsets_({}),
 			bind_depth_stencil_(nullptr),
 			params_2_update_({}), next_param_2_update_idx_(0), bind_rts_(),
 			vertex_buffers_({}),
@@ -97,6 +99,8 @@ namespace REngine
 			depth_stencil_				= nullptr;
 			index_buffer_				= nullptr;
 			shader_resource_binding_	= nullptr;
+			srb_constant_buffers_ = {};
+			bound_cbuffers_.fill(nullptr);
 			curr_assigned_texture_flags_ = curr_assigned_immutable_sa_flags_ = 0;
 
 			index_type_ = VT_UNDEFINED;
@@ -155,6 +159,10 @@ namespace REngine
 		{
 			ATOMIC_PROFILE(IDrawCommand::Draw);
 
+			// Skip draws whose shaders are still compiling or have failed to compile
+			if (!pipeline_info_->vs_shader || !pipeline_info_->ps_shader)
+				return;
+
 			PrepareDraw();
 
 			if (!pipeline_state_)
@@ -192,8 +200,14 @@ namespace REngine
 		{
 			ATOMIC_PROFILE(IDrawCommand::Draw);
 
+			if (!pipeline_info_->vs_shader || !pipeline_info_->ps_shader)
+				return;
+
 			PrepareDraw();
 
+			if (!pipeline_state_)
+				return;
+
 			context_->DrawIndexed({
 				desc.index_count,
 				index_type_,
@@ -271,41 +285,34 @@ namespace REngine
 		{
 			ATOMIC_PROFILE(IDrawCommand::SetShaders);
 			// TODO: add support for other shaders
-			static ShaderVariation* s_shaders[MAX_SHADER_TYPES] = {};
-			s_shaders[VS] = desc.vs;
-			s_shaders[PS] = desc.ps;
+			ShaderVariation* requested[MAX_SHADER_TYPES] = {};
+			requested[VS] = desc.vs;
+			requested[PS] = desc.ps;
 
-			static ShaderVariation* s_pipeline_shaders[MAX_SHADER_TYPES] = {};
-			s_pipeline_shaders[VS] = pipeline_info_->vs_shader;
-			s_pipeline_shaders[PS] = pipeline_info_->ps_shader;
+			// Stages that keep their shader keep the pipeline's variation, which may differ from the requested one when it
+			// is a clip plane or fallback variation
+			ShaderVariation* shaders[MAX_SHADER_TYPES] = {};
+			shaders[VS] = pipeline_info_->vs_shader;
+			shaders[PS] = pipeline_info_->ps_shader;
 
-			bool changed = false;
-			for(u8 i = 0; i < MAX_SHADER_TYPES; ++i)
+			const auto changed = MergePipelineShaders(shaders, requested, [this](ShaderType type, ShaderVariation* shader)
 			{
-				auto shader = s_shaders[i];
-				const auto pipeline_shader = s_pipeline_shaders[i];
-				if(shader == pipeline_shader)
-					continue;
-
-				if(enable_clip_planes_)
-				{
-					shader = shader->GetOwner()->GetVariation(
-						static_cast<ShaderType>(i),
-						shader->GetDefinesClipPlane()
-					);
-				}
-
-				if (shader == pipeline_shader)
-					continue;
-
-				if(i == VS)
-					dirty_flags_ |= static_cast<u32>(RenderCommandDirtyState::vertex_decl) | static_cast<u32>(RenderCommandDirtyState::vertex_buffer);
+				if(shader && enable_clip_planes_)
+					shader = shader->GetOwner()->GetVariation(type, shader->GetDefinesClipPlane());
 
 				// Build shader if is necessary
 				if(shader && !shader->GetGPUObject())
 				{
 					if (!shader->GetCompilerOutput().Empty())
 						shader = nullptr;
+					else if (graphics_->GetAsyncShaderCompile() || shader->IsCompiling())
+					{
+						// Until the variation is compiled on a worker thread, draw with the fallback or skip the draw
+						if (!shader->CreateAsync())
+							shader = nullptr;
+						else if (!shader->GetGPUObject())
+							shader = graphics_->GetFallbackShader(type);
+					}
 					else if(!shader->Create())
 					{
 						ATOMIC_LOGERROR("Failed to create shader: " + shader->GetName());
@@ -313,22 +320,24 @@ namespace REngine
 					}
 				}
 
-				s_shaders[i] = shader;
-				changed = true;
-			}
+				return shader;
+			});
 
 			if (!changed)
 				return;
 
-			pipeline_info_->vs_shader = s_shaders[VS];
-			pipeline_info_->ps_shader = s_shaders[PS];
+			if(changed & (1u << VS))
+				dirty_flags_ |= static_cast<u32>(RenderCommandDirtyState::vertex_decl) | static_cast<u32>(RenderCommandDirtyState::vertex_buffer);
+
+			pipeline_info_->vs_shader = shaders[VS];
+			pipeline_info_->ps_shader = shaders[PS];
 			dirty_flags_ |= static_cast<u32>(RenderCommandDirtyState::pipeline);
 
-			if(s_shaders[VS] && s_shaders[PS])
+			if(shaders[VS] && shaders[PS])
 			{
 				const ShaderProgramQuery query{
-					s_shaders[VS],
-					s_shaders[PS]
+					shaders[VS],
+					shaders[PS]
 				};
 				shader_program_ = GetOrCreateShaderProgram(query);
 
@@ -1536,7 +1545,10 @@ namespace REngine
 			create_desc.pipeline_hash = curr_pipeline_hash_;
 			create_desc.resources = &textures_;
 			create_desc.driver = graphics_->GetImpl();
+			create_desc.constant_buffers = &srb_constant_buffers_;
 			shader_resource_binding_ = pipeline_state_builder_get_or_create_srb(create_desc);
+			// Offsets of ring constant buffers are stored in the binding, so they must all be set again
+			bound_cbuffers_.fill(nullptr);
 			dirty_flags_ ^= static_cast<u32>(RenderCommandDirtyState::srb);
 			dirty_flags_ |= static_cast<u32>(RenderCommandDirtyState::commit_srb);
 		}
@@ -1759,6 +1771,29 @@ namespace REngine
 
 			graphics_->GetImpl()->UploadBufferChanges();
 		}
+		void PrepareConstantBufferOffsets()
+		{
+			ATOMIC_PROFILE(IDrawCommand::PrepareConstantBufferOffsets);
+			if (!shader_resource_binding_)
+				return;
+
+			const auto driver = graphics_->GetImpl();
+			for (u32 i = 0; i < bound_cbuffers_.size(); ++i)
+			{
+				const auto var = srb_constant_buffers_.variables[i];
+				const auto buffer = driver->GetConstantBufferAt(i);
+				if (!var || !buffer || !buffer->IsRing())
+					continue;
+
+				const auto offset = buffer->GetRingOffset();
+				if (bound_cbuffers_[i] == buffer && cbuffer_offsets_[i] == offset)
+					continue;
+
+				var->SetBufferOffset(offset);
+				bound_cbuffers_[i] = buffer;
+				cbuffer_offsets_[i] = offset;
+			}
+		}
 
 		void PrepareClear()
 		{
@@ -1781,6 +1816,7 @@ namespace REngine
 			PreparePipelineState();
 			PrepareSRB();
 			PrepareParametersToUpload();
+			PrepareConstantBufferOffsets();
 
 			if(changed_rts)
 				BoundRenderTargets();
@@ -1923,10 +1959,12 @@ namespace REngine
 			curr_pipeline_hash_ = pipeline_hash;
 
 			ShaderResourceTextures textures_dummy = {};
+			ShaderResourceBindingConstantBuffers srb_cbuffers;
 			RefCntAutoPtr<IShaderResourceBinding> srb = pipeline_state_builder_get_or_create_srb({
 				graphics_->GetImpl(),
 				pipeline_hash,
-				&textures_dummy
+				&textures_dummy,
+				&srb_cbuffers
 				});
 
 			{
@@ -1938,6 +1976,15 @@ namespace REngine
 				graphics_->GetImpl()->GetConstantBuffer(VS, SP_CAMERA)->Apply();
 				graphics_->GetImpl()->GetConstantBuffer(VS, SP_OBJECT)->Apply();
 				graphics_->GetImpl()->GetConstantBuffer(PS, SP_MATERIAL)->Apply();
+
+				for (u32 i = 0; i < bound_cbuffers_.size(); ++i)
+				{
+					const auto buffer = graphics_->GetImpl()->GetConstantBufferAt(i);
+					if (srb_cbuffers.variables[i] && buffer && buffer->IsRing())
+						srb_cbuffers.variables[i]->SetBufferOffset(buffer->GetRingOffset());
+				}
+				// The binding may be cached and shared with draws
+				bound_cbuffers_.fill(nullptr);
 			}
 
 			if(dirty_flags_ & static_cast<u32>(RenderCommandDirtyState::viewport))
@@ -2095,6 +2142,10 @@ namespace REngine
 		PipelineStateInfo* pipeline_info_;
 		Diligent::RefCntAutoPtr<Diligent::IPipelineState> pipeline_state_;
 		Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> shader_resource_binding_;
+		ShaderResourceBindingConstantBuffers srb_constant_buffers_;
+		// ring constant buffers and offsets last set on the shader resource binding
+		ea::array<ConstantBuffer*, MAX_SHADER_TYPES * MAX_SHADER_PARAMETER_GROUPS> bound_cbuffers_;
+		ea::array<u32, MAX_SHADER_TYPES * MAX_SHADER_PARAMETER_GROUPS> cbuffer_offsets_;
 
 		ea::shared_ptr<RenderSurface> depth_stencil_;
 		ITextureView* bind_depth_stencil_;
@@ -75,6 +75,29 @@ namespace Atomic
 		Matrix4 projection{ Matrix4::IDENTITY };
 	};
 
+	/// Merge requested shaders into the shaders of a pipeline, in ShaderType order. A requested shader that differs from the
+	/// pipeline's is passed through resolve, which returns the variation to draw with, such as a clip plane or fallback
+	/// variation, or null. Stages whose resolved variation is already in the pipeline keep it. Return a mask of the changed
+	/// stages.
+	template <class T> u32 MergePipelineShaders(ShaderVariation** pipeline_shaders, ShaderVariation* const* requested, T resolve)
+	{
+		u32 changed = 0;
+		for(u8 i = 0; i < MAX_SHADER_TYPES; ++i)
+		{
+			auto shader = requested[i];
+			if(shader == pipeline_shaders[i])
+				continue;
+
+			shader = resolve(static_cast<ShaderType>(i), shader);
+			if(shader == pipeline_shaders[i])
+				continue;
+
+			pipeline_shaders[i] = shader;
+			changed |= 1u << i;
+		}
+		return changed;
+	}
+
 	class IDrawCommand
 	{
 	public:
@@ -57,6 +57,7 @@ SourceBatch::SourceBatch() :
     worldTransform_(&Matrix3x4::IDENTITY),
     numWorldTransforms_(1),
     instancingData_((void*)0),
+    instanceBuffer_(0),
     geometryType_(GEOM_STATIC)
 {
 }
@@ -78,6 +79,7 @@ SourceBatch& SourceBatch::operator =(const SourceBatch& rhs)
     worldTransform_ = rhs.worldTransform_;
     numWorldTransforms_ = rhs.numWorldTransforms_;
     instancingData_ = rhs.instancingData_;
+    instanceBuffer_ = rhs.instanceBuffer_;
     geometryType_ = rhs.geometryType_;
 
     return *this;
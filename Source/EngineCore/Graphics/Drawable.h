@@ -52,6 +52,7 @@ class Material;
 class OcclusionBuffer;
 class Octant;
 class RayOctreeQuery;
+class VertexBuffer;
 class Zone;
 struct RayQueryResult;
 struct WorkItem;
@@ -102,6 +103,8 @@ struct ATOMIC_API SourceBatch
     unsigned numWorldTransforms_;
     /// Per-instance data. If not null, must contain enough data to fill instancing buffer.
     void* instancingData_;
+    /// Persistent instancing buffer holding the world transforms, or null to fill the renderer's instancing buffer each frame.
+    VertexBuffer* instanceBuffer_;
     /// %Geometry type.
     GeometryType geometryType_;
 };
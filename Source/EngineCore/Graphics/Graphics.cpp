@@ -38,7 +38,9 @@
 #include "../Graphics/ParticleEmitter.h"
 #include "../Graphics/RibbonTrail.h"
 #include "../Graphics/Shader.h"
+#include "../Graphics/ShaderCacheArchive.h"
 #include "../Graphics/ShaderPrecache.h"
+#include "../Graphics/ShaderVariation.h"
 #include "../Graphics/Skybox.h"
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/Technique.h"
@@ -52,6 +54,7 @@
 #include "../Graphics/DrawCommandQueue.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
 
 // ATOMIC BEGIN
 
@@ -220,8 +223,110 @@ void Graphics::PrecacheShaders(Deserializer& source)
 void Graphics::SetShaderCacheDir(const String& path)
 {
     String trimmedPath = path.Trimmed();
-    if (trimmedPath.Length())
-        shaderCacheDir_ = AddTrailingSlash(trimmedPath);
+    if (!trimmedPath.Length())
+        return;
+
+    shaderCacheDir_ = AddTrailingSlash(trimmedPath);
+
+    String storeDir = shaderCacheDir_;
+    if (!IsAbsolutePath(storeDir))
+    {
+        Vector<String> resourceDirs = GetSubsystem<ResourceCache>()->GetResourceDirs();
+        if (resourceDirs.Empty())
+            return;
+        storeDir = AddTrailingSlash(resourceDirs[0]) + storeDir;
+    }
+
+    // Shaders compiled at runtime go into one indexed, memory-mapped file instead of a file per variation
+    shaderCacheStore_ = new ShaderCacheArchive();
+    if (!shaderCacheStore_->Open(context_, storeDir + "ShaderCache.rsca"))
+        shaderCacheStore_.Reset();
+}
+
+void Graphics::SetAsyncShaderCompile(bool enable)
+{
+    asyncShaderCompile_ = enable;
+}
+
+void Graphics::SetFallbackShader(ShaderType type, ShaderVariation* variation)
+{
+    // The fallback stands in for variations that are not ready, so it is always created immediately
+    if (variation && !variation->GetGPUObject() && !variation->Create())
+    {
+        ATOMIC_LOGERROR("Failed to create fallback shader " + variation->GetFullName());
+        variation = 0;
+    }
+
+    fallbackShaders_[type] = variation;
+}
+
+bool Graphics::LoadShaderCacheArchive(const String& resourceName)
+{
+    ATOMIC_PROFILE(LoadShaderCacheArchive);
+
+    SharedPtr<File> file = GetSubsystem<ResourceCache>()->GetFile(resourceName);
+    if (!file)
+        return false;
+
+    SharedPtr<ShaderCacheArchive> archive(new ShaderCacheArchive());
+    if (!archive->Load(*file))
+        return false;
+
+    ATOMIC_LOGINFO("Loaded shader cache archive " + resourceName + " with " + String(archive->GetNumEntries()) + " shaders");
+    shaderCacheArchive_ = archive;
+    return true;
+}
+
+void Graphics::AddCompilingShader(ShaderVariation* variation)
+{
+    compilingShaders_.Push(WeakPtr<ShaderVariation>(variation));
+    shaderCompileStats_.numPending_ = compilingShaders_.Size();
+}
+
+void Graphics::UpdateCompilingShaders()
+{
+    if (compilingShaders_.Empty())
+        return;
+
+    ATOMIC_PROFILE(UpdateCompilingShaders);
+
+    for (unsigned i = 0; i < compilingShaders_.Size();)
+    {
+        ShaderVariation* variation = compilingShaders_[i];
+        if (variation && variation->IsCompiling())
+        {
+            variation->FinishAsyncCreate();
+            if (variation->IsCompiling())
+            {
+                ++i;
+                continue;
+            }
+
+            float latency = variation->GetCompileTime();
+            ++shaderCompileStats_.numCompiled_;
+            shaderCompileStats_.lastLatency_ = latency;
+            shaderCompileStats_.averageLatency_ += (latency - shaderCompileStats_.averageLatency_) /
+                shaderCompileStats_.numCompiled_;
+            shaderCompileStats_.maxLatency_ = Max(shaderCompileStats_.maxLatency_, latency);
+        }
+
+        // Released or destroyed variations have had their compile cancelled
+        compilingShaders_.EraseSwap(i);
+    }
+
+    shaderCompileStats_.numPending_ = compilingShaders_.Size();
+    ATOMIC_PROFILE_PLOT("ShaderCompileQueue", (i64)compilingShaders_.Size());
+    ATOMIC_PROFILE_PLOT("ShaderCompileLatency", (double)shaderCompileStats_.lastLatency_);
+}
+
+void Graphics::UpdateConstantBufferStats()
+{
+    constantBufferStats_ = constantBufferFrameStats_;
+    constantBufferFrameStats_ = ConstantBufferStats();
+
+    ATOMIC_PROFILE_PLOT("ConstantBufferMaps", (i64)constantBufferStats_.numMaps_);
+    ATOMIC_PROFILE_PLOT("ConstantBufferDiscards", (i64)constantBufferStats_.numDiscards_);
+    ATOMIC_PROFILE_PLOT("ConstantBufferBytes", (i64)constantBufferStats_.uploadedBytes_);
 }
 
 void Graphics::AddGPUObject(GPUObject* object)
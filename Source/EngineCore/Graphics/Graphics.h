@@ -54,6 +54,7 @@ class IndexBuffer;
 class GPUObject;
 class RenderSurface;
 class Shader;
+class ShaderCacheArchive;
 class ShaderPrecache;
 class ShaderVariation;
 class Texture;
@@ -84,6 +85,48 @@ struct ScratchBuffer
     bool reserved_;
 };
 
+/// Asynchronous shader compile statistics.
+struct ShaderCompileStats
+{
+    ShaderCompileStats() :
+        numPending_(0),
+        numCompiled_(0),
+        lastLatency_(0.0f),
+        averageLatency_(0.0f),
+        maxLatency_(0.0f)
+    {
+    }
+
+    /// Number of shader variations waiting for their compile to finish.
+    unsigned numPending_;
+    /// Number of shader variations compiled asynchronously.
+    unsigned numCompiled_;
+    /// Latency of the last compile in milliseconds, from queueing to the shader being ready.
+    float lastLatency_;
+    /// Average compile latency in milliseconds.
+    float averageLatency_;
+    /// Maximum compile latency in milliseconds.
+    float maxLatency_;
+};
+
+/// Constant buffer upload statistics of a frame.
+struct ConstantBufferStats
+{
+    ConstantBufferStats() :
+        numMaps_(0),
+        numDiscards_(0),
+        uploadedBytes_(0)
+    {
+    }
+
+    /// Number of constant buffer maps.
+    unsigned numMaps_;
+    /// Number of maps that discarded the whole buffer. The rest wrote to a free ring entry without synchronization.
+    unsigned numDiscards_;
+    /// Number of bytes written to constant buffers.
+    unsigned long long uploadedBytes_;
+};
+
 /// %Graphics subsystem. Manages the application window, rendering state and GPU resources.
 class ATOMIC_API Graphics : public Object
 {
@@ -262,8 +305,14 @@ public:
     void EndDumpShaders();
     /// Precache shader variations from an XML file generated with BeginDumpShaders().
     void PrecacheShaders(Deserializer& source);
-    /// Set shader cache directory, Direct3D only. This can either be an absolute path or a path within the resource system.
+    /// Set shader cache directory, where the shader cache store with the bytecode of shaders compiled at runtime is kept. This can either be an absolute path or a path relative to the first resource directory.
     void SetShaderCacheDir(const String& path);
+    /// Set whether shader variations missing from the shader cache are compiled on worker threads. Until a variation is ready, draws using it are skipped or use the fallback shader.
+    void SetAsyncShaderCompile(bool enable);
+    /// Set shader used in place of variations that are still compiling asynchronously. Null to skip such draws. The fallback must be compatible with the vertex layouts and varyings of the variations it replaces.
+    void SetFallbackShader(ShaderType type, ShaderVariation* variation);
+    /// Load a shader cache archive generated by the shader bake tool. Variations found in it are created without compiling. Return true if successful.
+    bool LoadShaderCacheArchive(const String& resourceName);
     
     ///  Set graphics backend. Cannot be changed after graphics initialization.
     void SetBackend(GraphicsBackend backend);
@@ -656,6 +705,24 @@ public:
     /// Return shader cache directory.
     const String& GetShaderCacheDir() const { return shaderCacheDir_; }
 
+    /// Return whether shader variations are compiled asynchronously.
+    bool GetAsyncShaderCompile() const { return asyncShaderCompile_; }
+
+    /// Return loaded shader cache archive, or null if none.
+    ShaderCacheArchive* GetShaderCacheArchive() const { return shaderCacheArchive_; }
+
+    /// Return shader cache store in the shader cache directory, or null if it could not be opened.
+    ShaderCacheArchive* GetShaderCacheStore() const { return shaderCacheStore_; }
+
+    /// Return fallback shader used while variations are compiling.
+    ShaderVariation* GetFallbackShader(ShaderType type) const { return fallbackShaders_[type]; }
+
+    /// Return asynchronous shader compile statistics.
+    const ShaderCompileStats& GetShaderCompileStats() const { return shaderCompileStats_; }
+
+    /// Return constant buffer upload statistics of the last frame.
+    const ConstantBufferStats& GetConstantBufferStats() const { return constantBufferStats_; }
+
     /// Return current rendertarget width and height.
     IntVector2 GetRenderTargetDimensions() const;
     
@@ -681,6 +748,20 @@ public:
     void CleanupScratchBuffers();
     /// Clean up shader parameters when a shader variation is released or destroyed.
     void CleanupShaderPrograms(ShaderVariation* variation);
+    /// Track a shader variation queued for asynchronous compile. Called by ShaderVariation.
+    void AddCompilingShader(ShaderVariation* variation);
+    /// Finish asynchronous shader compiles that worker threads are done with. Called on frame begin.
+    void UpdateCompilingShaders();
+    /// Record a constant buffer map for the frame statistics. Called by ConstantBuffer.
+    void AddConstantBufferMap(unsigned bytes, bool discard)
+    {
+        ++constantBufferFrameStats_.numMaps_;
+        if (discard)
+            ++constantBufferFrameStats_.numDiscards_;
+        constantBufferFrameStats_.uploadedBytes_ += bytes;
+    }
+    /// Store the constant buffer statistics of the finished frame and start counting a new one. Called on frame begin.
+    void UpdateConstantBufferStats();
     /// Clean up a render surface from all FBOs. Used only on OpenGL.
     void CleanupRenderSurface(RenderSurface* surface);
     void Cleanup(u32 cleanup_flags);
@@ -906,6 +987,22 @@ private:
     mutable String lastShaderName_;
     /// Shader precache utility.
     SharedPtr<ShaderPrecache> shaderPrecache_;
+    /// Baked shader bytecode archive.
+    SharedPtr<ShaderCacheArchive> shaderCacheArchive_;
+    /// Bytecode store of shaders compiled at runtime.
+    SharedPtr<ShaderCacheArchive> shaderCacheStore_;
+    /// Asynchronous shader compile flag.
+    bool asyncShaderCompile_;
+    /// Shader variations waiting for an asynchronous compile.
+    Vector<WeakPtr<ShaderVariation> > compilingShaders_;
+    /// Shaders used in place of variations that are still compiling.
+    SharedPtr<ShaderVariation> fallbackShaders_[MAX_SHADER_TYPES];
+    /// Asynchronous shader compile statistics.
+    ShaderCompileStats shaderCompileStats_;
+    /// Constant buffer upload statistics of the last frame.
+    ConstantBufferStats constantBufferStats_;
+    /// Constant buffer upload statistics of the current frame.
+    ConstantBufferStats constantBufferFrameStats_;
     /// Allowed screen orientations.
     String orientations_;
     /// Graphics API name.
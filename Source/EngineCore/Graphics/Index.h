@@ -13,7 +13,9 @@
 #include "./Texture2DArray.h"
 #include "./Texture3D.h"
 #include "./TextureCube.h"
+#include "./TextureStreamer.h"
 #include "./Shader.h"
+#include "./ShaderCacheArchive.h"
 #include "./ShaderPrecache.h"
 #include "./ShaderProgram.h"
 #include "./ShaderVariation.h"
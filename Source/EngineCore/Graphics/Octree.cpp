@@ -380,6 +380,11 @@ void Octree::Update(const FrameInfo& frame)
         return;
     }
 
+    // Resolve deferred transforms first, so that moved drawables get queued for reinsertion
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateTransforms();
+
     // Let drawables update themselves before reinsertion. This can be used for animation
     if (!drawableUpdates_.Empty())
     {
@@ -387,7 +392,6 @@ void Octree::Update(const FrameInfo& frame)
 
         // Perform updates in worker threads. Notify the scene that a threaded update is going on and components
         // (for example physics objects) should not perform non-threadsafe work when marked dirty
-        Scene* scene = GetScene();
         WorkQueue* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
@@ -437,7 +441,6 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     // Notify drawable update being finished. Custom animation (eg. IK) can be done at this point
-    Scene* scene = GetScene();
     if (scene)
     {
         using namespace SceneDrawableUpdateFinished;
@@ -446,6 +449,9 @@ void Octree::Update(const FrameInfo& frame)
         eventData[P_SCENE] = scene;
         eventData[P_TIMESTEP] = frame.timeStep_;
         scene->SendEvent(E_SCENEDRAWABLEUPDATEFINISHED, eventData);
+
+        // Resolve the transforms moved by the event handlers, so that their drawables get reinserted before culling
+        scene->UpdateTransforms();
     }
 
     // Reinsert drawables that have been moved or resized, or that have been newly added to the octree and do not sit inside
@@ -505,6 +511,7 @@ void Octree::RemoveManualDrawable(Drawable* drawable)
 
 void Octree::GetDrawables(OctreeQuery& query) const
 {
+    UpdateSceneTransforms();
     query.result_.Clear();
     GetDrawablesInternal(query, false);
 }
@@ -513,6 +520,7 @@ void Octree::Raycast(RayOctreeQuery& query) const
 {
     ATOMIC_PROFILE(Raycast);
 
+    UpdateSceneTransforms();
     query.result_.Clear();
     GetDrawablesInternal(query);
     Sort(query.result_.Begin(), query.result_.End(), CompareRayQueryResults);
@@ -522,6 +530,7 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
 {
     ATOMIC_PROFILE(Raycast);
 
+    UpdateSceneTransforms();
     query.result_.Clear();
     rayQueryDrawables_.Clear();
     GetDrawablesOnlyInternal(query, rayQueryDrawables_);
@@ -558,6 +567,14 @@ void Octree::RaycastSingle(RayOctreeQuery& query) const
     }
 }
 
+void Octree::UpdateSceneTransforms() const
+{
+    // Deferred transform changes have not marked the world bounding boxes of the moved drawables dirty yet
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateTransforms();
+}
+
 void Octree::QueueUpdate(Drawable* drawable)
 {
     Scene* scene = GetScene();
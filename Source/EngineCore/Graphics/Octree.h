@@ -205,6 +205,8 @@ public:
 private:
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Update the deferred transforms of the scene before a query.
+    void UpdateSceneTransforms() const;
 
     /// Drawable objects that require update.
     PODVector<Drawable*> drawableUpdates_;
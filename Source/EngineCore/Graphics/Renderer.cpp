@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Container/FlatHashSet.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/Camera.h"
@@ -40,6 +41,7 @@
 #include "../Graphics/Technique.h"
 #include "../Graphics/Texture2D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../Graphics/Zone.h"
@@ -303,6 +305,8 @@ Renderer::Renderer(Context* context) :
     initialized_(false),
     resetViews_(false)
 {
+    textureStreamer_ = new TextureStreamer(context_);
+
     SubscribeToEvent(E_SCREENMODE, ATOMIC_HANDLER(Renderer, HandleScreenMode));
 
     // Try to initialize right now, but skip if screen mode is not yet set
@@ -707,6 +711,9 @@ void Renderer::Update(float timeStep)
 
     queuedViewports_.Clear();
     resetViews_ = false;
+
+    // Stream texture mip levels for what the views requested
+    textureStreamer_->Update();
 }
 
 void Renderer::Render()
@@ -771,8 +778,8 @@ void Renderer::DrawDebugGeometry(bool depthTest)
     ATOMIC_PROFILE(RendererDrawDebug);
 
     /// \todo Because debug geometry is per-scene, if two cameras show views of the same area, occlusion is not shown correctly
-    HashSet<Drawable*> processedGeometries;
-    HashSet<Light*> processedLights;
+    FlatHashSet<Drawable*> processedGeometries;
+    FlatHashSet<Light*> processedLights;
 
     for (unsigned i = 0; i < views_.Size(); ++i)
     {
@@ -1639,16 +1646,8 @@ void Renderer::LoadShaders()
     shadersChangedFrameNumber_ = GetSubsystem<Time>()->GetFrameNumber();
 
     // Construct new names for deferred light volume pixel shaders based on rendering options
-    deferredLightPSVariations_.Resize(MAX_DEFERRED_LIGHT_PS_VARIATIONS);
-    
-    for (unsigned i = 0; i < MAX_DEFERRED_LIGHT_PS_VARIATIONS; ++i)
-    {
-        deferredLightPSVariations_[i] = lightPSVariations[i % DLPS_ORTHO];
-        if ((i % DLPS_ORTHO) >= DLPS_SHADOW)
-            deferredLightPSVariations_[i] += GetShadowVariations();
-        if (i >= DLPS_ORTHO)
-            deferredLightPSVariations_[i] += "ORTHO ";
-    }
+    Vector<String> vsVariations;
+    GetLightVolumeShaderDefines(GetShadowVariations(), vsVariations, deferredLightPSVariations_);
 
     shadersDirty_ = false;
 }
@@ -1657,52 +1656,70 @@ void Renderer::LoadPassShaders(Pass* pass, Vector<SharedPtr<ShaderVariation> >&
 {
     ATOMIC_PROFILE(LoadPassShaders);
 
+    Vector<String> vsDefines;
+    Vector<String> psDefines;
+    GetPassShaderDefines(pass, queue.vsExtraDefines_, queue.psExtraDefines_, GetShadowVariations(),
+        shadowQuality_ == SHADOWQUALITY_VSM || shadowQuality_ == SHADOWQUALITY_BLUR_VSM, vsDefines, psDefines);
+
     // Forget all the old shaders
     vertexShaders.Clear();
     pixelShaders.Clear();
 
-    String vsDefines = pass->GetEffectiveVertexShaderDefines();
-    String psDefines = pass->GetEffectivePixelShaderDefines();
+    vertexShaders.Resize(vsDefines.Size());
+    for (unsigned j = 0; j < vsDefines.Size(); ++j)
+        vertexShaders[j] = graphics_->GetShader(VS, pass->GetVertexShader(), vsDefines[j]);
+    pixelShaders.Resize(psDefines.Size());
+    for (unsigned j = 0; j < psDefines.Size(); ++j)
+        pixelShaders[j] = graphics_->GetShader(PS, pass->GetPixelShader(), psDefines[j]);
+
+    pass->MarkShadersLoaded(shadersChangedFrameNumber_);
+}
+
+void Renderer::GetPassShaderDefines(Pass* pass, const String& vsExtraDefines, const String& psExtraDefines,
+    const String& shadowVariations, bool vsmShadows, Vector<String>& vsDefines, Vector<String>& psDefines)
+{
+    vsDefines.Clear();
+    psDefines.Clear();
+
+    String vs = pass->GetEffectiveVertexShaderDefines();
+    String ps = pass->GetEffectivePixelShaderDefines();
 
     // Make sure to end defines with space to allow appending engine's defines
-    if (vsDefines.Length() && !vsDefines.EndsWith(" "))
-        vsDefines += ' ';
-    if (psDefines.Length() && !psDefines.EndsWith(" "))
-        psDefines += ' ';
+    if (vs.Length() && !vs.EndsWith(" "))
+        vs += ' ';
+    if (ps.Length() && !ps.EndsWith(" "))
+        ps += ' ';
 
     // Append defines from batch queue (renderpath command) if needed
-    if (queue.vsExtraDefines_.Length())
+    if (vsExtraDefines.Length())
     {
-        vsDefines += queue.vsExtraDefines_;
-        vsDefines += ' ';
+        vs += vsExtraDefines;
+        vs += ' ';
     }
-    if (queue.psExtraDefines_.Length())
+    if (psExtraDefines.Length())
     {
-        psDefines += queue.psExtraDefines_;
-        psDefines += ' ';
+        ps += psExtraDefines;
+        ps += ' ';
     }
 
     // Add defines for VSM in the shadow pass if necessary
-    if (pass->GetName() == "shadow"
-        && (shadowQuality_ == SHADOWQUALITY_VSM || shadowQuality_ == SHADOWQUALITY_BLUR_VSM))
+    if (pass->GetName() == "shadow" && vsmShadows)
     {
-        vsDefines += "VSM_SHADOW ";
-        psDefines += "VSM_SHADOW ";
+        vs += "VSM_SHADOW ";
+        ps += "VSM_SHADOW ";
     }
 
     if (pass->GetLightingMode() == LIGHTING_PERPIXEL)
     {
-        // Load forward pixel lit variations
-        vertexShaders.Resize(MAX_GEOMETRYTYPES * MAX_LIGHT_VS_VARIATIONS);
-        pixelShaders.Resize(MAX_LIGHT_PS_VARIATIONS * 2);
+        // Forward pixel lit variations
+        vsDefines.Resize(MAX_GEOMETRYTYPES * MAX_LIGHT_VS_VARIATIONS);
+        psDefines.Resize(MAX_LIGHT_PS_VARIATIONS * 2);
 
         for (unsigned j = 0; j < MAX_GEOMETRYTYPES * MAX_LIGHT_VS_VARIATIONS; ++j)
         {
             unsigned g = j / MAX_LIGHT_VS_VARIATIONS;
             unsigned l = j % MAX_LIGHT_VS_VARIATIONS;
-
-            vertexShaders[j] = graphics_->GetShader(VS, pass->GetVertexShader(),
-                vsDefines + lightVSVariations[l] + geometryVSVariations[g]);
+            vsDefines[j] = vs + lightVSVariations[l] + geometryVSVariations[g];
         }
         for (unsigned j = 0; j < MAX_LIGHT_PS_VARIATIONS * 2; ++j)
         {
@@ -1710,49 +1727,52 @@ void Renderer::LoadPassShaders(Pass* pass, Vector<SharedPtr<ShaderVariation> >&
             unsigned h = j / MAX_LIGHT_PS_VARIATIONS;
 
             if (l & LPS_SHADOW)
-            {
-                pixelShaders[j] = graphics_->GetShader(PS, pass->GetPixelShader(),
-                    psDefines + lightPSVariations[l] + GetShadowVariations() +
-                    heightFogVariations[h]);
-            }
+                psDefines[j] = ps + lightPSVariations[l] + shadowVariations + heightFogVariations[h];
             else
-                pixelShaders[j] = graphics_->GetShader(PS, pass->GetPixelShader(),
-                    psDefines + lightPSVariations[l] + heightFogVariations[h]);
+                psDefines[j] = ps + lightPSVariations[l] + heightFogVariations[h];
         }
     }
     else
     {
-        // Load vertex light variations
+        // Vertex light variations
         if (pass->GetLightingMode() == LIGHTING_PERVERTEX)
         {
-            vertexShaders.Resize(MAX_GEOMETRYTYPES * MAX_VERTEXLIGHT_VS_VARIATIONS);
+            vsDefines.Resize(MAX_GEOMETRYTYPES * MAX_VERTEXLIGHT_VS_VARIATIONS);
             for (unsigned j = 0; j < MAX_GEOMETRYTYPES * MAX_VERTEXLIGHT_VS_VARIATIONS; ++j)
             {
                 unsigned g = j / MAX_VERTEXLIGHT_VS_VARIATIONS;
                 unsigned l = j % MAX_VERTEXLIGHT_VS_VARIATIONS;
-                vertexShaders[j] = graphics_->GetShader(VS, pass->GetVertexShader(),
-                    vsDefines + vertexLightVSVariations[l] + geometryVSVariations[g]);
+                vsDefines[j] = vs + vertexLightVSVariations[l] + geometryVSVariations[g];
             }
         }
         else
         {
-            vertexShaders.Resize(MAX_GEOMETRYTYPES);
+            vsDefines.Resize(MAX_GEOMETRYTYPES);
             for (unsigned j = 0; j < MAX_GEOMETRYTYPES; ++j)
-            {
-                vertexShaders[j] = graphics_->GetShader(VS, pass->GetVertexShader(),
-                    vsDefines + geometryVSVariations[j]);
-            }
+                vsDefines[j] = vs + geometryVSVariations[j];
         }
 
-        pixelShaders.Resize(2);
+        psDefines.Resize(2);
         for (unsigned j = 0; j < 2; ++j)
-        {
-            pixelShaders[j] =
-                graphics_->GetShader(PS, pass->GetPixelShader(), psDefines + heightFogVariations[j]);
-        }
+            psDefines[j] = ps + heightFogVariations[j];
     }
+}
 
-    pass->MarkShadersLoaded(shadersChangedFrameNumber_);
+void Renderer::GetLightVolumeShaderDefines(const String& shadowVariations, Vector<String>& vsDefines, Vector<String>& psDefines)
+{
+    vsDefines.Resize(MAX_DEFERRED_LIGHT_VS_VARIATIONS);
+    for (unsigned i = 0; i < MAX_DEFERRED_LIGHT_VS_VARIATIONS; ++i)
+        vsDefines[i] = deferredLightVSVariations[i];
+
+    psDefines.Resize(MAX_DEFERRED_LIGHT_PS_VARIATIONS);
+    for (unsigned i = 0; i < MAX_DEFERRED_LIGHT_PS_VARIATIONS; ++i)
+    {
+        psDefines[i] = lightPSVariations[i % DLPS_ORTHO];
+        if ((i % DLPS_ORTHO) >= DLPS_SHADOW)
+            psDefines[i] += shadowVariations;
+        if (i >= DLPS_ORTHO)
+            psDefines[i] += "ORTHO ";
+    }
 }
 
 void Renderer::ReleaseMaterialShaders()
@@ -1933,32 +1953,26 @@ void Renderer::ResetBuffers()
 
 String Renderer::GetShadowVariations() const
 {
-    const auto backend = graphics_->GetBackend();
+    return GetShadowVariations(shadowQuality_, graphics_->GetBackend(), graphics_->GetHardwareShadowSupport());
+}
+
+String Renderer::GetShadowVariations(ShadowQuality quality, GraphicsBackend backend, bool hardwareShadows)
+{
     const auto is_opengl = backend == GraphicsBackend::OpenGL || backend == GraphicsBackend::OpenGLES;
-    switch (shadowQuality_)
+    switch (quality)
     {
         case SHADOWQUALITY_SIMPLE_16BIT:
-            if(is_opengl)
+            if(is_opengl || hardwareShadows)
                 return "SIMPLE_SHADOW ";
             else
-            {
-                if (graphics_->GetHardwareShadowSupport())
-                    return "SIMPLE_SHADOW ";
-                else
-                    return "SIMPLE_SHADOW SHADOWCMP ";
-            }
+                return "SIMPLE_SHADOW SHADOWCMP ";
         case SHADOWQUALITY_SIMPLE_24BIT:
             return "SIMPLE_SHADOW ";
         case SHADOWQUALITY_PCF_16BIT:
-            if(is_opengl)
+            if(is_opengl || hardwareShadows)
                 return "PCF_SHADOW ";
             else
-            {
-                if (graphics_->GetHardwareShadowSupport())
-                    return "PCF_SHADOW ";
-                else
-                    return "PCF_SHADOW SHADOWCMP ";
-            }
+                return "PCF_SHADOW SHADOWCMP ";
         case SHADOWQUALITY_PCF_24BIT:
             return "PCF_SHADOW ";
         case SHADOWQUALITY_VSM:
@@ -1967,7 +1981,7 @@ String Renderer::GetShadowVariations() const
             return "VSM_SHADOW ";
     }
     return "";
-};
+}
 
 void Renderer::HandleScreenMode(StringHash eventType, VariantMap& eventData)
 {
@@ -49,6 +49,7 @@ class Technique;
 class Texture;
 class Texture2D;
 class TextureCube;
+class TextureStreamer;
 class View;
 class Zone;
 struct BatchQueue;
@@ -298,6 +299,9 @@ public:
     /// Return whether shadow maps are reused.
     bool GetReuseShadowMaps() const { return reuseShadowMaps_; }
 
+    /// Return texture streamer.
+    TextureStreamer* GetTextureStreamer() const { return textureStreamer_; }
+
     /// Return maximum number of shadow maps per resolution.
     int GetMaxShadowMaps() const { return maxShadowMaps_; }
 
@@ -433,6 +437,12 @@ public:
 
     /// Return a view or its source view if it uses one. Used internally for render statistics.
     static View* GetActualView(View* view);
+    /// Return the vertex and pixel shader defines of all variations a material pass may use, in the order the renderer indexes them. The extra defines come from the renderpath command.
+    static void GetPassShaderDefines(Pass* pass, const String& vsExtraDefines, const String& psExtraDefines, const String& shadowVariations, bool vsmShadows, Vector<String>& vsDefines, Vector<String>& psDefines);
+    /// Return the vertex and pixel shader defines of the deferred light volume variations.
+    static void GetLightVolumeShaderDefines(const String& shadowVariations, Vector<String>& vsDefines, Vector<String>& psDefines);
+    /// Return the shadow shader defines for a shadow quality.
+    static String GetShadowVariations(ShadowQuality quality, GraphicsBackend backend, bool hardwareShadows);
 
 // ATOMIC BEGIN (public)
     /// Reload textures.
@@ -542,6 +552,8 @@ private:
     HashSet<Octree*> updatedOctrees_;
     /// Techniques for which missing shader error has been displayed.
     HashSet<Technique*> shaderErrorDisplayed_;
+    /// Texture streamer.
+    SharedPtr<TextureStreamer> textureStreamer_;
     /// Mutex for shadow camera allocation.
     Mutex rendererMutex_;
     /// Current variation names for deferred light volume shaders.
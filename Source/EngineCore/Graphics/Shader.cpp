@@ -83,9 +83,7 @@ void Shader::RegisterObject(Context* context)
 
 bool Shader::BeginLoad(Deserializer& source)
 {
-    Graphics* graphics = GetSubsystem<Graphics>();
-    if (!graphics)
-        return false;
+    // Source processing does not need the graphics subsystem, which allows baking shaders in headless tools
 
     // Load the shader source code and resolve any includes
     timeStamp_ = 0;
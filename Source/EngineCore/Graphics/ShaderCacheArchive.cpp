@@ -0,0 +1,462 @@
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/ShaderCacheArchive.h"
+#include "../IO/Deserializer.h"
+#include "../IO/File.h"
+#include "../IO/FileLock.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MappedFile.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+static const char* SHADER_CACHE_FILE_ID = "RSCA";
+static const unsigned SHADER_CACHE_VERSION = 1;
+/// Archive header size: file ID and version.
+static const unsigned SHADER_CACHE_HEADER_SIZE = 8;
+/// Marker at the start of each record, used to detect damaged data.
+static const unsigned SHADER_CACHE_RECORD_MARKER = 0x45435352;
+/// Record header size: marker, data size, key, checksum and padding.
+static const unsigned SHADER_CACHE_RECORD_HEADER_SIZE = 24;
+/// Alignment of record data. Keeps the bytecode headers aligned when reading records in place.
+static const unsigned SHADER_CACHE_ALIGNMENT = 8;
+/// Lock file slot held exclusively while appending to or rewriting the store file.
+static const unsigned SHADER_CACHE_LOCK_WRITE = 0;
+/// Lock file slot held shared by each process using the store file, and exclusively while rewriting it.
+static const unsigned SHADER_CACHE_LOCK_USERS = 1;
+
+static const unsigned long long FNV64_OFFSET = 0xcbf29ce484222325ull;
+static const unsigned long long FNV64_PRIME = 0x100000001b3ull;
+
+static inline unsigned AlignRecordSize(unsigned size)
+{
+    return (size + SHADER_CACHE_ALIGNMENT - 1) & ~(SHADER_CACHE_ALIGNMENT - 1);
+}
+
+static bool WriteRecord(Serializer& dest, unsigned long long key, unsigned checksum, const unsigned char* data, unsigned size)
+{
+    static const unsigned char padding[SHADER_CACHE_ALIGNMENT] = {};
+    unsigned paddingSize = AlignRecordSize(size) - size;
+
+    bool success = true;
+    success &= dest.WriteUInt(SHADER_CACHE_RECORD_MARKER);
+    success &= dest.WriteUInt(size);
+    success &= dest.WriteUInt64(key);
+    success &= dest.WriteUInt(checksum);
+    success &= dest.WriteUInt(0);
+    if (size)
+        success &= dest.Write(data, size) == size;
+    if (paddingSize)
+        success &= dest.Write(padding, paddingSize) == paddingSize;
+    return success;
+}
+
+ShaderCacheArchive::ShaderCacheArchive() :
+    context_(0),
+    wastedSize_(0)
+{
+}
+
+ShaderCacheArchive::~ShaderCacheArchive()
+{
+    Close();
+}
+
+bool ShaderCacheArchive::Load(Deserializer& source)
+{
+    Close();
+
+    if (source.ReadFileID() != SHADER_CACHE_FILE_ID)
+    {
+        ATOMIC_LOGERROR(source.GetName() + " is not a valid shader cache archive");
+        return false;
+    }
+
+    if (source.ReadUInt() != SHADER_CACHE_VERSION)
+    {
+        ATOMIC_LOGWARNING(source.GetName() + " is from an incompatible engine version, ignoring");
+        return false;
+    }
+
+    data_.Reserve(source.GetSize() - source.GetPosition());
+    ReadRecords(source, false);
+    return true;
+}
+
+bool ShaderCacheArchive::Save(Serializer& dest) const
+{
+    bool success = true;
+    success &= dest.WriteFileID(SHADER_CACHE_FILE_ID);
+    success &= dest.WriteUInt(SHADER_CACHE_VERSION);
+
+    for (HashMap<unsigned long long, Entry>::ConstIterator i = entries_.Begin(); i != entries_.End(); ++i)
+        success &= WriteRecord(dest, i->first_, i->second_.checksum_, GetEntryData(i->second_), i->second_.size_);
+
+    return success;
+}
+
+bool ShaderCacheArchive::Open(Context* context, const String& fileName)
+{
+    Close();
+
+    context_ = context;
+    fileName_ = fileName;
+
+    FileSystem* fileSystem = context_->GetSubsystem<FileSystem>();
+    String path = GetPath(fileName_);
+    if (path.Length() && !fileSystem->DirExists(path))
+        fileSystem->CreateDirsRecursive(path);
+
+    // Without a lock file, such as in a read-only directory, the store is assumed not to be shared
+    lock_ = new FileLock();
+    if (!lock_->Open(fileName_ + ".lock"))
+        lock_.Reset();
+
+    FileLockScope writeLock(lock_, SHADER_CACHE_LOCK_WRITE);
+    bool soleUse = AcquireSoleUse();
+    bool appendable = true;
+
+    if (!fileSystem->FileExists(fileName_))
+    {
+        SharedPtr<File> file(new File(context_, fileName_, FILE_WRITE));
+        if (!file->IsOpen() || !file->WriteFileID(SHADER_CACHE_FILE_ID) || !file->WriteUInt(SHADER_CACHE_VERSION))
+        {
+            ATOMIC_LOGERROR("Failed to create shader cache " + fileName_);
+            Close();
+            return false;
+        }
+    }
+
+    bool intact = false;
+    if (!MapFile(intact))
+    {
+        if (!soleUse)
+        {
+            ATOMIC_LOGWARNING("Shader cache " + fileName_ + " is damaged or from an incompatible engine version and in use "
+                "by another process, not using it");
+            Close();
+            return false;
+        }
+
+        ATOMIC_LOGWARNING("Shader cache " + fileName_ + " is damaged or from an incompatible engine version, recreating");
+        entries_.Clear();
+        data_.Clear();
+        Compact();
+    }
+    // Rewrite the file when it ends in a damaged record, as appended records would not be readable after it, or when
+    // most of it is replaced records. Other processes have the file mapped, so it is left alone while they use it
+    else if (!intact || wastedSize_ > mappedFile_->GetSize() / 2)
+    {
+        if (soleUse)
+        {
+            if (!intact)
+                ATOMIC_LOGWARNING("Shader cache " + fileName_ + " has damaged records, removing them");
+            Compact();
+        }
+        else if (!intact)
+        {
+            ATOMIC_LOGWARNING("Shader cache " + fileName_ + " has damaged records and is in use by another process, new "
+                "shaders will not be cached");
+            appendable = false;
+        }
+    }
+
+    if (fileName_.Empty())
+        return false;
+
+    if (soleUse)
+        ReleaseSoleUse();
+
+    if (!appendable)
+        return true;
+
+    appendFile_ = new File(context_, fileName_, FILE_APPEND);
+    if (!appendFile_->IsOpen())
+    {
+        ATOMIC_LOGWARNING("Failed to open shader cache " + fileName_ + " for writing, new shaders will not be cached");
+        appendFile_.Reset();
+    }
+
+    return true;
+}
+
+void ShaderCacheArchive::Close()
+{
+    appendFile_.Reset();
+    mappedFile_.Reset();
+    lock_.Reset();
+    entries_.Clear();
+    data_.Clear();
+    fileName_.Clear();
+    context_ = 0;
+    wastedSize_ = 0;
+}
+
+void ShaderCacheArchive::AddEntry(unsigned long long key, const void* data, unsigned size)
+{
+    HashMap<unsigned long long, Entry>::Iterator i = entries_.Find(key);
+    if (i != entries_.End() && appendFile_)
+        wastedSize_ += SHADER_CACHE_RECORD_HEADER_SIZE + AlignRecordSize(i->second_.size_);
+
+    Entry entry;
+    entry.offset_ = data_.Size();
+    entry.size_ = size;
+    entry.checksum_ = CalculateChecksum(data, size);
+    entry.mapped_ = false;
+
+    // Store the padding too, so that entries can be written out as they are
+    unsigned alignedSize = AlignRecordSize(size);
+    data_.Resize(entry.offset_ + alignedSize);
+    if (size)
+        memcpy(&data_[entry.offset_], data, size);
+    if (alignedSize > size)
+        memset(&data_[entry.offset_ + size], 0, alignedSize - size);
+
+    entries_[key] = entry;
+
+    if (appendFile_)
+    {
+        // Later records replace earlier ones with the same key, so the file is only ever appended to. Records of other
+        // processes are not interleaved with this one, but are only seen when the file is opened again
+        FileLockScope writeLock(lock_, SHADER_CACHE_LOCK_WRITE);
+        if (!WriteRecord(*appendFile_, key, entry.checksum_, static_cast<const unsigned char*>(data), size))
+        {
+            ATOMIC_LOGWARNING("Failed to write to shader cache " + fileName_ + ", new shaders will not be cached");
+            appendFile_.Reset();
+        }
+        else
+            appendFile_->Flush();
+    }
+}
+
+bool ShaderCacheArchive::FindEntry(unsigned long long key, const unsigned char*& data, unsigned& size)
+{
+    HashMap<unsigned long long, Entry>::ConstIterator i = entries_.Find(key);
+    if (i == entries_.End())
+        return false;
+
+    const Entry& entry = i->second_;
+    const unsigned char* entryData = GetEntryData(entry);
+    if (CalculateChecksum(entryData, entry.size_) != entry.checksum_)
+    {
+        ATOMIC_LOGWARNING("Shader cache entry " + String(key) + " is corrupted");
+        RemoveEntry(key);
+        return false;
+    }
+
+    data = entryData;
+    size = entry.size_;
+    return true;
+}
+
+void ShaderCacheArchive::RemoveEntry(unsigned long long key)
+{
+    HashMap<unsigned long long, Entry>::Iterator i = entries_.Find(key);
+    if (i == entries_.End())
+        return;
+
+    if (i->second_.mapped_ || appendFile_)
+        wastedSize_ += SHADER_CACHE_RECORD_HEADER_SIZE + AlignRecordSize(i->second_.size_);
+    entries_.Erase(i);
+}
+
+void ShaderCacheArchive::Clear()
+{
+    entries_.Clear();
+    data_.Clear();
+
+    if (fileName_.Empty())
+        return;
+
+    FileLockScope writeLock(lock_, SHADER_CACHE_LOCK_WRITE);
+    if (AcquireSoleUse())
+    {
+        Compact();
+        ReleaseSoleUse();
+    }
+    else
+        ATOMIC_LOGWARNING("Shader cache " + fileName_ + " is in use by another process, not emptying it");
+}
+
+unsigned long long ShaderCacheArchive::CalculateKey(const String& sourceCode, ShaderType type, GraphicsBackend backend)
+{
+    unsigned long long hash = FNV64_OFFSET;
+    const unsigned char* chars = reinterpret_cast<const unsigned char*>(sourceCode.CString());
+    for (unsigned i = 0; i < sourceCode.Length(); ++i)
+        hash = (hash ^ chars[i]) * FNV64_PRIME;
+
+    hash = (hash ^ (unsigned char)type) * FNV64_PRIME;
+    hash = (hash ^ (unsigned char)backend) * FNV64_PRIME;
+    return hash;
+}
+
+unsigned ShaderCacheArchive::CalculateChecksum(const void* data, unsigned size)
+{
+    // 32-bit FNV-1a
+    unsigned hash = 0x811c9dc5;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (unsigned i = 0; i < size; ++i)
+        hash = (hash ^ bytes[i]) * 0x01000193;
+    return hash;
+}
+
+bool ShaderCacheArchive::ReadRecords(Deserializer& source, bool inPlace)
+{
+    const String& name = fileName_.Length() ? fileName_ : source.GetName();
+
+    while (!source.IsEof())
+    {
+        unsigned remaining = source.GetSize() - source.GetPosition();
+        if (remaining < SHADER_CACHE_RECORD_HEADER_SIZE || source.ReadUInt() != SHADER_CACHE_RECORD_MARKER)
+        {
+            ATOMIC_LOGWARNING(name + " has a damaged record, ignoring the rest of the archive");
+            wastedSize_ += remaining;
+            return false;
+        }
+
+        Entry entry;
+        entry.size_ = source.ReadUInt();
+        unsigned long long key = source.ReadUInt64();
+        entry.checksum_ = source.ReadUInt();
+        entry.mapped_ = inPlace;
+        source.ReadUInt();
+
+        unsigned alignedSize = AlignRecordSize(entry.size_);
+        if (alignedSize < entry.size_ || alignedSize > source.GetSize() - source.GetPosition())
+        {
+            ATOMIC_LOGWARNING(name + " is truncated, ignoring the last record");
+            wastedSize_ += remaining;
+            return false;
+        }
+
+        if (inPlace)
+        {
+            entry.offset_ = source.GetPosition();
+            source.Seek(entry.offset_ + alignedSize);
+        }
+        else
+        {
+            entry.offset_ = data_.Size();
+            data_.Resize(entry.offset_ + alignedSize);
+            if (alignedSize)
+                source.Read(&data_[entry.offset_], alignedSize);
+        }
+
+        // Later records replace earlier ones with the same key
+        HashMap<unsigned long long, Entry>::Iterator i = entries_.Find(key);
+        if (i != entries_.End())
+        {
+            wastedSize_ += SHADER_CACHE_RECORD_HEADER_SIZE + AlignRecordSize(i->second_.size_);
+            i->second_ = entry;
+        }
+        else
+            entries_[key] = entry;
+    }
+
+    return true;
+}
+
+const unsigned char* ShaderCacheArchive::GetEntryData(const Entry& entry) const
+{
+    if (!entry.size_)
+        return 0;
+    return entry.mapped_ ? mappedFile_->GetData() + entry.offset_ : &data_[entry.offset_];
+}
+
+bool ShaderCacheArchive::MapFile(bool& intact)
+{
+    intact = false;
+    entries_.Clear();
+    data_.Clear();
+    wastedSize_ = 0;
+
+    mappedFile_ = new MappedFile();
+    if (!mappedFile_->Open(fileName_) || mappedFile_->GetSize() < SHADER_CACHE_HEADER_SIZE)
+    {
+        mappedFile_.Reset();
+        return false;
+    }
+
+    MemoryBuffer buffer(mappedFile_->GetData(), mappedFile_->GetSize());
+    if (buffer.ReadFileID() != SHADER_CACHE_FILE_ID || buffer.ReadUInt() != SHADER_CACHE_VERSION)
+    {
+        mappedFile_.Reset();
+        return false;
+    }
+
+    intact = ReadRecords(buffer, true);
+    return true;
+}
+
+bool ShaderCacheArchive::AcquireSoleUse()
+{
+    if (!lock_)
+        return true;
+
+    // Only one process at a time gets here, as the write lock is held, so releasing the shared lock first does not let
+    // another process rewrite the file in between
+    lock_->Release(SHADER_CACHE_LOCK_USERS);
+    if (lock_->TryAcquire(SHADER_CACHE_LOCK_USERS, true))
+        return true;
+
+    lock_->Acquire(SHADER_CACHE_LOCK_USERS, false);
+    return false;
+}
+
+void ShaderCacheArchive::ReleaseSoleUse()
+{
+    if (!lock_)
+        return;
+
+    lock_->Release(SHADER_CACHE_LOCK_USERS);
+    lock_->Acquire(SHADER_CACHE_LOCK_USERS, false);
+}
+
+bool ShaderCacheArchive::Compact()
+{
+    FileSystem* fileSystem = context_->GetSubsystem<FileSystem>();
+    String tempFileName = fileName_ + ".tmp";
+
+    {
+        SharedPtr<File> file(new File(context_, tempFileName, FILE_WRITE));
+        if (!file->IsOpen() || !Save(*file))
+        {
+            ATOMIC_LOGERROR("Failed to rewrite shader cache " + fileName_);
+            file.Reset();
+            fileSystem->Delete(tempFileName);
+            return false;
+        }
+    }
+
+    // Release the mapping and the append handle, as the file can not be replaced while they are open on all platforms
+    bool reopenAppend = appendFile_.NotNull();
+    appendFile_.Reset();
+    mappedFile_.Reset();
+    entries_.Clear();
+    data_.Clear();
+
+    bool intact = false;
+    if (!fileSystem->Delete(fileName_) || !fileSystem->Rename(tempFileName, fileName_) || !MapFile(intact))
+    {
+        ATOMIC_LOGERROR("Failed to replace shader cache " + fileName_);
+        Close();
+        return false;
+    }
+
+    if (reopenAppend)
+    {
+        appendFile_ = new File(context_, fileName_, FILE_APPEND);
+        if (!appendFile_->IsOpen())
+            appendFile_.Reset();
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Graphics/GraphicsDefs.h"
+
+namespace Atomic
+{
+
+class Context;
+class Deserializer;
+class File;
+class FileLock;
+class MappedFile;
+class Serializer;
+
+/// Packed shader bytecode archive. Entries are keyed by a hash of the complete source a variation is compiled from, so
+/// bytecode of an edited shader or include is never found. Each entry is stored as a self-contained record with its own
+/// checksum, which allows appending to an existing archive and skipping damaged entries. An archive is either loaded
+/// into memory from a resource, or opened as a store file that is memory-mapped for reading and appended to on writes.
+/// A store file may be shared by several processes: appends are serialized with an advisory lock file next to it, and
+/// the file is only rewritten by a process that has it open alone.
+class ATOMIC_API ShaderCacheArchive : public RefCounted
+{
+    ATOMIC_REFCOUNTED(ShaderCacheArchive)
+
+public:
+    /// Construct.
+    ShaderCacheArchive();
+    /// Destruct.
+    ~ShaderCacheArchive();
+
+    /// Read an archive into memory, replacing current entries. Reading stops at the first truncated or damaged record.
+    /// Return true if the archive header is valid.
+    bool Load(Deserializer& source);
+    /// Write all entries. Return true if successful.
+    bool Save(Serializer& dest) const;
+    /// Open a store file, creating it if it does not exist. Existing records are memory-mapped and further entries are
+    /// appended to the file. A damaged file is rewritten with its intact records, or left alone without appending to it
+    /// while other processes have it open. Return true if successful.
+    bool Open(Context* context, const String& fileName);
+    /// Close the store file and remove all entries.
+    void Close();
+
+    /// Add an entry, replacing an existing one with the same key. Appended to the store file if one is open.
+    void AddEntry(unsigned long long key, const void* data, unsigned size);
+    /// Find an entry. Return true if found and its checksum matches. A corrupted entry is removed, so that it can be
+    /// replaced.
+    bool FindEntry(unsigned long long key, const unsigned char*& data, unsigned& size);
+    /// Remove an entry.
+    void RemoveEntry(unsigned long long key);
+    /// Remove all entries. An open store file is emptied unless other processes have it open.
+    void Clear();
+
+    /// Return number of entries.
+    unsigned GetNumEntries() const { return entries_.Size(); }
+    /// Return store file name, or empty if not opened from a file.
+    const String& GetFileName() const { return fileName_; }
+
+    /// Return the entry key of a shader compile from its complete source code, type and backend.
+    static unsigned long long CalculateKey(const String& sourceCode, ShaderType type, GraphicsBackend backend);
+    /// Return the checksum of entry data.
+    static unsigned CalculateChecksum(const void* data, unsigned size);
+
+private:
+    /// Location of an entry.
+    struct Entry
+    {
+        /// Offset of the data in the mapped file or the data buffer.
+        unsigned offset_;
+        /// Data size.
+        unsigned size_;
+        /// Data checksum.
+        unsigned checksum_;
+        /// Whether the data is in the mapped file.
+        bool mapped_;
+    };
+
+    /// Read records following the archive header. When in place, entries refer to the source data instead of copying
+    /// it. Return false if the records end in damaged or truncated data.
+    bool ReadRecords(Deserializer& source, bool inPlace);
+    /// Return the data of an entry.
+    const unsigned char* GetEntryData(const Entry& entry) const;
+    /// Rewrite the store file with the current entries only. Return true if successful.
+    bool Compact();
+    /// Map the store file and index its records. Return false if the file is damaged or can not be mapped.
+    bool MapFile(bool& intact);
+    /// Try to become the only process using the store file, which allows rewriting it. The write lock must be held.
+    bool AcquireSoleUse();
+    /// Share the store file with other processes again after AcquireSoleUse() succeeded.
+    void ReleaseSoleUse();
+
+    /// Entries by key.
+    HashMap<unsigned long long, Entry> entries_;
+    /// Data of entries not in the mapped file.
+    PODVector<unsigned char> data_;
+    /// Mapped store file.
+    SharedPtr<MappedFile> mappedFile_;
+    /// Store file opened for appending.
+    SharedPtr<File> appendFile_;
+    /// Lock file coordinating the processes using the store file.
+    SharedPtr<FileLock> lock_;
+    /// Context of the store file.
+    Context* context_;
+    /// Store file name.
+    String fileName_;
+    /// Size of the records in the store file that have been replaced or are damaged.
+    unsigned wastedSize_;
+};
+
+}
@@ -32,6 +32,7 @@ namespace Atomic
 
 class ConstantBuffer;
 class Shader;
+struct ShaderCompileTask;
 
 
 /// Vertex or pixel shader on the GPU.
@@ -52,6 +53,12 @@ public:
 
     /// Compile the shader. Return true if successful.
     bool Create();
+    /// Begin compiling the shader on a worker thread. Bytecode found in the shader cache is loaded immediately. Return true if the shader was created or its compile is pending.
+    bool CreateAsync();
+    /// Create the shader if its asynchronous compile has finished. Called by Graphics.
+    void FinishAsyncCreate();
+    /// Compile for a backend and return the shader cache archive key and bytecode file data, without creating the shader. Does not require a graphics device and is safe to call from worker threads. Return true if successful.
+    bool Bake(GraphicsBackend backend, unsigned long long& key, ea::shared_array<u8>& shader_file_data, u32& shader_file_size, String& error) const;
     /// Set name.
     void SetName(const String& name);
     /// Set defines.
@@ -90,6 +97,12 @@ public:
     /// Return compile error/warning string.
     const String& GetCompilerOutput() const { return compilerOutput_; }
 
+    /// Return whether an asynchronous compile is pending.
+    bool IsCompiling() const { return compileTask_ != 0; }
+
+    /// Return duration of the last asynchronous compile in milliseconds, from queueing to the shader being ready.
+    float GetCompileTime() const { return compileTime_; }
+
     /// Return constant buffer data sizes.
     const unsigned* GetConstantBufferSizes() const { return &constantBufferSizes_[0]; }
 
@@ -101,12 +114,18 @@ public:
 
 private:
     void BuildHash();
-    /// Load bytecode from a file. Return true if successful.
-    bool LoadByteCode(const String& binaryShaderName);
-    /// Compile from source. Return true if successful.
-    bool Compile(ea::shared_array<u8>& shader_file_data, u32* shader_file_size);
-    /// Save bytecode to a file.
-    void SaveByteCode(const String& binaryShaderName, const ea::shared_array<u8>& byte_code, const u32 byte_code_len) const;
+    /// Calculate the hash stored in bytecode files.
+    u32 CalculateHash() const;
+    /// Load bytecode from the baked shader cache archive or the shader cache store. Return true if successful.
+    bool LoadFromCache(const ShaderCompileTask& task);
+    /// Add compiled bytecode to the shader cache store.
+    void SaveToCache(const ShaderCompileTask& task, const ea::shared_array<u8>& shader_file_data, u32 shader_file_size);
+    /// Create the shader from bytecode file data. Return true if successful.
+    bool CreateFromByteCode(void* data, unsigned size, const String& sourceName);
+    /// Fill the compiler input of a compile task for a backend. Return true if successful.
+    bool PrepareCompile(ShaderCompileTask& task, GraphicsBackend backend) const;
+    /// Create the shader from a finished compile task. Return true if successful.
+    bool CreateFromCompiled(ShaderCompileTask& task, ea::shared_array<u8>& shader_file_data, u32* shader_file_size);
 
     /// Shader this variation belongs to.
     WeakPtr<Shader> owner_;
@@ -133,6 +152,10 @@ private:
     ea::vector<REngine::TextureSampler> textures_{};
     ea::vector<REngine::ShaderCompilerReflectInputElement> input_elements_{};
     u32 hash_{};
+    /// Pending asynchronous compile.
+    ShaderCompileTask* compileTask_;
+    /// Duration of the last asynchronous compile in milliseconds.
+    float compileTime_;
 };
 
 }
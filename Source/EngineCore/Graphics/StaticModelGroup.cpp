@@ -29,6 +29,7 @@
 #include "../Graphics/Material.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/OctreeQuery.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/StaticModelGroup.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Scene/Scene.h"
@@ -50,7 +51,8 @@ const char* instanceNodesStructureElementNames[] =
 StaticModelGroup::StaticModelGroup(Context* context) :
     StaticModel(context),
     nodesDirty_(false),
-    nodeIDsDirty_(false)
+    nodeIDsDirty_(false),
+    instanceBufferDirty_(true)
 {
     // Initialize the default node IDs attribute
     UpdateNodeIDs();
@@ -178,6 +180,10 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
     distance_ = frame.camera_->GetDistance(worldBoundingBox.Center());
 
+    // The persistent buffer is filled or resized before drawing if the transforms have changed. Until it has been
+    // created, the transforms go through the renderer's instancing buffer
+    VertexBuffer* instanceBuffer = instanceBuffer_ && CanUsePersistentInstances() ? instanceBuffer_.Get() : (VertexBuffer*)0;
+
     if (batches_.Size() > 1)
     {
         for (unsigned i = 0; i < batches_.Size(); ++i)
@@ -185,6 +191,7 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
             batches_[i].distance_ = frame.camera_->GetDistance(worldTransform * geometryData_[i].center_);
             batches_[i].worldTransform_ = numWorldTransforms_ ? &worldTransforms_[0] : &Matrix3x4::IDENTITY;
             batches_[i].numWorldTransforms_ = numWorldTransforms_;
+            batches_[i].instanceBuffer_ = instanceBuffer;
         }
     }
     else if (batches_.Size() == 1)
@@ -192,6 +199,7 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
         batches_[0].distance_ = distance_;
         batches_[0].worldTransform_ = numWorldTransforms_ ? &worldTransforms_[0] : &Matrix3x4::IDENTITY;
         batches_[0].numWorldTransforms_ = numWorldTransforms_;
+        batches_[0].instanceBuffer_ = instanceBuffer;
     }
 
     float scale = worldBoundingBox.Size().DotProduct(DOT_SCALE);
@@ -204,6 +212,42 @@ void StaticModelGroup::UpdateBatches(const FrameInfo& frame)
     }
 }
 
+void StaticModelGroup::UpdateGeometry(const FrameInfo& frame)
+{
+    if (!CanUsePersistentInstances())
+        return;
+
+    if (!numWorldTransforms_)
+    {
+        instanceBufferDirty_ = false;
+        return;
+    }
+
+    VertexBuffer* sharedBuffer = GetSubsystem<Renderer>()->GetInstancingBuffer();
+    if (!instanceBuffer_)
+        instanceBuffer_ = new VertexBuffer(context_);
+
+    if (instanceBuffer_->GetVertexCount() < numWorldTransforms_ ||
+        instanceBuffer_->GetVertexSize() != sharedBuffer->GetVertexSize())
+    {
+        if (!instanceBuffer_->SetSize(numWorldTransforms_, sharedBuffer->GetElements()))
+            return;
+    }
+
+    instanceBuffer_->SetDataRange(&worldTransforms_[0], 0, numWorldTransforms_);
+
+    instanceBuffer_->ClearDataLost();
+    instanceBufferDirty_ = false;
+}
+
+UpdateGeometryType StaticModelGroup::GetUpdateGeometryType()
+{
+    if ((instanceBufferDirty_ || (instanceBuffer_ && instanceBuffer_->IsDataLost())) && CanUsePersistentInstances())
+        return UPDATE_MAIN_THREAD;
+    else
+        return UPDATE_NONE;
+}
+
 unsigned StaticModelGroup::GetNumOccluderTriangles()
 {
     // Make sure instance transforms are up-to-date
@@ -393,6 +437,7 @@ void StaticModelGroup::OnWorldBoundingBoxUpdate()
     // Store the amount of valid instances we found instead of resizing worldTransforms_. This is because this function may be 
     // called from multiple worker threads simultaneously
     numWorldTransforms_ = index;
+    instanceBufferDirty_ = true;
 }
 
 void StaticModelGroup::UpdateNumTransforms()
@@ -400,6 +445,7 @@ void StaticModelGroup::UpdateNumTransforms()
     worldTransforms_.Resize(instanceNodes_.Size());
     numWorldTransforms_ = 0; // Correct amount will be during world bounding box update
     nodeIDsDirty_ = true;
+    instanceBufferDirty_ = true;
 
     OnMarkedDirty(GetNode());
     MarkNetworkUpdate();
@@ -421,4 +467,11 @@ void StaticModelGroup::UpdateNodeIDs() const
     nodeIDsDirty_ = false;
 }
 
+bool StaticModelGroup::CanUsePersistentInstances() const
+{
+    // Extra instancing elements hold per-drawable data that only the shared buffer is filled with
+    Renderer* renderer = GetSubsystem<Renderer>();
+    return renderer && renderer->GetInstancingBuffer() && !renderer->GetNumExtraInstancingBufferElements();
+}
+
 }
@@ -28,6 +28,7 @@ namespace Atomic
 {
 
 /// Renders several object instances while culling and receiving light as one unit. Can be used as a CPU-side optimization, but note that also regular StaticModels will use instanced rendering if possible.
+/// The instance transforms are kept in a persistent instancing buffer that is only uploaded when an instance moves, instead of being copied to the renderer's instancing buffer every frame.
 class ATOMIC_API StaticModelGroup : public StaticModel
 {
     ATOMIC_OBJECT(StaticModelGroup, StaticModel);
@@ -46,6 +47,10 @@ public:
     virtual void ProcessRayQuery(const RayOctreeQuery& query, PODVector<RayQueryResult>& results);
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
     virtual void UpdateBatches(const FrameInfo& frame);
+    /// Upload the instance transforms to the persistent instancing buffer.
+    virtual void UpdateGeometry(const FrameInfo& frame);
+    /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
+    virtual UpdateGeometryType GetUpdateGeometryType();
     /// Return number of occlusion geometry triangles.
     virtual unsigned GetNumOccluderTriangles();
     /// Draw to occlusion buffer. Return true if did not run out of triangles.
@@ -81,11 +86,15 @@ private:
     void UpdateNumTransforms();
     /// Update node IDs attribute from the actual nodes.
     void UpdateNodeIDs() const;
+    /// Return whether the renderer's instancing buffer layout allows drawing from a persistent instancing buffer.
+    bool CanUsePersistentInstances() const;
 
     /// Instance nodes.
     Vector<WeakPtr<Node> > instanceNodes_;
     /// World transforms of valid (existing and visible) instances.
     PODVector<Matrix3x4> worldTransforms_;
+    /// Persistent instancing buffer holding the world transforms.
+    SharedPtr<VertexBuffer> instanceBuffer_;
     /// IDs of instance nodes for serialization.
     mutable VariantVector nodeIDsAttr_;
     /// Number of valid instance node transforms.
@@ -94,6 +103,8 @@ private:
     mutable bool nodesDirty_;
     /// Whether nodes have been manipulated by the API and node ID attribute should be refreshed.
     mutable bool nodeIDsDirty_;
+    /// Whether the world transforms have changed since the instancing buffer was uploaded.
+    bool instanceBufferDirty_;
 };
 
 }
@@ -77,6 +77,8 @@ Texture::Texture(Context* context) :
     width_(0),
     height_(0),
     depth_(0),
+    fullWidth_(0),
+    fullHeight_(0),
     shadowCompare_(false),
     filterMode_(FILTER_DEFAULT),
     anisotropy_(0),
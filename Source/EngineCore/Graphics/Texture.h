@@ -84,11 +84,11 @@ public:
     /// Return number of mip levels.
     unsigned GetLevels() const { return levels_; }
 
-    /// Return width.
-    int GetWidth() const { return width_; }
+    /// Return width. For a streamed texture this is the full width, also when its largest mip levels are not resident.
+    int GetWidth() const { return fullWidth_ ? fullWidth_ : width_; }
 
-    /// Return height.
-    int GetHeight() const { return height_; }
+    /// Return height. For a streamed texture this is the full height, also when its largest mip levels are not resident.
+    int GetHeight() const { return fullHeight_ ? fullHeight_ : height_; }
 
     /// Return depth.
     int GetDepth() const { return depth_; }
@@ -128,9 +128,9 @@ public:
 
     /// Return mip levels to skip on a quality setting when loading.
     int GetMipsToSkip(int quality) const;
-    /// Return mip level width, or 0 if level does not exist.
+    /// Return mip level width, or 0 if level does not exist. Levels are counted from the largest resident level.
     int GetLevelWidth(unsigned level) const;
-    /// Return mip level width, or 0 if level does not exist.
+    /// Return mip level width, or 0 if level does not exist. Levels are counted from the largest resident level.
     int GetLevelHeight(unsigned level) const;
     /// Return mip level depth, or 0 if level does not exist.
     int GetLevelDepth(unsigned level) const;
@@ -207,6 +207,10 @@ protected:
     int height_;
     /// Texture depth.
     int depth_;
+    /// Full width of a streamed texture whose largest mip levels are not resident, or 0 when all levels are.
+    int fullWidth_;
+    /// Full height of a streamed texture whose largest mip levels are not resident, or 0 when all levels are.
+    int fullHeight_;
     /// Shadow compare mode.
     bool shadowCompare_;
     /// Filtering mode.
@@ -29,6 +29,7 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -40,12 +41,20 @@ namespace Atomic
 {
 
 Texture2D::Texture2D(Context* context) :
-    Texture(context)
+    Texture(context),
+    streamingIndex_(M_MAX_UNSIGNED)
 {
 }
 
 Texture2D::~Texture2D()
 {
+    if (streamingIndex_ != M_MAX_UNSIGNED)
+    {
+        Renderer* renderer = GetSubsystem<Renderer>();
+        if (renderer)
+            renderer->GetTextureStreamer()->RemoveTexture(this);
+    }
+
     Texture2D::Release();
 }
 
@@ -68,8 +77,13 @@ bool Texture2D::BeginLoad(Deserializer& source)
         return true;
     }
 
-    // Load the image data for EndLoad()
+    // Load the image data for EndLoad(). When streaming, the largest mip levels are left out until needed
     loadImage_ = new Image(context_);
+    loadFileName_ = source.GetName();
+    Renderer* renderer = GetSubsystem<Renderer>();
+    if (renderer && renderer->GetTextureStreamer()->IsEnabled())
+        loadImage_->SetSkipLevels(renderer->GetTextureStreamer()->GetInitialSkipLevels());
+
     if (!loadImage_->Load(source))
     {
         loadImage_.Reset();
@@ -98,10 +112,19 @@ bool Texture2D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
+
+    // Register before setting the data, as streamed textures take their levels as loaded
+    Renderer* renderer = GetSubsystem<Renderer>();
+    if (renderer && renderer->GetTextureStreamer()->IsEnabled())
+        renderer->GetTextureStreamer()->AddTexture(this, loadFileName_, loadImage_);
+    else if (renderer && streamingIndex_ != M_MAX_UNSIGNED)
+        renderer->GetTextureStreamer()->RemoveTexture(this);
+
     const auto success = SetData(loadImage_);
 
     loadImage_.Reset();
     loadParameters_.Reset();
+    loadFileName_.Clear();
 
     return success;
 }
@@ -149,6 +172,8 @@ bool Texture2D::SetSize(int width, int height, TextureFormat format, TextureUsag
 
     width_ = width;
     height_ = height;
+    fullWidth_ = 0;
+    fullHeight_ = 0;
     format_ = format;
     depth_ = 1;
     multiSample_ = multiSample;
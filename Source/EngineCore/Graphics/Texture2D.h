@@ -37,6 +37,8 @@ class ATOMIC_API Texture2D : public Texture
 {
     ATOMIC_OBJECT(Texture2D, Texture);
 
+    friend class TextureStreamer;
+
 public:
     /// Construct.
     Texture2D(Context* context);
@@ -79,6 +81,8 @@ public:
 
     /// Return render surface.
     RenderSurface* GetRenderSurface() const { return renderSurface_; }
+    /// Return whether the mip levels are streamed.
+    bool IsStreaming() const { return streamingIndex_ != M_MAX_UNSIGNED; }
 
 protected:
     /// Create the GPU texture.
@@ -94,6 +98,10 @@ private:
     SharedPtr<Image> loadImage_;
     /// Parameter file acquired during BeginLoad.
     SharedPtr<XMLFile> loadParameters_;
+    /// Name of the file the image was loaded from during BeginLoad.
+    String loadFileName_;
+    /// Index in the texture streamer, or M_MAX_UNSIGNED if not streamed.
+    unsigned streamingIndex_;
 };
 
 }
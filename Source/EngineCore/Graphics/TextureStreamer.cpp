@@ -0,0 +1,347 @@
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreamer.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include <atomic>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+/// Mip levels of a streamed texture being loaded.
+struct TextureStreamingLoad
+{
+    /// File to load.
+    String fileName_;
+    /// Image to load into, set up to skip the levels above the new top level.
+    SharedPtr<Image> image_;
+    /// Work item when loading asynchronously.
+    SharedPtr<WorkItem> item_;
+    /// Work queue the item was added to.
+    WeakPtr<WorkQueue> queue_;
+    /// Load result.
+    bool success_{false};
+    /// Set by the worker thread when the load has finished.
+    std::atomic<bool> completed_{false};
+};
+
+/// Work item priority of texture loads. Lowest, so that waiting for frame work never waits for them.
+static const unsigned TEXTURE_STREAMING_PRIORITY = 0;
+/// Default number of top mip levels left out when a streamed texture is first loaded.
+static const unsigned DEFAULT_INITIAL_SKIP_LEVELS = 3;
+/// Default number of frames a texture keeps its requested levels after it was last seen.
+static const unsigned DEFAULT_KEEP_FRAMES = 120;
+/// Default maximum number of loads in progress.
+static const unsigned DEFAULT_MAX_LOADS = 4;
+
+static void LoadTextureLevels(TextureStreamingLoad& load)
+{
+    ResourceCache* cache = load.image_->GetSubsystem<ResourceCache>();
+    SharedPtr<File> file = cache ? cache->GetFile(load.fileName_, false) : SharedPtr<File>();
+    load.success_ = file && load.image_->BeginLoad(*file);
+}
+
+static void LoadTextureLevelsWork(const WorkItem* item, unsigned threadIndex)
+{
+    TextureStreamingLoad* load = reinterpret_cast<TextureStreamingLoad*>(item->aux_);
+    LoadTextureLevels(*load);
+    load->completed_ = true;
+}
+
+TextureStreamer::TextureStreamer(Context* context) :
+    Object(context),
+    frameNumber_(0),
+    initialSkipLevels_(DEFAULT_INITIAL_SKIP_LEVELS),
+    levelBias_(0.0f),
+    keepFrames_(DEFAULT_KEEP_FRAMES),
+    maxLoads_(DEFAULT_MAX_LOADS),
+    enabled_(false)
+{
+}
+
+TextureStreamer::~TextureStreamer()
+{
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        CancelLoad(textures_[i]);
+        textures_[i].texture_->streamingIndex_ = M_MAX_UNSIGNED;
+    }
+}
+
+bool TextureStreamer::AddTexture(Texture2D* texture, const String& fileName, Image* image)
+{
+    CompressedFormat format = image->GetCompressedFormat();
+    unsigned skipped = image->GetNumSkippedLevels();
+    unsigned numLevels = image->GetNumCompressedLevels() + skipped;
+
+    // Only DDS files support loading part of the mip chain
+    if ((format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5) || numLevels < 2 ||
+        numLevels > MAX_STREAMED_TEXTURE_LEVELS || image->GetNextSibling() || image->GetDepth() > 1 || fileName.Empty())
+    {
+        RemoveTexture(texture);
+        return false;
+    }
+
+    unsigned index = texture->streamingIndex_;
+    if (index < textures_.Size() && textures_[index].texture_ == texture)
+        CancelLoad(textures_[index]);
+    else
+    {
+        index = textures_.Size();
+        textures_.Resize(index + 1);
+        textures_[index].load_ = 0;
+        textures_[index].viewRequested_ = false;
+        texture->streamingIndex_ = index;
+    }
+
+    StreamingTexture& entry = textures_[index];
+    entry.texture_ = texture;
+    entry.fileName_ = fileName;
+    entry.numLevels_ = numLevels;
+
+    int width = image->GetFullWidth();
+    int height = image->GetFullHeight();
+    entry.size_ = Max(width, height);
+
+    unsigned blockSize = format == CF_DXT1 ? 8 : 16;
+    unsigned long long memory = 0;
+    for (unsigned i = numLevels - 1; i < numLevels; --i)
+    {
+        unsigned levelWidth = (unsigned)Max(width >> i, 1);
+        unsigned levelHeight = (unsigned)Max(height >> i, 1);
+        memory += ((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize;
+        entry.memory_[i] = memory;
+    }
+
+    entry.maxLevel_ = 0;
+    while (entry.maxLevel_ + 1 < numLevels && (width >> (entry.maxLevel_ + 1)) >= 4 && (height >> (entry.maxLevel_ + 1)) >= 4)
+        ++entry.maxLevel_;
+    entry.maxLevel_ = Max(entry.maxLevel_, skipped);
+
+    Renderer* renderer = GetSubsystem<Renderer>();
+    int quality = renderer ? renderer->GetTextureQuality() : QUALITY_HIGH;
+    entry.minLevel_ = Min((unsigned)texture->GetMipsToSkip(quality), entry.maxLevel_);
+
+    // Treat the loaded levels as requested, so that a texture is not dropped before it is first drawn
+    entry.residentLevel_ = skipped;
+    entry.requestedLevel_ = Max(skipped, entry.minLevel_);
+    entry.requestFrame_ = frameNumber_;
+
+    return true;
+}
+
+void TextureStreamer::RemoveTexture(Texture2D* texture)
+{
+    unsigned index = texture->streamingIndex_;
+    texture->streamingIndex_ = M_MAX_UNSIGNED;
+    if (index >= textures_.Size() || textures_[index].texture_ != texture)
+        return;
+
+    CancelLoad(textures_[index]);
+
+    // Move the last texture into the vacated slot
+    if (index < textures_.Size() - 1)
+    {
+        textures_[index] = textures_.Back();
+        textures_[index].texture_->streamingIndex_ = index;
+    }
+    textures_.Pop();
+}
+
+void TextureStreamer::RequestMaterial(Material* material, float screenSize)
+{
+    if (textures_.Empty() || !material || screenSize <= 0.0f)
+        return;
+
+    const auto& textures = material->GetTextures();
+    for (const auto& texture : textures)
+    {
+        if (!texture || texture->GetType() != Texture2D::GetTypeStatic())
+            continue;
+
+        unsigned index = static_cast<Texture2D*>(texture.Get())->streamingIndex_;
+        if (index >= textures_.Size())
+            continue;
+
+        // Assume the texture is mapped once across the drawable, so that one texel covers about one pixel at this level
+        StreamingTexture& entry = textures_[index];
+        float level = log2f((float)entry.size_ / screenSize) + levelBias_;
+        unsigned requested = level > 0.0f ? (unsigned)level : 0;
+        requested = Clamp(requested, entry.minLevel_, entry.maxLevel_);
+
+        // Keep the most detailed request of the frame
+        entry.viewRequested_ = true;
+        if (entry.requestFrame_ != frameNumber_)
+        {
+            entry.requestedLevel_ = requested;
+            entry.requestFrame_ = frameNumber_;
+        }
+        else
+            entry.requestedLevel_ = Min(entry.requestedLevel_, requested);
+    }
+}
+
+void TextureStreamer::Update()
+{
+    if (textures_.Empty())
+    {
+        stats_ = TextureStreamingStats();
+        ++frameNumber_;
+        return;
+    }
+
+    ATOMIC_PROFILE(UpdateTextureStreaming);
+
+    unsigned numLoading = 0;
+    unsigned long long requestedMemory = 0;
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+    {
+        StreamingTexture& entry = textures_[i];
+        if (entry.load_)
+        {
+            if (entry.load_->completed_)
+                FinishLoad(entry);
+            else
+                ++numLoading;
+        }
+
+        requestedMemory += entry.memory_[GetTargetLevel(entry)];
+    }
+
+    unsigned long long residentMemory = 0;
+    for (unsigned i = 0; i < textures_.Size(); ++i)
+        residentMemory += textures_[i].memory_[textures_[i].residentLevel_];
+
+    // The budget also covers textures that are not streamed. Their use is taken from the resource cache
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    unsigned long long budget = cache->GetMemoryBudget(Texture2D::GetTypeStatic());
+    unsigned long long streamingBudget = 0;
+    if (budget)
+    {
+        unsigned long long totalUse = cache->GetMemoryUse(Texture2D::GetTypeStatic());
+        unsigned long long otherUse = totalUse > residentMemory ? totalUse - residentMemory : 0;
+        streamingBudget = budget > otherUse ? budget - otherUse : 1;
+    }
+
+    // Drop the same number of levels from every request until the requests fit
+    unsigned bias = 0;
+    unsigned long long targetMemory = requestedMemory;
+    while (streamingBudget && targetMemory > streamingBudget && bias < MAX_STREAMED_TEXTURE_LEVELS)
+    {
+        ++bias;
+        targetMemory = 0;
+        for (unsigned i = 0; i < textures_.Size(); ++i)
+            targetMemory += textures_[i].memory_[Min(GetTargetLevel(textures_[i]) + bias, textures_[i].maxLevel_)];
+    }
+
+    // Queue loads that drop levels first, as they free memory for the rest
+    for (unsigned pass = 0; pass < 2 && numLoading < maxLoads_; ++pass)
+    {
+        for (unsigned i = 0; i < textures_.Size() && numLoading < maxLoads_; ++i)
+        {
+            StreamingTexture& entry = textures_[i];
+            if (entry.load_)
+                continue;
+
+            unsigned level = Min(GetTargetLevel(entry) + bias, entry.maxLevel_);
+            if (pass == 0 ? level > entry.residentLevel_ : level < entry.residentLevel_)
+            {
+                QueueLoad(entry, level);
+                ++numLoading;
+            }
+        }
+    }
+
+    stats_.numTextures_ = textures_.Size();
+    stats_.numLoading_ = numLoading;
+    stats_.residentMemory_ = residentMemory;
+    stats_.requestedMemory_ = requestedMemory;
+    stats_.targetMemory_ = targetMemory;
+    stats_.budget_ = budget;
+    stats_.budgetBias_ = bias;
+
+    ++frameNumber_;
+}
+
+unsigned TextureStreamer::GetTargetLevel(const StreamingTexture& entry) const
+{
+    // A texture that no view has requested within the keep frames of loading it is drawn some other way, such as by the
+    // UI. It can not be told to be out of sight, so it streams in all levels instead of being dropped
+    if (frameNumber_ - entry.requestFrame_ > keepFrames_)
+        return entry.viewRequested_ ? entry.maxLevel_ : entry.minLevel_;
+
+    return Clamp(entry.requestedLevel_, entry.minLevel_, entry.maxLevel_);
+}
+
+void TextureStreamer::QueueLoad(StreamingTexture& entry, unsigned level)
+{
+    TextureStreamingLoad* load = new TextureStreamingLoad();
+    load->fileName_ = entry.fileName_;
+    load->image_ = new Image(context_);
+    load->image_->SetSkipLevels(level);
+    entry.load_ = load;
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (!queue)
+    {
+        LoadTextureLevels(*load);
+        load->completed_ = true;
+        return;
+    }
+
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->priority_ = TEXTURE_STREAMING_PRIORITY;
+    item->workFunction_ = LoadTextureLevelsWork;
+    item->aux_ = load;
+    load->item_ = item;
+    load->queue_ = queue;
+    queue->AddWorkItem(item);
+}
+
+void TextureStreamer::FinishLoad(StreamingTexture& entry)
+{
+    TextureStreamingLoad* load = entry.load_;
+    entry.load_ = 0;
+
+    if (load->success_ && entry.texture_->SetData(load->image_))
+        entry.residentLevel_ = load->image_->GetNumSkippedLevels();
+    else
+    {
+        // Keep the resident levels instead of retrying every frame
+        ATOMIC_LOGWARNING("Failed to stream mip levels of texture " + entry.fileName_);
+        entry.minLevel_ = entry.residentLevel_;
+        entry.maxLevel_ = entry.residentLevel_;
+    }
+
+    delete load;
+}
+
+void TextureStreamer::CancelLoad(StreamingTexture& entry)
+{
+    if (!entry.load_)
+        return;
+
+    // The worker thread writes into the load, so a load that has already started must be waited for
+    WorkQueue* queue = entry.load_->queue_;
+    if (queue && !queue->RemoveWorkItem(entry.load_->item_))
+    {
+        while (!entry.load_->completed_)
+            Time::Sleep(0);
+    }
+
+    delete entry.load_;
+    entry.load_ = 0;
+}
+
+}
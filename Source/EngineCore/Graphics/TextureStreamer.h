@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Atomic
+{
+
+class Image;
+class Material;
+class Texture2D;
+struct TextureStreamingLoad;
+
+/// Maximum number of mip levels of a streamed texture.
+static const unsigned MAX_STREAMED_TEXTURE_LEVELS = 16;
+
+/// Texture streaming statistics.
+struct TextureStreamingStats
+{
+    /// Construct.
+    TextureStreamingStats() :
+        numTextures_(0),
+        numLoading_(0),
+        residentMemory_(0),
+        requestedMemory_(0),
+        targetMemory_(0),
+        budget_(0),
+        budgetBias_(0)
+    {
+    }
+
+    /// Number of streamed textures.
+    unsigned numTextures_;
+    /// Number of mip level loads in progress.
+    unsigned numLoading_;
+    /// Memory of the resident mip levels.
+    unsigned long long residentMemory_;
+    /// Memory of the mip levels requested by the views.
+    unsigned long long requestedMemory_;
+    /// Memory of the mip levels streamed towards after fitting the requests into the budget.
+    unsigned long long targetMemory_;
+    /// Texture2D memory budget of the resource cache, or 0 if unlimited.
+    unsigned long long budget_;
+    /// Number of mip levels dropped from every request to fit the budget.
+    unsigned budgetBias_;
+};
+
+/// Streams the mip levels of 2D textures loaded from mip-chained compressed DDS files. Such textures are first loaded
+/// without their largest mip levels. Views report the screen size at which materials are drawn, from which the mip level
+/// each texture needs is estimated. The missing levels are then loaded on worker threads and uploaded, and textures not
+/// seen for a while drop back to their smallest levels. Textures that no view has requested within the keep frames of
+/// being loaded are drawn some other way, such as by the UI, so they stream in all levels and are not dropped. When the requests exceed the Texture2D memory budget of the
+/// resource cache, the same number of levels is dropped from every texture until they fit.
+class ATOMIC_API TextureStreamer : public Object
+{
+    ATOMIC_OBJECT(TextureStreamer, Object);
+
+public:
+    /// Construct.
+    TextureStreamer(Context* context);
+    /// Destruct. Waits for loads in progress.
+    virtual ~TextureStreamer();
+
+    /// Enable or disable streaming of textures loaded afterward. Disabled by default.
+    void SetEnabled(bool enable) { enabled_ = enable; }
+    /// Set number of top mip levels left out when a streamed texture is first loaded.
+    void SetInitialSkipLevels(unsigned levels) { initialSkipLevels_ = levels; }
+    /// Set bias added to the estimated mip level of a texture. Negative values stream in more detail.
+    void SetLevelBias(float bias) { levelBias_ = bias; }
+    /// Set number of frames a texture keeps its requested levels after it was last seen.
+    void SetKeepFrames(unsigned frames) { keepFrames_ = frames; }
+    /// Set maximum number of mip level loads in progress at a time.
+    void SetMaxLoads(unsigned loads) { maxLoads_ = Max(loads, 1U); }
+
+    /// Return whether streaming is enabled.
+    bool IsEnabled() const { return enabled_; }
+    /// Return number of top mip levels left out when a streamed texture is first loaded.
+    unsigned GetInitialSkipLevels() const { return initialSkipLevels_; }
+    /// Return mip level bias.
+    float GetLevelBias() const { return levelBias_; }
+    /// Return number of frames a texture keeps its requested levels after it was last seen.
+    unsigned GetKeepFrames() const { return keepFrames_; }
+    /// Return maximum number of mip level loads in progress at a time.
+    unsigned GetMaxLoads() const { return maxLoads_; }
+    /// Return statistics of the last update.
+    const TextureStreamingStats& GetStats() const { return stats_; }
+
+    /// Start streaming a texture that has been loaded from a file, or update it after a reload. The image is the loaded
+    /// part of the mip chain. Return false if the image is not a compressed mip chain, in which case the texture is not
+    /// streamed. Called by Texture2D.
+    bool AddTexture(Texture2D* texture, const String& fileName, Image* image);
+    /// Stop streaming a texture, cancelling a load in progress. Called by Texture2D.
+    void RemoveTexture(Texture2D* texture);
+    /// Request the streamed textures of a material for drawing at a screen size in pixels. Called by View.
+    void RequestMaterial(Material* material, float screenSize);
+    /// Upload finished loads, then choose the mip levels of each texture within the budget and queue loads. Called by
+    /// Renderer once per frame after the views have been updated.
+    void Update();
+
+private:
+    /// Streamed texture.
+    struct StreamingTexture
+    {
+        /// Texture.
+        Texture2D* texture_;
+        /// File the texture was loaded from.
+        String fileName_;
+        /// Larger of the width and height of the first mip level. Estimated if the level has not been loaded.
+        int size_;
+        /// Number of mip levels in the file.
+        unsigned numLevels_;
+        /// Smallest top mip level allowed by the texture quality setting.
+        unsigned minLevel_;
+        /// Largest top mip level, the smallest that is still a whole compression block.
+        unsigned maxLevel_;
+        /// Top mip level currently uploaded.
+        unsigned residentLevel_;
+        /// Top mip level requested by the views.
+        unsigned requestedLevel_;
+        /// Frame of the last request, or of loading the texture if not requested by a view yet.
+        unsigned requestFrame_;
+        /// Whether a view has requested the texture.
+        bool viewRequested_;
+        /// Load in progress, or null.
+        TextureStreamingLoad* load_;
+        /// Memory use when each mip level is the top level. Estimated for levels above the first load.
+        unsigned long long memory_[MAX_STREAMED_TEXTURE_LEVELS];
+    };
+
+    /// Return the top mip level a texture streams towards before applying the budget.
+    unsigned GetTargetLevel(const StreamingTexture& entry) const;
+    /// Queue loading a texture from a top mip level.
+    void QueueLoad(StreamingTexture& entry, unsigned level);
+    /// Upload a finished load.
+    void FinishLoad(StreamingTexture& entry);
+    /// Cancel or wait for a load in progress.
+    void CancelLoad(StreamingTexture& entry);
+
+    /// Streamed textures.
+    Vector<StreamingTexture> textures_;
+    /// Statistics of the last update.
+    TextureStreamingStats stats_;
+    /// Frame counter advanced by each update.
+    unsigned frameNumber_;
+    /// Top mip levels left out when first loaded.
+    unsigned initialSkipLevels_;
+    /// Mip level bias.
+    float levelBias_;
+    /// Frames to keep requested levels.
+    unsigned keepFrames_;
+    /// Maximum loads in progress.
+    unsigned maxLoads_;
+    /// Enabled flag.
+    bool enabled_;
+};
+
+}
@@ -42,6 +42,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreamer.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -1214,6 +1215,11 @@ void View::GetBaseBatches()
 {
     ATOMIC_PROFILE(GetBaseBatches);
 
+    // Pixels covered by a world unit at unit distance, for requesting streamed texture mip levels
+    TextureStreamer* textureStreamer = renderer_->GetTextureStreamer();
+    bool streamTextures = textureStreamer->IsEnabled() && cullCamera_;
+    float pixelsPerUnit = streamTextures ? (float)viewSize_.y_ * 0.5f / cullCamera_->GetHalfViewSize() : 0.0f;
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1226,6 +1232,13 @@ void View::GetBaseBatches()
         const Vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
 
+        float screenSize = 0.0f;
+        if (streamTextures)
+        {
+            float distance = cullCamera_->IsOrthographic() ? 1.0f : Max(drawable->GetDistance(), cullCamera_->GetNearClip());
+            screenSize = drawable->GetWorldBoundingBox().Size().Length() * pixelsPerUnit / distance;
+        }
+
         for (unsigned j = 0; j < batches.Size(); ++j)
         {
             const SourceBatch& srcBatch = batches[j];
@@ -1235,6 +1248,9 @@ void View::GetBaseBatches()
             if (srcBatch.material_ && srcBatch.material_->GetAuxViewFrameNumber() != frame_.frameNumber_ && !renderTarget_)
                 CheckMaterialForAuxView(srcBatch.material_);
 
+            if (streamTextures)
+                textureStreamer->RequestMaterial(srcBatch.material_, screenSize);
+
             Technique* tech = GetTechnique(drawable, srcBatch.material_);
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
                 continue;
@@ -157,7 +157,9 @@ bool File::Open(PackageFile* package, const String& fileName)
 
     fileName_ = fileName;
     offset_ = entry->offset_;
-    checksum_ = entry->checksum_;
+    // Version 2 packages store fast checksums, while the checksum of a file is the SDBM hash wherever it is stored, as
+    // scene checksums are compared between loose files and packages of either version. It is calculated when requested
+    checksum_ = package->GetVersion() == 1 ? entry->checksum_ : 0;
     size_ = entry->size_;
     compressed_ = package->IsCompressed();
 
@@ -365,7 +367,7 @@ unsigned File::Write(const void* data, unsigned size)
 
 unsigned File::GetChecksum()
 {
-    if (offset_ || checksum_)
+    if (checksum_)
         return checksum_;
 #ifdef __ANDROID__
     if ((!handle_ && !assetHandle_) || mode_ == FILE_WRITE)
@@ -0,0 +1,141 @@
+#include "../Precompiled.h"
+
+#include "../IO/FileLock.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+FileLock::FileLock() :
+#ifdef _WIN32
+    handle_(INVALID_HANDLE_VALUE)
+#else
+    fd_(-1)
+#endif
+{
+}
+
+FileLock::~FileLock()
+{
+    Close();
+}
+
+bool FileLock::Open(const String& fileName)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE handle = CreateFileW(GetWideNativePath(fileName).CString(), GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        ATOMIC_LOGERROR("Failed to open lock file " + fileName);
+        return false;
+    }
+    handle_ = handle;
+#else
+    fd_ = open(GetNativePath(fileName).CString(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+    {
+        ATOMIC_LOGERROR("Failed to open lock file " + fileName);
+        return false;
+    }
+#endif
+
+    fileName_ = fileName;
+    return true;
+}
+
+void FileLock::Close()
+{
+#ifdef _WIN32
+    if (handle_ != INVALID_HANDLE_VALUE)
+        CloseHandle((HANDLE)handle_);
+    handle_ = INVALID_HANDLE_VALUE;
+#else
+    if (fd_ >= 0)
+        close(fd_);
+    fd_ = -1;
+#endif
+
+    fileName_.Clear();
+}
+
+bool FileLock::Acquire(unsigned slot, bool exclusive)
+{
+    return Lock(slot, exclusive, true);
+}
+
+bool FileLock::TryAcquire(unsigned slot, bool exclusive)
+{
+    return Lock(slot, exclusive, false);
+}
+
+void FileLock::Release(unsigned slot)
+{
+    if (!IsOpen())
+        return;
+
+#ifdef _WIN32
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = slot;
+    UnlockFileEx((HANDLE)handle_, 0, 1, 0, &overlapped);
+#else
+    struct flock lock = {};
+    lock.l_type = F_UNLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = slot;
+    lock.l_len = 1;
+    fcntl(fd_, F_SETLK, &lock);
+#endif
+}
+
+bool FileLock::IsOpen() const
+{
+#ifdef _WIN32
+    return handle_ != INVALID_HANDLE_VALUE;
+#else
+    return fd_ >= 0;
+#endif
+}
+
+bool FileLock::Lock(unsigned slot, bool exclusive, bool wait)
+{
+    if (!IsOpen())
+        return false;
+
+#ifdef _WIN32
+    // Byte ranges beyond the end of the file can be locked, so the lock file stays empty
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = slot;
+    DWORD flags = (exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0) | (wait ? 0 : LOCKFILE_FAIL_IMMEDIATELY);
+    return LockFileEx((HANDLE)handle_, flags, 0, 1, 0, &overlapped) != FALSE;
+#else
+    struct flock lock = {};
+    lock.l_type = exclusive ? F_WRLCK : F_RDLCK;
+    lock.l_whence = SEEK_SET;
+    lock.l_start = slot;
+    lock.l_len = 1;
+
+    for (;;)
+    {
+        if (fcntl(fd_, wait ? F_SETLKW : F_SETLK, &lock) == 0)
+            return true;
+        if (errno != EINTR)
+            return false;
+    }
+#endif
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Container/Str.h"
+
+namespace Atomic
+{
+
+/// Advisory inter-process lock on a lock file, for coordinating processes that share a file on disk. The lock file is
+/// separate from the shared file, so that the shared file can be replaced while locked. Each slot is one byte of the lock
+/// file and is locked independently, either shared between processes or exclusively. Locks are released when the lock
+/// file is closed or the process exits. Locks only exclude other processes: on POSIX systems the locks of a process are
+/// shared by all its threads and lock files, so only one FileLock per lock file should be opened in a process.
+class ATOMIC_API FileLock : public RefCounted
+{
+    ATOMIC_REFCOUNTED(FileLock)
+
+public:
+    /// Construct.
+    FileLock();
+    /// Destruct. Release all locks.
+    ~FileLock();
+
+    /// Open a lock file, creating it if it does not exist. Return true if successful.
+    bool Open(const String& fileName);
+    /// Close the lock file, releasing all locks.
+    void Close();
+
+    /// Lock a slot, waiting for other processes to release a conflicting lock. Return true if successful.
+    bool Acquire(unsigned slot, bool exclusive);
+    /// Try to lock a slot without waiting. Return true if successful.
+    bool TryAcquire(unsigned slot, bool exclusive);
+    /// Release a slot.
+    void Release(unsigned slot);
+
+    /// Return lock file name.
+    const String& GetName() const { return fileName_; }
+    /// Return whether a lock file is open.
+    bool IsOpen() const;
+
+private:
+    /// Lock a slot. Return true if successful.
+    bool Lock(unsigned slot, bool exclusive, bool wait);
+
+    /// Lock file name.
+    String fileName_;
+#ifdef _WIN32
+    /// Lock file handle.
+    void* handle_;
+#else
+    /// Lock file descriptor.
+    int fd_;
+#endif
+};
+
+/// Holds a slot of a FileLock exclusively for its lifetime.
+class ATOMIC_API FileLockScope
+{
+public:
+    /// Construct and acquire the slot exclusively. Does nothing if the lock is null or not open. The lock is kept alive
+    /// until released.
+    FileLockScope(FileLock* lock, unsigned slot) :
+        lock_(lock && lock->IsOpen() && lock->Acquire(slot, true) ? lock : 0),
+        slot_(slot)
+    {
+    }
+
+    /// Destruct and release the slot.
+    ~FileLockScope()
+    {
+        if (lock_)
+            lock_->Release(slot_);
+    }
+
+    /// Return whether the slot is held.
+    bool IsLocked() const { return lock_.NotNull(); }
+
+private:
+    /// Prevent copy construction.
+    FileLockScope(const FileLockScope& rhs);
+    /// Prevent assignment.
+    FileLockScope& operator =(const FileLockScope& rhs);
+
+    /// Lock, or null if not held.
+    SharedPtr<FileLock> lock_;
+    /// Slot.
+    unsigned slot_;
+};
+
+}
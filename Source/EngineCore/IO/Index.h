@@ -5,12 +5,14 @@
 #include "./Deserializer.h"
 #include "./Serializer.h"
 #include "./File.h"
+#include "./FileLock.h"
 #include "./FileSystem.h"
 #if defined(ENGINE_FILEWATCHER)
     #include "./FileWatcher.h"
 #endif
 #include "./IOEvents.h"
 #include "./Log.h"
+#include "./MappedFile.h"
 #include "./MemoryBuffer.h"
 #include "./PackageFile.h"
 #include "./VectorBuffer.h"
\ No newline at end of file
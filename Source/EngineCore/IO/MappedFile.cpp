@@ -0,0 +1,130 @@
+#include "../Precompiled.h"
+
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+MappedFile::MappedFile() :
+    data_(0),
+    size_(0),
+    isOpen_(false)
+#ifdef _WIN32
+    , fileHandle_(INVALID_HANDLE_VALUE),
+    mappingHandle_(0)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const String& fileName)
+{
+    Close();
+
+#ifdef _WIN32
+    // Allow other handles to append to the file while it is mapped
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName).CString(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+        0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart > M_MAX_UNSIGNED)
+    {
+        CloseHandle(fileHandle);
+        return false;
+    }
+
+    fileHandle_ = fileHandle;
+    size_ = (unsigned)fileSize.QuadPart;
+
+    // Empty files can not be mapped, but are valid
+    if (size_)
+    {
+        mappingHandle_ = CreateFileMappingW(fileHandle, 0, PAGE_READONLY, 0, 0, 0);
+        if (mappingHandle_)
+            data_ = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+        if (!data_)
+        {
+            ATOMIC_LOGERROR("Failed to map file " + fileName);
+            Close();
+            return false;
+        }
+    }
+#else
+    int fd = open(GetNativePath(fileName).CString(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (unsigned long long)st.st_size > M_MAX_UNSIGNED)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_ = (unsigned)st.st_size;
+
+    // Empty files can not be mapped, but are valid
+    if (size_)
+    {
+        void* data = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ATOMIC_LOGERROR("Failed to map file " + fileName);
+            close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = static_cast<const unsigned char*>(data);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+
+    fileName_ = fileName;
+    isOpen_ = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mappingHandle_)
+        CloseHandle(mappingHandle_);
+    if (fileHandle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle_);
+    mappingHandle_ = 0;
+    fileHandle_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_)
+        munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+
+    data_ = 0;
+    size_ = 0;
+    isOpen_ = false;
+    fileName_.Clear();
+}
+
+}
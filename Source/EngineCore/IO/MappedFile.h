@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../Container/RefCounted.h"
+#include "../Container/Str.h"
+
+namespace Atomic
+{
+
+/// Read-only memory mapping of a file. The file contents are paged in by the operating system on access instead of
+/// being read up front. Only plain files on disk can be mapped, not files inside packages.
+class ATOMIC_API MappedFile : public RefCounted
+{
+    ATOMIC_REFCOUNTED(MappedFile)
+
+public:
+    /// Construct.
+    MappedFile();
+    /// Destruct and unmap.
+    ~MappedFile();
+
+    /// Map a file. An already mapped file is unmapped first. Return true if successful.
+    bool Open(const String& fileName);
+    /// Unmap the file.
+    void Close();
+
+    /// Return mapped data, or null if not mapped or the file is empty.
+    const unsigned char* GetData() const { return data_; }
+    /// Return mapped size.
+    unsigned GetSize() const { return size_; }
+    /// Return file name.
+    const String& GetName() const { return fileName_; }
+    /// Return whether a file is mapped.
+    bool IsOpen() const { return isOpen_; }
+
+private:
+    /// File name.
+    String fileName_;
+    /// Mapped data.
+    const unsigned char* data_;
+    /// Mapped size.
+    unsigned size_;
+    /// Open flag.
+    bool isOpen_;
+#ifdef _WIN32
+    /// File handle.
+    void* fileHandle_;
+    /// File mapping handle.
+    void* mappingHandle_;
+#endif
+};
+
+}
@@ -32,12 +32,33 @@
 namespace Atomic
 {
 
+/// Return whether a file ID is one of the package formats: uncompressed and LZ4 compressed, with SDBM checksums
+/// (version 1) or fast checksums (version 2).
+static bool IsPackageFileID(const String& id)
+{
+    return id == "RPAK" || id == "RLZ4" || id == "RPK2" || id == "RLZ2";
+}
+
+static inline unsigned RotateLeft(unsigned value, unsigned bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline unsigned ReadWord(const unsigned char* data)
+{
+    // Little-endian, as are all supported platforms
+    unsigned value;
+    memcpy(&value, data, sizeof value);
+    return value;
+}
+
 PackageFile::PackageFile(Context* context) :
     Object(context),
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
-    compressed_(false)
+    compressed_(false),
+    version_(1)
 {
 }
 
@@ -46,7 +67,8 @@ PackageFile::PackageFile(Context* context, const String& fileName, unsigned star
     totalSize_(0),
     totalDataSize_(0),
     checksum_(0),
-    compressed_(false)
+    compressed_(false),
+    version_(1)
 {
     Open(fileName, startOffset);
 }
@@ -64,7 +86,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     // Check ID, then read the directory
     file->Seek(startOffset);
     String id = file->ReadFileID();
-    if (id != "RPAK" && id != "RLZ4")
+    if (!IsPackageFileID(id))
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
         // to know how much we must rewind to find the package start
@@ -81,7 +103,7 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
             }
         }
 
-        if (id != "RPAK" && id != "RLZ4")
+        if (!IsPackageFileID(id))
         {
             ATOMIC_LOGERROR(fileName + " is not a valid package file");
             return false;
@@ -91,7 +113,8 @@ bool PackageFile::Open(const String& fileName, unsigned startOffset)
     fileName_ = fileName;
     nameHash_ = fileName_;
     totalSize_ = file->GetSize();
-    compressed_ = id == "RLZ4";
+    compressed_ = id == "RLZ4" || id == "RLZ2";
+    version_ = id == "RPK2" || id == "RLZ2" ? 2 : 1;
 
     unsigned numFiles = file->ReadUInt();
     checksum_ = file->ReadUInt();
@@ -191,5 +214,57 @@ void PackageFile::Scan(Vector<String>& result, const String& pathName, const Str
         }
     }
 }
+
+unsigned PackageFile::CalculateFastChecksum(const void* data, unsigned size)
+{
+    static const unsigned PRIME1 = 2654435761U;
+    static const unsigned PRIME2 = 2246822519U;
+    static const unsigned PRIME3 = 3266489917U;
+    static const unsigned PRIME4 = 668265263U;
+    static const unsigned PRIME5 = 374761393U;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const unsigned char* end = bytes + size;
+    unsigned hash;
+
+    if (size >= 16)
+    {
+        // Four independent lanes of whole words
+        unsigned v1 = PRIME1 + PRIME2;
+        unsigned v2 = PRIME2;
+        unsigned v3 = 0;
+        unsigned v4 = 0 - PRIME1;
+        const unsigned char* limit = end - 16;
+
+        do
+        {
+            v1 = RotateLeft(v1 + ReadWord(bytes) * PRIME2, 13) * PRIME1;
+            v2 = RotateLeft(v2 + ReadWord(bytes + 4) * PRIME2, 13) * PRIME1;
+            v3 = RotateLeft(v3 + ReadWord(bytes + 8) * PRIME2, 13) * PRIME1;
+            v4 = RotateLeft(v4 + ReadWord(bytes + 12) * PRIME2, 13) * PRIME1;
+            bytes += 16;
+        } while (bytes <= limit);
+
+        hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+    }
+    else
+        hash = PRIME5;
+
+    hash += size;
+
+    for (; bytes + 4 <= end; bytes += 4)
+        hash = RotateLeft(hash + ReadWord(bytes) * PRIME3, 17) * PRIME4;
+
+    for (; bytes < end; ++bytes)
+        hash = RotateLeft(hash + *bytes * PRIME5, 11) * PRIME1;
+
+    hash ^= hash >> 15;
+    hash *= PRIME2;
+    hash ^= hash >> 13;
+    hash *= PRIME3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
 // ATOMIC END
 }
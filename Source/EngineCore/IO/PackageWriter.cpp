@@ -0,0 +1,459 @@
+#include "../Precompiled.h"
+
+#include "../Container/ArrayPtr.h"
+#include "../Container/List.h"
+#include "../Core/StringUtils.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/PackageFile.h"
+#include "../IO/PackageWriter.h"
+
+#include <LZ4/lz4.h>
+#include <LZ4/lz4hc.h>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+/// Uncompressed size of an LZ4 block, the unit PackageFile decompresses in.
+static const unsigned PACKAGE_BLOCK_SIZE = 32768;
+/// Number of blocks compressed by one work item.
+static const unsigned PACKAGE_CHUNK_BLOCKS = 32;
+/// Maximum source data read ahead of the writes.
+static const unsigned PACKAGE_MAX_PENDING_SIZE = 64 * 1024 * 1024;
+
+/// Part of an entry compressed by one work item. Chunks are written in order, so the package does not depend on the
+/// number of threads.
+struct PackageWriterChunk
+{
+    /// Construct.
+    PackageWriterChunk() :
+        entryIndex_(0),
+        offset_(0),
+        size_(0),
+        success_(false)
+    {
+    }
+
+    /// Index of the entry.
+    unsigned entryIndex_;
+    /// Data of the whole entry. Null when copied from the previous package.
+    SharedArrayPtr<unsigned char> data_;
+    /// Uncompressed offset within the entry.
+    unsigned offset_;
+    /// Uncompressed size.
+    unsigned size_;
+    /// Block headers and compressed blocks, as written to the package.
+    PODVector<unsigned char> output_;
+    /// Compression success flag.
+    bool success_;
+    /// Work item, or null if compressed on the calling thread.
+    SharedPtr<WorkItem> item_;
+};
+
+static bool CompressChunk(PackageWriterChunk& chunk)
+{
+    unsigned numBlocks = (chunk.size_ + PACKAGE_BLOCK_SIZE - 1) / PACKAGE_BLOCK_SIZE;
+    chunk.output_.Resize(numBlocks * (4 + LZ4_compressBound(PACKAGE_BLOCK_SIZE)));
+
+    const unsigned char* src = chunk.data_.Get() + chunk.offset_;
+    unsigned outputSize = 0;
+    unsigned pos = 0;
+
+    while (pos < chunk.size_)
+    {
+        unsigned unpackedSize = Min(PACKAGE_BLOCK_SIZE, chunk.size_ - pos);
+        unsigned char* dest = &chunk.output_[outputSize];
+
+        int packedSize = LZ4_compressHC((const char*)src + pos, (char*)dest + 4, unpackedSize);
+        if (packedSize <= 0)
+            return false;
+
+        unsigned short header[2] = { (unsigned short)unpackedSize, (unsigned short)packedSize };
+        memcpy(dest, header, sizeof(header));
+
+        outputSize += 4 + packedSize;
+        pos += unpackedSize;
+    }
+
+    chunk.output_.Resize(outputSize);
+    return true;
+}
+
+static void CompressChunkWork(const WorkItem* item, unsigned threadIndex)
+{
+    PackageWriterChunk* chunk = reinterpret_cast<PackageWriterChunk*>(item->aux_);
+    chunk->success_ = CompressChunk(*chunk);
+}
+
+static void CancelChunks(List<PackageWriterChunk>& chunks, WorkQueue* queue)
+{
+    // The workers write into the chunks, so started ones must be waited for
+    for (List<PackageWriterChunk>::Iterator i = chunks.Begin(); i != chunks.End(); ++i)
+    {
+        if (i->item_ && !queue->RemoveWorkItem(i->item_))
+        {
+            while (!i->item_->completed_)
+                Time::Sleep(0);
+        }
+    }
+
+    chunks.Clear();
+}
+
+PackageWriter::PackageWriter(Context* context) :
+    Object(context),
+    checksum_(0),
+    totalDataSize_(0),
+    packageSize_(0),
+    numReused_(0),
+    compressed_(true),
+    fastChecksums_(true)
+{
+}
+
+PackageWriter::~PackageWriter()
+{
+}
+
+void PackageWriter::AddFile(const String& name, const String& sourcePath)
+{
+    PackageWriterEntry entry;
+    entry.name_ = name;
+    entry.sourcePath_ = sourcePath;
+    entries_.Push(entry);
+}
+
+bool PackageWriter::Write(const String& fileName)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    bool threaded = compressed_ && queue && queue->GetNumThreads();
+
+    error_.Clear();
+    checksum_ = 0;
+    totalDataSize_ = 0;
+    packageSize_ = 0;
+    numReused_ = 0;
+
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        PackageWriterEntry& entry = entries_[i];
+        entry.offset_ = 0;
+        entry.size_ = 0;
+        entry.packedSize_ = 0;
+        entry.checksum_ = 0;
+        entry.reused_ = false;
+    }
+
+    // Unchanged entries are copied from the package being replaced instead of being compressed again
+    if (compressed_ && fastChecksums_ && fileSystem->FileExists(fileName))
+    {
+        previousPackage_ = new PackageFile(context_);
+        previousFile_ = new File(context_);
+        if (!previousPackage_->Open(fileName) || previousPackage_->GetVersion() < 2 || !previousPackage_->IsCompressed() ||
+            !previousFile_->Open(fileName))
+        {
+            previousPackage_.Reset();
+            previousFile_.Reset();
+        }
+    }
+
+    // Write next to the destination and rename over it, as the previous package is read while writing
+    String tempFileName = fileName + ".tmp";
+
+    File dest(context_);
+    if (!dest.Open(tempFileName, FILE_WRITE))
+    {
+        error_ = "Could not open output file " + tempFileName;
+        previousPackage_.Reset();
+        previousFile_.Reset();
+        return false;
+    }
+
+    // Write the header and entries. Offsets, sizes and checksums are filled in once known
+    WriteHeader(dest);
+    WriteEntries(dest);
+
+    unsigned pendingSize = 0;
+    bool success = true;
+    List<PackageWriterChunk> chunks;
+
+    // Read file data & calculate checksums on this thread, compress on the workers and write in order
+    for (unsigned i = 0; success && i < entries_.Size(); ++i)
+    {
+        PackageWriterEntry& entry = entries_[i];
+
+        File srcFile(context_, entry.sourcePath_);
+        if (!srcFile.IsOpen())
+        {
+            error_ = "Could not open input file " + entry.sourcePath_;
+            success = false;
+            break;
+        }
+
+        unsigned dataSize = srcFile.GetSize();
+        entry.size_ = dataSize;
+        totalDataSize_ += dataSize;
+        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
+
+        if (dataSize && srcFile.Read(&buffer[0], dataSize) != dataSize)
+        {
+            error_ = "Could not read input file " + entry.sourcePath_;
+            success = false;
+            break;
+        }
+        srcFile.Close();
+
+        if (fastChecksums_)
+            entry.checksum_ = PackageFile::CalculateFastChecksum(buffer.Get(), dataSize);
+        else
+        {
+            for (unsigned j = 0; j < dataSize; ++j)
+            {
+                checksum_ = SDBMHash(checksum_, buffer[j]);
+                entry.checksum_ = SDBMHash(entry.checksum_, buffer[j]);
+            }
+        }
+
+        bool reused = false;
+        if (previousPackage_)
+        {
+            chunks.Push(PackageWriterChunk());
+            PackageWriterChunk& chunk = chunks.Back();
+            chunk.entryIndex_ = i;
+            chunk.size_ = dataSize;
+
+            reused = ReadPreviousEntry(entry, buffer.Get(), chunk);
+            if (reused)
+            {
+                pendingSize += chunk.output_.Size();
+                entry.reused_ = true;
+                ++numReused_;
+            }
+            else
+                chunks.Pop();
+        }
+
+        if (!reused)
+        {
+            unsigned offset = 0;
+            do
+            {
+                chunks.Push(PackageWriterChunk());
+                PackageWriterChunk& chunk = chunks.Back();
+                chunk.entryIndex_ = i;
+                chunk.data_ = buffer;
+                chunk.offset_ = offset;
+                chunk.size_ = compressed_ ? Min(PACKAGE_BLOCK_SIZE * PACKAGE_CHUNK_BLOCKS, dataSize - offset) : dataSize;
+                offset += chunk.size_;
+
+                if (threaded && chunk.size_)
+                {
+                    chunk.item_ = new WorkItem();
+                    chunk.item_->priority_ = M_MAX_UNSIGNED;
+                    chunk.item_->workFunction_ = CompressChunkWork;
+                    chunk.item_->aux_ = &chunk;
+                    queue->AddWorkItem(chunk.item_);
+                }
+            } while (offset < dataSize);
+
+            pendingSize += dataSize;
+        }
+
+        // Write finished chunks. Wait for the oldest once too much data has been read ahead. Chunks without a work item
+        // are copied or compressed right away
+        while (chunks.Size() && (pendingSize > PACKAGE_MAX_PENDING_SIZE || !chunks.Front().item_ ||
+            chunks.Front().item_->completed_))
+        {
+            PackageWriterChunk& chunk = chunks.Front();
+            unsigned chunkSize = chunk.data_ ? chunk.size_ : chunk.output_.Size();
+
+            if (!WriteChunk(dest, chunk))
+            {
+                success = false;
+                break;
+            }
+
+            pendingSize -= chunkSize;
+            chunks.PopFront();
+        }
+    }
+
+    while (success && chunks.Size())
+    {
+        if (!WriteChunk(dest, chunks.Front()))
+            success = false;
+        else
+            chunks.PopFront();
+    }
+
+    if (queue)
+        CancelChunks(chunks, queue);
+
+    previousPackage_.Reset();
+    previousFile_.Reset();
+
+    if (!success)
+    {
+        dest.Close();
+        fileSystem->Delete(tempFileName);
+        return false;
+    }
+
+    // The version 2 package checksum covers the entry checksums in order
+    if (fastChecksums_ && entries_.Size())
+    {
+        PODVector<unsigned> checksums;
+        for (unsigned i = 0; i < entries_.Size(); ++i)
+            checksums.Push(entries_[i].checksum_);
+        checksum_ = PackageFile::CalculateFastChecksum(&checksums[0], checksums.Size() * sizeof(unsigned));
+    }
+
+    // Write package size to the end of file to allow finding it linked to an executable file
+    unsigned currentSize = dest.GetSize();
+    dest.WriteUInt(currentSize + sizeof(unsigned));
+
+    // Write header again with correct offsets & checksums
+    dest.Seek(0);
+    WriteHeader(dest);
+    WriteEntries(dest);
+
+    packageSize_ = dest.GetSize();
+    dest.Close();
+
+    if (fileSystem->FileExists(fileName))
+        fileSystem->Delete(fileName);
+    if (!fileSystem->Rename(tempFileName, fileName))
+    {
+        error_ = "Could not rename " + tempFileName + " to " + fileName;
+        return false;
+    }
+
+    return true;
+}
+
+void PackageWriter::WriteHeader(File& dest)
+{
+    if (!compressed_)
+        dest.WriteFileID(fastChecksums_ ? "RPK2" : "RPAK");
+    else
+        dest.WriteFileID(fastChecksums_ ? "RLZ2" : "RLZ4");
+    dest.WriteUInt(entries_.Size());
+    dest.WriteUInt(checksum_);
+}
+
+void PackageWriter::WriteEntries(File& dest)
+{
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        const PackageWriterEntry& entry = entries_[i];
+        dest.WriteString(entry.name_);
+        dest.WriteUInt(entry.offset_);
+        dest.WriteUInt(entry.size_);
+        dest.WriteUInt(entry.checksum_);
+    }
+}
+
+bool PackageWriter::ReadPreviousEntry(const PackageWriterEntry& entry, const unsigned char* data, PackageWriterChunk& chunk)
+{
+    const PackageEntry* previous = previousPackage_->GetEntry(entry.name_);
+    if (!previous || previous->size_ != entry.size_ || previous->checksum_ != entry.checksum_)
+        return false;
+
+    // Decompress and compare the blocks, so that a checksum collision can not leave stale data in the package
+    previousFile_->Seek(previous->offset_);
+    chunk.output_.Clear();
+
+    unsigned char unpacked[65536];
+    unsigned pos = 0;
+
+    while (pos < entry.size_)
+    {
+        if (previousFile_->GetPosition() + 4 > previousFile_->GetSize())
+            return false;
+
+        unsigned short header[2];
+        header[0] = previousFile_->ReadUShort();
+        header[1] = previousFile_->ReadUShort();
+        unsigned unpackedSize = header[0];
+        unsigned packedSize = header[1];
+
+        if (!unpackedSize || pos + unpackedSize > entry.size_ ||
+            previousFile_->GetPosition() + packedSize > previousFile_->GetSize())
+            return false;
+
+        unsigned start = chunk.output_.Size();
+        chunk.output_.Resize(start + 4 + packedSize);
+        memcpy(&chunk.output_[start], header, sizeof(header));
+
+        if (previousFile_->Read(&chunk.output_[start + 4], packedSize) != packedSize)
+            return false;
+
+        if (LZ4_decompress_safe((const char*)&chunk.output_[start + 4], (char*)unpacked, packedSize, unpackedSize) !=
+            (int)unpackedSize || memcmp(unpacked, data + pos, unpackedSize))
+            return false;
+
+        pos += unpackedSize;
+    }
+
+    chunk.success_ = true;
+    return true;
+}
+
+bool PackageWriter::WriteChunk(File& dest, PackageWriterChunk& chunk)
+{
+    if (chunk.item_)
+    {
+        // Compress on this thread if no worker has started on the chunk yet
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        if (queue->RemoveWorkItem(chunk.item_))
+            chunk.success_ = CompressChunk(chunk);
+        else
+        {
+            while (!chunk.item_->completed_)
+                Time::Sleep(0);
+        }
+
+        chunk.item_.Reset();
+    }
+    else if (chunk.data_ && compressed_)
+        chunk.success_ = CompressChunk(chunk);
+
+    PackageWriterEntry& entry = entries_[chunk.entryIndex_];
+
+    if (!compressed_)
+    {
+        entry.offset_ = dest.GetSize();
+        entry.packedSize_ = entry.size_;
+        if (entry.size_ && dest.Write(chunk.data_.Get(), entry.size_) != entry.size_)
+        {
+            error_ = "Could not write to package file " + dest.GetName();
+            return false;
+        }
+        return true;
+    }
+
+    if (!chunk.success_)
+    {
+        error_ = ToString("LZ4 compression failed for file %s at offset %u", entry.sourcePath_.CString(), chunk.offset_);
+        return false;
+    }
+
+    if (!chunk.offset_)
+        entry.offset_ = dest.GetSize();
+
+    if (chunk.output_.Size() && dest.Write(&chunk.output_[0], chunk.output_.Size()) != chunk.output_.Size())
+    {
+        error_ = "Could not write to package file " + dest.GetName();
+        return false;
+    }
+
+    entry.packedSize_ = dest.GetSize() - entry.offset_;
+    return true;
+}
+
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Atomic
+{
+
+class File;
+class PackageFile;
+struct PackageWriterChunk;
+
+/// File entry of a package being written.
+struct PackageWriterEntry
+{
+    /// Construct.
+    PackageWriterEntry() :
+        offset_(0),
+        size_(0),
+        packedSize_(0),
+        checksum_(0),
+        reused_(false)
+    {
+    }
+
+    /// Name within the package.
+    String name_;
+    /// Path of the source file.
+    String sourcePath_;
+    /// Offset in the package.
+    unsigned offset_;
+    /// Uncompressed size.
+    unsigned size_;
+    /// Size in the package.
+    unsigned packedSize_;
+    /// Checksum.
+    unsigned checksum_;
+    /// Whether the data was copied from the package being replaced.
+    bool reused_;
+};
+
+/// Writes package files for PackageFile. Compressed packages are split into LZ4HC blocks, compressed on the WorkQueue
+/// threads and written in order, so the package does not depend on the number of threads. When a compressed version 2
+/// package is replaced, entries with unchanged data are copied from it instead of being compressed again.
+class ATOMIC_API PackageWriter : public Object
+{
+    ATOMIC_OBJECT(PackageWriter, Object);
+
+public:
+    /// Construct.
+    PackageWriter(Context* context);
+    /// Destruct.
+    virtual ~PackageWriter();
+
+    /// Add a file to the package.
+    void AddFile(const String& name, const String& sourcePath);
+    /// Set whether to LZ4 compress the package. Default true.
+    void SetCompressed(bool enable) { compressed_ = enable; }
+    /// Set whether to write a version 2 package with checksums from PackageFile::CalculateFastChecksum(). Default true.
+    void SetFastChecksums(bool enable) { fastChecksums_ = enable; }
+
+    /// Write the package, replacing any file at the path. Return true if successful, otherwise see GetError().
+    bool Write(const String& fileName);
+
+    /// Return the file entries. Offsets, sizes and checksums are valid after writing.
+    const Vector<PackageWriterEntry>& GetEntries() const { return entries_; }
+    /// Return whether the package is compressed.
+    bool IsCompressed() const { return compressed_; }
+    /// Return whether the package is written with fast checksums.
+    bool GetFastChecksums() const { return fastChecksums_; }
+    /// Return checksum of the written package.
+    unsigned GetChecksum() const { return checksum_; }
+    /// Return total uncompressed size of the files in the written package.
+    unsigned GetTotalDataSize() const { return totalDataSize_; }
+    /// Return size of the written package.
+    unsigned GetPackageSize() const { return packageSize_; }
+    /// Return number of entries copied from the package that was replaced.
+    unsigned GetNumReused() const { return numReused_; }
+    /// Return the error of the last write that failed.
+    const String& GetError() const { return error_; }
+
+private:
+    /// Write the package ID, number of files and checksum.
+    void WriteHeader(File& dest);
+    /// Write the file entry table.
+    void WriteEntries(File& dest);
+    /// Copy the compressed data of an entry that is unchanged in the previous package. Return true if it was.
+    bool ReadPreviousEntry(const PackageWriterEntry& entry, const unsigned char* data, PackageWriterChunk& chunk);
+    /// Wait for a chunk to be compressed and write it. Return true if successful.
+    bool WriteChunk(File& dest, PackageWriterChunk& chunk);
+
+    /// File entries.
+    Vector<PackageWriterEntry> entries_;
+    /// Package being replaced, which unchanged entries are copied from.
+    SharedPtr<PackageFile> previousPackage_;
+    /// File of the package being replaced.
+    SharedPtr<File> previousFile_;
+    /// Error of the last write.
+    String error_;
+    /// Package checksum.
+    unsigned checksum_;
+    /// Total uncompressed size of the files.
+    unsigned totalDataSize_;
+    /// Package size.
+    unsigned packageSize_;
+    /// Number of entries copied from the previous package.
+    unsigned numReused_;
+    /// Compression flag.
+    bool compressed_;
+    /// Fast checksums flag.
+    bool fastChecksums_;
+};
+
+}
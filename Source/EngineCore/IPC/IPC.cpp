@@ -26,6 +26,7 @@
 
 #include "../Core/CoreEvents.h"
 #include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
 #include "../Engine/Engine.h"
 #include "../Input/InputEvents.h"
 #include "../IO/Log.h"
@@ -98,6 +99,22 @@ bool IPC::InitWorker(unsigned id, IPCHandle fd1, IPCHandle fd2)
     worker_ = new IPCWorker(context_, fd1, fd2, id);
 #endif
 
+#ifdef ENGINE_PLATFORM_LINUX
+    // shared memory created by the broker, the mapping stays valid once the descriptor is closed
+    const Vector<String>& arguments = GetArguments();
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].StartsWith("--ipc-shm="))
+        {
+            int fd = ToInt(arguments[i].Substring(10));
+            if (!worker_->OpenSharedMemory(fd))
+                ATOMIC_LOGWARNING("IPC::InitWorker - Unable to map shared memory, using pipe transport");
+            close(fd);
+            break;
+        }
+    }
+#endif
+
     worker_->Run();
 
     SendEventToBroker(E_IPCWORKERSTART);
@@ -61,8 +61,9 @@ void IPCBroker::ThreadFunction()
             break;
         }
 
-        // sleep thread a bit so we don't gobble CPU
-        Time::Sleep(10);
+        // sleep thread a bit so we don't gobble CPU, shared memory receives wait for messages themselves
+        if (!IsReceivingSharedMemory())
+            Time::Sleep(10);
     }
 
     shouldRun_ = false;
@@ -129,7 +130,24 @@ bool IPCBroker::SpawnWorker(const String& command, const Vector<String>& args, c
 
     pargs.Push(ToString("--ipc-id=%i", id_));
 
-    if (!otherProcess_->Launch(command, pargs, initialDirectory))
+#ifdef ENGINE_PLATFORM_LINUX
+    // messages go through shared memory once the worker has mapped it, workers which don't stay on the pipe
+    int sharedFD = ring_.Create();
+    if (sharedFD != -1)
+    {
+        pargs.Push(ToString("--ipc-shm=%i", sharedFD));
+        otherProcess_->SetSharedFD(sharedFD);
+    }
+#endif
+
+    bool launched = otherProcess_->Launch(command, pargs, initialDirectory);
+
+#ifdef ENGINE_PLATFORM_LINUX
+    if (sharedFD != -1)
+        close(sharedFD);
+#endif
+
+    if (!launched)
         return false;
 
 #ifndef ENGINE_PLATFORM_WINDOWS
@@ -29,6 +29,10 @@ namespace Atomic
 
 IPCChannel::IPCChannel(Context* context, unsigned id) : Object(context),
     id_(id)
+#ifdef ENGINE_PLATFORM_LINUX
+    , sendRing_(false),
+    receiveRing_(false)
+#endif
 {
     ipc_ = GetSubsystem<IPC>();
     currentHeader_.messageType_ = IPC_MESSAGE_UNDEFINED;
@@ -42,11 +46,54 @@ IPCChannel::~IPCChannel()
 void IPCChannel::PostMessage(StringHash eventType, VariantMap &eventData)
 {
     IPCMessageEvent msgEvent;
+
+#ifdef ENGINE_PLATFORM_LINUX
+    if (ring_.IsOpen())
+    {
+        MutexLock lock(sendMutex_);
+
+        // switch to the ring once the other process has mapped it, the switch message keeps the order
+        if (!sendRing_ && ring_.IsPeerAttached())
+        {
+            ring_.SetPeerSocket(transport_.GetFD());
+
+            IPCMessageHeader header;
+            header.messageType_ = IPC_MESSAGE_SWITCH;
+            header.messageSize_ = 0;
+            sendRing_ = transport_.Write(&header, sizeof(IPCMessageHeader));
+        }
+
+        if (sendRing_)
+        {
+            // the ring applies backpressure while the other process catches up, so this only fails once it has gone
+            if (!msgEvent.DoSend(ring_, sendBuffer_, id_, eventType, eventData))
+                ATOMIC_LOGERROR("IPCChannel::PostMessage - Unable to send message, the other process is not receiving");
+
+            return;
+        }
+    }
+#endif
+
     msgEvent.DoSend(transport_, id_, eventType, eventData);
 }
 
+void IPCChannel::QueueMessage(MemoryBuffer& buffer)
+{
+    IPCMessageEvent event;
+    StringHash eventType;
+    VariantMap eventData;
+    unsigned id;
+    event.DoRead(buffer, id, eventType, eventData);
+    ipc_->QueueEvent(id, eventType, eventData);
+}
+
 bool IPCChannel::Receive()
 {
+#ifdef ENGINE_PLATFORM_LINUX
+    if (receiveRing_)
+        return ReceiveRing();
+#endif
+
     size_t sz = 0;
     const char* data = transport_.Receive(&sz);
 
@@ -76,18 +123,25 @@ bool IPCChannel::Receive()
             dataBuffer_.Read(&currentHeader_, sizeof(IPCMessageHeader));
         }
 
+#ifdef ENGINE_PLATFORM_LINUX
+        if (currentHeader_.messageType_ == IPC_MESSAGE_SWITCH)
+        {
+            // nothing follows on the pipe once the other process sends through the ring
+            currentHeader_.messageType_ = IPC_MESSAGE_UNDEFINED;
+            dataBuffer_.Clear();
+
+            receiveRing_ = true;
+            return true;
+        }
+#endif
+
         if (currentHeader_.messageSize_ <= dataBuffer_.GetSize() - dataBuffer_.GetPosition())
         {
             MemoryBuffer buffer(dataBuffer_.GetData() + dataBuffer_.GetPosition(), currentHeader_.messageSize_);
             dataBuffer_.Seek( dataBuffer_.GetPosition() + currentHeader_.messageSize_);
             currentHeader_.messageType_ = IPC_MESSAGE_UNDEFINED;
 
-            IPCMessageEvent event;
-            StringHash eventType;
-            VariantMap eventData;
-            unsigned id;
-            event.DoRead(buffer, id, eventType, eventData);
-            ipc_->QueueEvent(id, eventType, eventData);
+            QueueMessage(buffer);
         }
 
         if (dataBuffer_.IsEof())
@@ -108,5 +162,62 @@ bool IPCChannel::Receive()
 
 }
 
+#ifdef ENGINE_PLATFORM_LINUX
+
+bool IPCChannel::OpenSharedMemory(int fd)
+{
+    return ring_.Open(fd);
+}
+
+bool IPCChannel::ReceiveRing()
+{
+    unsigned type;
+    const char* data;
+    unsigned size;
+
+    if (!ring_.Peek(type, data, size))
+    {
+        ring_.Wait(100);
+
+        if (!ring_.Peek(type, data, size))
+            return true;
+    }
+
+    // drain everything written since the last wakeup
+    do
+    {
+        if (type == IPC_MESSAGE_FRAGMENT)
+        {
+            unsigned offset = fragments_.Size();
+            fragments_.Resize(offset + size);
+            memcpy(&fragments_[offset], data, size);
+        }
+        else if (type == IPC_MESSAGE_EVENT && fragments_.Empty())
+        {
+            // read in place from the shared memory
+            MemoryBuffer buffer(data, size);
+            QueueMessage(buffer);
+        }
+        else if (type == IPC_MESSAGE_EVENT)
+        {
+            // last part of a fragmented message
+            unsigned offset = fragments_.Size();
+            fragments_.Resize(offset + size);
+            if (size)
+                memcpy(&fragments_[offset], data, size);
+
+            MemoryBuffer buffer(&fragments_[0], fragments_.Size());
+            QueueMessage(buffer);
+            fragments_.Clear();
+        }
+
+        ring_.Pop();
+
+    } while (ring_.Peek(type, data, size));
+
+    return true;
+}
+
+#endif
 
 }
@@ -60,8 +60,19 @@ public:
 
     IPCProcess* GetOtherProcess() { return otherProcess_; }
 
+#ifdef ENGINE_PLATFORM_LINUX
+    // map the shared memory transport created by the broker
+    bool OpenSharedMemory(int fd);
+    // whether messages are received from shared memory, which waits for them itself
+    bool IsReceivingSharedMemory() const { return receiveRing_; }
+#else
+    bool IsReceivingSharedMemory() const { return false; }
+#endif
+
 protected:
 
+    void QueueMessage(MemoryBuffer& buffer);
+
     unsigned id_;
 
     // for access from thread
@@ -75,6 +86,19 @@ protected:
     IPCMessageHeader currentHeader_;
     VectorBuffer dataBuffer_;
 
+#ifdef ENGINE_PLATFORM_LINUX
+    bool ReceiveRing();
+
+    RingTransport ring_;
+    // whether messages are sent and received through the ring, each direction switches on its own
+    bool sendRing_;
+    bool receiveRing_;
+    Mutex sendMutex_;
+    VectorBuffer sendBuffer_;
+    // parts received so far of a message too large for one ring record
+    PODVector<char> fragments_;
+#endif
+
 };
 
 }
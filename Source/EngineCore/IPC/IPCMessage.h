@@ -37,6 +37,12 @@ namespace Atomic
 
 const unsigned IPC_MESSAGE_UNDEFINED = 0;
 const unsigned IPC_MESSAGE_EVENT = 1;
+// sent over the pipe, later messages arrive through the shared memory ring
+const unsigned IPC_MESSAGE_SWITCH = 2;
+// ring record holding part of a message too large for one record, the message ends with an event record
+const unsigned IPC_MESSAGE_FRAGMENT = 3;
+// ring record skipping the space up to the end of the ring
+const unsigned IPC_MESSAGE_PADDING = 4;
 
 struct IPCMessageHeader
 {
@@ -74,6 +80,33 @@ public:
 
         return true;
     }
+
+#ifdef ENGINE_PLATFORM_LINUX
+    bool DoSend(RingTransport& ring, VectorBuffer& buffer, unsigned id, const StringHash& eventType, const VariantMap& eventData)
+    {
+        // the buffer is kept by the channel, so sending doesn't allocate once it has grown
+        buffer.Clear();
+        buffer.WriteUInt(id);
+        buffer.WriteStringHash(eventType);
+        buffer.WriteVariantMap(eventData);
+
+        const unsigned char* data = buffer.GetData();
+        unsigned size = buffer.GetSize();
+        unsigned maxSize = ring.GetMaxMessageSize();
+
+        // larger messages are split into fragments, which the reader consumes while the rest is written
+        while (size > maxSize)
+        {
+            if (!ring.Write(IPC_MESSAGE_FRAGMENT, data, maxSize))
+                return false;
+
+            data += maxSize;
+            size -= maxSize;
+        }
+
+        return ring.Write(IPC_MESSAGE_EVENT, data, size);
+    }
+#endif
 };
 
 }
@@ -26,6 +26,7 @@
 
 #include <unistd.h>
 #include <signal.h>
+#include <string.h>
 #include <sys/socket.h>
 #include <errno.h>
 
@@ -35,8 +36,15 @@
 
 #ifdef ENGINE_PLATFORM_LINUX
 #include <sys/wait.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <atomic>
 #endif
 
+#include "IPCMessage.h"
+
 namespace Atomic
 {
 
@@ -162,11 +170,276 @@ char* PipeTransport::Receive(size_t* size) {
     return &buf_[0];
 }
 
+#ifdef ENGINE_PLATFORM_LINUX
+
+// Shared header of one ring. Positions count bytes and wrap around, the ring size is a power of two.
+struct IPCRingHeader {
+    // advanced by the writer once a record is complete
+    alignas(64) std::atomic<unsigned> writePos_;
+    // advanced by the reader once a record has been consumed
+    alignas(64) std::atomic<unsigned> readPos_;
+    // set while the reader sleeps on writePos_
+    alignas(64) std::atomic<unsigned> readerWaiting_;
+    // set while the writer sleeps on readPos_
+    std::atomic<unsigned> writerWaiting_;
+    // set once the reader's process has mapped the memory
+    std::atomic<unsigned> readerAttached_;
+};
+
+static const unsigned kRingHeaderSz = 256;
+static const unsigned kRingRecordAlign = 8;
+
+static_assert(sizeof(IPCRingHeader) <= kRingHeaderSz, "IPC ring header too large");
+static_assert(sizeof(IPCMessageHeader) == kRingRecordAlign, "IPC ring records assume an 8 byte message header");
+
+static void FutexWait(std::atomic<unsigned>* word, unsigned value, unsigned msec) {
+    struct timespec timeout;
+    timeout.tv_sec = msec / 1000;
+    timeout.tv_nsec = (msec % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<int*> (word), FUTEX_WAIT, (int) value, &timeout, NULL, 0);
+}
+
+static void FutexWake(std::atomic<unsigned>* word) {
+    syscall(SYS_futex, reinterpret_cast<int*> (word), FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+RingTransport::RingTransport() :
+    base_(0),
+    mapSz_(0),
+    send_(0),
+    sendData_(0),
+    receive_(0),
+    receiveData_(0),
+    peekSz_(0),
+    peerFD_(-1) {
+}
+
+RingTransport::~RingTransport() {
+    Close();
+}
+
+int RingTransport::Create() {
+#ifdef SYS_memfd_create
+    // not close-on-exec, the worker inherits the descriptor
+    int fd = (int) syscall(SYS_memfd_create, "ipc-channel", 0);
+    if (fd == -1) {
+        return -1;
+    }
+
+    size_t sz = 2 * (kRingHeaderSz + kRingSz);
+    if (ftruncate(fd, sz) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    void* base = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    // the new memory is zeroed, so all positions and flags start at 0
+    Map(base, sz, true);
+    receive_->readerAttached_ = 1;
+
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+bool RingTransport::Open(int fd) {
+    size_t sz = 2 * (kRingHeaderSz + kRingSz);
+
+    void* base = mmap(NULL, sz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    Map(base, sz, false);
+    receive_->readerAttached_ = 1;
+
+    return true;
+}
+
+void RingTransport::Map(void* base, size_t sz, bool creator) {
+    base_ = base;
+    mapSz_ = sz;
+
+    // the broker writes the first ring and reads the second
+    char* first = static_cast<char*> (base);
+    char* second = first + kRingHeaderSz + kRingSz;
+
+    char* sendRing = creator ? first : second;
+    char* receiveRing = creator ? second : first;
+
+    send_ = reinterpret_cast<IPCRingHeader*> (sendRing);
+    sendData_ = sendRing + kRingHeaderSz;
+    receive_ = reinterpret_cast<IPCRingHeader*> (receiveRing);
+    receiveData_ = receiveRing + kRingHeaderSz;
+}
+
+void RingTransport::Close() {
+    if (!base_) {
+        return;
+    }
+
+    // a writer waiting for room stops once the reader has detached
+    receive_->readerAttached_ = 0;
+    if (receive_->writerWaiting_.load()) {
+        FutexWake(&receive_->readPos_);
+    }
+
+    munmap(base_, mapSz_);
+    base_ = 0;
+    send_ = receive_ = 0;
+    sendData_ = receiveData_ = 0;
+}
+
+bool RingTransport::IsPeerAttached() const {
+    return send_ && send_->readerAttached_.load() != 0;
+}
+
+bool RingTransport::IsPeerAlive() const {
+    if (!IsPeerAttached()) {
+        return false;
+    }
+
+    // the socket hangs up once the other process has exited
+    if (peerFD_ == -1) {
+        return true;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = peerFD_;
+    pfd.events = 0;
+    pfd.revents = 0;
+    if (HANDLE_EINTR(poll(&pfd, 1, 0)) < 0) {
+        return false;
+    }
+
+    return !(pfd.revents & (POLLHUP | POLLERR | POLLNVAL));
+}
+
+bool RingTransport::Write(unsigned type, const void* data, unsigned sz) {
+    unsigned recordSz = (sizeof(IPCMessageHeader) + sz + kRingRecordAlign - 1) & ~(kRingRecordAlign - 1);
+    if (!send_ || recordSz > kRingSz / 2) {
+        return false;
+    }
+
+    unsigned writePos = send_->writePos_.load(std::memory_order_relaxed);
+    unsigned offset = writePos & (kRingSz - 1);
+
+    // a record never wraps, the space up to the end of the ring is skipped instead
+    unsigned tail = kRingSz - offset;
+    unsigned needed = recordSz > tail ? tail + recordSz : recordSz;
+
+    // wait for the reader to make room for as long as it takes, which holds back a sender that outpaces the receiver
+    for (;;) {
+        unsigned readPos = send_->readPos_.load(std::memory_order_acquire);
+        if (kRingSz - (writePos - readPos) >= needed) {
+            break;
+        }
+
+        if (!IsPeerAlive()) {
+            return false;
+        }
+
+        send_->writerWaiting_ = 1;
+        if (send_->readPos_.load() == readPos) {
+            FutexWait(&send_->readPos_, readPos, 100);
+        }
+        send_->writerWaiting_ = 0;
+    }
+
+    if (recordSz > tail) {
+        IPCMessageHeader* padding = reinterpret_cast<IPCMessageHeader*> (sendData_ + offset);
+        padding->messageType_ = IPC_MESSAGE_PADDING;
+        padding->messageSize_ = tail - sizeof(IPCMessageHeader);
+        offset = 0;
+    }
+
+    IPCMessageHeader* header = reinterpret_cast<IPCMessageHeader*> (sendData_ + offset);
+    header->messageType_ = type;
+    header->messageSize_ = sz;
+    if (sz) {
+        memcpy(header + 1, data, sz);
+    }
+
+    send_->writePos_.store(writePos + needed);
+
+    if (send_->readerWaiting_.load()) {
+        FutexWake(&send_->writePos_);
+    }
+
+    return true;
+}
+
+bool RingTransport::Peek(unsigned& type, const char*& data, unsigned& sz) {
+    if (!receive_) {
+        return false;
+    }
+
+    unsigned readPos = receive_->readPos_.load(std::memory_order_relaxed);
+
+    for (;;) {
+        unsigned writePos = receive_->writePos_.load(std::memory_order_acquire);
+        if (readPos == writePos) {
+            return false;
+        }
+
+        const IPCMessageHeader* header = reinterpret_cast<const IPCMessageHeader*> (receiveData_ + (readPos & (kRingSz - 1)));
+        unsigned recordSz = (sizeof(IPCMessageHeader) + header->messageSize_ + kRingRecordAlign - 1) & ~(kRingRecordAlign - 1);
+
+        if (header->messageType_ == IPC_MESSAGE_PADDING) {
+            readPos += recordSz;
+            receive_->readPos_.store(readPos);
+            continue;
+        }
+
+        type = header->messageType_;
+        data = reinterpret_cast<const char*> (header + 1);
+        sz = header->messageSize_;
+        peekSz_ = recordSz;
+        return true;
+    }
+}
+
+void RingTransport::Pop() {
+    if (!receive_ || !peekSz_) {
+        return;
+    }
+
+    receive_->readPos_.store(receive_->readPos_.load(std::memory_order_relaxed) + peekSz_);
+    peekSz_ = 0;
+
+    if (receive_->writerWaiting_.load()) {
+        FutexWake(&receive_->readPos_);
+    }
+}
+
+void RingTransport::Wait(unsigned msec) {
+    if (!receive_) {
+        return;
+    }
+
+    // the flag is set before checking, so a writer either sees it or its record is seen here
+    receive_->readerWaiting_ = 1;
+    unsigned writePos = receive_->writePos_.load();
+    if (receive_->readPos_.load(std::memory_order_relaxed) == writePos) {
+        FutexWait(&receive_->writePos_, writePos, msec);
+    }
+    receive_->readerWaiting_ = 0;
+}
+
+#endif
+
 
 IPCProcess::IPCProcess(Context* context, int fd1, int fd2, int pid) : Object(context),
     pid_(pid),
     fd1_(fd1),
-    fd2_(fd2)
+    fd2_(fd2),
+    sharedFD_(-1)
 {
 }
 
@@ -243,10 +516,10 @@ bool IPCProcess::Launch(const String& command, const Vector<String>& args, const
         }
 
         // close all open file descriptors other than stdin, stdout, stderr
-        // and the IPC child fd
+        // and the IPC child fd and shared memory
         for (int i = 3; i < getdtablesize(); ++i)
         {
-            if (i != fd2())
+            if (i != fd2() && i != sharedFD_)
                 close(i);
         }
 
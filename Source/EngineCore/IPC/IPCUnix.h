@@ -41,7 +41,7 @@ private:
 };
 
 
-class PipeUnix {
+class ATOMIC_API PipeUnix {
 public:
     PipeUnix();
 
@@ -52,13 +52,14 @@ public:
     bool Read(void* buf, size_t* sz);
 
     bool IsConnected() const { return fd_ != -1; }
+    int GetFD() const { return fd_; }
 
 private:
     int fd_;
 };
 
 
-class PipeTransport : public PipeUnix {
+class ATOMIC_API PipeTransport : public PipeUnix {
 public:
     static const size_t kBufferSz = 1024 * 1024;
 
@@ -72,6 +73,61 @@ private:
     PODVector<char> buf_;
 };
 
+#ifdef ENGINE_PLATFORM_LINUX
+
+struct IPCRingHeader;
+
+// Shared memory rings carrying the messages of a channel, one ring per direction, each with a single writer and
+// a single reader. The memory is a memfd created by the broker and inherited by the worker. Readers sleep on a futex
+// and are only woken when they wait, so bursts of small messages are drained with one wakeup. A writer waits for room
+// as long as the reader is alive, messages larger than a record are split into several.
+class ATOMIC_API RingTransport {
+public:
+    static const unsigned kRingSz = 4 * 1024 * 1024;
+
+    RingTransport();
+    ~RingTransport();
+
+    // creates the shared memory, returns the descriptor the worker maps or -1 if unavailable
+    int Create();
+    // maps the shared memory created by the broker
+    bool Open(int fd);
+    void Close();
+
+    bool IsOpen() const { return base_ != 0; }
+    // whether the other process has mapped the memory, until then messages are sent over the pipe
+    bool IsPeerAttached() const;
+    // socket connected to the other process, which tells a writer waiting for room when the reader has gone
+    void SetPeerSocket(int fd) { peerFD_ = fd; }
+    // largest record written to the ring, larger messages are split
+    unsigned GetMaxMessageSize() const { return kRingSz / 4; }
+
+    // writes a record, waiting for room while the reader catches up, fails once the reader has detached or its process
+    // has exited
+    bool Write(unsigned type, const void* data, unsigned sz);
+    // returns the next record without consuming it, false if the ring is empty
+    bool Peek(unsigned& type, const char*& data, unsigned& sz);
+    // consumes the record returned by Peek
+    void Pop();
+    // waits until a record is available or the timeout in milliseconds has passed
+    void Wait(unsigned msec);
+
+private:
+    void Map(void* base, size_t sz, bool creator);
+    bool IsPeerAlive() const;
+
+    void* base_;
+    size_t mapSz_;
+    IPCRingHeader* send_;
+    char* sendData_;
+    IPCRingHeader* receive_;
+    char* receiveData_;
+    unsigned peekSz_;
+    int peerFD_;
+};
+
+#endif
+
 class ATOMIC_API IPCProcess : public Object
 {
     ATOMIC_OBJECT(IPCProcess, Object)
@@ -91,11 +147,15 @@ class ATOMIC_API IPCProcess : public Object
 
     bool Launch(const String& command, const Vector<String>& args, const String& initialDirectory);
 
+    // descriptor left open in the launched process besides fd2, for the shared memory transport
+    void SetSharedFD(int fd) { sharedFD_ = fd; }
+
 private:
 
     int pid_;
     int fd1_;
     int fd2_;
+    int sharedFD_;
 };
 
 
@@ -117,7 +117,8 @@ void IPCWorker::ThreadFunction()
            break;
         }
 
-        Time::Sleep(10);
+        if (!IsReceivingSharedMemory())
+            Time::Sleep(10);
     }
 
     shouldRun_ = false;
@@ -40,33 +40,65 @@ namespace Atomic
 
 const StringHash StringHash::ZERO;
 
-StringHash::StringHash(const char* str) :
-    value_(Calculate(str))
+/// SDBM hash multiplier: SDBMHash(hash, c) equals hash * SDBM_MULTIPLIER + c.
+static const unsigned SDBM_MULTIPLIER = 65599u;
+/// Powers of the multiplier for hashing eight characters at a time.
+static const unsigned SDBM_POW2 = SDBM_MULTIPLIER * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW3 = SDBM_POW2 * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW4 = SDBM_POW3 * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW5 = SDBM_POW4 * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW6 = SDBM_POW5 * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW7 = SDBM_POW6 * SDBM_MULTIPLIER;
+static const unsigned SDBM_POW8 = SDBM_POW7 * SDBM_MULTIPLIER;
+
+/// Convert the ASCII capitals of eight packed characters to lowercase. Other characters are left unchanged.
+static inline unsigned long long ToLowerPacked(unsigned long long word)
 {
-#if ENGINE_PROFILING
-    RegisterSignificantString(str, *this);
-#endif
+    const unsigned long long ones = 0x0101010101010101ULL;
+    unsigned long long ascii = word & (0x7f * ones);
+    // High bit is set in bytes that are at least 'A', and in bytes that are past 'Z'
+    unsigned long long capitals = ((ascii + (0x80 - 'A') * ones) ^ (ascii + (0x80 - 'Z' - 1) * ones)) & ~word & (0x80 * ones);
+    return word | (capitals >> 2);
 }
 
 StringHash::StringHash(const String& str) :
-    value_(Calculate(str.CString()))
+    value_(Calculate(str.CString(), str.Length(), 0))
 {
 #if ENGINE_PROFILING
     RegisterSignificantString(str, *this);
 #endif
 }
+
 // ATOMIC BEGIN
-unsigned StringHash::Calculate(const char* str, unsigned hash)
+unsigned StringHash::Calculate(const char* str, unsigned length, unsigned hash)
 {
     if (!str)
         return hash;
 // ATOMIC END
-    while (*str)
+
+    // Expand eight steps of the SDBM recurrence so that the multiplies are independent
+    while (length >= 8)
+    {
+        unsigned long long word;
+        memcpy(&word, str, sizeof word);
+        word = ToLowerPacked(word);
+
+        unsigned char c[8];
+        memcpy(c, &word, sizeof c);
+        hash = hash * SDBM_POW8 + c[0] * SDBM_POW7 + c[1] * SDBM_POW6 + c[2] * SDBM_POW5 + c[3] * SDBM_POW4 +
+            c[4] * SDBM_POW3 + c[5] * SDBM_POW2 + c[6] * SDBM_MULTIPLIER + c[7];
+
+        str += 8;
+        length -= 8;
+    }
+
+    while (length--)
     {
         // Perform the actual hashing as case-insensitive
-        char c = *str;
-        hash = SDBMHash(hash, (unsigned char)tolower(c));
-        ++str;
+        unsigned char c = (unsigned char)*str++;
+        if (c >= 'A' && c <= 'Z')
+            c += 'a' - 'A';
+        hash = SDBMHash(hash, c);
     }
 
     return hash;
@@ -83,6 +115,8 @@ String StringHash::ToString() const
 
 // Lookup for significant strings, not a member of StringHash so don't need to drag hashmap into header
 static HashMap<StringHash, String>* gSignificantLookup = 0;
+// Different strings that were registered with the same hash
+static Vector<String>* gSignificantCollisions = 0;
 
 StringHash StringHash::RegisterSignificantString(const String& str)
 {
@@ -96,8 +130,19 @@ void StringHash::RegisterSignificantString(const char* str, StringHash hash)
     if (!gSignificantLookup)
         gSignificantLookup = new HashMap<StringHash, String>();
 
-    if (gSignificantLookup->Contains(hash))
+    HashMap<StringHash, String>::ConstIterator i = gSignificantLookup->Find(hash);
+    if (i != gSignificantLookup->End())
+    {
+        if (i->second_.Compare(str, false) != 0)
+        {
+            String collision = i->second_ + " / " + str + " (" + hash.ToString() + ")";
+            if (!gSignificantCollisions)
+                gSignificantCollisions = new Vector<String>();
+            if (!gSignificantCollisions->Contains(collision))
+                gSignificantCollisions->Push(collision);
+        }
         return;
+    }
 
     (*gSignificantLookup)[hash] = str;
 }
@@ -125,6 +170,12 @@ bool StringHash::GetSignificantString(StringHash hash, String& strOut)
     return true;
 }
 
+const Vector<String>& StringHash::GetSignificantStringCollisions()
+{
+    static const Vector<String> noCollisions;
+    return gSignificantCollisions ? *gSignificantCollisions : noCollisions;
+}
+
 // ATOMIC END
 
 
@@ -24,6 +24,8 @@
 
 #include "../Container/Str.h"
 
+#include <type_traits>
+
 namespace Atomic
 {
 
@@ -32,25 +34,33 @@ class ATOMIC_API StringHash
 {
 public:
     /// Construct with zero value.
-    StringHash() :
+    constexpr StringHash() :
         value_(0)
     {
     }
 
     /// Copy-construct from another hash.
-    StringHash(const StringHash& rhs) :
+    constexpr StringHash(const StringHash& rhs) :
         value_(rhs.value_)
     {
     }
 
     /// Construct with an initial value.
-    explicit StringHash(unsigned value) :
+    constexpr explicit StringHash(unsigned value) :
         value_(value)
     {
     }
 
-    /// Construct from a C string case-insensitively.
-    StringHash(const char* str);
+    /// Construct from a C string case-insensitively. Constant strings are hashed at compile time.
+    constexpr StringHash(const char* str) :
+        value_(Calculate(str))
+    {
+#if ENGINE_PROFILING
+        if (!std::is_constant_evaluated())
+            RegisterSignificantString(str, *this);
+#endif
+    }
+
     /// Construct from a string case-insensitively.
     StringHash(const String& str);
 
@@ -92,7 +102,7 @@ public:
     operator bool() const { return value_ != 0; }
 
     /// Return hash value.
-    unsigned Value() const { return value_; }
+    constexpr unsigned Value() const { return value_; }
 
     /// Return as string.
     String ToString() const;
@@ -105,8 +115,29 @@ public:
 
     // ATOMIC BEGIN
 
-    /// Calculate hash value case-insensitively from a C string.
-    static unsigned Calculate(const char* str, unsigned hash = 0);
+    /// Calculate hash value case-insensitively from a C string. Evaluated at compile time for constant strings.
+    static constexpr unsigned Calculate(const char* str, unsigned hash = 0)
+    {
+        if (!std::is_constant_evaluated())
+            return str ? Calculate(str, (unsigned)strlen(str), hash) : hash;
+
+        if (!str)
+            return hash;
+
+        for (; *str; ++str)
+        {
+            unsigned char c = (unsigned char)*str;
+            if (c >= 'A' && c <= 'Z')
+                c += 'a' - 'A';
+            // Same as SDBMHash()
+            hash = c + (hash << 6) + (hash << 16) - hash;
+        }
+
+        return hash;
+    }
+    /// Calculate hash value case-insensitively from a string of known length. Hashes eight characters at a time, with
+    /// the same result as Calculate().
+    static unsigned Calculate(const char* str, unsigned length, unsigned hash);
     /// Register significant string, which can be looked up via hash, note that the lookup is case insensitive
     static StringHash RegisterSignificantString(const String& str);
     /// Register significant string, which can be looked up via hash, note that the lookup is case insensitive
@@ -118,6 +149,8 @@ public:
 
     /// Get a significant string from a case insensitive hash value
     static bool GetSignificantString(StringHash hash, String& strOut);
+    /// Return descriptions of the hash collisions found between registered significant strings.
+    static const Vector<String>& GetSignificantStringCollisions();
 
     // ATOMIC END
 
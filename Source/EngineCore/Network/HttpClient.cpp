@@ -0,0 +1,702 @@
+#include "../Precompiled.h"
+
+#include "../Core/Condition.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Network/HttpClient.h"
+#include "../Network/NetworkEvents.h"
+
+#include <Civetweb/include/civetweb.h>
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+static const unsigned ERROR_BUFFER_SIZE = 256;
+/// Civetweb error when a connection ended or timed out before any of a response was received.
+static const char* NO_RESPONSE_ERROR = "Client did not send a request";
+/// Bytes read from a connection at a time.
+static const unsigned READ_CHUNK_SIZE = 16384;
+static const unsigned DEFAULT_MAX_CONCURRENT_REQUESTS = 4;
+static const unsigned DEFAULT_MAX_CONNECTIONS_PER_HOST = 6;
+static const unsigned DEFAULT_IDLE_CONNECTION_TIMEOUT = 30000;
+static const unsigned DEFAULT_REQUEST_TIMEOUT = 30000;
+
+/// Worker thread executing requests of an HTTP client.
+class HttpClientWorker : public Thread, public RefCounted
+{
+    ATOMIC_REFCOUNTED(HttpClientWorker)
+
+public:
+    /// Construct.
+    HttpClientWorker(HttpClient* owner) :
+        owner_(owner)
+    {
+    }
+
+    /// Execute requests until stopped, waiting while there are none.
+    virtual void ThreadFunction()
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->ProcessNextRequest())
+                wakeCondition_.Wait();
+        }
+    }
+
+    /// Wake the thread to look for queued requests.
+    void Wake() { wakeCondition_.Set(); }
+
+    /// Stop the thread, waking it if it is waiting.
+    void Stop()
+    {
+        shouldRun_ = false;
+        wakeCondition_.Set();
+        Thread::Stop();
+    }
+
+private:
+    /// HTTP client.
+    HttpClient* owner_;
+    /// Condition set when requests are queued or the thread is stopped.
+    Condition wakeCondition_;
+};
+
+/// Return whether a verb is idempotent, so that a request can be sent again if the server may have received it.
+static bool IsIdempotent(const String& verb)
+{
+    return verb == "GET" || verb == "HEAD" || verb == "PUT" || verb == "DELETE" || verb == "OPTIONS";
+}
+
+HttpClientRequest::HttpClientRequest(const String& url, const String& verb) :
+    url_(url.Trimmed()),
+    verb_(!verb.Empty() ? verb.ToUpper() : "GET"),
+    path_("/"),
+    port_(80),
+    ssl_(false),
+    destData_(0),
+    destSize_(0),
+    state_(HTTP_INITIALIZING),
+    statusCode_(0),
+    numBytesReceived_(0),
+    batchID_(0),
+    cancelled_(false),
+    completed_(false)
+{
+    String host;
+    unsigned protocolEnd = url_.Find("://");
+    if (protocolEnd != String::NPOS)
+    {
+        ssl_ = !url_.Substring(0, protocolEnd).Compare("https", false);
+        host = url_.Substring(protocolEnd + 3);
+    }
+    else
+        host = url_;
+
+    if (ssl_)
+        port_ = 443;
+
+    unsigned pathStart = host.Find('/');
+    if (pathStart != String::NPOS)
+    {
+        path_ = host.Substring(pathStart);
+        host = host.Substring(0, pathStart);
+    }
+
+    unsigned portStart = host.Find(':');
+    if (portStart != String::NPOS)
+    {
+        port_ = ToInt(host.Substring(portStart + 1));
+        host = host.Substring(0, portStart);
+    }
+
+    host_ = host;
+    hostKey_ = host_.ToLower() + ":" + String(port_) + (ssl_ ? ":ssl" : "");
+}
+
+HttpClientRequest::~HttpClientRequest()
+{
+}
+
+void HttpClientRequest::AddHeader(const String& header)
+{
+    String trimmed = header.Trimmed();
+    if (trimmed.Length())
+        headers_ += trimmed + "\r\n";
+}
+
+void HttpClientRequest::SetBody(const String& body)
+{
+    body_.Resize(body.Length());
+    if (body.Length())
+        memcpy(&body_[0], body.CString(), body.Length());
+}
+
+void HttpClientRequest::SetBody(const PODVector<unsigned char>& body)
+{
+    body_ = body;
+}
+
+void HttpClientRequest::SetDestination(File* file)
+{
+    destFile_ = file;
+    destData_ = 0;
+    destSize_ = 0;
+}
+
+void HttpClientRequest::SetDestination(void* data, unsigned size)
+{
+    destFile_.Reset();
+    destData_ = (unsigned char*)data;
+    destSize_ = data ? size : 0;
+}
+
+String HttpClientRequest::GetResponseHeader(const String& name) const
+{
+    HashMap<String, String>::ConstIterator i = responseHeaders_.Find(name.ToLower());
+    return i != responseHeaders_.End() ? i->second_ : String::EMPTY;
+}
+
+String HttpClientRequest::GetResponseString() const
+{
+    return responseData_.Size() ? String((const char*)&responseData_[0], responseData_.Size()) : String::EMPTY;
+}
+
+bool HttpClientRequest::WriteResponse(const unsigned char* data, unsigned size)
+{
+    if (destFile_)
+        return destFile_->Write(data, size) == size;
+
+    if (destData_)
+    {
+        if (numBytesReceived_ + size > destSize_)
+            return false;
+        memcpy(destData_ + numBytesReceived_, data, size);
+        return true;
+    }
+
+    unsigned oldSize = responseData_.Size();
+    responseData_.Resize(oldSize + size);
+    memcpy(&responseData_[oldSize], data, size);
+    return true;
+}
+
+HttpClient::HttpClient(Context* context) :
+    Object(context),
+    rateBytes_(0),
+    lastBatchID_(0),
+    maxConcurrentRequests_(DEFAULT_MAX_CONCURRENT_REQUESTS),
+    maxConnectionsPerHost_(DEFAULT_MAX_CONNECTIONS_PER_HOST),
+    maxDownloadRate_(0),
+    idleConnectionTimeout_(DEFAULT_IDLE_CONNECTION_TIMEOUT),
+    requestTimeout_(DEFAULT_REQUEST_TIMEOUT)
+{
+    SubscribeToEvent(E_BEGINFRAME, ATOMIC_HANDLER(HttpClient, HandleBeginFrame));
+}
+
+HttpClient::~HttpClient()
+{
+    {
+        MutexLock lock(mutex_);
+        queue_.Clear();
+    }
+
+    for (unsigned i = 0; i < requests_.Size(); ++i)
+        requests_[i]->Cancel();
+
+    // Stopping waits for the request a worker is executing, which returns soon after being cancelled
+    for (unsigned i = 0; i < workers_.Size(); ++i)
+        workers_[i]->Stop();
+    workers_.Clear();
+
+    for (HashMap<String, Vector<PooledConnection> >::Iterator i = pool_.Begin(); i != pool_.End(); ++i)
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+            mg_close_connection(i->second_[j].connection_);
+    }
+    pool_.Clear();
+}
+
+void HttpClient::Send(HttpClientRequest* request)
+{
+    if (!request)
+        return;
+
+    if (request->state_ != HTTP_INITIALIZING)
+    {
+        ATOMIC_LOGERROR("HTTP request to " + request->url_ + " has already been sent");
+        return;
+    }
+
+    QueueRequest(request, 0);
+}
+
+unsigned HttpClient::SendBatch(const Vector<SharedPtr<HttpClientRequest> >& requests)
+{
+    unsigned batchID = lastBatchID_ + 1;
+    if (!batchID)
+        batchID = 1;
+
+    unsigned numRequests = 0;
+    for (unsigned i = 0; i < requests.Size(); ++i)
+    {
+        HttpClientRequest* request = requests[i];
+        if (!request)
+            continue;
+
+        if (request->state_ != HTTP_INITIALIZING)
+        {
+            ATOMIC_LOGERROR("HTTP request to " + request->url_ + " has already been sent");
+            continue;
+        }
+
+        QueueRequest(request, batchID);
+        ++numRequests;
+    }
+
+    if (!numRequests)
+        return 0;
+
+    lastBatchID_ = batchID;
+    Batch& batch = batches_[batchID];
+    batch.numRequests_ = numRequests;
+    batch.numCompleted_ = 0;
+    batch.numFailed_ = 0;
+    return batchID;
+}
+
+void HttpClient::WaitForRequests()
+{
+    ATOMIC_PROFILE(WaitForHttpRequests);
+
+    while (!requests_.Empty())
+    {
+        SendCompletionEvents();
+        if (!requests_.Empty())
+            Time::Sleep(1);
+    }
+}
+
+void HttpClient::SetMaxConcurrentRequests(unsigned count)
+{
+    maxConcurrentRequests_ = Max(count, 1U);
+
+    // Surplus workers finish their current request before stopping
+    while (workers_.Size() > maxConcurrentRequests_)
+    {
+        workers_.Back()->Stop();
+        workers_.Pop();
+    }
+
+    if (!workers_.Empty())
+        StartWorkers();
+}
+
+void HttpClient::SetMaxDownloadRate(unsigned bytesPerSecond)
+{
+    MutexLock lock(rateMutex_);
+
+    maxDownloadRate_ = bytesPerSecond;
+    rateBytes_ = 0;
+    rateTimer_.Reset();
+}
+
+HttpClientStats HttpClient::GetStats() const
+{
+    MutexLock lock(mutex_);
+    return stats_;
+}
+
+void HttpClient::QueueRequest(HttpClientRequest* request, unsigned batchID)
+{
+    request->state_ = HTTP_OPEN;
+    request->batchID_ = batchID;
+    requests_.Push(SharedPtr<HttpClientRequest>(request));
+
+    // A request that can not be executed completes with an error on the next frame, like one that failed
+    if (request->host_.Empty())
+    {
+        request->error_ = "Invalid URL " + request->url_;
+        request->completed_ = true;
+        return;
+    }
+
+#ifdef ENGINE_THREADING
+    {
+        MutexLock lock(mutex_);
+        queue_.Push(request);
+    }
+
+    StartWorkers();
+#else
+    request->error_ = "HTTP request will not execute as threading is disabled";
+    request->completed_ = true;
+#endif
+}
+
+void HttpClient::StartWorkers()
+{
+    for (unsigned i = 0; i < workers_.Size(); ++i)
+        workers_[i]->Wake();
+
+    while (workers_.Size() < maxConcurrentRequests_)
+    {
+        SharedPtr<HttpClientWorker> worker(new HttpClientWorker(this));
+        if (!worker->Run())
+        {
+            ATOMIC_LOGERROR("Could not start HTTP client worker thread");
+            break;
+        }
+        workers_.Push(worker);
+    }
+}
+
+bool HttpClient::ProcessNextRequest()
+{
+    HttpClientRequest* request = 0;
+    mg_connection* connection = 0;
+    bool reused = false;
+
+    {
+        MutexLock lock(mutex_);
+
+        CloseIdleConnections(Time::GetSystemTime());
+
+        // Requests to a host that has all its connections in use wait, while requests to other hosts can go ahead
+        for (List<HttpClientRequest*>::Iterator i = queue_.Begin(); i != queue_.End(); ++i)
+        {
+            unsigned& numConnections = hostConnections_[(*i)->hostKey_];
+            if (numConnections >= maxConnectionsPerHost_)
+                continue;
+
+            ++numConnections;
+            request = *i;
+            queue_.Erase(i);
+            break;
+        }
+
+        if (!request)
+            return false;
+
+        HashMap<String, Vector<PooledConnection> >::Iterator i = pool_.Find(request->hostKey_);
+        if (i != pool_.End() && !i->second_.Empty())
+        {
+            // Take the most recently used connection, which is the least likely to have been closed by the server
+            connection = i->second_.Back().connection_;
+            i->second_.Pop();
+            --stats_.numPooledConnections_;
+            reused = true;
+        }
+    }
+
+    ATOMIC_PROFILE(ExecuteHttpRequest);
+
+    for (;;)
+    {
+        if (!connection)
+        {
+            char errorBuffer[ERROR_BUFFER_SIZE];
+            memset(errorBuffer, 0, sizeof(errorBuffer));
+
+            /// \todo SSL mode will not actually work unless Civetweb's SSL mode is initialized with an external SSL DLL
+            connection = mg_connect_client(request->host_.CString(), request->port_, request->ssl_ ? 1 : 0, errorBuffer,
+                sizeof(errorBuffer));
+            if (!connection)
+            {
+                request->error_ = String(errorBuffer);
+                if (request->error_.Empty())
+                    request->error_ = "Could not connect to " + request->host_;
+                break;
+            }
+
+            MutexLock lock(mutex_);
+            ++stats_.numConnectionsOpened_;
+        }
+
+        bool closed = ExecuteRequest(request, connection);
+
+        if (reused && request->statusCode_)
+        {
+            MutexLock lock(mutex_);
+            ++stats_.numConnectionsReused_;
+        }
+
+        // A kept-alive connection may have been closed by the server while idle, in which case an idempotent request is
+        // sent again on a new connection. Other requests fail, as the server may have acted on them before closing
+        if (!closed || !reused || request->cancelled_ || !IsIdempotent(request->verb_))
+            break;
+
+        reused = false;
+    }
+
+    {
+        MutexLock lock(mutex_);
+
+        --hostConnections_[request->hostKey_];
+        if (connection)
+        {
+            PooledConnection pooled;
+            pooled.connection_ = connection;
+            pooled.idleTime_ = Time::GetSystemTime();
+            pool_[request->hostKey_].Push(pooled);
+            ++stats_.numPooledConnections_;
+        }
+
+        ++stats_.numRequests_;
+        if (!request->error_.Empty())
+            ++stats_.numFailed_;
+        stats_.numBytesReceived_ += request->numBytesReceived_;
+    }
+
+    request->completed_ = true;
+    return true;
+}
+
+bool HttpClient::ExecuteRequest(HttpClientRequest* request, mg_connection*& connection)
+{
+    request->error_.Clear();
+    request->statusCode_ = 0;
+    request->responseHeaders_.Clear();
+
+    if (request->cancelled_)
+    {
+        request->error_ = "Cancelled";
+        return false;
+    }
+
+    // Requests are HTTP/1.1 so that the server keeps the connection alive
+    String header = request->verb_ + " " + request->path_ + " HTTP/1.1\r\nHost: " + request->host_;
+    if (request->port_ != (request->ssl_ ? 443 : 80))
+        header += ":" + String(request->port_);
+    header += "\r\n" + request->headers_;
+    if (!request->body_.Empty() || request->verb_ == "POST" || request->verb_ == "PUT")
+        header += "Content-Length: " + String(request->body_.Size()) + "\r\n";
+    header += "\r\n";
+
+    if (mg_write(connection, header.CString(), header.Length()) != (int)header.Length() || (!request->body_.Empty() &&
+        mg_write(connection, &request->body_[0], request->body_.Size()) != (int)request->body_.Size()))
+    {
+        request->error_ = "Could not send request";
+        mg_close_connection(connection);
+        connection = 0;
+        return true;
+    }
+
+    char errorBuffer[ERROR_BUFFER_SIZE];
+    memset(errorBuffer, 0, sizeof(errorBuffer));
+
+    Timer responseTimer;
+    if (mg_get_response(connection, errorBuffer, sizeof(errorBuffer), (int)requestTimeout_) < 0)
+    {
+        request->error_ = "Could not receive response: " + String(errorBuffer);
+        mg_close_connection(connection);
+        connection = 0;
+
+        // Civetweb reports end of stream and timeout alike when nothing was received, so the connection is known to have
+        // been closed only if the wait ended before the timeout
+        return !strcmp(errorBuffer, NO_RESPONSE_ERROR) && responseTimer.GetMSec(false) < requestTimeout_;
+    }
+
+    // For a response, Civetweb stores the protocol as the method and the status code as the URI
+    const mg_request_info* info = mg_get_request_info(connection);
+    request->statusCode_ = ToInt(info->uri);
+    for (int i = 0; i < info->num_headers; ++i)
+        request->responseHeaders_[String(info->http_headers[i].name).ToLower()] = String(info->http_headers[i].value);
+
+    long long contentLength = info->content_length;
+    bool chunked = !request->GetResponseHeader("Transfer-Encoding").Compare("chunked", false);
+    bool keepAlive = !String(info->request_method).Compare("HTTP/1.1", false) &&
+        request->GetResponseHeader("Connection").Compare("close", false);
+    bool hasBody = request->verb_ != "HEAD" && request->statusCode_ >= 200 && request->statusCode_ != 204 &&
+        request->statusCode_ != 304;
+
+    // Civetweb discards bytes read ahead when the next response is received, so a connection is only reused when its
+    // response has been read exactly to the end
+    bool reusable = keepAlive && (!hasBody || (contentLength >= 0 && !chunked));
+
+    if (hasBody)
+    {
+        if (contentLength >= 0)
+        {
+            if (request->destData_ && (unsigned long long)contentLength > request->destSize_)
+            {
+                request->error_ = "Response of " + String(contentLength) + " bytes does not fit in destination memory";
+                mg_close_connection(connection);
+                connection = 0;
+                return false;
+            }
+            if (!request->destFile_ && !request->destData_)
+                request->responseData_.Reserve((unsigned)contentLength);
+        }
+
+        unsigned char buffer[READ_CHUNK_SIZE];
+
+        for (;;)
+        {
+            if (request->cancelled_)
+            {
+                request->error_ = "Cancelled";
+                break;
+            }
+
+            unsigned size = AcquireDownloadBytes(READ_CHUNK_SIZE);
+            int numRead = mg_read(connection, buffer, size);
+            if ((int)size > Max(numRead, 0))
+                ReleaseDownloadBytes(size - Max(numRead, 0));
+
+            if (numRead < 0)
+            {
+                request->error_ = "Could not read response";
+                break;
+            }
+            if (!numRead)
+                break;
+
+            if (!request->WriteResponse(buffer, (unsigned)numRead))
+            {
+                request->error_ = request->destFile_ ? "Could not write response to file" :
+                    "Response does not fit in destination memory";
+                break;
+            }
+            request->numBytesReceived_ += numRead;
+        }
+
+        if (request->error_.Empty() && contentLength >= 0 && request->numBytesReceived_ != (unsigned long long)contentLength)
+            request->error_ = "Incomplete response";
+    }
+
+    if (!reusable || !request->error_.Empty())
+    {
+        mg_close_connection(connection);
+        connection = 0;
+    }
+
+    return false;
+}
+
+unsigned HttpClient::AcquireDownloadBytes(unsigned size)
+{
+    for (;;)
+    {
+        {
+            MutexLock lock(rateMutex_);
+
+            if (!maxDownloadRate_)
+                return size;
+
+            // Refill by the time passed, keeping at most a second's worth so that an idle period does not allow a burst
+            long long elapsed = rateTimer_.GetUSec(false);
+            long long refill = elapsed * maxDownloadRate_ / 1000000;
+            if (refill > 0)
+            {
+                rateBytes_ = Min(rateBytes_ + refill, (long long)maxDownloadRate_);
+                rateTimer_.Reset();
+            }
+
+            if (rateBytes_ > 0)
+            {
+                unsigned allowed = (unsigned)Min((long long)size, rateBytes_);
+                rateBytes_ -= allowed;
+                return allowed;
+            }
+        }
+
+        Time::Sleep(1);
+    }
+}
+
+void HttpClient::ReleaseDownloadBytes(unsigned size)
+{
+    MutexLock lock(rateMutex_);
+
+    if (maxDownloadRate_)
+        rateBytes_ = Min(rateBytes_ + size, (long long)maxDownloadRate_);
+}
+
+void HttpClient::CloseIdleConnections(unsigned now)
+{
+    for (HashMap<String, Vector<PooledConnection> >::Iterator i = pool_.Begin(); i != pool_.End(); ++i)
+    {
+        Vector<PooledConnection>& connections = i->second_;
+        for (unsigned j = connections.Size() - 1; j < connections.Size(); --j)
+        {
+            if (now - connections[j].idleTime_ >= idleConnectionTimeout_)
+            {
+                mg_close_connection(connections[j].connection_);
+                connections.Erase(j);
+                --stats_.numPooledConnections_;
+            }
+        }
+    }
+}
+
+void HttpClient::SendCompletionEvents()
+{
+    for (unsigned i = 0; i < requests_.Size();)
+    {
+        if (!requests_[i]->completed_)
+        {
+            ++i;
+            continue;
+        }
+
+        // Keep the request alive while its event is handled
+        SharedPtr<HttpClientRequest> request = requests_[i];
+        requests_.Erase(i);
+
+        bool success = request->error_.Empty();
+        request->state_ = success ? HTTP_CLOSED : HTTP_ERROR;
+        if (!success)
+            ATOMIC_LOGWARNING("HTTP request to " + request->url_ + " failed: " + request->error_);
+
+        if (!request->batchID_)
+        {
+            using namespace HttpRequestCompleted;
+
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_REQUEST] = request.Get();
+            eventData[P_SUCCESS] = success;
+            eventData[P_STATUSCODE] = request->statusCode_;
+            SendEvent(E_HTTPREQUESTCOMPLETED, eventData);
+            continue;
+        }
+
+        HashMap<unsigned, Batch>::Iterator j = batches_.Find(request->batchID_);
+        if (j == batches_.End())
+            continue;
+
+        Batch& batch = j->second_;
+        ++batch.numCompleted_;
+        if (!success)
+            ++batch.numFailed_;
+
+        if (batch.numCompleted_ == batch.numRequests_)
+        {
+            using namespace HttpBatchCompleted;
+
+            VariantMap& eventData = GetEventDataMap();
+            eventData[P_BATCHID] = j->first_;
+            eventData[P_NUMREQUESTS] = batch.numRequests_;
+            eventData[P_NUMFAILED] = batch.numFailed_;
+            batches_.Erase(j);
+            SendEvent(E_HTTPBATCHCOMPLETED, eventData);
+        }
+    }
+}
+
+void HttpClient::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (!requests_.Empty())
+        SendCompletionEvents();
+
+    // The worker threads wait while there are no requests, so idle connections are also closed here
+    MutexLock lock(mutex_);
+    if (stats_.numPooledConnections_)
+        CloseIdleConnections(Time::GetSystemTime());
+}
+
+}
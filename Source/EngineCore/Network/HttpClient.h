@@ -0,0 +1,268 @@
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Core/Object.h"
+#include "../Core/Timer.h"
+#include "../Network/HttpRequest.h"
+
+#include <atomic>
+
+struct mg_connection;
+
+namespace Atomic
+{
+
+class File;
+class HttpClientWorker;
+
+/// Request sent through an HttpClient. Set up the request before sending it. The response is valid once the request has
+/// completed.
+class ATOMIC_API HttpClientRequest : public RefCounted
+{
+    ATOMIC_REFCOUNTED(HttpClientRequest)
+
+    friend class HttpClient;
+
+public:
+    /// Construct with URL and verb. Empty verb defaults to GET.
+    HttpClientRequest(const String& url, const String& verb = String::EMPTY);
+    /// Destruct.
+    ~HttpClientRequest();
+
+    /// Add a request header in "Name: value" form.
+    void AddHeader(const String& header);
+    /// Set request body.
+    void SetBody(const String& body);
+    /// Set request body.
+    void SetBody(const PODVector<unsigned char>& body);
+    /// Write the response body to an open file instead of keeping it in memory.
+    void SetDestination(File* file);
+    /// Write the response body to caller owned memory, such as a writable file mapping, instead of keeping it in memory. The request fails if the body does not fit. The memory must stay valid until the request has completed.
+    void SetDestination(void* data, unsigned size);
+    /// Abort the request. It completes with an error.
+    void Cancel() { cancelled_ = true; }
+
+    /// Return URL.
+    const String& GetURL() const { return url_; }
+    /// Return verb.
+    const String& GetVerb() const { return verb_; }
+    /// Return state. Initializing until sent, open while queued or in progress, then closed or error.
+    HttpRequestState GetState() const { return state_; }
+    /// Return whether the request has completed.
+    bool IsCompleted() const { return state_ == HTTP_CLOSED || state_ == HTTP_ERROR; }
+    /// Return error. Only non-empty in the error state.
+    const String& GetError() const { return error_; }
+    /// Return HTTP status code of the response, or 0 if none was received.
+    int GetStatusCode() const { return statusCode_; }
+    /// Return a response header by case-insensitive name, or empty if not present.
+    String GetResponseHeader(const String& name) const;
+    /// Return response body when no destination was set.
+    const PODVector<unsigned char>& GetResponseData() const { return responseData_; }
+    /// Return response body as a string when no destination was set.
+    String GetResponseString() const;
+    /// Return number of response body bytes received.
+    unsigned long long GetNumBytesReceived() const { return numBytesReceived_; }
+
+private:
+    /// Write received response body bytes to the destination. Called by the worker thread. Return false if they do not fit.
+    bool WriteResponse(const unsigned char* data, unsigned size);
+
+    /// URL.
+    String url_;
+    /// Verb.
+    String verb_;
+    /// Host name.
+    String host_;
+    /// Path and query.
+    String path_;
+    /// Port.
+    int port_;
+    /// SSL flag.
+    bool ssl_;
+    /// Connection pool key of the host.
+    String hostKey_;
+    /// Request headers, each ending in CRLF.
+    String headers_;
+    /// Request body.
+    PODVector<unsigned char> body_;
+    /// File destination.
+    SharedPtr<File> destFile_;
+    /// Memory destination.
+    unsigned char* destData_;
+    /// Memory destination size.
+    unsigned destSize_;
+    /// State. Changed by the main thread only.
+    HttpRequestState state_;
+    /// Error string, written by the worker thread.
+    String error_;
+    /// Response status code, written by the worker thread.
+    int statusCode_;
+    /// Response headers keyed by lowercase name, written by the worker thread.
+    HashMap<String, String> responseHeaders_;
+    /// Response body when no destination was set, written by the worker thread.
+    PODVector<unsigned char> responseData_;
+    /// Number of response body bytes received.
+    unsigned long long numBytesReceived_;
+    /// Batch the request belongs to, or 0.
+    unsigned batchID_;
+    /// Cancel flag.
+    std::atomic<bool> cancelled_;
+    /// Set by the worker thread when the request has completed.
+    std::atomic<bool> completed_;
+};
+
+/// HTTP client statistics.
+struct HttpClientStats
+{
+    /// Construct.
+    HttpClientStats() :
+        numRequests_(0),
+        numFailed_(0),
+        numConnectionsOpened_(0),
+        numConnectionsReused_(0),
+        numPooledConnections_(0),
+        numBytesReceived_(0)
+    {
+    }
+
+    /// Number of completed requests.
+    unsigned numRequests_;
+    /// Number of failed requests.
+    unsigned numFailed_;
+    /// Number of connections opened.
+    unsigned numConnectionsOpened_;
+    /// Number of requests sent on a kept-alive connection.
+    unsigned numConnectionsReused_;
+    /// Number of idle connections kept for reuse.
+    unsigned numPooledConnections_;
+    /// Number of response body bytes received.
+    unsigned long long numBytesReceived_;
+};
+
+/// HTTP/1.1 client that executes requests on worker threads and keeps connections alive for reuse per host. Response
+/// bodies are written straight to memory, a file or caller owned memory, and a single event is sent on the main thread
+/// when a request or a batch of requests completes. The number of connections per host and the total download rate can
+/// be limited. Uses the Civetweb client functions like HttpRequest, so requests are sent one at a time per connection
+/// without pipelining.
+class ATOMIC_API HttpClient : public Object
+{
+    ATOMIC_OBJECT(HttpClient, Object);
+
+    friend class HttpClientWorker;
+
+public:
+    /// Construct.
+    HttpClient(Context* context);
+    /// Destruct. Cancel requests in progress and close connections.
+    virtual ~HttpClient();
+
+    /// Queue a request. E_HTTPREQUESTCOMPLETED is sent when it has completed.
+    void Send(HttpClientRequest* request);
+    /// Queue requests as a batch. E_HTTPBATCHCOMPLETED is sent once all of them have completed, instead of an event for each. Return the batch ID, or 0 if no requests could be queued.
+    unsigned SendBatch(const Vector<SharedPtr<HttpClientRequest> >& requests);
+    /// Block until all queued requests have completed and send their events.
+    void WaitForRequests();
+
+    /// Set number of requests executed at a time, which is the number of worker threads. Default 4.
+    void SetMaxConcurrentRequests(unsigned count);
+    /// Set maximum number of connections to a host at a time. Default 6.
+    void SetMaxConnectionsPerHost(unsigned count) { maxConnectionsPerHost_ = Max(count, 1U); }
+    /// Set total download rate limit in bytes per second, or 0 for unlimited. Default 0.
+    void SetMaxDownloadRate(unsigned bytesPerSecond);
+    /// Set milliseconds an idle connection is kept for reuse. Default 30000.
+    void SetIdleConnectionTimeout(unsigned msec) { idleConnectionTimeout_ = msec; }
+    /// Set milliseconds to wait for a response before failing. Default 30000.
+    void SetRequestTimeout(unsigned msec) { requestTimeout_ = msec; }
+
+    /// Return number of requests executed at a time.
+    unsigned GetMaxConcurrentRequests() const { return maxConcurrentRequests_; }
+    /// Return maximum number of connections to a host at a time.
+    unsigned GetMaxConnectionsPerHost() const { return maxConnectionsPerHost_; }
+    /// Return total download rate limit in bytes per second, or 0 for unlimited.
+    unsigned GetMaxDownloadRate() const { return maxDownloadRate_; }
+    /// Return milliseconds an idle connection is kept for reuse.
+    unsigned GetIdleConnectionTimeout() const { return idleConnectionTimeout_; }
+    /// Return milliseconds to wait for a response.
+    unsigned GetRequestTimeout() const { return requestTimeout_; }
+    /// Return number of requests that have not completed.
+    unsigned GetNumPendingRequests() const { return requests_.Size(); }
+    /// Return statistics.
+    HttpClientStats GetStats() const;
+
+private:
+    /// Idle connection kept for reuse.
+    struct PooledConnection
+    {
+        /// Connection.
+        mg_connection* connection_;
+        /// System time in milliseconds when the connection became idle.
+        unsigned idleTime_;
+    };
+
+    /// Batch of requests.
+    struct Batch
+    {
+        /// Number of requests.
+        unsigned numRequests_;
+        /// Number of completed requests.
+        unsigned numCompleted_;
+        /// Number of failed requests.
+        unsigned numFailed_;
+    };
+
+    /// Queue a request for the worker threads, or complete it with an error if it can not be executed.
+    void QueueRequest(HttpClientRequest* request, unsigned batchID);
+    /// Wake the worker threads to look for queued requests, and start more up to the concurrency limit.
+    void StartWorkers();
+    /// Execute the next request whose host has a free connection slot. Called by the worker threads. Return false if none.
+    bool ProcessNextRequest();
+    /// Send a request and receive the response on a connection, which is closed and set to null if it can not be reused. Return true if the request failed because the connection was found closed before any response was received, so that the request can be sent again on a new connection.
+    bool ExecuteRequest(HttpClientRequest* request, mg_connection*& connection);
+    /// Take up to the requested number of bytes from the download rate limit, waiting if none are available.
+    unsigned AcquireDownloadBytes(unsigned size);
+    /// Return unused bytes to the download rate limit.
+    void ReleaseDownloadBytes(unsigned size);
+    /// Close idle connections that have timed out. Must be called with the mutex held.
+    void CloseIdleConnections(unsigned now);
+    /// Finish completed requests and send their events.
+    void SendCompletionEvents();
+    /// Send completion events.
+    void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Requests that have not completed, kept alive by the main thread.
+    Vector<SharedPtr<HttpClientRequest> > requests_;
+    /// Batches in progress.
+    HashMap<unsigned, Batch> batches_;
+    /// Queued requests waiting for a worker thread. Guarded by the mutex.
+    List<HttpClientRequest*> queue_;
+    /// Idle connections by host. Guarded by the mutex.
+    HashMap<String, Vector<PooledConnection> > pool_;
+    /// Number of connections in use by host. Guarded by the mutex.
+    HashMap<String, unsigned> hostConnections_;
+    /// Worker threads.
+    Vector<SharedPtr<HttpClientWorker> > workers_;
+    /// Statistics. Guarded by the mutex.
+    HttpClientStats stats_;
+    /// Mutex for synchronizing the worker threads and the main thread.
+    mutable Mutex mutex_;
+    /// Mutex for the download rate limit.
+    Mutex rateMutex_;
+    /// Timer for refilling the download rate limit.
+    HiresTimer rateTimer_;
+    /// Bytes available under the download rate limit.
+    long long rateBytes_;
+    /// Last assigned batch ID.
+    unsigned lastBatchID_;
+    /// Number of worker threads.
+    unsigned maxConcurrentRequests_;
+    /// Connections per host.
+    unsigned maxConnectionsPerHost_;
+    /// Download rate limit.
+    unsigned maxDownloadRate_;
+    /// Idle connection timeout.
+    unsigned idleConnectionTimeout_;
+    /// Response timeout.
+    unsigned requestTimeout_;
+};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "./Connection.h"
+#include "./HttpClient.h"
 #include "./HttpRequest.h"
 #include "./Network.h"
 #include "./NetworkEvents.h"
@@ -124,4 +124,20 @@ ATOMIC_EVENT(E_NETWORKSTRINGMESSAGE, NetworkStringMessage)
 
 // ATOMIC END
 
+/// HTTP client request finished, successfully or not. Not sent for requests of a batch.
+ATOMIC_EVENT(E_HTTPREQUESTCOMPLETED, HttpRequestCompleted)
+{
+    ATOMIC_PARAM(P_REQUEST, Request);            // HttpClientRequest pointer
+    ATOMIC_PARAM(P_SUCCESS, Success);            // bool
+    ATOMIC_PARAM(P_STATUSCODE, StatusCode);      // int
+}
+
+/// All requests of an HTTP client batch finished.
+ATOMIC_EVENT(E_HTTPBATCHCOMPLETED, HttpBatchCompleted)
+{
+    ATOMIC_PARAM(P_BATCHID, BatchID);            // unsigned
+    ATOMIC_PARAM(P_NUMREQUESTS, NumRequests);    // unsigned
+    ATOMIC_PARAM(P_NUMFAILED, NumFailed);        // unsigned
+}
+
 }
@@ -19,9 +19,13 @@ namespace Atomic
         object_ = nullptr;
         shadowData_.Reset();
         size_ = 0;
+        ringSize_ = 0;
+        ringStride_ = 0;
+        ringOffset_ = 0;
+        bindOffset_ = 0;
     }
 
-    bool ConstantBuffer::SetSize(unsigned size)
+    bool ConstantBuffer::SetSize(unsigned size, unsigned ringEntries)
     {
         Release();
         if(!size)
@@ -42,13 +46,22 @@ namespace Atomic
         if (!graphics_)
             return true;
 
+        // Ring entries must start at the device's constant buffer offset alignment
+        const auto alignment = graphics_->GetImpl()->GetDevice()->GetAdapterInfo().Buffer.ConstantBufferOffsetAlignment;
+        if (ringEntries > 1 && alignment)
+        {
+            ringStride_ = (size_ + alignment - 1) / alignment * alignment;
+            ringSize_ = ringStride_ * ringEntries;
+            ringOffset_ = ringSize_;
+        }
+
         using namespace Diligent;
         BufferDesc buffer_desc = {};
         buffer_desc.Name = dbg_name_.CString();
         buffer_desc.Usage = USAGE_DYNAMIC;
         buffer_desc.BindFlags = BIND_UNIFORM_BUFFER;
         buffer_desc.CPUAccessFlags = CPU_ACCESS_WRITE;
-        buffer_desc.Size = size_;
+        buffer_desc.Size = ringSize_ ? ringSize_ : size_;
 
         IBuffer* buffer = nullptr;
         graphics_->GetImpl()->GetDevice()->CreateBuffer(buffer_desc, nullptr, &buffer);
@@ -70,14 +83,25 @@ namespace Atomic
 
         using namespace Diligent;
         auto buffer = object_.Cast<IBuffer>(IID_Buffer);
+        // A ring is only discarded when it is full or a new frame starts. Otherwise the data is written to the next
+        // entry without waiting for the GPU, as the entries before it are still in use
+        const bool discard = !ringSize_ || ringOffset_ + ringStride_ > ringSize_;
+        if (ringSize_ && discard)
+            ringOffset_ = 0;
+
         void* mapped_data = nullptr;
-        graphics_->GetImpl()->GetDeviceContext()->MapBuffer(buffer, MAP_WRITE, MAP_FLAG_DISCARD, mapped_data);
+        graphics_->GetImpl()->GetDeviceContext()->MapBuffer(buffer, MAP_WRITE,
+            discard ? MAP_FLAG_DISCARD : MAP_FLAG_NO_OVERWRITE, mapped_data);
 
         if (!mapped_data)
             return;
 
-        memcpy(mapped_data, shadowData_.Get(), size_);
+        memcpy(static_cast<uint8_t*>(mapped_data) + ringOffset_, shadowData_.Get(), size_);
         graphics_->GetImpl()->GetDeviceContext()->UnmapBuffer(buffer, MAP_WRITE);
+        graphics_->AddConstantBufferMap(size_, discard);
+
+        bindOffset_ = ringOffset_;
+        ringOffset_ += ringStride_;
         dirty_ = false;
     }
 }
@@ -65,7 +65,8 @@ namespace REngine
         engine_factory_(nullptr),
         device_contexts_({}),
         render_device_(nullptr),
-        swap_chain_(nullptr)
+        swap_chain_(nullptr),
+        constant_buffer_ring_entries_(DEFAULT_CONSTANT_BUFFER_RING_ENTRIES)
     {
         // Setup default constant buffer sizes for Vertex Shaders
         SetConstantBufferSize(Atomic::VS, Atomic::SP_FRAME, 64/*i can't have a cbuffer too small*/);
@@ -321,7 +322,7 @@ namespace REngine
 		constant_buffers_[index] = buffer;
 
         // Every time we update default constant buffers, we need to update SRB caches too.
-        srb_cache_update_default_cbuffers(type, group, buffer->GetGPUObject().Cast<Diligent::IBuffer>(Diligent::IID_Buffer));
+        srb_cache_update_default_cbuffers(type, group, buffer);
         return buffer;
     }
 
@@ -348,6 +349,13 @@ namespace REngine
                 constant_buffers_[i]->MakeDirty();
     }
 
+    void DriverInstance::ResetConstantBufferRings()
+    {
+        for (u32 i = 0; i < _countof(constant_buffers_); ++i)
+            if (constant_buffers_[i])
+                constant_buffers_[i]->ResetRing();
+    }
+
     void DriverInstance::InitDefaultConstantBuffers()
     {
         for(uint8_t i =0; i < static_cast<uint8_t>(MAX_SHADER_TYPES); ++i)
@@ -371,7 +379,7 @@ namespace REngine
 
         const auto constant_buffer = new ConstantBuffer(graphics_->GetContext());
         constant_buffer->SetDebugName(name);
-        constant_buffer->SetSize(size);
+        constant_buffer->SetSize(size, constant_buffer_ring_entries_);
 
 		return SharedPtr<ConstantBuffer>(constant_buffer);
     }
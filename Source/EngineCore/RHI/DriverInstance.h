@@ -17,6 +17,9 @@ namespace Atomic
 }
 namespace REngine
 {
+    /// Default number of entries in the ring of each default constant buffer.
+    static constexpr u32 DEFAULT_CONSTANT_BUFFER_RING_ENTRIES = 64;
+
     struct DriverInstanceInitDesc
     {
         /// Specify Driver Backend. Default is OpenGL
@@ -75,10 +78,31 @@ namespace REngine
             constant_buffers_[index] = nullptr;
         }
 
+        /// Set number of ring entries of the default constant buffers, so that many applies fit a frame without
+        /// discarding. 0 or 1 disables rings. Buffers are recreated on next use.
+        void SetConstantBufferRingEntries(u32 entries)
+        {
+            constant_buffer_ring_entries_ = entries;
+            for (u32 i = 0; i < _countof(constant_buffers_); ++i)
+                constant_buffers_[i] = nullptr;
+        }
+        u32 GetConstantBufferRingEntries() const { return constant_buffer_ring_entries_; }
+
         Atomic::SharedPtr<Atomic::ConstantBuffer> GetConstantBuffer(Atomic::ShaderType type, Atomic::ShaderParameterGroup group);
+        /// Return default constant buffer by index without creating it.
+        Atomic::ConstantBuffer* GetConstantBufferAt(u32 index) const
+        {
+            return index < _countof(constant_buffers_) ? constant_buffers_[index].Get() : nullptr;
+        }
         void UploadBufferChanges();
         void ClearConstantBuffers();
         void MakeBuffersAsDirty();
+        /// Discard constant buffer rings on their next upload. Called on frame begin.
+        void ResetConstantBufferRings();
+        static uint8_t GetConstantBufferIndex(Atomic::ShaderType type, Atomic::ShaderParameterGroup group)
+        {
+	        return static_cast<uint8_t>(type) * static_cast<uint8_t>(Atomic::MAX_SHADER_PARAMETER_GROUPS) + static_cast<uint8_t>(group);
+		}
     private:
         void InitDefaultConstantBuffers();
         Atomic::SharedPtr<Atomic::ConstantBuffer> CreateConstantBuffer(Atomic::ShaderType type, Atomic::ShaderParameterGroup grp, uint32_t size) const;
@@ -88,10 +112,6 @@ namespace REngine
             const char* file,
             int line);
         unsigned FindBestAdapter(unsigned adapter_id, Atomic::GraphicsBackend backend) const;
-    	static uint8_t GetConstantBufferIndex(Atomic::ShaderType type, Atomic::ShaderParameterGroup group)
-        {
-	        return static_cast<uint8_t>(type) * static_cast<uint8_t>(Atomic::MAX_SHADER_PARAMETER_GROUPS) + static_cast<uint8_t>(group);
-		}
 
         Atomic::Graphics* graphics_;
         Atomic::GraphicsBackend backend_;
@@ -102,6 +122,7 @@ namespace REngine
         Diligent::RefCntAutoPtr<Diligent::ISwapChain> swap_chain_;
 
         uint8_t multisample_;
+        u32 constant_buffer_ring_entries_;
         uint32_t constant_buffer_sizes_[static_cast<uint8_t>(Atomic::MAX_SHADER_PARAMETER_GROUPS) * static_cast<uint8_t>(Atomic::MAX_SHADER_TYPES)];
         Atomic::SharedPtr<Atomic::ConstantBuffer> constant_buffers_[static_cast<uint8_t>(Atomic::MAX_SHADER_PARAMETER_GROUPS) * static_cast<uint8_t>(Atomic::MAX_SHADER_TYPES)];
     };
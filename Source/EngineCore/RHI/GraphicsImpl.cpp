@@ -11,7 +11,9 @@
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Shader.h"
+#include "../Graphics/ShaderCacheArchive.h"
 #include "../Graphics/ShaderPrecache.h"
+#include "../Graphics/ShaderVariation.h"
 #include "../Graphics/Texture2D.h"
 #include "../Graphics/TextureCube.h"
 #include "../Graphics/VertexBuffer.h"
@@ -345,6 +347,7 @@ namespace Atomic
 		// TODO: use Shaders instead of Shaders/SpirV
 		shaderPath_("Shaders/SpirV/"),
 		shaderExtension_(".glsl"),
+		asyncShaderCompile_(false),
 		orientations_("LandscapeLeft LandscapeRight"),
 		apiName_("DiligentCore")
 	{
@@ -798,6 +801,10 @@ namespace Atomic
 				return false;
 		}
 
+		UpdateCompilingShaders();
+		UpdateConstantBufferStats();
+		impl_->ResetConstantBufferRings();
+
 		if(draw_command_)
 			draw_command_->Reset();
 		SendEvent(E_BEGINRENDERING);
@@ -1,7 +1,7 @@
 #include "./PipelineStateBuilder.h"
 #include "./DiligentUtils.h"
 #include "./DriverInstance.h"
-#include "../Container/HashMap.h"
+#include "../Container/FlatHashMap.h"
 #include "../Container/Hash.h"
 #include "../IO/Log.h"
 #include "../Graphics/ShaderVariation.h"
@@ -10,8 +10,9 @@
 
 namespace REngine
 {
-    static Atomic::HashMap<unsigned, Diligent::RefCntAutoPtr<Diligent::IPipelineState>> s_pipelines;
-    static Atomic::HashMap<unsigned, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> s_srb;
+    static Atomic::FlatHashMap<unsigned, Diligent::RefCntAutoPtr<Diligent::IPipelineState>> s_pipelines;
+    static Atomic::FlatHashMap<unsigned, Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding>> s_srb;
+    static Atomic::FlatHashMap<unsigned, ShaderResourceBindingConstantBuffers> s_srb_cbuffers;
 
     static uint8_t s_num_components_tbl[] = {
         1,
@@ -405,6 +406,7 @@ namespace REngine
     {
         s_pipelines.Clear();
         s_srb.Clear();
+        s_srb_cbuffers.Clear();
     }
 
     uint32_t pipeline_state_builder_items_count()
@@ -412,6 +414,16 @@ namespace REngine
 	    return s_pipelines.Size();
 	}
 
+    static void srb_bind_cbuffer(Diligent::IShaderResourceVariable* var, Atomic::ConstantBuffer* cbuffer, Diligent::SET_SHADER_RESOURCE_FLAGS flags)
+    {
+        const auto buffer = cbuffer->GetGPUObject().Cast<Diligent::IBuffer>(Diligent::IID_Buffer);
+        // Ring buffers are bound with the range of a single entry, which is then moved by dynamic offset
+        if (cbuffer->IsRing())
+            var->SetBufferRange(buffer, 0, cbuffer->GetSize(), 0, flags);
+        else
+            var->Set(buffer, flags);
+    }
+
     Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pipeline_state_builder_get_or_create_srb(const ShaderResourceBindingCreateDesc& desc)
     {
         u32 key = desc.pipeline_hash;
@@ -426,6 +438,8 @@ namespace REngine
         if(s_srb.Contains(key))
         {
             auto srb = s_srb[key];
+            if (desc.constant_buffers)
+                *desc.constant_buffers = s_srb_cbuffers[key];
             return srb;
         }
 
@@ -442,6 +456,8 @@ namespace REngine
         pipeline->CreateShaderResourceBinding(&srb, true);
 
         s_srb[key] = srb;
+        auto& cbuffer_vars = s_srb_cbuffers[key];
+        cbuffer_vars = {};
 
         // Bind Constant Buffers
         for(u8 type = 0; type < MAX_SHADER_TYPES; ++type)
@@ -454,10 +470,14 @@ namespace REngine
 	            const auto name = utils_get_shader_parameter_group_name(shader_type, group);
 
 				const auto var = srb->GetVariableByName(d_shader_type, name);
-                if (var)
-                    var->Set(desc.driver->GetConstantBuffer(shader_type, group)->GetGPUObject().Cast<Diligent::IBuffer>(Diligent::IID_Buffer));
+                if (!var)
+                    continue;
+                srb_bind_cbuffer(var, desc.driver->GetConstantBuffer(shader_type, group), Diligent::SET_SHADER_RESOURCE_FLAG_NONE);
+                cbuffer_vars.variables[DriverInstance::GetConstantBufferIndex(shader_type, group)] = var;
 			}
 		}
+        if (desc.constant_buffers)
+            *desc.constant_buffers = cbuffer_vars;
 
         for(const auto& it : *desc.resources)
         {
@@ -474,7 +494,7 @@ namespace REngine
         return srb;
     }
 
-    void srb_cache_update_default_cbuffers(const Atomic::ShaderType type, const Atomic::ShaderParameterGroup grp, Diligent::IBuffer* cbuffer)
+    void srb_cache_update_default_cbuffers(const Atomic::ShaderType type, const Atomic::ShaderParameterGroup grp, Atomic::ConstantBuffer* cbuffer)
     {
         using namespace Diligent;
         const auto name = utils_get_shader_parameter_group_name(type, grp);
@@ -485,13 +505,14 @@ namespace REngine
 	        const auto srb = it.second_;
             const auto var = srb->GetVariableByName(shader_type, name);
             if(var)
-                var->Set(cbuffer, SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
+                srb_bind_cbuffer(var, cbuffer, SET_SHADER_RESOURCE_FLAG_ALLOW_OVERWRITE);
         }
     }
 
     void srb_cache_release()
     {
 		s_srb.Clear();
+        s_srb_cbuffers.Clear();
     }
 
     uint32_t srb_cache_items_count()
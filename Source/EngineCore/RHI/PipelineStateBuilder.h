@@ -5,6 +5,11 @@
 #include <DiligentCore/Graphics/GraphicsEngine/interface/ShaderResourceBinding.h>
 #include <DiligentCore/Graphics/GraphicsEngine/interface/Buffer.h>
 
+namespace Atomic
+{
+    class ConstantBuffer;
+}
+
 namespace REngine
 {
     /**
@@ -29,11 +34,20 @@ namespace REngine
 
     uint32_t pipeline_state_builder_items_count();
 
+    /// Constant buffer variables of a shader resource binding, indexed by DriverInstance::GetConstantBufferIndex.
+    /// Used to set the dynamic offset of ring constant buffers.
+    struct ShaderResourceBindingConstantBuffers
+    {
+        Diligent::IShaderResourceVariable* variables[Atomic::MAX_SHADER_TYPES * Atomic::MAX_SHADER_PARAMETER_GROUPS]{};
+    };
+
     struct ShaderResourceBindingCreateDesc
     {
         DriverInstance* driver{nullptr};
         u32 pipeline_hash{0};
         ShaderResourceTextures* resources{nullptr};
+        /// Optional output of the constant buffer variables of the binding.
+        ShaderResourceBindingConstantBuffers* constant_buffers{nullptr};
     };
     /**
      * \brief get or create a shader resource binding from an pipeline hash
@@ -41,7 +55,7 @@ namespace REngine
      */
     Diligent::RefCntAutoPtr<Diligent::IShaderResourceBinding> pipeline_state_builder_get_or_create_srb(const ShaderResourceBindingCreateDesc& desc);
 
-    void srb_cache_update_default_cbuffers(const Atomic::ShaderType type, const Atomic::ShaderParameterGroup grp, Diligent::IBuffer* cbuffer);
+    void srb_cache_update_default_cbuffers(const Atomic::ShaderType type, const Atomic::ShaderParameterGroup grp, Atomic::ConstantBuffer* cbuffer);
     /**
      * \brief release cached shader resource bindings
      */
@@ -94,6 +94,48 @@ namespace REngine
         Atomic::StringVector samplers_{};
     };
 
+    /// Shader compiler and options owned by a single thread. Creating a compiler is expensive, so each thread that
+    /// compiles shaders keeps its instance for its lifetime instead of creating one per shader.
+    struct ThreadShaderCompiler
+    {
+        shaderc_compiler_t compiler;
+        shaderc_compile_options_t preprocess_options;
+        shaderc_compile_options_t compile_options;
+
+        ThreadShaderCompiler()
+        {
+            compiler = shaderc_compiler_initialize();
+
+            preprocess_options = shaderc_compile_options_initialize();
+            shaderc_compile_options_set_source_language(preprocess_options, shaderc_source_language_glsl);
+            shaderc_compile_options_set_optimization_level(preprocess_options, shaderc_optimization_level_performance);
+            shaderc_compile_options_set_target_env(preprocess_options, shaderc_target_env_opengl, 0);
+            shaderc_compile_options_set_auto_map_locations(preprocess_options, true);
+            shaderc_compile_options_set_auto_bind_uniforms(preprocess_options, true);
+
+            compile_options = shaderc_compile_options_initialize();
+            shaderc_compile_options_set_source_language(compile_options, shaderc_source_language_glsl);
+            shaderc_compile_options_set_optimization_level(compile_options, shaderc_optimization_level_size);
+            shaderc_compile_options_set_target_env(compile_options, shaderc_target_env_opengl, 0);
+            shaderc_compile_options_set_auto_map_locations(compile_options, true);
+            shaderc_compile_options_set_auto_bind_uniforms(compile_options, true);
+            shaderc_compile_options_set_generate_debug_info(compile_options);
+        }
+
+        ~ThreadShaderCompiler()
+        {
+            shaderc_compile_options_release(compile_options);
+            shaderc_compile_options_release(preprocess_options);
+            shaderc_compiler_release(compiler);
+        }
+    };
+
+    static const ThreadShaderCompiler& get_thread_compiler()
+    {
+        static thread_local ThreadShaderCompiler s_compiler;
+        return s_compiler;
+    }
+
     static shaderc_shader_kind get_shader_kind(Atomic::ShaderType type)
     {
         constexpr shaderc_shader_kind shader_type_tbl[MAX_SHADER_TYPES] = {
@@ -104,6 +146,18 @@ namespace REngine
         return shader_type_tbl[type];
     }
 
+    // Hash a name without registering it as a significant string, as reflection and shader binaries are processed on
+    // worker threads while the registry is not thread-safe
+    static Atomic::StringHash get_name_hash(const char* str, size_t length)
+    {
+        return Atomic::StringHash(Atomic::StringHash::Calculate(str, static_cast<unsigned>(length), 0));
+    }
+
+    static Atomic::StringHash get_name_hash(const Atomic::String& str)
+    {
+        return get_name_hash(str.CString(), str.Length());
+    }
+
     static Atomic::VertexElementType get_element_type(const spirv_cross::SPIRType& type)
     {
         Atomic::VertexElementType result = Atomic::MAX_VERTEX_ELEMENT_TYPES;
@@ -149,21 +203,14 @@ namespace REngine
             source_code.Replace("#version 300 es", "#version 450");
         }
 
-        const auto compiler = shaderc_compiler_initialize();
-        const auto options = shaderc_compile_options_initialize();
-        shaderc_compile_options_set_source_language(options, shaderc_source_language_glsl);
-        shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
-        shaderc_compile_options_set_target_env(options, shaderc_target_env_opengl, 0);
-        shaderc_compile_options_set_auto_map_locations(options, true);
-        shaderc_compile_options_set_auto_bind_uniforms(options, true);
-
-        const auto result = shaderc_compile_into_preprocessed_text(compiler,
+        const auto& compiler = get_thread_compiler();
+        const auto result = shaderc_compile_into_preprocessed_text(compiler.compiler,
             source_code.CString(),
             source_code.Length(),
             get_shader_kind(desc.type),
             desc.name.CString(),
             "main",
-            options);
+            compiler.preprocess_options);
 
         if(shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success)
         {
@@ -185,8 +232,6 @@ namespace REngine
 
 
         shaderc_result_release(result);
-    	shaderc_compile_options_release(options);
-        shaderc_compiler_release(compiler);
     }
 
     void shader_compiler_compile(const ShaderCompilerDesc& desc, const bool optimize, ShaderCompilerResult& output)
@@ -198,22 +243,14 @@ namespace REngine
             source_code.Replace("#version 300 es", "#version 450");
         }
 
-        const auto compiler = shaderc_compiler_initialize();
-        const auto options = shaderc_compile_options_initialize();
-        shaderc_compile_options_set_source_language(options, shaderc_source_language_glsl);
-        shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_size);
-        shaderc_compile_options_set_target_env(options, shaderc_target_env_opengl, 0);
-        shaderc_compile_options_set_auto_map_locations(options, true);
-        shaderc_compile_options_set_auto_bind_uniforms(options, true);
-        shaderc_compile_options_set_generate_debug_info(options);
-
-        const auto result = shaderc_compile_into_spv(compiler,
+        const auto& compiler = get_thread_compiler();
+        const auto result = shaderc_compile_into_spv(compiler.compiler,
             source_code.CString(),
             source_code.Length(),
             get_shader_kind(desc.type),
             desc.name.CString(),
             "main",
-            options);
+            compiler.compile_options);
 
         if(shaderc_result_get_compilation_status(result) != shaderc_compilation_status_success)
         {
@@ -229,8 +266,6 @@ namespace REngine
         }
 
         shaderc_result_release(result);
-    	shaderc_compile_options_release(options);
-        shaderc_compiler_release(compiler);
     }
 
     void shader_compiler_reflect(const ShaderCompilerReflectDesc& desc, ShaderCompilerReflectInfo& output)
@@ -256,7 +291,7 @@ namespace REngine
             buffer_desc.name = name;
             buffer_desc.size = static_cast<uint32_t>(buffer_size);
             buffer_desc.parameter_group = grp_type;
-            output.constant_buffers[name] = buffer_desc;
+            output.constant_buffers[get_name_hash(name)] = buffer_desc;
 
             if (grp_type != Atomic::MAX_SHADER_PARAMETER_GROUPS)
                 output.constant_buffer_sizes[grp_type] = buffer_desc.size;
@@ -276,9 +311,6 @@ namespace REngine
                 if (member_name.Length() > 0 && member_name[0] == 'c')
                     member_name = member_name.Substring(1);
 
-                if (StringHash(member_name) == Atomic::VSP_MODEL)
-                    member_name = member_name;
-
                 Atomic::ShaderParameter shader_param = {};
                 shader_param.buffer_ = buffer_desc.parameter_group;
                 shader_param.name_ = member_name;
@@ -286,7 +318,7 @@ namespace REngine
                 shader_param.offset_ = member_offset;
                 shader_param.size_ = static_cast<uint32_t>(member_size);
 
-                output.parameters[member_name] = shader_param;
+                output.parameters[get_name_hash(member_name)] = shader_param;
             }
         }
 
@@ -325,7 +357,7 @@ namespace REngine
         for (const auto& image : resources.sampled_images)
         {
             const auto name = ea::string(compiler.get_name(image.id).c_str());
-            const auto hash = Atomic::StringHash(compiler.get_name(image.id).c_str());
+            const auto hash = get_name_hash(name.c_str(), name.length());
             const auto& type = compiler.get_type(image.type_id);
             const auto texture_unit = utils_get_texture_unit(name);
             Atomic::TextureUnitType unit_type = Atomic::TextureUnitType::Undefined;
@@ -450,7 +482,7 @@ namespace REngine
         }
         for (const auto& it : desc.reflect_info->samplers)
         {
-            str_pos_map[StringHash(it.name.c_str()).ToHash()] = file_header.strings_size;
+            str_pos_map[get_name_hash(it.name.c_str(), it.name.length()).ToHash()] = file_header.strings_size;
             file_header.strings_size += it.name.length() + 1;
         }
         for (const auto& it : desc.reflect_info->constant_buffers)
@@ -460,7 +492,7 @@ namespace REngine
         }
         for (const auto& it : desc.reflect_info->input_elements)
         {
-            str_pos_map[StringHash(it.name).ToHash()] = file_header.strings_size;
+            str_pos_map[get_name_hash(it.name).ToHash()] = file_header.strings_size;
             file_header.strings_size += it.name.Length() + 1;
         }
         file_header.strings_size += 1;
@@ -635,7 +667,7 @@ namespace REngine
             parameter.buffer_ = param.buffer_idx;
             parameter.offset_ = param.offset;
             parameter.size_ = param.size;
-            result.reflect_info.parameters[name] = parameter;
+            result.reflect_info.parameters[get_name_hash(name)] = parameter;
         }
 
         memset(&result.reflect_info.used_texture_units, 0x0, sizeof(bool) * MAX_TEXTURE_UNITS);
@@ -644,7 +676,7 @@ namespace REngine
             const auto name = ea::string(static_cast<char*>(static_cast<void*>(str_buffer + textures[i].name_idx)));
             TextureSampler sampler = {
             	name,
-            	StringHash(name.c_str()),
+            	get_name_hash(name.c_str(), name.length()),
             	textures[i].unit,
             	textures[i].unit_type
             };
@@ -664,7 +696,7 @@ namespace REngine
             buffer_desc.size = buffer.size;
             buffer_desc.parameter_group = utils_get_shader_parameter_group_type(file_header->type, name);
             
-            result.reflect_info.constant_buffers[name] = buffer_desc;
+            result.reflect_info.constant_buffers[get_name_hash(name)] = buffer_desc;
             if(buffer_desc.parameter_group == MAX_SHADER_PARAMETER_GROUPS)
                 result.reflect_info.constant_buffer_sizes[buffer_desc.parameter_group] = buffer_desc.size;
         }
@@ -3,8 +3,11 @@
 #include "./DiligentUtils.h"
 #include "./DriverInstance.h"
 #include "./ShaderCompiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Shader.h"
+#include "../Graphics/ShaderCacheArchive.h"
 #include "../Graphics/ShaderVariation.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/File.h"
@@ -17,17 +20,96 @@
 #include <DiligentCore/Graphics/GraphicsEngine/interface/Shader.h>
 #include <DiligentCore/Graphics/GraphicsTools/interface/ShaderMacroHelper.hpp>
 
+#include <atomic>
+
 namespace Atomic
 {
-    static const char* s_shader_file_id = "RSHD";
-    static ea::array<const char*, static_cast<u32>(GraphicsBackend::Max) + 1> s_shader_backend_name = {
-        "D3D11",
-        "D3D12",
-        "Vk",
-        "GL",
-        "GLES"
+    /// Shader compile work for one variation. Filled on the main thread, compiled from source on any thread, and
+    /// turned into a GPU shader on the main thread again.
+    struct ShaderCompileTask
+    {
+        /// Compiler input with the full source code.
+        REngine::ShaderCompilerDesc desc_;
+        /// Shader cache key of the source code.
+        unsigned long long key_{0};
+        /// Preprocessed GLSL source, or HLSL source on Direct3D.
+        String source_;
+        /// SPIR-V bytecode.
+        ea::vector<u8> spirv_;
+        /// Reflection of the compiled shader.
+        REngine::ShaderCompilerReflectInfo reflectInfo_;
+        /// Compiler error output. Empty if successful.
+        String error_;
+        /// Work item when compiling asynchronously.
+        SharedPtr<WorkItem> item_;
+        /// Work queue the item was added to.
+        WeakPtr<WorkQueue> queue_;
+        /// Time since the compile was queued.
+        HiresTimer timer_;
+        /// Set by the worker thread when the compile has finished.
+        std::atomic<bool> completed_{false};
     };
 
+    /// Work item priority of asynchronous shader compiles. Lowest, so that waiting for frame work never waits for them.
+    static const unsigned SHADER_COMPILE_PRIORITY = 0;
+
+    /// Preprocess, compile and reflect the source of a compile task. Touches only the task, so it is safe to call from
+    /// worker threads.
+    static void CompileShaderSource(ShaderCompileTask& task)
+    {
+        // Preprocess shader before compile
+        REngine::ShaderCompilerPreProcessResult pre_process_result = {};
+        REngine::shader_compiler_preprocess(task.desc_, pre_process_result);
+
+        if(pre_process_result.has_error)
+        {
+            task.error_ = pre_process_result.error.Empty() ? "Failed to preprocess shader " + task.desc_.name : pre_process_result.error;
+            return;
+        }
+
+        // Put pre-processed shader code and compile to obtain spirv bytecode
+        REngine::ShaderCompilerDesc compiler_desc = task.desc_;
+        compiler_desc.source_code = pre_process_result.source_code;
+#ifdef ENGINE_PLATFORM_WINDOWS
+        // OpenGL ES on windows is emulated. we must change version to 4.5
+        if (compiler_desc.backend == GraphicsBackend::OpenGLES)
+            compiler_desc.source_code = compiler_desc.source_code.Replaced("#version 300 es", "#version 450");
+#endif
+
+        REngine::ShaderCompilerResult result = {};
+        REngine::shader_compiler_compile(compiler_desc, true, result);
+        if (result.has_error)
+        {
+            task.error_ = result.error.Empty() ? "Failed to compile shader " + task.desc_.name : result.error;
+            return;
+        }
+
+        REngine::ShaderCompilerReflectDesc reflect_desc = {
+            result.spirv_code.data(),
+            static_cast<u32>(result.spirv_code.size()),
+            compiler_desc.type
+        };
+        REngine::shader_compiler_reflect(reflect_desc, task.reflectInfo_);
+
+        const auto backend = compiler_desc.backend;
+#if ENGINE_PLATFORM_WINDOWS
+        // On D3D, spirv code needs to be converted to HLSL
+        if (backend == GraphicsBackend::D3D11 || backend == GraphicsBackend::D3D12)
+            REngine::shader_compiler_to_hlsl({result.spirv_code.data(), static_cast<u32>(result.spirv_code.size())}, task.source_);
+#endif
+        if (backend == GraphicsBackend::OpenGL || backend == GraphicsBackend::OpenGLES)
+            task.source_ = pre_process_result.source_code;
+
+        task.spirv_ = ea::move(result.spirv_code);
+    }
+
+    static void CompileShaderWork(const WorkItem* item, unsigned threadIndex)
+    {
+        ShaderCompileTask* task = reinterpret_cast<ShaderCompileTask*>(item->aux_);
+        CompileShaderSource(*task);
+        task->completed_ = true;
+    }
+
     void ShaderVariation::OnDeviceLost()
     {
         // No-op on Direct3D11
@@ -46,39 +128,185 @@ namespace Atomic
             return false;
         }
 
-        // Check for up-to-date bytecode on disk
-        String path, name, extension;
-        SplitPath(owner_->GetName(), path, name, extension);
-        REngine::shader_compiler_get_file_ext(type_, extension);
-
-        const auto backend = graphics_->GetBackend();
-        const String binary_shader_name = graphics_->GetShaderCacheDir()
-    	    + String(s_shader_backend_name[static_cast<u32>(backend)])
-            + String("/")
-    	    + name + "_"
-    	    + StringHash(defines_).ToString()
-            + extension;
+        ShaderCompileTask task;
+        if (!PrepareCompile(task, graphics_->GetBackend()))
+        {
+            compilerOutput_ = task.error_;
+            ATOMIC_LOGERROR(compilerOutput_);
+            return false;
+        }
 
+        // Check for up-to-date bytecode in the shader caches
         BuildHash();
-        if (!LoadByteCode(binary_shader_name))
+        if (!LoadFromCache(task))
         {
+            // Compile shader if don't have valid bytecode
+            CompileShaderSource(task);
+            if (!task.error_.Empty())
+            {
+                compilerOutput_ = task.error_;
+                ATOMIC_LOGERROR(compilerOutput_);
+                return false;
+            }
+
             ea::shared_array<u8> shader_file_data;
             u32 shader_file_size = 0;
-            // Compile shader if don't have valid bytecode
-            if (!Compile(shader_file_data, &shader_file_size)) 
+            if (!CreateFromCompiled(task, shader_file_data, &shader_file_size))
             {
                 ATOMIC_LOGERROR(compilerOutput_);
                 return false;
             }
-            // Save Shader File
-            SaveByteCode(binary_shader_name, shader_file_data, shader_file_size);
+            SaveToCache(task, shader_file_data, shader_file_size);
         }
 
         return object_ != nullptr;
     }
 
+    bool ShaderVariation::CreateAsync()
+    {
+        if (object_ || compileTask_)
+            return true;
+
+        WorkQueue* queue = graphics_ ? graphics_->GetSubsystem<WorkQueue>() : nullptr;
+        if (!queue)
+            return Create();
+
+        Release();
+
+        if (!owner_)
+        {
+            compilerOutput_ = "Owner shader has expired";
+            return false;
+        }
+
+        compileTask_ = new ShaderCompileTask();
+        if (!PrepareCompile(*compileTask_, graphics_->GetBackend()))
+        {
+            compilerOutput_ = compileTask_->error_;
+            delete compileTask_;
+            compileTask_ = nullptr;
+            ATOMIC_LOGERROR(compilerOutput_);
+            return false;
+        }
+
+        // Loading bytecode from the shader cache is cheap, so only compiles from source are deferred
+        BuildHash();
+        if (LoadFromCache(*compileTask_))
+        {
+            delete compileTask_;
+            compileTask_ = nullptr;
+            return true;
+        }
+
+        SharedPtr<WorkItem> item(new WorkItem());
+        item->priority_ = SHADER_COMPILE_PRIORITY;
+        item->workFunction_ = CompileShaderWork;
+        item->aux_ = compileTask_;
+        compileTask_->item_ = item;
+        compileTask_->queue_ = queue;
+        compileTask_->timer_.Reset();
+
+        graphics_->AddCompilingShader(this);
+        queue->AddWorkItem(item);
+        return true;
+    }
+
+    bool ShaderVariation::Bake(GraphicsBackend backend, unsigned long long& key, ea::shared_array<u8>& shader_file_data,
+                               u32& shader_file_size, String& error) const
+    {
+        if (backend == GraphicsBackend::D3D11 || backend == GraphicsBackend::D3D12)
+        {
+            // Direct3D bytecode is produced by the device from the converted HLSL source
+            error = "Baking Direct3D shaders is not supported";
+            return false;
+        }
+
+        if (!owner_)
+        {
+            error = "Owner shader has expired";
+            return false;
+        }
+
+        ShaderCompileTask task;
+        if (!PrepareCompile(task, backend))
+        {
+            error = task.error_;
+            return false;
+        }
+
+        key = task.key_;
+
+        CompileShaderSource(task);
+        if (!task.error_.Empty())
+        {
+            error = task.error_;
+            return false;
+        }
+
+        REngine::ShaderCompilerBinDesc bin_desc = {};
+        if (backend == GraphicsBackend::Vulkan)
+        {
+            bin_desc.byte_code = task.spirv_.data();
+            bin_desc.byte_code_size = task.spirv_.size();
+            bin_desc.byte_code_type = ShaderByteCodeType::SpirV;
+        }
+        else
+        {
+            bin_desc.byte_code = const_cast<char*>(task.source_.CString());
+            bin_desc.byte_code_size = task.source_.Length();
+            bin_desc.byte_code_type = ShaderByteCodeType::Raw;
+        }
+        bin_desc.type = type_;
+        bin_desc.shader_hash = CalculateHash();
+        bin_desc.reflect_info = &task.reflectInfo_;
+
+        shader_file_data = REngine::shader_compiler_to_bin(bin_desc, &shader_file_size);
+        return true;
+    }
+
+    void ShaderVariation::FinishAsyncCreate()
+    {
+        if (!compileTask_ || !compileTask_->completed_)
+            return;
+
+        ShaderCompileTask* task = compileTask_;
+        compileTask_ = nullptr;
+        compileTime_ = static_cast<float>(task->timer_.GetUSec(false)) / 1000.0f;
+
+        if (!task->error_.Empty())
+        {
+            compilerOutput_ = task->error_;
+            ATOMIC_LOGERROR(compilerOutput_);
+        }
+        else if (graphics_ && owner_)
+        {
+            ea::shared_array<u8> shader_file_data;
+            u32 shader_file_size = 0;
+            if (CreateFromCompiled(*task, shader_file_data, &shader_file_size))
+                SaveToCache(*task, shader_file_data, shader_file_size);
+            else
+                ATOMIC_LOGERROR(compilerOutput_);
+        }
+
+        delete task;
+    }
+
     void ShaderVariation::Release()
     {
+        if (compileTask_)
+        {
+            // The worker thread writes into the task, so a compile that has already started must be waited for
+            WorkQueue* queue = compileTask_->queue_;
+            if (queue && !queue->RemoveWorkItem(compileTask_->item_))
+            {
+                while (!compileTask_->completed_)
+                    Time::Sleep(0);
+            }
+
+            delete compileTask_;
+            compileTask_ = nullptr;
+        }
+
         if (!graphics_)
             return;
         if (object_)
@@ -120,31 +348,46 @@ namespace Atomic
             definesClipPlane_ += " CLIPPLANE";
     }
 
-    bool ShaderVariation::LoadByteCode(const String& binaryShaderName)
+    bool ShaderVariation::LoadFromCache(const ShaderCompileTask& task)
     {
-        ResourceCache* cache = owner_->GetSubsystem<ResourceCache>();
-        if (!cache->Exists(binaryShaderName))
-            return false;
-
-        const SharedPtr<File> file = cache->GetFile(binaryShaderName);
-        if (!file || file->ReadFileID() != s_shader_file_id)
+        // Baked archive first, then the shaders compiled at runtime
+        ShaderCacheArchive* caches[] = { graphics_->GetShaderCacheArchive(), graphics_->GetShaderCacheStore() };
+        for (ShaderCacheArchive* cache : caches)
         {
-            ATOMIC_LOGERROR(binaryShaderName + " is not a valid shader bytecode file");
-            return false;
+            const unsigned char* data = nullptr;
+            unsigned size = 0;
+            if (!cache || !cache->FindEntry(task.key_, data, size))
+                continue;
+
+            // Importing only reads the data, so it is used in place
+            if (CreateFromByteCode(const_cast<unsigned char*>(data), size, cache->GetFileName().Length() ?
+                cache->GetFileName() : String("shader cache archive")))
+                return true;
+
+            // Stale or unusable for this device. Forget the entry so that the recompiled shader replaces it
+            if (cache == graphics_->GetShaderCacheStore())
+                cache->RemoveEntry(task.key_);
         }
 
-        const auto file_size = file->GetSize() - 4;
-        if(file_size == 0)
-        {
-            ATOMIC_LOGERROR(binaryShaderName + " has zero bytes");
-            return false;
-        }
+        return false;
+    }
 
-        const SharedArrayPtr<uint8_t> byte_code(static_cast<uint8_t*>(malloc(file_size)));
-        file->Read(byte_code.Get(), file_size);
+    void ShaderVariation::SaveToCache(const ShaderCompileTask& task, const ea::shared_array<u8>& shader_file_data, u32 shader_file_size)
+    {
+        ShaderCacheArchive* store = graphics_->GetShaderCacheStore();
+        if (store && shader_file_data)
+            store->AddEntry(task.key_, shader_file_data.get(), shader_file_size);
+    }
 
+    bool ShaderVariation::CreateFromByteCode(void* data, unsigned size, const String& sourceName)
+    {
         REngine::ShaderCompilerImportBinResult bin_result = {};
-        REngine::shader_compiler_import_bin(byte_code, file_size, bin_result);
+        REngine::shader_compiler_import_bin(data, size, bin_result);
+        if (bin_result.has_error)
+        {
+            ATOMIC_LOGERROR(sourceName + ": " + bin_result.error);
+            return false;
+        }
 
         const auto backend = graphics_->GetImpl()->GetBackend();
         if(backend == GraphicsBackend::D3D11 || backend == GraphicsBackend::D3D12)
@@ -169,7 +412,7 @@ namespace Atomic
 
         if(hash_ != bin_result.shader_hash)
         {
-            ATOMIC_LOGWARNINGF("Invalid shader bytecode for %s. It seems that their original shader was changed or shader bytecode is corrupted!", name_.CString());
+            ATOMIC_LOGWARNINGF("Invalid shader bytecode for %s in %s. It seems that their original shader was changed or shader bytecode is corrupted!", name_.CString(), sourceName.CString());
             return false;
         }
 
@@ -220,7 +463,7 @@ namespace Atomic
 
         if(!shader)
         {
-            ATOMIC_LOGERROR("Failed to create shader from Shader File");
+            ATOMIC_LOGERROR("Failed to create shader from " + sourceName);
             return false;
         }
 
@@ -228,15 +471,8 @@ namespace Atomic
         return true;
     }
 
-    bool ShaderVariation::Compile(ea::shared_array<u8>& shader_file_data, u32* shader_file_size)
+    bool ShaderVariation::PrepareCompile(ShaderCompileTask& task, GraphicsBackend backend) const
     {
-        const auto full_name = GetFullName();
-        Diligent::ShaderCreateInfo shader_ci = {};
-        shader_ci.Desc.Name = full_name.CString();
-        shader_ci.Desc.UseCombinedTextureSamplers = true;
-        shader_ci.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL_VERBATIM;
-        shader_ci.Desc.ShaderType = REngine::utils_get_shader_type(type_);
-
         String source_code = owner_->GetSourceCode(type_);
         String entrypoint;
 
@@ -244,8 +480,6 @@ namespace Atomic
         for (const auto& part : defines_.Split(' '))
             defines.push_back(part.CString());
 
-        const auto backend = graphics_->GetImpl()->GetBackend();
-
         switch (backend)
         {
         case GraphicsBackend::D3D11:
@@ -301,7 +535,7 @@ namespace Atomic
             break;
         case MAX_SHADER_TYPES:
         default:
-            ATOMIC_LOGERROR("Invalid Shader type");
+            task.error_ = "Invalid Shader type";
             return false;
         }
 
@@ -345,90 +579,61 @@ namespace Atomic
         source_code.AppendWithFormat("\t%s\n", entrypoint.CString());
         source_code.Append("}");
 
-        REngine::ShaderCompilerReflectInfo reflect_info = {};
-        {
-            REngine::ShaderCompilerDesc compiler_desc = {};
-            compiler_desc.type = type_;
-            compiler_desc.backend = backend;
-            compiler_desc.name = name_.CString();
-            compiler_desc.source_code = source_code;
-
-            // Preprocess shader before compile
-            REngine::ShaderCompilerPreProcessResult pre_process_result = {};
-            REngine::shader_compiler_preprocess(compiler_desc, pre_process_result);
-
-            if(pre_process_result.has_error)
-            {
-                compilerOutput_ = pre_process_result.source_code;
-                return false;
-            }
-
-            // Put pre-processed shader code and compile to obtain spirv bytecode
-            compiler_desc.source_code = pre_process_result.source_code;
-#ifdef ENGINE_PLATFORM_WINDOWS
-            // OpenGL ES on windows is emulated. we must change version to 4.5
-            if (backend == GraphicsBackend::OpenGLES)
-                compiler_desc.source_code = compiler_desc.source_code.Replaced("#version 300 es", "#version 450");
-#endif
-
+        task.desc_.type = type_;
+        task.desc_.backend = backend;
+        task.desc_.name = name_;
+        task.desc_.source_code = source_code;
+        task.key_ = ShaderCacheArchive::CalculateKey(source_code, type_, backend);
+        return true;
+    }
 
-            REngine::ShaderCompilerResult result = {};
-            REngine::shader_compiler_compile(compiler_desc, true, result);
-            if (result.has_error)
-            {
-                compilerOutput_ = result.error;
-                return false;
-            }
+    bool ShaderVariation::CreateFromCompiled(ShaderCompileTask& task, ea::shared_array<u8>& shader_file_data, u32* shader_file_size)
+    {
+        const auto full_name = GetFullName();
+        Diligent::ShaderCreateInfo shader_ci = {};
+        shader_ci.Desc.Name = full_name.CString();
+        shader_ci.Desc.UseCombinedTextureSamplers = true;
+        shader_ci.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_GLSL_VERBATIM;
+        shader_ci.Desc.ShaderType = REngine::utils_get_shader_type(type_);
 
-            REngine::ShaderCompilerReflectDesc reflect_desc = {
-                result.spirv_code.data(),
-                static_cast<u32>(result.spirv_code.size()),
-                type_
-            };
-            REngine::shader_compiler_reflect(reflect_desc, reflect_info);
+        const auto backend = task.desc_.backend;
+        REngine::ShaderCompilerReflectInfo& reflect_info = task.reflectInfo_;
 
-            for (uint8_t i = 0; i < MAX_TEXTURE_UNITS; ++i)
-                useTextureUnit_[i] = reflect_info.used_texture_units[i];
-            for (uint8_t i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
-                constantBufferSizes_[i] = reflect_info.constant_buffer_sizes[i];
+        for (uint8_t i = 0; i < MAX_TEXTURE_UNITS; ++i)
+            useTextureUnit_[i] = reflect_info.used_texture_units[i];
+        for (uint8_t i = 0; i < MAX_SHADER_PARAMETER_GROUPS; ++i)
+            constantBufferSizes_[i] = reflect_info.constant_buffer_sizes[i];
 
-            elementHash_ = reflect_info.element_hash;
-            parameters_ = reflect_info.parameters;
-            input_elements_ = reflect_info.input_elements;
-            textures_ = reflect_info.samplers;
+        elementHash_ = reflect_info.element_hash;
+        parameters_ = reflect_info.parameters;
+        input_elements_ = reflect_info.input_elements;
+        textures_ = reflect_info.samplers;
 
 #if ENGINE_PLATFORM_WINDOWS
-            // On D3D, spirv code needs to be converted to HLSL
-            if (backend == GraphicsBackend::D3D11 || backend == GraphicsBackend::D3D12)
-            {
-                source_code.Clear();
-                REngine::shader_compiler_to_hlsl({result.spirv_code.data(), static_cast<u32>(result.spirv_code.size())}, source_code);
-
-                //ATOMIC_LOGDEBUG(source_code);
-                shader_ci.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
-                shader_ci.Source = source_code.CString();
-                shader_ci.SourceLength = source_code.Length();
-            }
+        if (backend == GraphicsBackend::D3D11 || backend == GraphicsBackend::D3D12)
+        {
+            shader_ci.SourceLanguage = Diligent::SHADER_SOURCE_LANGUAGE_HLSL;
+            shader_ci.Source = task.source_.CString();
+            shader_ci.SourceLength = task.source_.Length();
+        }
 #endif
 
-            if (backend == GraphicsBackend::Vulkan)
-            {
-                byteCode_ = result.spirv_code;
-                shader_ci.ByteCode = byteCode_.data();
-                shader_ci.ByteCodeSize = byteCode_.size();
-            }
-            else if (backend == GraphicsBackend::OpenGL || backend == GraphicsBackend::OpenGLES)
-            {
-                const auto byte_code = reinterpret_cast<const unsigned char*>(pre_process_result.source_code.CString());
-                byteCode_ = ea::vector<u8>(
-                    byte_code,
-                    byte_code + pre_process_result.source_code.Length()
-                );
-                source_code = pre_process_result.source_code;
-                shader_ci.Source = source_code.CString();
-                shader_ci.SourceLength = source_code.Length();
-                shader_ci.EntryPoint = "main";
-            }
+        if (backend == GraphicsBackend::Vulkan)
+        {
+            byteCode_ = task.spirv_;
+            shader_ci.ByteCode = byteCode_.data();
+            shader_ci.ByteCodeSize = byteCode_.size();
+        }
+        else if (backend == GraphicsBackend::OpenGL || backend == GraphicsBackend::OpenGLES)
+        {
+            const auto byte_code = reinterpret_cast<const unsigned char*>(task.source_.CString());
+            byteCode_ = ea::vector<u8>(
+                byte_code,
+                byte_code + task.source_.Length()
+            );
+            shader_ci.Source = task.source_.CString();
+            shader_ci.SourceLength = task.source_.Length();
+            shader_ci.EntryPoint = "main";
         }
 
         Diligent::RefCntAutoPtr<Diligent::IShader> shader;
@@ -440,10 +645,15 @@ namespace Atomic
 
         if (!shader)
         {
-            compilerOutput_ = String(
-                static_cast<const char*>(shader_output->GetDataPtr()), 
-                static_cast<uint32_t>(shader_output->GetSize())
-            );
+            if (shader_output)
+            {
+                compilerOutput_ = String(
+                    static_cast<const char*>(shader_output->GetDataPtr()),
+                    static_cast<uint32_t>(shader_output->GetSize())
+                );
+            }
+            else
+                compilerOutput_ = "Failed to create shader " + full_name;
             return false;
         }
 
@@ -498,41 +708,19 @@ namespace Atomic
         return true;
     }
     
-    void ShaderVariation::SaveByteCode(const String& binaryShaderName, const ea::shared_array<u8>& byte_code,
-                                       const u32 byte_code_len) const
+    void ShaderVariation::BuildHash()
     {
-        const auto cache = owner_->GetSubsystem<ResourceCache>();
-        const auto fileSystem = owner_->GetSubsystem<FileSystem>();
-
-        // Filename may or may not be inside the resource system
-        auto full_name = binaryShaderName;
-        if (!IsAbsolutePath(full_name))
-        {
-            // If not absolute, use the resource dir of the shader
-            const auto shader_file_name = cache->GetResourceFileName(owner_->GetName());
-            if (shader_file_name.Empty())
-                return;
-            full_name = shader_file_name.Substring(0, shader_file_name.Find(owner_->GetName())) + binaryShaderName;
-        }
-        
-        const auto path = GetPath(full_name);
-        if (!fileSystem->DirExists(path))
-            fileSystem->CreateDir(path);
-
-        const SharedPtr file(new File(owner_->GetContext(), full_name, FILE_WRITE));
-        if (!file->IsOpen())
-            return;
-
-        file->WriteFileID(s_shader_file_id);
-        file->Write(byte_code.get(), byte_code_len);
+        hash_ = CalculateHash();
     }
-    void ShaderVariation::BuildHash()
+
+    u32 ShaderVariation::CalculateHash() const
     {
-        hash_ = StringHash::Calculate(name_.CString());
-        CombineHash(hash_, StringHash::Calculate(GetDefinesClipPlane().CString()));
-        CombineHash(hash_, owner_->ToHash());
-        CombineHash(hash_, Graphics::GetMaxBones());
-        CombineHash(hash_, type_);
+        u32 hash = StringHash::Calculate(name_.CString());
+        CombineHash(hash, StringHash::Calculate(definesClipPlane_.CString()));
+        CombineHash(hash, owner_->ToHash());
+        CombineHash(hash, Graphics::GetMaxBones());
+        CombineHash(hash, type_);
+        return hash;
     }
 
 }
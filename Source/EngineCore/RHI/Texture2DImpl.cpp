@@ -239,7 +239,8 @@ namespace Atomic
                 need_decompress = true;
             }
 
-            auto mips_to_skip = mipsToSkip_[quality];
+            // Streamed textures leave out mip levels when loading instead
+            unsigned mips_to_skip = streamingIndex_ != M_MAX_UNSIGNED ? 0 : mipsToSkip_[quality];
             if (mips_to_skip >= levels)
                 mips_to_skip = levels - 1;
             while (mips_to_skip && (width / (1 << mips_to_skip) < 4 || height / (1 << mips_to_skip) < 4))
@@ -250,6 +251,13 @@ namespace Atomic
             SetNumLevels(Max((levels - mips_to_skip), 1U));
             SetSize(width, height, format);
 
+            // Keep reporting the full size while the largest levels of a streamed texture are not resident
+            if (image->GetNumSkippedLevels())
+            {
+                fullWidth_ = image->GetFullWidth();
+                fullHeight_ = image->GetFullHeight();
+            }
+
             for (unsigned i = 0; i < levels_ && i < levels - mips_to_skip; ++i)
             {
                 CompressedLevel level = image->GetCompressedLevel(i + mips_to_skip);
@@ -555,7 +555,7 @@ namespace Atomic
 
     TextureCube* TextureCube::CreateFrom(Texture2D* texture)
     {
-        if(texture->GetWidth() != texture->GetHeight())
+        if(texture->GetLevelWidth(0) != texture->GetLevelHeight(0))
         {
             ATOMIC_LOGERRORF("Can't create TextureCube from Texture %s. Sizes must be equal", texture->GetName().CString());
             // TODO: return dummy texture cube
@@ -569,7 +569,7 @@ namespace Atomic
 
         TextureCube* tex_cube = new TextureCube(texture->GetContext());
         tex_cube->SetName(name);
-        tex_cube->SetSize(texture->GetWidth(), texture->GetFormat(), texture->GetUsage(), 1);
+        tex_cube->SetSize(texture->GetLevelWidth(0), texture->GetFormat(), texture->GetUsage(), 1);
         for (u32 face = FACE_POSITIVE_X; face < MAX_CUBEMAP_FACES; ++face)
             tex_cube->SetData(static_cast<CubeMapFace>(face), texture);
         return tex_cube;
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -41,6 +43,9 @@
 #include <STB/stb_image.h>
 #include <STB/stb_image_write.h>
 // ATOMIC END
+#ifdef ENGINE_SSE
+#include <emmintrin.h>
+#endif
 #ifdef ENGINE_WEBP
 #include <webp/decode.h>
 #include <webp/encode.h>
@@ -239,6 +244,242 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
+/// Minimum number of output rows per work item when generating mip levels.
+static const int MIN_MIP_ROWS_PER_WORK_ITEM = 16;
+/// Number of entries in the linear to sRGB conversion table used when generating mip levels.
+static const unsigned LINEAR_TO_SRGB_TABLE_SIZE = 4096;
+
+/// Filter taps of one output pixel along one axis.
+struct MipFilterTaps
+{
+    /// First input pixel.
+    int start_;
+    /// Number of input pixels.
+    int count_;
+    /// Offset of the weights.
+    unsigned weightOffset_;
+};
+
+/// Rows of a mip level to filter. Pixel data is linear floating point.
+struct MipFilterJob
+{
+    /// Input level data.
+    const float* input_;
+    /// Output level data.
+    float* output_;
+    /// Input level width.
+    int inputWidth_;
+    /// Output level width.
+    int outputWidth_;
+    /// Number of components.
+    unsigned components_;
+    /// Horizontal filter taps of each output column.
+    const MipFilterTaps* horizontalTaps_;
+    /// Vertical filter taps of each output row.
+    const MipFilterTaps* verticalTaps_;
+    /// Filter weights.
+    const float* weights_;
+    /// First output row.
+    int startRow_;
+    /// One past the last output row.
+    int endRow_;
+};
+
+static float SRGBToLinear(float value)
+{
+    return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+/// Calculate tent filter taps for downsampling one axis. The filter spans two input pixels in each direction for a 2:1
+/// reduction, weighting them 1:3:3:1, and reduces to a copy when the axis is not downsampled.
+static void CalculateMipFilterTaps(int inputSize, int outputSize, PODVector<MipFilterTaps>& taps, PODVector<float>& weights)
+{
+    float scale = (float)inputSize / (float)outputSize;
+    taps.Resize((unsigned)outputSize);
+
+    for (int i = 0; i < outputSize; ++i)
+    {
+        float center = (i + 0.5f) * scale;
+        int start = Max((int)floorf(center - scale), 0);
+        int end = Min((int)ceilf(center + scale), inputSize);
+
+        MipFilterTaps& tap = taps[i];
+        tap.start_ = start;
+        tap.count_ = end - start;
+        tap.weightOffset_ = weights.Size();
+
+        // Taps outside the image are dropped and the remaining weights renormalized
+        float total = 0.0f;
+        for (int j = start; j < end; ++j)
+        {
+            float weight = Max(1.0f - Abs(j + 0.5f - center) / scale, 0.0f);
+            weights.Push(weight);
+            total += weight;
+        }
+        for (int j = 0; j < tap.count_; ++j)
+            weights[tap.weightOffset_ + j] /= total;
+    }
+}
+
+static void FilterMipRows(const MipFilterJob& job)
+{
+    unsigned components = job.components_;
+    unsigned inputRowSize = job.inputWidth_ * components;
+    PODVector<float> row(inputRowSize);
+
+    for (int y = job.startRow_; y < job.endRow_; ++y)
+    {
+        // Vertical pass into a full width row
+        const MipFilterTaps& vertical = job.verticalTaps_[y];
+        const float* verticalWeights = job.weights_ + vertical.weightOffset_;
+        float* dest = &row[0];
+        memset(dest, 0, inputRowSize * sizeof(float));
+
+        for (int i = 0; i < vertical.count_; ++i)
+        {
+            const float* src = job.input_ + (vertical.start_ + i) * inputRowSize;
+            float weight = verticalWeights[i];
+            unsigned x = 0;
+
+#ifdef ENGINE_SSE
+            __m128 weights = _mm_set1_ps(weight);
+            for (; x + 4 <= inputRowSize; x += 4)
+                _mm_storeu_ps(dest + x, _mm_add_ps(_mm_loadu_ps(dest + x), _mm_mul_ps(_mm_loadu_ps(src + x), weights)));
+#endif
+
+            for (; x < inputRowSize; ++x)
+                dest[x] += src[x] * weight;
+        }
+
+        // Horizontal pass into the output row
+        float* out = job.output_ + y * job.outputWidth_ * components;
+        for (int x = 0; x < job.outputWidth_; ++x)
+        {
+            const MipFilterTaps& horizontal = job.horizontalTaps_[x];
+            const float* horizontalWeights = job.weights_ + horizontal.weightOffset_;
+            const float* src = dest + horizontal.start_ * components;
+
+            for (unsigned c = 0; c < components; ++c)
+            {
+                float sum = 0.0f;
+                for (int i = 0; i < horizontal.count_; ++i)
+                    sum += src[i * components + c] * horizontalWeights[i];
+                out[x * components + c] = sum;
+            }
+        }
+    }
+}
+
+static void FilterMipRowsWork(const WorkItem* item, unsigned threadIndex)
+{
+    FilterMipRows(*reinterpret_cast<const MipFilterJob*>(item->aux_));
+}
+
+/// Return the fraction of pixels whose alpha is above the reference. Alpha is the last component.
+static float CalculateAlphaCoverage(const float* data, unsigned numPixels, unsigned components, float alphaReference)
+{
+    const float* alpha = data + components - 1;
+    unsigned passed = 0;
+    for (unsigned i = 0; i < numPixels; ++i)
+    {
+        if (alpha[i * components] > alphaReference)
+            ++passed;
+    }
+
+    return numPixels ? (float)passed / (float)numPixels : 0.0f;
+}
+
+/// Return the alpha scale that makes a mip level's alpha coverage at the reference match the desired coverage.
+static float CalculateAlphaCoverageScale(const float* data, unsigned numPixels, unsigned components, float alphaReference,
+    float coverage)
+{
+    // Search the threshold that gives the desired coverage, then scale alpha so that the threshold maps to the reference
+    float low = 0.0f;
+    float high = 1.0f;
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        float threshold = (low + high) * 0.5f;
+        if (CalculateAlphaCoverage(data, numPixels, components, threshold) > coverage)
+            low = threshold;
+        else
+            high = threshold;
+    }
+
+    return alphaReference / Max((low + high) * 0.5f, 1.0f / 255.0f);
+}
+
+#ifdef ATOMIC_PLATFORM_DESKTOP
+/// Minimum number of block rows per work item when compressing.
+static const int MIN_BLOCK_ROWS_PER_WORK_ITEM = 4;
+
+/// Band of block rows to compress.
+struct BlockCompressJob
+{
+    /// RGBA pixel data of the first row.
+    const unsigned char* rgba_;
+    /// Destination of the first block.
+    unsigned char* blocks_;
+    /// Width in pixels.
+    int width_;
+    /// Height in pixels.
+    int height_;
+    /// Squish compression flags.
+    int flags_;
+};
+
+static void CompressBlocksWork(const WorkItem* item, unsigned threadIndex)
+{
+    const BlockCompressJob* job = reinterpret_cast<const BlockCompressJob*>(item->aux_);
+    squish::CompressImage(job->rgba_, job->width_, job->height_, job->blocks_, job->flags_);
+}
+
+/// Compress RGBA pixel data with squish, splitting the image into bands of block rows across worker threads when called
+/// from the main thread.
+static void CompressBlocks(WorkQueue* queue, const unsigned char* rgba, int width, int height, unsigned char* blocks, int flags)
+{
+    int blockRows = (height + 3) / 4;
+    if (!queue || !queue->GetNumThreads() || !Thread::IsMainThread() || blockRows < MIN_BLOCK_ROWS_PER_WORK_ITEM * 2)
+    {
+        squish::CompressImage(rgba, width, height, blocks, flags);
+        return;
+    }
+
+    // Use a few bands per thread, as blocks vary in compression time
+    int numJobs = Min((int)(queue->GetNumThreads() + 1) * 4, blockRows / MIN_BLOCK_ROWS_PER_WORK_ITEM);
+    int rowsPerJob = (blockRows + numJobs - 1) / numJobs;
+    unsigned blockRowSize = (unsigned)squish::GetStorageRequirements(width, 4, flags);
+
+    PODVector<BlockCompressJob> jobs;
+    jobs.Reserve((unsigned)numJobs);
+    for (int row = 0; row < blockRows; row += rowsPerJob)
+    {
+        BlockCompressJob job;
+        job.rgba_ = rgba + row * 4 * width * 4;
+        job.blocks_ = blocks + row * blockRowSize;
+        job.width_ = width;
+        job.height_ = Min(rowsPerJob * 4, height - row * 4);
+        job.flags_ = flags;
+        jobs.Push(job);
+    }
+
+    for (unsigned i = 0; i < jobs.Size(); ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CompressBlocksWork;
+        item->aux_ = &jobs[i];
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+#endif
+
 bool CompressedLevel::Decompress(unsigned char* dest)
 {
     if (!data_)
@@ -276,6 +517,10 @@ Image::Image(Context* context) :
     depth_(0),
     components_(0),
     numCompressedLevels_(0),
+    skipLevels_(0),
+    skippedLevels_(0),
+    fullWidth_(0),
+    fullHeight_(0),
     cubemap_(false),
     array_(false),
     sRGB_(false),
@@ -390,6 +635,26 @@ bool Image::BeginLoad(Deserializer& source)
             array_ = true;
         }
 
+        // Leave out top mip levels if requested. Only supported for a single compressed 2D image with a mip chain
+        skippedLevels_ = 0;
+        if (skipLevels_ && compressedFormat_ != CF_RGBA && imageChainCount == 1 && ddsd.dwMipMapCount_ > 1 && ddsd.dwDepth_ <= 1)
+        {
+            const unsigned blockSize = compressedFormat_ == CF_DXT1 ? 8 : 16;
+            unsigned skippedSize = 0;
+            fullWidth_ = ddsd.dwWidth_;
+            fullHeight_ = ddsd.dwHeight_;
+            while (skippedLevels_ < skipLevels_ && ddsd.dwMipMapCount_ > 1 && ddsd.dwWidth_ >= 8 && ddsd.dwHeight_ >= 8)
+            {
+                skippedSize += ((ddsd.dwWidth_ + 3) / 4) * ((ddsd.dwHeight_ + 3) / 4) * blockSize;
+                ddsd.dwWidth_ /= 2;
+                ddsd.dwHeight_ /= 2;
+                --ddsd.dwMipMapCount_;
+                ++skippedLevels_;
+            }
+
+            source.Seek(source.GetPosition() + skippedSize);
+        }
+
         // Calculate the size of the data
         unsigned dataSize = 0;
         if (compressedFormat_ != CF_RGBA)
@@ -1331,6 +1596,11 @@ bool Image::SaveJPG(const String& fileName, int quality) const
 }
 // ATOMIC BEGIN
 bool Image::SaveDDS(const String& fileName) const
+{
+    return SaveDDS(fileName, CF_NONE, false);
+}
+
+bool Image::SaveDDS(const String& fileName, CompressedFormat format, bool mipmaps) const
 {
 #if !defined(ATOMIC_PLATFORM_DESKTOP)
 
@@ -1353,38 +1623,104 @@ bool Image::SaveDDS(const String& fileName) const
         return false;
     }
 
-    if (data_)
+    if (!data_)
     {
-        // #623 BEGIN TODO: Should have an abstract ImageReader and ImageWriter classes
-        // with subclasses for particular image output types. Also should have image settings in the image meta.
-        // ImageReader/Writers should also support a progress callback so UI can be updated.
+        ATOMIC_LOGERROR("Can not save empty image to DDS");
+        return false;
+    }
 
-        if (!width_ || !height_)
-        {
-            ATOMIC_LOGERRORF("Attempting to save zero width/height DDS to %s", fileName.CString());
-            return false;
-        }
+    // #623 BEGIN TODO: Should have an abstract ImageReader and ImageWriter classes
+    // with subclasses for particular image output types. Also should have image settings in the image meta.
+    // ImageReader/Writers should also support a progress callback so UI can be updated.
 
-        squish::u8 *inputData = (squish::u8 *) data_.Get();
+    if (!width_ || !height_)
+    {
+        ATOMIC_LOGERRORF("Attempting to save zero width/height DDS to %s", fileName.CString());
+        return false;
+    }
 
-        SharedPtr<Image> tempImage;
+    if (depth_ > 1)
+    {
+        ATOMIC_LOGERROR("Can not save 3D image to DDS");
+        return false;
+    }
 
-        // libsquish expects 4 channel RGBA, so create a temporary image if necessary
-        if (components_ != 4)
+    // libsquish expects 4 channel RGBA, so 3 channel levels are expanded when compressed
+    if (components_ != 3 && components_ != 4)
+    {
+        ATOMIC_LOGERROR("Can only save images with 3 or 4 components to DDS");
+        return false;
+    }
+
+    if (format == CF_NONE)
+        format = HasAlphaChannel() ? CF_DXT5 : CF_DXT1;
+
+    int squishFlags;
+    unsigned fourCC;
+    unsigned dxgiFormat;
+    switch (format)
+    {
+    case CF_DXT1:
+        squishFlags = squish::kDxt1;
+        fourCC = FOURCC_DXT1;
+        dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC1_UNORM_SRGB : DDS_DXGI_FORMAT_BC1_UNORM;
+        break;
+
+    case CF_DXT3:
+        squishFlags = squish::kDxt3;
+        fourCC = FOURCC_DXT3;
+        dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC2_UNORM_SRGB : DDS_DXGI_FORMAT_BC2_UNORM;
+        break;
+
+    case CF_DXT5:
+        squishFlags = squish::kDxt5;
+        fourCC = FOURCC_DXT5;
+        dxgiFormat = sRGB_ ? DDS_DXGI_FORMAT_BC3_UNORM_SRGB : DDS_DXGI_FORMAT_BC3_UNORM;
+        break;
+
+    default:
+        ATOMIC_LOGERROR("Unsupported compressed format for saving DDS");
+        return false;
+    }
+
+    // Use a slow but high quality colour compressor (the default). (TODO: expose other settings as parameter)
+    squishFlags |= squish::kColourClusterFit;
+
+    // Collect the mip levels. Levels not yet calculated are generated here and released after saving
+    Vector<SharedPtr<Image> > generatedLevels;
+    PODVector<const Image*> levels;
+    levels.Push(this);
+    if (mipmaps)
+    {
+        const Image* level = this;
+        while (level->width_ > 1 || level->height_ > 1)
         {
-            if (components_ != 3)
-            {
-                ATOMIC_LOGERROR("Can only save images with 3 or 4 components to DDS");
+            SharedPtr<Image> nextLevel = level->GetNextLevel();
+            if (!nextLevel)
                 return false;
-            }
+            generatedLevels.Push(nextLevel);
+            level = nextLevel;
+            levels.Push(level);
+        }
+    }
 
-            tempImage = new Image(context_);
-            tempImage->SetSize(width_, height_, 4);
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    PODVector<unsigned char> compressedData;
+    PODVector<unsigned char> rgbaData;
 
-            squish::u8* srcBits = (squish::u8*) data_;
-            squish::u8* dstBits = (squish::u8*) tempImage->data_;
+    for (unsigned i = 0; i < levels.Size(); ++i)
+    {
+        const Image* level = levels[i];
+        const unsigned char* inputData = level->data_.Get();
+        unsigned numPixels = (unsigned)level->width_ * (unsigned)level->height_;
+
+        if (level->components_ == 3)
+        {
+            rgbaData.Resize(numPixels * 4);
+            const unsigned char* srcBits = inputData;
+            unsigned char* dstBits = &rgbaData[0];
 
-            for (unsigned i = 0; i < (unsigned) width_ * (unsigned) height_; i++)
+            for (unsigned j = 0; j < numPixels; j++)
             {
                 *dstBits++ = *srcBits++;
                 *dstBits++ = *srcBits++;
@@ -1392,59 +1728,70 @@ bool Image::SaveDDS(const String& fileName) const
                 *dstBits++ = 255;
             }
 
-            inputData = (squish::u8 *) tempImage->data_.Get();
+            inputData = &rgbaData[0];
         }
 
-        unsigned squishFlags = HasAlphaChannel() ? squish::kDxt5 : squish::kDxt1;
-
-        // Use a slow but high quality colour compressor (the default). (TODO: expose other settings as parameter)
-        squishFlags |= squish::kColourClusterFit;
+        unsigned offset = compressedData.Size();
+        compressedData.Resize(offset + (unsigned)squish::GetStorageRequirements(level->width_, level->height_, squishFlags));
+        CompressBlocks(queue, inputData, level->width_, level->height_, &compressedData[offset], squishFlags);
+    }
 
-        unsigned storageRequirements = (unsigned) squish::GetStorageRequirements( width_, height_,  squishFlags);
+    DDSurfaceDesc2 sdesc;
 
-        SharedArrayPtr<unsigned char> compressedData(new unsigned char[storageRequirements]);
+    if (sizeof(sdesc) != 124)
+    {
+        ATOMIC_LOGERROR("Image::SaveDDS - sizeof(DDSurfaceDesc2) != 124");
+        return false;
+    }
+    memset(&sdesc, 0, sizeof(sdesc));
+    sdesc.dwSize_ = 124;
+    sdesc.dwFlags_ = DDSD_CAPS | DDSD_PIXELFORMAT | DDSD_WIDTH | DDSD_HEIGHT | DDSD_LINEARSIZE;
+    sdesc.dwWidth_ = width_;
+    sdesc.dwHeight_ = height_;
+    sdesc.dwLinearSize_ = (unsigned)squish::GetStorageRequirements(width_, height_, squishFlags);
+    sdesc.ddsCaps_.dwCaps_ = DDSCAPS_TEXTURE;
 
-        squish::CompressImage(inputData, width_, height_, compressedData.Get(), squishFlags);
+    if (levels.Size() > 1)
+    {
+        sdesc.dwFlags_ |= DDSD_MIPMAPCOUNT;
+        sdesc.dwMipMapCount_ = levels.Size();
+        sdesc.ddsCaps_.dwCaps_ |= DDSCAPS_MIPMAP | DDSCAPS_COMPLEX;
+    }
 
-        DDSurfaceDesc2 sdesc;
+    // sRGB formats can only be expressed with the DX10 header
+    sdesc.ddpfPixelFormat_.dwSize_ = 32;
+    sdesc.ddpfPixelFormat_.dwFlags_ = DDPF_FOURCC | (HasAlphaChannel() ? DDPF_ALPHAPIXELS : 0);
+    sdesc.ddpfPixelFormat_.dwFourCC_ = sRGB_ ? FOURCC_DX10 : fourCC;
 
-        if (sizeof(sdesc) != 124)
-        {
-            ATOMIC_LOGERROR("Image::SaveDDS - sizeof(DDSurfaceDesc2) != 124");
-            return false;
-        }
-        memset(&sdesc, 0, sizeof(sdesc));
-        sdesc.dwSize_ = 124;
-        sdesc.dwFlags_ = DDSD_CAPS | DDSD_PIXELFORMAT | DDSD_WIDTH | DDSD_HEIGHT;
-        sdesc.dwWidth_ = width_;
-        sdesc.dwHeight_ = height_;
+    SharedPtr<File> dest(new File(context_, fileName, FILE_WRITE));
 
-        sdesc.ddpfPixelFormat_.dwSize_ = 32;
-        sdesc.ddpfPixelFormat_.dwFlags_ = DDPF_FOURCC | (HasAlphaChannel() ? DDPF_ALPHAPIXELS : 0);
-        sdesc.ddpfPixelFormat_.dwFourCC_ = HasAlphaChannel() ? FOURCC_DXT5 : FOURCC_DXT1;
-
-        SharedPtr<File> dest(new File(context_, fileName, FILE_WRITE));
+    if (!dest->IsOpen())
+    {
+        ATOMIC_LOGERRORF("Failed to open DXT image file for writing %s", fileName.CString());
+        return false;
+    }
 
-        if (!dest->IsOpen())
-        {
-            ATOMIC_LOGERRORF("Failed to open DXT image file for writing %s", fileName.CString());
-            return false;
-        }
-        else
-        {
+    dest->Write((void*)"DDS ", 4);
+    dest->Write((void*)&sdesc, sizeof(sdesc));
 
-            dest->Write((void*)"DDS ", 4);
-            dest->Write((void*)&sdesc, sizeof(sdesc));
+    if (sRGB_)
+    {
+        DDSHeader10 dxgiHeader;
+        dxgiHeader.dxgiFormat = dxgiFormat;
+        dxgiHeader.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+        dxgiHeader.miscFlag = 0;
+        dxgiHeader.arraySize = 1;
+        dxgiHeader.reserved = 0;
+        dest->Write(&dxgiHeader, sizeof(dxgiHeader));
+    }
 
-            bool success = dest->Write(compressedData.Get(), storageRequirements) == storageRequirements;
+    bool success = dest->Write(&compressedData[0], compressedData.Size()) == compressedData.Size();
 
-            if (!success)
-                ATOMIC_LOGERRORF("Failed to write image to DXT, file size mismatch %s", fileName.CString());
+    if (!success)
+        ATOMIC_LOGERRORF("Failed to write image to DXT, file size mismatch %s", fileName.CString());
 
-            return success;
-        }
-        // #623 END TODO
-    }
+    return success;
+    // #623 END TODO
 #endif
 }
 
@@ -1804,8 +2151,25 @@ SharedPtr<Image> Image::GetNextLevel() const
                 const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
                 const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
                 unsigned char* out = &pixelDataOut[y * widthOut * 4];
+                int x = 0;
+
+#ifdef ENGINE_SSE
+                // Average two output pixels per iteration. Same result as the scalar loop below
+                __m128i zero = _mm_setzero_si128();
+                for (; x + 8 <= widthOut * 4; x += 8)
+                {
+                    __m128i upper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inUpper[x * 2]));
+                    __m128i lower = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inLower[x * 2]));
+                    __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero));
+                    __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero));
+                    left = _mm_add_epi16(left, _mm_srli_si128(left, 8));
+                    right = _mm_add_epi16(right, _mm_srli_si128(right, 8));
+                    __m128i sum = _mm_srli_epi16(_mm_unpacklo_epi64(left, right), 2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(sum, sum));
+                }
+#endif
 
-                for (int x = 0; x < widthOut * 4; x += 4)
+                for (; x < widthOut * 4; x += 4)
                 {
                     out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
                                               inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
@@ -2358,6 +2722,146 @@ void Image::PrecalculateLevels()
     }
 }
 
+bool Image::GenerateLevels(float alphaReference)
+{
+    if (!data_ || IsCompressed())
+    {
+        ATOMIC_LOGERROR("Can not generate mip levels without uncompressed data");
+        return false;
+    }
+    if (depth_ > 1)
+    {
+        ATOMIC_LOGERROR("Can not generate filtered mip levels for a 3D image");
+        return false;
+    }
+    if (components_ < 1 || components_ > 4)
+    {
+        ATOMIC_LOGERROR("Illegal number of image components for mip level generation");
+        return false;
+    }
+
+    ATOMIC_PROFILE(GenerateImageMipLevels);
+
+    nextLevel_.Reset();
+
+    // Alpha is the last component of luminance-alpha and RGBA images, and is always linear
+    unsigned components = components_;
+    bool hasAlpha = components == 2 || components == 4;
+    unsigned colorComponents = hasAlpha ? components - 1 : components;
+    bool preserveCoverage = hasAlpha && alphaReference > 0.0f;
+
+    float decodeTable[256];
+    for (unsigned i = 0; i < 256; ++i)
+        decodeTable[i] = sRGB_ ? SRGBToLinear(i / 255.0f) : i / 255.0f;
+
+    PODVector<unsigned char> encodeTable(LINEAR_TO_SRGB_TABLE_SIZE);
+    for (unsigned i = 0; i < LINEAR_TO_SRGB_TABLE_SIZE; ++i)
+    {
+        float value = (float)i / (float)(LINEAR_TO_SRGB_TABLE_SIZE - 1);
+        encodeTable[i] = (unsigned char)(Clamp(sRGB_ ? LinearToSRGB(value) : value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Each level is filtered from the unquantized previous level
+    int width = width_;
+    int height = height_;
+    unsigned numPixels = (unsigned)width * (unsigned)height;
+    PODVector<float> input(numPixels * components);
+    for (unsigned i = 0; i < numPixels * components; ++i)
+        input[i] = i % components < colorComponents ? decodeTable[data_[i]] : data_[i] / 255.0f;
+
+    float coverage = preserveCoverage ? CalculateAlphaCoverage(&input[0], numPixels, components, alphaReference) : 0.0f;
+
+    // Worker threads can only be waited on from the main thread
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numThreads = queue && Thread::IsMainThread() ? queue->GetNumThreads() : 0;
+
+    PODVector<float> output;
+    PODVector<float> weights;
+    PODVector<MipFilterTaps> horizontalTaps;
+    PODVector<MipFilterTaps> verticalTaps;
+    PODVector<MipFilterJob> jobs;
+    Image* current = this;
+
+    while (width > 1 || height > 1)
+    {
+        int widthOut = Max(width / 2, 1);
+        int heightOut = Max(height / 2, 1);
+        unsigned numPixelsOut = (unsigned)widthOut * (unsigned)heightOut;
+
+        weights.Clear();
+        CalculateMipFilterTaps(width, widthOut, horizontalTaps, weights);
+        CalculateMipFilterTaps(height, heightOut, verticalTaps, weights);
+        output.Resize(numPixelsOut * components);
+
+        MipFilterJob job;
+        job.input_ = &input[0];
+        job.output_ = &output[0];
+        job.inputWidth_ = width;
+        job.outputWidth_ = widthOut;
+        job.components_ = components;
+        job.horizontalTaps_ = &horizontalTaps[0];
+        job.verticalTaps_ = &verticalTaps[0];
+        job.weights_ = &weights[0];
+        job.startRow_ = 0;
+        job.endRow_ = heightOut;
+
+        if (numThreads && heightOut >= MIN_MIP_ROWS_PER_WORK_ITEM * 2)
+        {
+            int numJobs = Min((int)numThreads + 1, heightOut / MIN_MIP_ROWS_PER_WORK_ITEM);
+            int rowsPerJob = (heightOut + numJobs - 1) / numJobs;
+
+            jobs.Clear();
+            for (int row = 0; row < heightOut; row += rowsPerJob)
+            {
+                job.startRow_ = row;
+                job.endRow_ = Min(row + rowsPerJob, heightOut);
+                jobs.Push(job);
+            }
+
+            for (unsigned i = 0; i < jobs.Size(); ++i)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = FilterMipRowsWork;
+                item->aux_ = &jobs[i];
+                queue->AddWorkItem(item);
+            }
+
+            queue->Complete(M_MAX_UNSIGNED);
+        }
+        else
+            FilterMipRows(job);
+
+        float alphaScale = preserveCoverage ?
+            CalculateAlphaCoverageScale(&output[0], numPixelsOut, components, alphaReference, coverage) : 1.0f;
+
+        SharedPtr<Image> level(new Image(context_));
+        level->SetSize(widthOut, heightOut, components);
+        level->sRGB_ = sRGB_;
+
+        unsigned char* levelData = level->data_.Get();
+        for (unsigned i = 0; i < numPixelsOut * components; ++i)
+        {
+            if (i % components < colorComponents)
+            {
+                float value = Clamp(output[i], 0.0f, 1.0f);
+                levelData[i] = encodeTable[(unsigned)(value * (LINEAR_TO_SRGB_TABLE_SIZE - 1) + 0.5f)];
+            }
+            else
+                levelData[i] = (unsigned char)(Clamp(output[i] * alphaScale, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+
+        current->nextLevel_ = level;
+        current = level;
+
+        input.Swap(output);
+        width = widthOut;
+        height = heightOut;
+    }
+
+    return true;
+}
+
 void Image::CleanupLevels()
 {
     nextLevel_.Reset();
@@ -143,6 +143,8 @@ public:
     bool SaveJPG(const String& fileName, int quality) const;
     /// Save in DDS format. Only uncompressed RGBA images are supported. Return true if successful.
     bool SaveDDS(const String& fileName) const;
+    /// Save in DDS format with a block compressed format, or CF_NONE to choose DXT5 for images with alpha and DXT1 otherwise. Optionally include the mip levels, which are generated if not yet present. sRGB images are saved with an sRGB format. Return true if successful.
+    bool SaveDDS(const String& fileName, CompressedFormat format, bool mipmaps) const;
     /// Save in WebP format with minimum (fastest) or specified compression. Return true if successful. Fails always if WebP support is not compiled in.
     bool SaveWEBP(const String& fileName, float compression = 0.0f) const;
     /// Whether this texture is detected as a cubemap, only relevant for DDS.
@@ -151,6 +153,8 @@ public:
     bool IsArray() const { return array_; }
     /// Whether this texture is in sRGB, only relevant for DDS.
     bool IsSRGB() const { return sRGB_; }
+    /// Set whether the color data is in sRGB, which affects mip generation and DDS saving.
+    void SetSRGB(bool enable) { sRGB_ = enable; }
 
     /// Return a 2D pixel color.
     Color GetPixel(int x, int y) const;
@@ -189,6 +193,15 @@ public:
     /// Return number of compressed mip levels. Returns 0 if the image is has not been loaded from a source file containing multiple mip levels.
     unsigned GetNumCompressedLevels() const { return numCompressedLevels_; }
 
+    /// Set number of top mip levels to leave out when loading a mip-chained compressed 2D DDS image, which are then not read at all. Fewer are skipped if the image would become smaller than a compression block. Used by texture streaming.
+    void SetSkipLevels(unsigned levels) { skipLevels_ = levels; }
+    /// Return number of top mip levels that were left out when loading.
+    unsigned GetNumSkippedLevels() const { return skippedLevels_; }
+    /// Return width including the top mip levels that were left out when loading.
+    int GetFullWidth() const { return skippedLevels_ ? fullWidth_ : width_; }
+    /// Return height including the top mip levels that were left out when loading.
+    int GetFullHeight() const { return skippedLevels_ ? fullHeight_ : height_; }
+
     /// Return next mip level by bilinear filtering. Note that if the image is already 1x1x1, will keep returning an image of that size.
     SharedPtr<Image> GetNextLevel() const;
     /// Return the next sibling image of an array or cubemap.
@@ -203,6 +216,8 @@ public:
     SDL_Surface* GetSDLSurface(const IntRect& rect = IntRect::ZERO) const;
     /// Precalculate the mip levels. Used by asynchronous texture loading.
     void PrecalculateLevels();
+    /// Generate the mip levels with a high quality tent filter, in linear space if the image is sRGB. If alpha reference is positive, alpha is scaled in each level to preserve the fraction of pixels passing an alpha test at that reference. Slower than PrecalculateLevels and meant for offline processing. 3D images are not supported. Return true if successful.
+    bool GenerateLevels(float alphaReference = 0.0f);
 
     // ATOMIC BEGIN
     /// Whether this texture has an alpha channel
@@ -233,6 +248,14 @@ private:
     unsigned components_;
     /// Number of compressed mip levels.
     unsigned numCompressedLevels_;
+    /// Number of top mip levels to leave out when loading.
+    unsigned skipLevels_;
+    /// Number of top mip levels left out by the last load.
+    unsigned skippedLevels_;
+    /// Width including the top mip levels left out by the last load.
+    int fullWidth_;
+    /// Height including the top mip levels left out by the last load.
+    int fullHeight_;
     /// Cubemap status if DDS.
     bool cubemap_;
     /// Texture array status if DDS.
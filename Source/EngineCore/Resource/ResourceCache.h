@@ -176,7 +176,7 @@ public:
     const HashMap<StringHash, ResourceGroup>& GetAllResources() const { return resourceGroups_; }
 
     /// Return added resource load directories.
-    const Vector<String>& GetResourceDirs() const { return Vector(resourceDirs_.data(), resourceDirs_.size()); }
+    Vector<String> GetResourceDirs() const { return Vector<String>(resourceDirs_.data(), resourceDirs_.size()); }
 
     /// Return added package files.
     const Vector<SharedPtr<PackageFile> >& GetPackageFiles() const { return packages_; }
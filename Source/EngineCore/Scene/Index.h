@@ -12,7 +12,9 @@
 #include "./PrefabEvents.h"
 #include "./ReplicationState.h"
 #include "./SceneEvents.h"
+#include "./SceneArchive.h"
 #include "./SceneResolver.h"
 #include "./SmoothedTransform.h"
 #include "./SplinePath.h"
+#include "./TransformHierarchy.h"
 #include "./UnknownComponent.h"
\ No newline at end of file
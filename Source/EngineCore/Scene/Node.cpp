@@ -34,6 +34,7 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SmoothedTransform.h"
+#include "../Scene/TransformHierarchy.h"
 #include "../Scene/UnknownComponent.h"
 
 #include "../DebugNew.h"
@@ -58,7 +59,8 @@ Node::Node(Context* context) :
     position_(Vector3::ZERO),
     rotation_(Quaternion::IDENTITY),
     scale_(Vector3::ONE),
-    worldRotation_(Quaternion::IDENTITY)
+    worldRotation_(Quaternion::IDENTITY),
+    transformIndex_(M_MAX_UNSIGNED)
 {
     impl_ = new NodeImpl();
     impl_->owner_ = 0;
@@ -744,6 +746,15 @@ void Node::SetOwner(Connection* owner)
 
 void Node::MarkDirty()
 {
+    // With a flat transform hierarchy the subtree is flagged and its listeners notified, while the world transforms are
+    // recalculated in bulk by Scene::UpdateTransforms(). Worker threads in a threaded update keep the immediate path
+    if (scene_)
+    {
+        TransformHierarchy* hierarchy = scene_->GetTransformHierarchy();
+        if (hierarchy && !scene_->IsThreadedUpdate() && hierarchy->MarkDirty(this))
+            return;
+    }
+
     Node *cur = this;
     for (;;)
     {
@@ -759,21 +770,7 @@ void Node::MarkDirty()
         cur->dirty_ = true;
 
         // Notify listener components first, then mark child nodes
-        for (Vector<WeakPtr<Component> >::Iterator i = cur->listeners_.Begin(); i != cur->listeners_.End();)
-        {
-            Component *c = *i;
-            if (c)
-            {
-                c->OnMarkedDirty(cur);
-                ++i;
-            }
-            // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
-            else
-            {
-                *i = cur->listeners_.Back();
-                cur->listeners_.Pop();
-            }
-        }
+        cur->NotifyListeners();
 
         // Tail call optimization: Don't recurse to mark the first child dirty, but
         // instead process it in the context of the current function. If there are more
@@ -791,6 +788,25 @@ void Node::MarkDirty()
     }
 }
 
+void Node::NotifyListeners()
+{
+    for (Vector<WeakPtr<Component> >::Iterator i = listeners_.Begin(); i != listeners_.End();)
+    {
+        Component *c = *i;
+        if (c)
+        {
+            c->OnMarkedDirty(this);
+            ++i;
+        }
+        // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
+        else
+        {
+            *i = listeners_.Back();
+            listeners_.Pop();
+        }
+    }
+}
+
 Node* Node::CreateChild(const String& name, CreateMode mode, unsigned id, bool temporary)
 {
     Node* newNode = CreateChild(id, mode, temporary);
@@ -845,6 +861,8 @@ void Node::AddChild(Node* node, unsigned index)
         scene_->NodeAdded(node);
 
     node->parent_ = this;
+    if (scene_ && scene_->GetTransformHierarchy())
+        scene_->GetTransformHierarchy()->AddNode(node);
     node->MarkDirty();
     node->MarkNetworkUpdate();
     // If the child node has components, also mark network update on them to ensure they have a valid NetworkState
@@ -75,6 +75,8 @@ class ATOMIC_API Node : public Animatable
     ATOMIC_OBJECT(Node, Animatable);
 
     friend class Connection;
+    friend class SceneArchive;
+    friend class TransformHierarchy;
 
 public:
     /// Construct.
@@ -689,6 +691,8 @@ private:
 
     /// Recalculate the world transform.
     void UpdateWorldTransform() const;
+    /// Notify listener components that the transform has changed.
+    void NotifyListeners();
     /// Remove child node by iterator.
     void RemoveChild(Vector<SharedPtr<Node> >::Iterator i);
     /// Return child nodes recursively.
@@ -742,6 +746,8 @@ private:
     Vector<WeakPtr<Component> > listeners_;
     /// Pointer to implementation.
     UniquePtr<NodeImpl> impl_;
+    /// Index in the scene's flat transform hierarchy, or M_MAX_UNSIGNED if not indexed.
+    unsigned transformIndex_;
 
     // ATOMIC BEGIN
 
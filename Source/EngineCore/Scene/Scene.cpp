@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
@@ -37,9 +38,11 @@
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
+#include "../Scene/SceneArchive.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
+#include "../Scene/TransformHierarchy.h"
 #include "../Scene/UnknownComponent.h"
 #include "../Scene/ValueAnimation.h"
 
@@ -91,9 +94,9 @@ Scene::~Scene()
     RemoveAllChildren();
 
     // Remove scene reference and owner from all nodes that still exist
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->ResetScene();
-    for (HashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Begin(); i != localNodes_.End(); ++i)
         i->second_->ResetScene();
 }
 
@@ -121,6 +124,9 @@ bool Scene::Load(Deserializer& source, bool setInstanceDefault)
 
     StopAsyncLoading();
 
+    if (SceneArchive::IsCompactScene(source))
+        return LoadCompact(source, setInstanceDefault);
+
     // Check ID
     if (source.ReadFileID() != "USCN")
     {
@@ -200,6 +206,43 @@ bool Scene::LoadJSON(const JSONValue& source, bool setInstanceDefault)
         return false;
 }
 
+bool Scene::LoadCompact(Deserializer& source, bool setInstanceDefault)
+{
+    StopAsyncLoading();
+
+    ATOMIC_LOGINFO("Loading compact scene from " + source.GetName());
+
+    Clear();
+
+    SceneArchive archive;
+    SceneResolver resolver;
+    if (archive.Load(this, source, resolver, setInstanceDefault))
+    {
+        resolver.Resolve();
+        ApplyAttributes();
+        FinishLoading(&source);
+        return true;
+    }
+    else
+        return false;
+}
+
+bool Scene::SaveCompact(Serializer& dest, bool compress) const
+{
+    Deserializer* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        ATOMIC_LOGINFO("Saving compact scene to " + ptr->GetName());
+
+    SceneArchive archive;
+    if (archive.Save(this, dest, compress))
+    {
+        FinishSaving(&dest);
+        return true;
+    }
+    else
+        return false;
+}
+
 void Scene::MarkNetworkUpdate()
 {
     if (!networkUpdate_)
@@ -214,7 +257,7 @@ void Scene::AddReplicationState(NodeReplicationState* state)
     Node::AddReplicationState(state);
 
     // This is the first update for a new connection. Mark all replicated nodes dirty
-    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         state->sceneState_->dirtyNodes_.Insert(i->first_);
 }
 
@@ -320,6 +363,51 @@ bool Scene::LoadAsync(File* file, LoadMode mode)
 
     StopAsyncLoading();
 
+    // The compact format is read to memory up front, then its nodes are created in the async updates and the attributes,
+    // which are stored by type rather than by node, are assigned when finishing
+    if (SceneArchive::IsCompactScene(*file))
+    {
+        UniquePtr<SceneArchive> archive(new SceneArchive());
+        if (!archive->BeginLoad(*file))
+            return false;
+
+        if (mode > LOAD_RESOURCES_ONLY)
+        {
+            ATOMIC_LOGINFO("Loading compact scene from " + file->GetName());
+            Clear();
+        }
+
+        asyncLoading_ = true;
+        asyncProgress_.file_ = file;
+        asyncProgress_.mode_ = mode;
+        asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_ = asyncProgress_.loadedResources_ = asyncProgress_.totalResources_ = 0;
+        asyncProgress_.resources_.Clear();
+
+        if (mode != LOAD_SCENE)
+        {
+            ATOMIC_PROFILE(FindResourcesToPreload);
+
+            if (mode == LOAD_RESOURCES_ONLY)
+                ATOMIC_LOGINFO("Preloading resources from " + file->GetName());
+            PreloadResourcesCompact(*archive);
+        }
+
+        if (mode > LOAD_RESOURCES_ONLY)
+        {
+            // Create the scene's own components first, then prepare to create the other nodes in the async updates
+            if (!archive->LoadNode(this, resolver_))
+            {
+                StopAsyncLoading();
+                return false;
+            }
+
+            asyncProgress_.totalNodes_ = archive->GetNumNodes() - 1;
+            asyncProgress_.archive_ = archive.Detach();
+        }
+
+        return true;
+    }
+
     // Check ID
     bool isSceneFile = file->ReadFileID() == "USCN";
     if (!isSceneFile)
@@ -525,6 +613,7 @@ void Scene::StopAsyncLoading()
     asyncProgress_.jsonFile_.Reset();
     asyncProgress_.xmlElement_ = XMLElement::EMPTY;
     asyncProgress_.jsonIndex_ = 0;
+    asyncProgress_.archive_.Reset();
     asyncProgress_.resources_.Clear();
     resolver_.Reset();
 }
@@ -673,6 +762,21 @@ void Scene::SetAsyncLoadingMs(int ms)
     asyncLoadingMs_ = Max(ms, 1);
 }
 
+void Scene::SetFlatTransformsEnabled(bool enable)
+{
+    if (enable == transformHierarchy_.NotNull())
+        return;
+
+    if (enable)
+        transformHierarchy_ = new TransformHierarchy(this);
+    else
+    {
+        // Deliver pending listener notifications before returning to immediate dirty processing
+        transformHierarchy_->Update();
+        transformHierarchy_.Reset();
+    }
+}
+
 void Scene::SetElapsedTime(float time)
 {
     elapsedTime_ = time;
@@ -711,12 +815,12 @@ Node* Scene::GetNode(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Find(id);
         return i != replicatedNodes_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::ConstIterator i = localNodes_.Find(id);
         return i != localNodes_.End() ? i->second_ : 0;
     }
 }
@@ -738,12 +842,12 @@ Component* Scene::GetComponent(unsigned id) const
 {
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = replicatedComponents_.Find(id);
         return i != replicatedComponents_.End() ? i->second_ : 0;
     }
     else
     {
-        HashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::ConstIterator i = localComponents_.Find(id);
         return i != localComponents_.End() ? i->second_ : 0;
     }
 }
@@ -787,6 +891,9 @@ void Scene::Update(float timeStep)
     // Update scene attribute animation.
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
+    // Resolve transforms moved by logic before subsystems such as physics see them
+    UpdateTransforms();
+
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
     SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
 
@@ -807,12 +914,27 @@ void Scene::Update(float timeStep)
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
 
+    UpdateTransforms();
+
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
     // SetElapsedTime()
     elapsedTime_ += timeStep;
 }
 
+void Scene::UpdateTransforms()
+{
+    if (transformHierarchy_.Null() || threadedUpdate_ || !Thread::IsMainThread())
+        return;
+
+    // Octree queries update the transforms too, so skip while the main thread works on a queue of threaded work items
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->IsCompleting())
+        return;
+
+    transformHierarchy_->Update();
+}
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -930,7 +1052,7 @@ void Scene::NodeAdded(Node* node)
     // If node with same ID exists, remove the scene reference from it and overwrite with the new node
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Find(id);
         if (i != replicatedNodes_.End() && i->second_ != node)
         {
             ATOMIC_LOGWARNING("Overwriting node with ID " + String(id));
@@ -944,7 +1066,7 @@ void Scene::NodeAdded(Node* node)
     }
     else
     {
-        HashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
+        FlatHashMap<unsigned, Node*>::Iterator i = localNodes_.Find(id);
         if (i != localNodes_.End() && i->second_ != node)
         {
             ATOMIC_LOGWARNING("Overwriting node with ID " + String(id));
@@ -985,6 +1107,9 @@ void Scene::NodeRemoved(Node* node)
     if (!node || node->GetScene() != this)
         return;
 
+    if (transformHierarchy_.NotNull())
+        transformHierarchy_->RemoveNode(node);
+
     unsigned id = node->GetID();
     if (id < FIRST_LOCAL_ID)
     {
@@ -1029,7 +1154,7 @@ void Scene::ComponentAdded(Component* component)
 
     if (id < FIRST_LOCAL_ID)
     {
-        HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Find(id);
         if (i != replicatedComponents_.End() && i->second_ != component)
         {
             ATOMIC_LOGWARNING("Overwriting component with ID " + String(id));
@@ -1040,7 +1165,7 @@ void Scene::ComponentAdded(Component* component)
     }
     else
     {
-        HashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
+        FlatHashMap<unsigned, Component*>::Iterator i = localComponents_.Find(id);
         if (i != localComponents_.End() && i->second_ != component)
         {
             ATOMIC_LOGWARNING("Overwriting component with ID " + String(id));
@@ -1094,14 +1219,14 @@ String Scene::GetVarNamesAttr() const
 
 void Scene::PrepareNetworkUpdate()
 {
-    for (HashSet<unsigned>::Iterator i = networkUpdateNodes_.Begin(); i != networkUpdateNodes_.End(); ++i)
+    for (FlatHashSet<unsigned>::Iterator i = networkUpdateNodes_.Begin(); i != networkUpdateNodes_.End(); ++i)
     {
         Node* node = GetNode(*i);
         if (node)
             node->PrepareNetworkUpdate();
     }
 
-    for (HashSet<unsigned>::Iterator i = networkUpdateComponents_.Begin(); i != networkUpdateComponents_.End(); ++i)
+    for (FlatHashSet<unsigned>::Iterator i = networkUpdateComponents_.Begin(); i != networkUpdateComponents_.End(); ++i)
     {
         Component* component = GetComponent(*i);
         if (component)
@@ -1116,10 +1241,10 @@ void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
 
-    for (HashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+    for (FlatHashMap<unsigned, Node*>::Iterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
         i->second_->CleanupConnection(connection);
 
-    for (HashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
+    for (FlatHashMap<unsigned, Component*>::Iterator i = replicatedComponents_.Begin(); i != replicatedComponents_.End(); ++i)
         i->second_->CleanupConnection(connection);
 }
 
@@ -1229,6 +1354,16 @@ void Scene::UpdateAsyncLoading()
             newNode->LoadJSON(childValue, resolver_);
             ++asyncProgress_.jsonIndex_;
         }
+        else if (asyncProgress_.archive_) // Load from compact
+        {
+            // On corrupted structure data stop creating nodes and finish without assigning the misaligned attributes
+            if (!asyncProgress_.archive_->LoadNode(this, resolver_))
+            {
+                asyncProgress_.archive_.Reset();
+                asyncProgress_.loadedNodes_ = asyncProgress_.totalNodes_;
+                continue;
+            }
+        }
         else // Load from binary
         {
             unsigned nodeID = asyncProgress_.file_->ReadUInt();
@@ -1260,6 +1395,8 @@ void Scene::FinishAsyncLoading()
 {
     if (asyncProgress_.mode_ > LOAD_RESOURCES_ONLY)
     {
+        if (asyncProgress_.archive_)
+            asyncProgress_.archive_->EndLoad();
         resolver_.Resolve();
         ApplyAttributes();
         FinishLoading(asyncProgress_.file_);
@@ -1532,6 +1669,27 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 #endif
 }
 
+void Scene::PreloadResourcesCompact(const SceneArchive& archive)
+{
+    // If not threaded, can not background load resources, so rather load synchronously later when needed
+#ifdef ENGINE_THREADING
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+
+    Vector<ResourceRef> refs;
+    archive.GetResources(context_, refs);
+    for (unsigned i = 0; i < refs.Size(); ++i)
+    {
+        String name = cache->SanitateResourceName(refs[i].name_);
+        bool success = cache->BackgroundLoadResource(refs[i].type_, name);
+        if (success)
+        {
+            ++asyncProgress_.totalResources_;
+            asyncProgress_.resources_.Insert(StringHash(name));
+        }
+    }
+#endif
+}
+
 void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
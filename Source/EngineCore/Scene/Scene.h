@@ -22,11 +22,14 @@
 
 #pragma once
 
+#include "../Container/FlatHashMap.h"
+#include "../Container/FlatHashSet.h"
 #include "../Container/HashSet.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
+#include "../Scene/SceneArchive.h"
 #include "../Scene/SceneResolver.h"
 
 namespace Atomic
@@ -34,6 +37,7 @@ namespace Atomic
 
 class File;
 class PackageFile;
+class TransformHierarchy;
 
 static const unsigned FIRST_REPLICATED_ID = 0x1;
 static const unsigned LAST_REPLICATED_ID = 0xffffff;
@@ -67,6 +71,9 @@ struct AsyncProgress
     /// Current JSON child array and for JSON mode
     unsigned jsonIndex_;
 
+    /// Archive for compact mode, holding the payload until all nodes are created.
+    UniquePtr<SceneArchive> archive_;
+
     /// Current load mode.
     LoadMode mode_;
     /// Resource name hashes left to load.
@@ -75,9 +82,9 @@ struct AsyncProgress
     unsigned loadedResources_;
     /// Total resources.
     unsigned totalResources_;
-    /// Loaded root-level nodes.
+    /// Loaded root-level nodes. In compact mode all nodes are counted.
     unsigned loadedNodes_;
-    /// Total root-level nodes.
+    /// Total root-level nodes. In compact mode all nodes are counted.
     unsigned totalNodes_;
 };
 
@@ -119,7 +126,11 @@ public:
     bool SaveXML(Serializer& dest, const String& indentation = "\t") const;
     /// Save to a JSON file. Return true if successful.
     bool SaveJSON(Serializer& dest, const String& indentation = "\t") const;
-    /// Load from a binary file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
+    /// Load from the compact binary format. Removes all existing child nodes and components first. Return true if successful.
+    bool LoadCompact(Deserializer& source, bool setInstanceDefault = false);
+    /// Save to the compact binary format, optionally LZ4 compressed. Return true if successful.
+    bool SaveCompact(Serializer& dest, bool compress = true) const;
+    /// Load from a binary or compact file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
     bool LoadAsync(File* file, LoadMode mode = LOAD_SCENE_AND_RESOURCES);
     /// Load from an XML file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
     bool LoadAsyncXML(File* file, LoadMode mode = LOAD_SCENE_AND_RESOURCES);
@@ -154,6 +165,9 @@ public:
     void SetSnapThreshold(float threshold);
     /// Set maximum milliseconds per frame to spend on async scene loading.
     void SetAsyncLoadingMs(int ms);
+    /// Enable or disable the flat transform hierarchy. When enabled, moving a node only flags it and its children dirty;
+    /// world transforms are recalculated in one pass per update and transform listeners are notified in bulk.
+    void SetFlatTransformsEnabled(bool enable);
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -205,6 +219,9 @@ public:
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether the flat transform hierarchy is enabled.
+    bool GetFlatTransformsEnabled() const { return transformHierarchy_.NotNull(); }
+
     /// Return required package files.
     const Vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
 
@@ -219,9 +236,15 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Recalculate dirty world transforms when the flat transform hierarchy is enabled.
+    /// Called automatically during the scene update, during the octree update and before octree queries. Does nothing outside
+    /// the main thread or while worker threads are running.
+    void UpdateTransforms();
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
+    /// Return the flat transform hierarchy, or null if not enabled.
+    TransformHierarchy* GetTransformHierarchy() const { return transformHierarchy_.Get(); }
 
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
@@ -275,15 +298,17 @@ private:
     void PreloadResourcesXML(const XMLElement& element);
     /// Preload resources from a JSON scene or object prefab file.
     void PreloadResourcesJSON(const JSONValue& value);
+    /// Preload resources from a compact scene.
+    void PreloadResourcesCompact(const SceneArchive& archive);
 
     /// Replicated scene nodes by ID.
-    HashMap<unsigned, Node*> replicatedNodes_;
+    FlatHashMap<unsigned, Node*> replicatedNodes_;
     /// Local scene nodes by ID.
-    HashMap<unsigned, Node*> localNodes_;
+    FlatHashMap<unsigned, Node*> localNodes_;
     /// Replicated components by ID.
-    HashMap<unsigned, Component*> replicatedComponents_;
+    FlatHashMap<unsigned, Component*> replicatedComponents_;
     /// Local components by ID.
-    HashMap<unsigned, Component*> localComponents_;
+    FlatHashMap<unsigned, Component*> localComponents_;
     /// Cached tagged nodes by tag.
     HashMap<StringHash, PODVector<Node*> > taggedNodes_;
     /// Asynchronous loading progress.
@@ -297,11 +322,13 @@ private:
     /// Registered node user variable reverse mappings.
     HashMap<StringHash, String> varNames_;
     /// Nodes to check for attribute changes on the next network update.
-    HashSet<unsigned> networkUpdateNodes_;
+    FlatHashSet<unsigned> networkUpdateNodes_;
     /// Components to check for attribute changes on the next network update.
-    HashSet<unsigned> networkUpdateComponents_;
+    FlatHashSet<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     PODVector<Component*> delayedDirtyComponents_;
+    /// Flat transform hierarchy, if enabled.
+    UniquePtr<TransformHierarchy> transformHierarchy_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
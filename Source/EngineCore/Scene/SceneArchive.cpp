@@ -0,0 +1,741 @@
+#include "../Precompiled.h"
+
+#include "../Container/ArrayPtr.h"
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Compression.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Scene/Component.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneArchive.h"
+#include "../Scene/SceneResolver.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+static const char* COMPACT_SCENE_FILE_ID = "CSCN";
+static const unsigned COMPACT_SCENE_VERSION = 1;
+static const unsigned COMPACT_SCENE_BLOCK_SIZE = 256 * 1024;
+static const unsigned CSF_COMPRESSED = 0x1;
+
+static const AttributeInfo* FindFileAttribute(const Vector<AttributeInfo>* attributes, const String& name, VariantType type)
+{
+    if (!attributes)
+        return 0;
+
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& attr = attributes->At(i);
+        if ((attr.mode_ & AM_FILE) && attr.type_ == type && attr.name_ == name)
+            return &attr;
+    }
+
+    return 0;
+}
+
+SceneArchive::SceneArchive() :
+    position_(0),
+    numNodes_(0)
+{
+}
+
+SceneArchive::~SceneArchive()
+{
+}
+
+bool SceneArchive::IsCompactScene(Deserializer& source)
+{
+    unsigned position = source.GetPosition();
+    bool isCompact = source.ReadFileID() == COMPACT_SCENE_FILE_ID;
+    source.Seek(position);
+    return isCompact;
+}
+
+bool SceneArchive::Save(const Scene* scene, Serializer& dest, bool compress)
+{
+    ATOMIC_PROFILE(SaveCompactScene);
+
+    Reset();
+    CollectNode(const_cast<Scene*>(scene), M_MAX_UNSIGNED);
+
+    // Write the sections before the string table, as they fill it
+    VectorBuffer structure;
+    WriteStructure(structure);
+    VectorBuffer sections;
+    WriteSections(sections);
+    if (!WriteBlobs(sections))
+    {
+        Reset();
+        return false;
+    }
+
+    VectorBuffer payload;
+    payload.WriteVLE(strings_.Size());
+    for (unsigned i = 0; i < strings_.Size(); ++i)
+        payload.WriteString(strings_[i]);
+    payload.WriteVLE(types_.Size());
+    for (unsigned i = 0; i < types_.Size(); ++i)
+        payload.WriteStringHash(types_[i]);
+    payload.Write(structure.GetData(), structure.GetSize());
+    payload.Write(sections.GetData(), sections.GetSize());
+
+    bool success = true;
+    success &= dest.WriteFileID(COMPACT_SCENE_FILE_ID);
+    success &= dest.WriteUInt(COMPACT_SCENE_VERSION);
+    success &= dest.WriteUInt(compress ? CSF_COMPRESSED : 0);
+    success &= dest.WriteUInt(payload.GetSize());
+
+    if (compress)
+    {
+        // Compress in fixed size blocks so that the loader never needs a second copy of the whole payload
+        unsigned numBlocks = (payload.GetSize() + COMPACT_SCENE_BLOCK_SIZE - 1) / COMPACT_SCENE_BLOCK_SIZE;
+        SharedArrayPtr<unsigned char> packed(new unsigned char[EstimateCompressBound(COMPACT_SCENE_BLOCK_SIZE)]);
+
+        success &= dest.WriteUInt(numBlocks);
+        for (unsigned i = 0; i < numBlocks; ++i)
+        {
+            unsigned offset = i * COMPACT_SCENE_BLOCK_SIZE;
+            unsigned unpackedSize = Min(payload.GetSize() - offset, COMPACT_SCENE_BLOCK_SIZE);
+            unsigned packedSize = CompressData(packed.Get(), payload.GetData() + offset, unpackedSize);
+            success &= dest.WriteUInt(unpackedSize);
+            success &= dest.WriteUInt(packedSize);
+            success &= dest.Write(packed.Get(), packedSize) == packedSize;
+        }
+    }
+    else
+        success &= dest.Write(payload.GetData(), payload.GetSize()) == payload.GetSize();
+
+    if (!success)
+        ATOMIC_LOGERROR("Could not save compact scene, writing to stream failed");
+
+    Reset();
+    return success;
+}
+
+bool SceneArchive::Load(Scene* scene, Deserializer& source, SceneResolver& resolver, bool setInstanceDefault)
+{
+    ATOMIC_PROFILE(LoadCompactScene);
+
+    bool success = BeginLoad(source);
+    while (success && nodes_.Size() < numNodes_)
+        success = LoadNode(scene, resolver);
+    success = success && EndLoad(setInstanceDefault);
+
+    Reset();
+    return success;
+}
+
+bool SceneArchive::BeginLoad(Deserializer& source)
+{
+    Reset();
+
+    if (source.ReadFileID() != COMPACT_SCENE_FILE_ID)
+    {
+        ATOMIC_LOGERROR(source.GetName() + " is not a valid compact scene file");
+        return false;
+    }
+
+    unsigned version = source.ReadUInt();
+    if (version > COMPACT_SCENE_VERSION)
+    {
+        ATOMIC_LOGERROR(source.GetName() + " has unsupported compact scene version " + String(version));
+        return false;
+    }
+
+    unsigned flags = source.ReadUInt();
+    unsigned payloadSize = source.ReadUInt();
+    if (!payloadSize)
+    {
+        ATOMIC_LOGERROR(source.GetName() + " has an invalid compact scene payload size");
+        return false;
+    }
+
+    // Bring the whole payload to memory with a few large reads, then parse it from there
+    payload_.Resize(payloadSize);
+    if (flags & CSF_COMPRESSED)
+    {
+        unsigned numBlocks = source.ReadUInt();
+        PODVector<unsigned char> packed;
+        unsigned offset = 0;
+
+        for (unsigned i = 0; i < numBlocks; ++i)
+        {
+            unsigned unpackedSize = source.ReadUInt();
+            unsigned packedSize = source.ReadUInt();
+            if (!unpackedSize || unpackedSize > payloadSize - offset || packedSize > EstimateCompressBound(unpackedSize))
+            {
+                ATOMIC_LOGERROR(source.GetName() + " has a corrupted compact scene block");
+                Reset();
+                return false;
+            }
+
+            packed.Resize(packedSize);
+            if (source.Read(&packed[0], packedSize) != packedSize)
+            {
+                ATOMIC_LOGERROR("Could not load " + source.GetName() + ", stream ended unexpectedly");
+                Reset();
+                return false;
+            }
+
+            DecompressData(&payload_[offset], &packed[0], unpackedSize);
+            offset += unpackedSize;
+        }
+
+        if (offset != payloadSize)
+        {
+            ATOMIC_LOGERROR(source.GetName() + " has a truncated compact scene payload");
+            Reset();
+            return false;
+        }
+    }
+    else if (source.Read(&payload_[0], payloadSize) != payloadSize)
+    {
+        ATOMIC_LOGERROR("Could not load " + source.GetName() + ", stream ended unexpectedly");
+        Reset();
+        return false;
+    }
+
+    MemoryBuffer buffer(payload_);
+    unsigned numStrings = buffer.ReadVLE();
+    strings_.Resize(numStrings);
+    for (unsigned i = 0; i < numStrings; ++i)
+        strings_[i] = buffer.ReadString();
+    unsigned numTypes = buffer.ReadVLE();
+    types_.Resize(numTypes);
+    for (unsigned i = 0; i < numTypes; ++i)
+        types_[i] = buffer.ReadStringHash();
+
+    numNodes_ = buffer.ReadVLE();
+    if (!numNodes_)
+    {
+        ATOMIC_LOGERROR("Compact scene contains no nodes");
+        Reset();
+        return false;
+    }
+
+    nodes_.Reserve(numNodes_);
+    position_ = buffer.GetPosition();
+    return true;
+}
+
+bool SceneArchive::LoadNode(Scene* scene, SceneResolver& resolver)
+{
+    if (nodes_.Size() >= numNodes_)
+        return false;
+
+    MemoryBuffer buffer(payload_);
+    buffer.Seek(position_);
+    bool success = ReadNode(scene, buffer, resolver);
+    position_ = buffer.GetPosition();
+    return success;
+}
+
+bool SceneArchive::EndLoad(bool setInstanceDefault)
+{
+    if (!numNodes_ || nodes_.Size() != numNodes_)
+    {
+        ATOMIC_LOGERROR("Compact scene attributes can not be loaded before all nodes are created");
+        return false;
+    }
+
+    MemoryBuffer buffer(payload_);
+    buffer.Seek(position_);
+    bool success = ReadSections(buffer, setInstanceDefault) && ReadBlobs(buffer, setInstanceDefault);
+
+    Reset();
+    return success;
+}
+
+void SceneArchive::GetResources(Context* context, Vector<ResourceRef>& dest) const
+{
+    MemoryBuffer buffer(payload_);
+    buffer.Seek(position_);
+
+    // Skip the structure, which holds no resources
+    for (unsigned i = 0; i < numNodes_; ++i)
+    {
+        buffer.ReadUInt();
+        if (i)
+            buffer.ReadVLE();
+        unsigned numComponents = buffer.ReadVLE();
+        for (unsigned j = 0; j < numComponents; ++j)
+        {
+            buffer.ReadVLE();
+            buffer.ReadUInt();
+            buffer.ReadBool();
+        }
+    }
+
+    // Resource names are only read from resource columns, the others are skipped whole
+    unsigned numSections = buffer.ReadVLE();
+    for (unsigned i = 0; i < numSections && !buffer.IsEof(); ++i)
+    {
+        buffer.ReadStringHash();
+        unsigned numObjects = buffer.ReadVLE();
+        unsigned numColumns = buffer.ReadVLE();
+        for (unsigned j = 0; j < numColumns; ++j)
+        {
+            buffer.ReadVLE();
+            VariantType columnType = (VariantType)buffer.ReadUByte();
+            unsigned columnSize = buffer.ReadVLE();
+            unsigned columnEnd = buffer.GetPosition() + columnSize;
+
+            if (columnType == VAR_RESOURCEREF)
+            {
+                for (unsigned k = 0; k < numObjects; ++k)
+                    dest.Push(ReadValue(buffer, columnType).GetResourceRef());
+            }
+            else if (columnType == VAR_RESOURCEREFLIST)
+            {
+                for (unsigned k = 0; k < numObjects; ++k)
+                {
+                    ResourceRefList refList = ReadValue(buffer, columnType).GetResourceRefList();
+                    for (unsigned l = 0; l < refList.names_.Size(); ++l)
+                        dest.Push(ResourceRef(refList.type_, refList.names_[l]));
+                }
+            }
+
+            buffer.Seek(columnEnd);
+        }
+    }
+
+    // Components stored as blobs are read like in a binary scene
+    unsigned numBlobs = buffer.ReadVLE();
+    for (unsigned i = 0; i < numBlobs && !buffer.IsEof(); ++i)
+    {
+        VectorBuffer compBuffer(buffer, buffer.ReadVLE());
+        StringHash compType = compBuffer.ReadStringHash();
+        compBuffer.ReadUInt();
+
+        const Vector<AttributeInfo>* attributes = context->GetAttributes(compType);
+        if (!attributes)
+            continue;
+
+        for (unsigned j = 0; j < attributes->Size(); ++j)
+        {
+            const AttributeInfo& attr = attributes->At(j);
+            if (!(attr.mode_ & AM_FILE))
+                continue;
+
+            Variant value = compBuffer.ReadVariant(attr.type_);
+            if (attr.type_ == VAR_RESOURCEREF)
+                dest.Push(value.GetResourceRef());
+            else if (attr.type_ == VAR_RESOURCEREFLIST)
+            {
+                const ResourceRefList& refList = value.GetResourceRefList();
+                for (unsigned k = 0; k < refList.names_.Size(); ++k)
+                    dest.Push(ResourceRef(refList.type_, refList.names_[k]));
+            }
+        }
+    }
+}
+
+void SceneArchive::Reset()
+{
+    payload_.Clear();
+    position_ = 0;
+    numNodes_ = 0;
+    nodes_.Clear();
+    parents_.Clear();
+    types_.Clear();
+    typeIndices_.Clear();
+    sections_.Clear();
+    sectionIndices_.Clear();
+    blobs_.Clear();
+    strings_.Clear();
+    stringIndices_.Clear();
+}
+
+void SceneArchive::CollectNode(Node* node, unsigned parentIndex)
+{
+    unsigned nodeIndex = nodes_.Size();
+    nodes_.Push(node);
+    parents_.Push(parentIndex);
+    AddToSection(node->GetType(), node);
+
+    const Vector<SharedPtr<Component> >& components = node->GetComponents();
+    for (unsigned i = 0; i < components.Size(); ++i)
+    {
+        Component* component = components[i];
+        if (component->IsTemporary())
+            continue;
+
+        AddType(component->GetType());
+        if (IsColumnar(component))
+            AddToSection(component->GetType(), component);
+        else
+            blobs_.Push(component);
+    }
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        Node* child = children[i];
+        if (!child->IsTemporary())
+            CollectNode(child, nodeIndex);
+    }
+}
+
+void SceneArchive::AddToSection(StringHash type, Serializable* object)
+{
+    HashMap<StringHash, unsigned>::ConstIterator i = sectionIndices_.Find(type);
+    if (i != sectionIndices_.End())
+    {
+        sections_[i->second_].objects_.Push(object);
+        return;
+    }
+
+    sectionIndices_[type] = sections_.Size();
+    sections_.Resize(sections_.Size() + 1);
+    sections_.Back().type_ = type;
+    sections_.Back().objects_.Push(object);
+}
+
+bool SceneArchive::IsColumnar(Component* component) const
+{
+    // Components with per-instance attribute lists (script components, unknown components) can not share columns, and
+    // components that do more in Load() than set their attributes, such as AnimatedModel, must be loaded through it
+    return !component->HasCustomLoad() &&
+        component->GetAttributes() == component->GetContext()->GetAttributes(component->GetType());
+}
+
+unsigned SceneArchive::AddType(StringHash type)
+{
+    HashMap<StringHash, unsigned>::ConstIterator i = typeIndices_.Find(type);
+    if (i != typeIndices_.End())
+        return i->second_;
+
+    unsigned index = types_.Size();
+    types_.Push(type);
+    typeIndices_[type] = index;
+    return index;
+}
+
+unsigned SceneArchive::AddString(const String& value)
+{
+    HashMap<String, unsigned>::ConstIterator i = stringIndices_.Find(value);
+    if (i != stringIndices_.End())
+        return i->second_;
+
+    unsigned index = strings_.Size();
+    strings_.Push(value);
+    stringIndices_[value] = index;
+    return index;
+}
+
+const String& SceneArchive::GetString(unsigned index) const
+{
+    return index < strings_.Size() ? strings_[index] : String::EMPTY;
+}
+
+void SceneArchive::WriteStructure(Serializer& dest)
+{
+    dest.WriteVLE(nodes_.Size());
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        Node* node = nodes_[i];
+        dest.WriteUInt(node->GetID());
+        // The scene itself is always first and has no parent
+        if (i)
+            dest.WriteVLE(parents_[i]);
+
+        const Vector<SharedPtr<Component> >& components = node->GetComponents();
+        dest.WriteVLE(node->GetNumPersistentComponents());
+        for (unsigned j = 0; j < components.Size(); ++j)
+        {
+            Component* component = components[j];
+            if (component->IsTemporary())
+                continue;
+
+            dest.WriteVLE(typeIndices_[component->GetType()]);
+            dest.WriteUInt(component->GetID());
+            dest.WriteBool(IsColumnar(component));
+        }
+    }
+}
+
+void SceneArchive::WriteSections(Serializer& dest)
+{
+    VectorBuffer column;
+    Variant value;
+
+    dest.WriteVLE(sections_.Size());
+    for (unsigned i = 0; i < sections_.Size(); ++i)
+    {
+        const Section& section = sections_[i];
+        const Vector<AttributeInfo>* attributes = section.objects_[0]->GetAttributes();
+
+        PODVector<const AttributeInfo*> fileAttributes;
+        if (attributes)
+        {
+            for (unsigned j = 0; j < attributes->Size(); ++j)
+            {
+                const AttributeInfo& attr = attributes->At(j);
+                if ((attr.mode_ & AM_FILE) && (attr.mode_ & AM_FILEREADONLY) != AM_FILEREADONLY)
+                    fileAttributes.Push(&attr);
+            }
+        }
+
+        dest.WriteStringHash(section.type_);
+        dest.WriteVLE(section.objects_.Size());
+        dest.WriteVLE(fileAttributes.Size());
+
+        for (unsigned j = 0; j < fileAttributes.Size(); ++j)
+        {
+            const AttributeInfo& attr = *fileAttributes[j];
+
+            column.Clear();
+            for (unsigned k = 0; k < section.objects_.Size(); ++k)
+            {
+                section.objects_[k]->OnGetAttribute(attr, value);
+                WriteValue(column, attr.type_, value);
+            }
+
+            // Store name, type and size so that removed or changed attributes can be skipped on load
+            dest.WriteVLE(AddString(attr.name_));
+            dest.WriteUByte((unsigned char)attr.type_);
+            dest.WriteVLE(column.GetSize());
+            dest.Write(column.GetData(), column.GetSize());
+        }
+    }
+}
+
+bool SceneArchive::WriteBlobs(Serializer& dest)
+{
+    VectorBuffer compBuffer;
+
+    dest.WriteVLE(blobs_.Size());
+    for (unsigned i = 0; i < blobs_.Size(); ++i)
+    {
+        compBuffer.Clear();
+        if (!blobs_[i]->Save(compBuffer))
+        {
+            ATOMIC_LOGERROR("Could not save component " + blobs_[i]->GetTypeName() + " to compact scene");
+            return false;
+        }
+
+        dest.WriteVLE(compBuffer.GetSize());
+        dest.Write(compBuffer.GetData(), compBuffer.GetSize());
+    }
+
+    return true;
+}
+
+void SceneArchive::WriteValue(Serializer& dest, VariantType type, const Variant& value)
+{
+    switch (type)
+    {
+    case VAR_STRING:
+        dest.WriteVLE(AddString(value.GetString()));
+        break;
+
+    case VAR_RESOURCEREF:
+        {
+            const ResourceRef& ref = value.GetResourceRef();
+            dest.WriteStringHash(ref.type_);
+            dest.WriteVLE(AddString(ref.name_));
+        }
+        break;
+
+    case VAR_RESOURCEREFLIST:
+        {
+            const ResourceRefList& refList = value.GetResourceRefList();
+            dest.WriteStringHash(refList.type_);
+            dest.WriteVLE(refList.names_.Size());
+            for (unsigned i = 0; i < refList.names_.Size(); ++i)
+                dest.WriteVLE(AddString(refList.names_[i]));
+        }
+        break;
+
+    case VAR_STRINGVECTOR:
+        {
+            const StringVector& strings = value.GetStringVector();
+            dest.WriteVLE(strings.Size());
+            for (unsigned i = 0; i < strings.Size(); ++i)
+                dest.WriteVLE(AddString(strings[i]));
+        }
+        break;
+
+    default:
+        dest.WriteVariantData(value);
+        break;
+    }
+}
+
+bool SceneArchive::ReadNode(Scene* scene, Deserializer& source, SceneResolver& resolver)
+{
+    unsigned index = nodes_.Size();
+    unsigned nodeID = source.ReadUInt();
+    Node* node = scene;
+    if (index)
+    {
+        unsigned parentIndex = source.ReadVLE();
+        if (parentIndex >= index)
+        {
+            ATOMIC_LOGERROR("Compact scene has an invalid parent node index");
+            return false;
+        }
+
+        node = nodes_[parentIndex]->CreateChild(nodeID, nodeID < FIRST_LOCAL_ID ? REPLICATED : LOCAL);
+    }
+
+    resolver.AddNode(nodeID, node);
+    nodes_.Push(node);
+    AddToSection(node->GetType(), node);
+
+    unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        unsigned typeIndex = source.ReadVLE();
+        unsigned compID = source.ReadUInt();
+        bool columnar = source.ReadBool();
+        if (typeIndex >= types_.Size())
+        {
+            ATOMIC_LOGERROR("Compact scene has an invalid component type index");
+            return false;
+        }
+
+        StringHash compType = types_[typeIndex];
+        Component* newComponent = node->SafeCreateComponent(String::EMPTY, compType,
+            compID < FIRST_LOCAL_ID ? REPLICATED : LOCAL, compID);
+        if (newComponent)
+            resolver.AddComponent(compID, newComponent);
+
+        // Keep failed components as null entries so that the attribute data stays aligned
+        if (columnar)
+            AddToSection(compType, newComponent);
+        else
+            blobs_.Push(newComponent);
+    }
+
+    return true;
+}
+
+bool SceneArchive::ReadSections(Deserializer& source, bool setInstanceDefault)
+{
+    Context* context = nodes_[0]->GetContext();
+
+    unsigned numSections = source.ReadVLE();
+    for (unsigned i = 0; i < numSections; ++i)
+    {
+        StringHash type = source.ReadStringHash();
+        unsigned numObjects = source.ReadVLE();
+
+        HashMap<StringHash, unsigned>::ConstIterator j = sectionIndices_.Find(type);
+        if (j == sectionIndices_.End() || sections_[j->second_].objects_.Size() != numObjects)
+        {
+            ATOMIC_LOGERROR("Compact scene attribute section does not match the scene structure");
+            return false;
+        }
+
+        const PODVector<Serializable*>& objects = sections_[j->second_].objects_;
+        const Vector<AttributeInfo>* attributes = context->GetAttributes(type);
+
+        unsigned numColumns = source.ReadVLE();
+        for (unsigned k = 0; k < numColumns; ++k)
+        {
+            const String& name = GetString(source.ReadVLE());
+            VariantType columnType = (VariantType)source.ReadUByte();
+            unsigned columnSize = source.ReadVLE();
+            unsigned columnEnd = source.GetPosition() + columnSize;
+
+            const AttributeInfo* attr = FindFileAttribute(attributes, name, columnType);
+            if (!attr)
+            {
+                // The attribute was removed or changed type since the scene was saved, or the type is unknown
+                source.Seek(columnEnd);
+                continue;
+            }
+
+            for (unsigned l = 0; l < objects.Size(); ++l)
+            {
+                Variant value = ReadValue(source, columnType);
+                Serializable* object = objects[l];
+                if (!object)
+                    continue;
+
+                object->OnSetAttribute(*attr, value);
+                if (setInstanceDefault)
+                    object->SetInstanceDefault(attr->name_, value);
+            }
+
+            if (source.GetPosition() != columnEnd)
+            {
+                ATOMIC_LOGERROR("Compact scene attribute column " + name + " is corrupted");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool SceneArchive::ReadBlobs(Deserializer& source, bool setInstanceDefault)
+{
+    unsigned numBlobs = source.ReadVLE();
+    if (numBlobs != blobs_.Size())
+    {
+        ATOMIC_LOGERROR("Compact scene component data does not match the scene structure");
+        return false;
+    }
+
+    for (unsigned i = 0; i < numBlobs; ++i)
+    {
+        VectorBuffer compBuffer(source, source.ReadVLE());
+        Component* component = blobs_[i];
+        if (!component)
+            continue;
+
+        // Type and ID were already read from the structure
+        compBuffer.ReadStringHash();
+        compBuffer.ReadUInt();
+        // Do not abort if component fails to load, as the component buffer is nested and we can skip to the next
+        component->Load(compBuffer, setInstanceDefault);
+    }
+
+    return true;
+}
+
+Variant SceneArchive::ReadValue(Deserializer& source, VariantType type) const
+{
+    switch (type)
+    {
+    case VAR_STRING:
+        return GetString(source.ReadVLE());
+
+    case VAR_RESOURCEREF:
+        {
+            ResourceRef ref;
+            ref.type_ = source.ReadStringHash();
+            ref.name_ = GetString(source.ReadVLE());
+            return ref;
+        }
+
+    case VAR_RESOURCEREFLIST:
+        {
+            ResourceRefList refList;
+            refList.type_ = source.ReadStringHash();
+            refList.names_.Resize(source.ReadVLE());
+            for (unsigned i = 0; i < refList.names_.Size(); ++i)
+                refList.names_[i] = GetString(source.ReadVLE());
+            return refList;
+        }
+
+    case VAR_STRINGVECTOR:
+        {
+            StringVector strings(source.ReadVLE());
+            for (unsigned i = 0; i < strings.Size(); ++i)
+                strings[i] = GetString(source.ReadVLE());
+            return strings;
+        }
+
+    default:
+        return source.ReadVariant(type);
+    }
+}
+
+}
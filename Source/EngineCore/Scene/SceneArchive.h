@@ -0,0 +1,118 @@
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Core/Variant.h"
+
+namespace Atomic
+{
+
+class Component;
+class Context;
+class Deserializer;
+class Node;
+class Scene;
+class SceneResolver;
+class Serializable;
+class Serializer;
+
+/// Compact binary scene container. Strings and resource names are stored once in a shared table, and the attributes of
+/// each node and component type are stored as columns, so that loading is a few bulk reads followed by in-memory parsing.
+class ATOMIC_API SceneArchive
+{
+public:
+    /// Construct.
+    SceneArchive();
+    /// Destruct.
+    ~SceneArchive();
+
+    /// Save a scene, optionally compressing the payload with LZ4. Return true if successful.
+    bool Save(const Scene* scene, Serializer& dest, bool compress = true);
+    /// Load a scene. The scene should be cleared beforehand. Loaded IDs are stored into the resolver, which the caller
+    /// should resolve before applying attributes. Return true if successful.
+    bool Load(Scene* scene, Deserializer& source, SceneResolver& resolver, bool setInstanceDefault = false);
+    /// Begin loading a scene in steps by reading the payload to memory. Return true if successful.
+    bool BeginLoad(Deserializer& source);
+    /// Create the next node and its components in hierarchy order. The first node is the scene itself. Return true if successful.
+    bool LoadNode(Scene* scene, SceneResolver& resolver);
+    /// Assign the attributes once all nodes are created and release the payload. Return true if successful.
+    bool EndLoad(bool setInstanceDefault = false);
+    /// Return the resources referenced by the attributes of the scene being loaded. Call before creating any nodes.
+    void GetResources(Context* context, Vector<ResourceRef>& dest) const;
+    /// Return number of nodes in the scene being loaded, including the scene itself.
+    unsigned GetNumNodes() const { return numNodes_; }
+    /// Return number of nodes created so far.
+    unsigned GetNumLoadedNodes() const { return nodes_.Size(); }
+
+    /// Return whether a stream contains a compact scene. Does not change the stream position.
+    static bool IsCompactScene(Deserializer& source);
+
+private:
+    /// Objects of one type whose attributes are stored as columns.
+    struct Section
+    {
+        /// Object type.
+        StringHash type_;
+        /// Objects in hierarchy order. Null entries are kept on load to stay aligned with the saved data.
+        PODVector<Serializable*> objects_;
+    };
+
+    /// Reset all tables.
+    void Reset();
+    /// Flatten a node and its persistent children into the node, type and section tables.
+    void CollectNode(Node* node, unsigned parentIndex);
+    /// Add an object to the column section of a type. The object may be null on load.
+    void AddToSection(StringHash type, Serializable* object);
+    /// Return whether a component's attributes can be stored as columns.
+    bool IsColumnar(Component* component) const;
+    /// Return index of a component type, adding it if new.
+    unsigned AddType(StringHash type);
+    /// Return index of a string, adding it if new.
+    unsigned AddString(const String& value);
+    /// Return string by index, or empty if out of range.
+    const String& GetString(unsigned index) const;
+
+    /// Write the node and component structure.
+    void WriteStructure(Serializer& dest);
+    /// Write all column sections.
+    void WriteSections(Serializer& dest);
+    /// Write components that could not be stored as columns.
+    bool WriteBlobs(Serializer& dest);
+    /// Write a single attribute value, replacing strings with string table indices.
+    void WriteValue(Serializer& dest, VariantType type, const Variant& value);
+
+    /// Read the structure of the next node and create it with its components.
+    bool ReadNode(Scene* scene, Deserializer& source, SceneResolver& resolver);
+    /// Read all column sections and assign the attributes.
+    bool ReadSections(Deserializer& source, bool setInstanceDefault);
+    /// Read components that were not stored as columns.
+    bool ReadBlobs(Deserializer& source, bool setInstanceDefault);
+    /// Read a single attribute value written by WriteValue().
+    Variant ReadValue(Deserializer& source, VariantType type) const;
+
+    /// Payload of the scene being loaded.
+    PODVector<unsigned char> payload_;
+    /// Read position in the payload.
+    unsigned position_;
+    /// Number of nodes in the scene being loaded.
+    unsigned numNodes_;
+    /// Nodes in hierarchy order. The scene is always first.
+    PODVector<Node*> nodes_;
+    /// Parent node index of each node.
+    PODVector<unsigned> parents_;
+    /// Component types.
+    Vector<StringHash> types_;
+    /// Component type indices.
+    HashMap<StringHash, unsigned> typeIndices_;
+    /// Column sections.
+    Vector<Section> sections_;
+    /// Column section indices by object type.
+    HashMap<StringHash, unsigned> sectionIndices_;
+    /// Components stored as separate attribute blobs.
+    PODVector<Component*> blobs_;
+    /// String table.
+    Vector<String> strings_;
+    /// String table indices.
+    HashMap<String, unsigned> stringIndices_;
+};
+
+}
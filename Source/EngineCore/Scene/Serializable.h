@@ -45,6 +45,8 @@ class ATOMIC_API Serializable : public Object
 {
     ATOMIC_OBJECT(Serializable, Object);
 
+    friend class SceneArchive;
+
 public:
     /// Construct.
     Serializable(Context* context);
@@ -77,6 +79,8 @@ public:
 
     /// Return whether should save default-valued attributes into XML. Default false.
     virtual bool SaveDefaultAttributes() const { return false; }
+    /// Return whether Load() does more than set the attributes, so that they can not be set from separately stored values. Default false.
+    virtual bool HasCustomLoad() const { return false; }
 
     /// Mark for attribute check on the next network update.
     virtual void MarkNetworkUpdate() { }
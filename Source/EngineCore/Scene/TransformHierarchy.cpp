@@ -0,0 +1,441 @@
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/TransformHierarchy.h"
+
+#include "../DebugNew.h"
+
+namespace Atomic
+{
+
+/// Minimum number of dirty entries per work item when the update is split across worker threads.
+static const unsigned MIN_TRANSFORMS_PER_WORK_ITEM = 1024;
+
+/// Subtree of an added node to insert into the index.
+struct TransformInsertion
+{
+    /// Added node.
+    Node* node_;
+    /// Index of the parent before the insertion.
+    unsigned parent_;
+    /// Index to insert at before the insertion, which is the end of the parent's subtree.
+    unsigned position_;
+};
+
+static inline bool CompareTransformInsertions(const TransformInsertion& lhs, const TransformInsertion& rhs)
+{
+    return lhs.position_ < rhs.position_;
+}
+
+void UpdateTransformsWork(const WorkItem* item, unsigned threadIndex)
+{
+    TransformHierarchy* hierarchy = reinterpret_cast<TransformHierarchy*>(item->aux_);
+    TransformRange* start = reinterpret_cast<TransformRange*>(item->start_);
+    TransformRange* end = reinterpret_cast<TransformRange*>(item->end_);
+
+    for (TransformRange* i = start; i < end; ++i)
+        hierarchy->UpdateRange(i->start_, i->end_);
+}
+
+TransformHierarchy::TransformHierarchy(Scene* scene) :
+    scene_(scene),
+    numRemoved_(0),
+    numUpdated_(0),
+    notifying_(false)
+{
+}
+
+TransformHierarchy::~TransformHierarchy()
+{
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        if (nodes_[i])
+            nodes_[i]->transformIndex_ = M_MAX_UNSIGNED;
+    }
+}
+
+bool TransformHierarchy::MarkDirty(Node* node)
+{
+    unsigned index = node->transformIndex_;
+    if (index >= nodes_.Size() || nodes_[index] != node)
+        return false;
+
+    // A flagged node that is still dirty has its whole subtree flagged and dirty already
+    if (dirty_[index] && node->dirty_)
+        return true;
+
+    dirtyRoots_.Push(index);
+
+    // Listeners are notified now, as with the immediate path, so that they see the change before the update. Only the
+    // world transforms are deferred. Listeners may mark further nodes dirty, but the update can not reorder the index
+    // until they are done
+    bool wasNotifying = notifying_;
+    notifying_ = true;
+
+    unsigned end = index + subtreeSizes_[index];
+    for (unsigned i = index; i < end; ++i)
+    {
+        Node* current = nodes_[i];
+        if (!current)
+            continue;
+
+        dirty_[i] = 1;
+        if (!current->dirty_)
+        {
+            current->dirty_ = true;
+            current->NotifyListeners();
+        }
+    }
+
+    notifying_ = wasNotifying;
+    return true;
+}
+
+void TransformHierarchy::AddNode(Node* node)
+{
+    // Before the first update the whole scene gets indexed at once
+    if (nodes_.Empty())
+        return;
+
+    // A node moved to another parent leaves its old position, and is inserted again with its subtree
+    unsigned index = node->transformIndex_;
+    if (index < nodes_.Size() && nodes_[index] == node)
+        DetachRange(index, index + subtreeSizes_[index]);
+
+    if (!addedNodes_.Contains(node))
+        addedNodes_.Push(node);
+}
+
+void TransformHierarchy::RemoveNode(Node* node)
+{
+    // The scene removes the children of a removed node one by one, so only the node's own entry is detached here
+    unsigned index = node->transformIndex_;
+    if (index < nodes_.Size() && nodes_[index] == node)
+        DetachRange(index, index + 1);
+    else
+        addedNodes_.Remove(node);
+}
+
+void TransformHierarchy::Update()
+{
+    // Listeners may query the octree, which updates the transforms again
+    if (notifying_)
+        return;
+
+    if (nodes_.Empty() || numRemoved_ > nodes_.Size() / 2)
+        Rebuild();
+    else if (!addedNodes_.Empty())
+        IndexAddedNodes();
+
+    numUpdated_ = 0;
+    if (dirtyRoots_.Empty())
+        return;
+
+    ATOMIC_PROFILE(UpdateTransforms);
+
+    // Drop the roots inside the subtree of a preceding root, so that the remaining subtrees are disjoint
+    Sort(dirtyRoots_.Begin(), dirtyRoots_.End());
+    unsigned numRoots = 0;
+    unsigned numDirty = 0;
+    unsigned coveredEnd = 0;
+    ranges_.Clear();
+    for (unsigned i = 0; i < dirtyRoots_.Size(); ++i)
+    {
+        unsigned root = dirtyRoots_[i];
+        if (root < coveredEnd || !nodes_[root])
+            continue;
+
+        coveredEnd = root + subtreeSizes_[root];
+        numDirty += subtreeSizes_[root];
+        dirtyRoots_[numRoots++] = root;
+        ranges_.Push(TransformRange(root, coveredEnd));
+    }
+    dirtyRoots_.Resize(numRoots);
+
+    WorkQueue* queue = scene_->GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = queue ? queue->GetNumThreads() + 1 : 1; // Worker threads + main thread
+
+    if (numWorkItems > 1 && numDirty >= MIN_TRANSFORMS_PER_WORK_ITEM * 2)
+    {
+        unsigned targetSize = Max(numDirty / numWorkItems, MIN_TRANSFORMS_PER_WORK_ITEM);
+
+        // Work items read the parents of their subtrees, so make sure those are not recalculated lazily in the workers
+        for (unsigned i = 0; i < ranges_.Size(); ++i)
+        {
+            unsigned parent = parents_[ranges_[i].start_];
+            if (parent != M_MAX_UNSIGNED && parent != 0 && nodes_[parent])
+                nodes_[parent]->GetWorldTransform();
+        }
+
+        // Split subtrees larger than a work item into their child subtrees. The subtree root is calculated here first
+        for (unsigned i = 0; i < ranges_.Size();)
+        {
+            TransformRange range = ranges_[i];
+            if (range.end_ - range.start_ <= targetSize)
+            {
+                ++i;
+                continue;
+            }
+
+            UpdateRange(range.start_, range.start_ + 1);
+            ranges_[i] = ranges_.Back();
+            ranges_.Pop();
+            for (unsigned child = range.start_ + 1; child < range.end_; child += subtreeSizes_[child])
+                ranges_.Push(TransformRange(child, child + subtreeSizes_[child]));
+        }
+
+        for (unsigned start = 0; start < ranges_.Size();)
+        {
+            unsigned end = start;
+            unsigned size = 0;
+            while (end < ranges_.Size() && size < targetSize)
+            {
+                size += ranges_[end].end_ - ranges_[end].start_;
+                ++end;
+            }
+
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = UpdateTransformsWork;
+            item->aux_ = this;
+            item->start_ = &ranges_[0] + start;
+            item->end_ = &ranges_[0] + end;
+            queue->AddWorkItem(item);
+
+            start = end;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+    else
+    {
+        for (unsigned i = 0; i < ranges_.Size(); ++i)
+            UpdateRange(ranges_[i].start_, ranges_[i].end_);
+    }
+
+    ClearDirty();
+}
+
+void TransformHierarchy::Rebuild()
+{
+    ATOMIC_PROFILE(RebuildTransformHierarchy);
+
+    // Keep the flagged nodes flagged under their new indices
+    PODVector<Node*> flagged;
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        if (nodes_[i])
+        {
+            if (dirty_[i])
+                flagged.Push(nodes_[i]);
+            nodes_[i]->transformIndex_ = M_MAX_UNSIGNED;
+        }
+    }
+
+    nodes_.Clear();
+    parents_.Clear();
+    subtreeSizes_.Clear();
+    addedNodes_.Clear();
+    numRemoved_ = 0;
+
+    IndexNode(scene_, M_MAX_UNSIGNED);
+
+    unsigned numNodes = nodes_.Size();
+    worldTransforms_.Resize(numNodes);
+    worldRotations_.Resize(numNodes);
+    dirty_.Resize(numNodes);
+    memset(&dirty_[0], 0, numNodes);
+
+    dirtyRoots_.Clear();
+    for (unsigned i = 0; i < flagged.Size(); ++i)
+    {
+        unsigned index = flagged[i]->transformIndex_;
+        dirty_[index] = 1;
+        dirtyRoots_.Push(index);
+    }
+}
+
+void TransformHierarchy::IndexAddedNodes()
+{
+    ATOMIC_PROFILE(IndexAddedNodes);
+
+    // Nodes added below a node that is itself waiting to be indexed get indexed as part of its subtree
+    PODVector<TransformInsertion> insertions;
+    for (unsigned i = 0; i < addedNodes_.Size(); ++i)
+    {
+        Node* node = addedNodes_[i];
+        Node* parent = node->GetParent();
+        if (node->transformIndex_ != M_MAX_UNSIGNED || !parent || parent->transformIndex_ == M_MAX_UNSIGNED)
+            continue;
+
+        TransformInsertion insertion;
+        insertion.node_ = node;
+        insertion.parent_ = parent->transformIndex_;
+        insertion.position_ = insertion.parent_ + subtreeSizes_[insertion.parent_];
+        insertions.Push(insertion);
+    }
+    addedNodes_.Clear();
+
+    if (insertions.Empty())
+        return;
+
+    Sort(insertions.Begin(), insertions.End(), CompareTransformInsertions);
+
+    // Move the entries after the first insertion aside. Nodes added under the scene go to the end, where nothing is moved
+    unsigned first = insertions[0].position_;
+    unsigned oldSize = nodes_.Size();
+    unsigned numMoved = oldSize - first;
+    PODVector<Node*> movedNodes(numMoved);
+    PODVector<unsigned> movedParents(numMoved);
+    PODVector<unsigned> movedSizes(numMoved);
+    PODVector<unsigned char> movedDirty(numMoved);
+    PODVector<unsigned> remap(numMoved);
+    if (numMoved)
+    {
+        memcpy(&movedNodes[0], &nodes_[first], numMoved * sizeof(Node*));
+        memcpy(&movedParents[0], &parents_[first], numMoved * sizeof(unsigned));
+        memcpy(&movedSizes[0], &subtreeSizes_[first], numMoved * sizeof(unsigned));
+        memcpy(&movedDirty[0], &dirty_[first], numMoved);
+    }
+    nodes_.Resize(first);
+    parents_.Resize(first);
+    subtreeSizes_.Resize(first);
+    dirty_.Resize(first);
+
+    unsigned next = 0;
+    for (unsigned i = first; i <= oldSize; ++i)
+    {
+        // Parents precede the insertion position, so their new index is known already
+        while (next < insertions.Size() && insertions[next].position_ == i)
+        {
+            const TransformInsertion& insertion = insertions[next++];
+            unsigned parent = insertion.parent_ < first ? insertion.parent_ : remap[insertion.parent_ - first];
+            unsigned start = nodes_.Size();
+            IndexNode(insertion.node_, parent);
+
+            unsigned count = nodes_.Size() - start;
+            dirty_.Resize(nodes_.Size());
+            memset(&dirty_[start], dirty_[parent], count);
+            for (unsigned j = parent; j != M_MAX_UNSIGNED; j = parents_[j])
+                subtreeSizes_[j] += count;
+        }
+
+        if (i == oldSize)
+            break;
+
+        unsigned k = i - first;
+        unsigned index = nodes_.Size();
+        remap[k] = index;
+        if (movedNodes[k])
+            movedNodes[k]->transformIndex_ = index;
+        nodes_.Push(movedNodes[k]);
+        unsigned parent = movedParents[k];
+        parents_.Push(parent == M_MAX_UNSIGNED || parent < first ? parent : remap[parent - first]);
+        subtreeSizes_.Push(movedSizes[k]);
+        dirty_.Push(movedDirty[k]);
+    }
+
+    for (unsigned i = 0; i < dirtyRoots_.Size(); ++i)
+    {
+        if (dirtyRoots_[i] >= first)
+            dirtyRoots_[i] = remap[dirtyRoots_[i] - first];
+    }
+
+    worldTransforms_.Resize(nodes_.Size());
+    worldRotations_.Resize(nodes_.Size());
+}
+
+void TransformHierarchy::IndexNode(Node* node, unsigned parentIndex)
+{
+    unsigned index = nodes_.Size();
+    node->transformIndex_ = index;
+    nodes_.Push(node);
+    parents_.Push(parentIndex);
+    subtreeSizes_.Push(1);
+
+    const Vector<SharedPtr<Node> >& children = node->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+        IndexNode(children[i], index);
+
+    subtreeSizes_[index] = nodes_.Size() - index;
+}
+
+void TransformHierarchy::DetachRange(unsigned start, unsigned end)
+{
+    // The entries stay as holes, so that subtree sizes and the indices of the other nodes remain valid. The listeners of
+    // flagged nodes were notified when flagged, and the nodes stay dirty to calculate their world transforms lazily
+    for (unsigned i = start; i < end; ++i)
+    {
+        Node* node = nodes_[i];
+        if (!node)
+            continue;
+
+        dirty_[i] = 0;
+        node->transformIndex_ = M_MAX_UNSIGNED;
+        nodes_[i] = 0;
+        ++numRemoved_;
+    }
+}
+
+void TransformHierarchy::UpdateRange(unsigned start, unsigned end)
+{
+    for (unsigned i = start; i < end; ++i)
+    {
+        if (!dirty_[i])
+            continue;
+
+        Node* node = nodes_[i];
+        if (node->dirty_)
+        {
+            // As in Node::UpdateWorldTransform(), the scene transform is not applied to its children
+            unsigned parent = parents_[i];
+            if (parent == M_MAX_UNSIGNED || parent == 0)
+            {
+                node->worldTransform_ = node->GetTransform();
+                node->worldRotation_ = node->rotation_;
+            }
+            else if (dirty_[parent])
+            {
+                // Parents precede their children, so a flagged parent has been calculated already
+                node->worldTransform_ = worldTransforms_[parent] * node->GetTransform();
+                node->worldRotation_ = worldRotations_[parent] * node->rotation_;
+            }
+            else
+            {
+                Node* parentNode = nodes_[parent];
+                node->worldTransform_ = parentNode->GetWorldTransform() * node->GetTransform();
+                node->worldRotation_ = parentNode->GetWorldRotation() * node->rotation_;
+            }
+
+            node->dirty_ = false;
+        }
+
+        worldTransforms_[i] = node->worldTransform_;
+        worldRotations_[i] = node->worldRotation_;
+    }
+}
+
+void TransformHierarchy::ClearDirty()
+{
+    numUpdated_ = 0;
+    for (unsigned i = 0; i < dirtyRoots_.Size(); ++i)
+    {
+        unsigned root = dirtyRoots_[i];
+        unsigned end = root + subtreeSizes_[root];
+        for (unsigned j = root; j < end; ++j)
+        {
+            if (dirty_[j])
+            {
+                dirty_[j] = 0;
+                ++numUpdated_;
+            }
+        }
+    }
+
+    dirtyRoots_.Clear();
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Math/Matrix3x4.h"
+#include "../Math/Quaternion.h"
+
+namespace Atomic
+{
+
+class Node;
+class Scene;
+struct WorkItem;
+
+/// Range of a dirty subtree in the flat transform hierarchy.
+struct TransformRange
+{
+    /// Construct undefined.
+    TransformRange()
+    {
+    }
+
+    /// Construct with start and end.
+    TransformRange(unsigned start, unsigned end) :
+        start_(start),
+        end_(end)
+    {
+    }
+
+    /// Index of the subtree root.
+    unsigned start_;
+    /// One past the last index of the subtree.
+    unsigned end_;
+};
+
+/// Flat view of a scene's node hierarchy used to update world transforms in bulk. Nodes are stored in depth-first order,
+/// so that parents always precede their children and every subtree is a contiguous range. Marking a node dirty flags its
+/// range and notifies the transform listeners of the newly dirty nodes right away; world transforms of the flagged ranges
+/// are then recalculated in one pass per update, optionally split across worker threads.
+class ATOMIC_API TransformHierarchy
+{
+    friend void UpdateTransformsWork(const WorkItem* item, unsigned threadIndex);
+
+public:
+    /// Construct.
+    TransformHierarchy(Scene* scene);
+    /// Destruct.
+    ~TransformHierarchy();
+
+    /// Flag a node and its children dirty and notify their listeners, deferring the world transforms to the next update.
+    /// Return false if the node is not indexed, in which case it must be marked dirty immediately.
+    bool MarkDirty(Node* node);
+    /// Handle a node added or moved to a new parent. Its subtree is inserted into the index on the next update; until then
+    /// it is marked dirty immediately.
+    void AddNode(Node* node);
+    /// Forget a node that is being removed from the scene.
+    void RemoveNode(Node* node);
+    /// Index added nodes and recalculate dirty world transforms. Must be called from the main thread.
+    void Update();
+
+    /// Return number of index entries, including those of removed nodes not yet compacted.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+    /// Return number of nodes updated by the last update.
+    unsigned GetNumUpdated() const { return numUpdated_; }
+
+private:
+    /// Index the whole node structure, dropping the entries of removed nodes.
+    void Rebuild();
+    /// Insert the subtrees of the added nodes after their parents' subtrees, moving only the entries that follow.
+    void IndexAddedNodes();
+    /// Index a node and its children recursively at the end.
+    void IndexNode(Node* node, unsigned parentIndex);
+    /// Remove the entries of a range from the index.
+    void DetachRange(unsigned start, unsigned end);
+    /// Recalculate world transforms of the flagged nodes in a range.
+    void UpdateRange(unsigned start, unsigned end);
+    /// Clear the flags of the updated nodes.
+    void ClearDirty();
+
+    /// Scene.
+    Scene* scene_;
+    /// Nodes in depth-first order. Removed nodes are nulled until the next rebuild.
+    PODVector<Node*> nodes_;
+    /// Parent index of each node. The scene has no parent.
+    PODVector<unsigned> parents_;
+    /// Number of entries in each node's subtree, including itself.
+    PODVector<unsigned> subtreeSizes_;
+    /// World transforms calculated during the update.
+    PODVector<Matrix3x4> worldTransforms_;
+    /// World rotations calculated during the update.
+    PODVector<Quaternion> worldRotations_;
+    /// Dirty flag of each node.
+    PODVector<unsigned char> dirty_;
+    /// Indices of the nodes marked dirty since the last update. Their subtrees are flagged.
+    PODVector<unsigned> dirtyRoots_;
+    /// Subtree ranges to recalculate, distributed to the work items.
+    PODVector<TransformRange> ranges_;
+    /// Nodes added or moved since the last update, waiting to be indexed.
+    PODVector<Node*> addedNodes_;
+    /// Number of nulled entries.
+    unsigned numRemoved_;
+    /// Number of nodes updated by the last update.
+    unsigned numUpdated_;
+    /// Listener notification in progress flag. The index is not reordered meanwhile.
+    bool notifying_;
+};
+
+}
@@ -58,6 +58,8 @@ public:
     virtual bool SaveXML(XMLElement& dest) const;
     /// Save as JSON data. Return true if successful.
     virtual bool SaveJSON(JSONValue& dest) const;
+    /// Return true, as the attribute data is kept as it was loaded.
+    virtual bool HasCustomLoad() const { return true; }
 
     /// Initialize the type name. Called by Node when loading.
     void SetTypeName(const String& typeName);
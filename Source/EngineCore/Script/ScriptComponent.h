@@ -53,6 +53,8 @@ public:
     bool Load(Deserializer& source, bool setInstanceDefault);
     /// Load from XML data. Return true if successful.
     bool LoadXML(const XMLElement& source, bool setInstanceDefault);
+    /// Return true, as field values are only applied when loaded through Load().
+    virtual bool HasCustomLoad() const { return true; }
 
     /// Save as binary data. Return true if successful.
     virtual bool Save(Serializer& dest) const;
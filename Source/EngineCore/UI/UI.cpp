@@ -149,6 +149,7 @@ UI::~UI()
 
         delete rootWidget_;
         widgetWrap_.Clear();
+        pruneCandidates_.Clear();
 
         // leak
         //delete TBUIRenderer::renderer_;
@@ -523,6 +524,7 @@ bool UI::UnwrapWidget(tb::TBWidget* widget)
     {
         widget->SetDelegate(0);
         widgetWrap_.Erase(widget);
+        pruneCandidates_.Erase(widget);
         return true;
     }
 
@@ -532,26 +534,44 @@ bool UI::UnwrapWidget(tb::TBWidget* widget)
 
 void UI::PruneUnreachableWidgets()
 {
-    HashMap<tb::TBWidget*, SharedPtr<UIWidget>>::Iterator itr;
+    if (pruneCandidates_.Empty())
+        return;
+
+    // Deleting a widget removes and unwraps its children, which changes the candidates while iterating
+    PODVector<tb::TBWidget*> candidates;
+    candidates.Reserve(pruneCandidates_.Size());
+    for (HashSet<tb::TBWidget*>::ConstIterator i = pruneCandidates_.Begin(); i != pruneCandidates_.End(); ++i)
+        candidates.Push(*i);
 
-    for (itr = widgetWrap_.Begin(); itr != widgetWrap_.End(); )
+    for (unsigned i = 0; i < candidates.Size(); ++i)
     {
-        if ((*itr).first_->GetParent() || (*itr).second_->Refs() > 1)
+        tb::TBWidget* toDelete = candidates[i];
+        if (!pruneCandidates_.Contains(toDelete))
+            continue;
+
+        HashMap<tb::TBWidget*, SharedPtr<UIWidget> >::Iterator itr = widgetWrap_.Find(toDelete);
+        if (itr == widgetWrap_.End())
         {
-            itr++;
+            pruneCandidates_.Erase(toDelete);
+            continue;
+        }
+
+        if (toDelete->GetParent())
+        {
+            pruneCandidates_.Erase(toDelete);
             continue;
         }
 
-        itr.GotoNext();
+        // Still referenced from script or native code, check again on the next prune
+        if (itr->second_->Refs() > 1)
+            continue;
 
         VariantMap eventData;
-        eventData[WidgetDeleted::P_WIDGET] = (UIWidget*) (*itr).second_;
-        (*itr).second_->SendEvent(E_WIDGETDELETED, eventData);
+        eventData[WidgetDeleted::P_WIDGET] = (UIWidget*) itr->second_;
+        itr->second_->SendEvent(E_WIDGETDELETED, eventData);
 
-        tb::TBWidget* toDelete = (*itr).first_;
         UnwrapWidget(toDelete);
         delete toDelete;
-
     }
 }
 
@@ -559,6 +579,9 @@ void UI::WrapWidget(UIWidget* widget, tb::TBWidget* tbwidget)
 {
     assert (!widgetWrap_.Contains(tbwidget));
     widgetWrap_[tbwidget] = widget;
+
+    if (!tbwidget->GetParent())
+        pruneCandidates_.Insert(tbwidget);
 }
 
 UIWidget* UI::WrapWidget(tb::TBWidget* widget)
@@ -831,6 +854,17 @@ bool UI::OnWidgetDying(tb::TBWidget *widget)
     return false;
 }
 
+void UI::OnWidgetAdded(tb::TBWidget *parent, tb::TBWidget *child)
+{
+    pruneCandidates_.Erase(child);
+}
+
+void UI::OnWidgetRemove(tb::TBWidget *parent, tb::TBWidget *child)
+{
+    if (widgetWrap_.Contains(child))
+        pruneCandidates_.Insert(child);
+}
+
 void UI::OnWindowClose(tb::TBWindow *window)
 {
     if (widgetWrap_.Contains(window))
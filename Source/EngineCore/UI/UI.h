@@ -24,6 +24,7 @@
 
 #include <ThirdParty/TurboBadger/tb_widgets_listener.h>
 
+#include "../Container/HashSet.h"
 #include "../Core/Object.h"
 #include "../UI/UIEnums.h"
 #include "../UI/UIBatch.h"
@@ -86,6 +87,8 @@ public:
 
     unsigned DebugGetWrappedWidgetCount() { return widgetWrap_.Size(); }
 
+    /// Delete wrapped widgets that have no parent and are only referenced by the UI. Only widgets that have been
+    /// removed from their parent, or were wrapped without one, are checked.
     void PruneUnreachableWidgets();
 
     void GetTBIDString(unsigned id, String& value);
@@ -148,6 +151,8 @@ private:
     void OnWidgetDelete(tb::TBWidget *widget);
     bool OnWidgetDying(tb::TBWidget *widget);    
     void OnWidgetFocusChanged(tb::TBWidget *widget, bool focused);
+    void OnWidgetAdded(tb::TBWidget *parent, tb::TBWidget *child);
+    void OnWidgetRemove(tb::TBWidget *parent, tb::TBWidget *child);
     bool OnWidgetInvokeEvent(tb::TBWidget *widget, const tb::TBWidgetEvent &ev);
     void OnWindowClose(tb::TBWindow *window);
 
@@ -164,6 +169,8 @@ private:
     WeakPtr<Graphics> graphics_;
 
     HashMap<tb::TBWidget*, SharedPtr<UIWidget> > widgetWrap_;
+    /// Wrapped widgets that may have no parent, checked when pruning.
+    HashSet<tb::TBWidget*> pruneCandidates_;
     HashMap<unsigned, String> tbidToString_;
 
     WeakPtr<UIPopupWindow> tooltip_;
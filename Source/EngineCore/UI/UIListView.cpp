@@ -20,8 +20,10 @@
 // THE SOFTWARE.
 //
 
+#include <TurboBadger/tb_core.h>
 #include <TurboBadger/tb_menu_window.h>
 #include <TurboBadger/tb_select.h>
+#include <TurboBadger/tb_system.h>
 
 #include "../IO/Log.h"
 #include "../Core/Timer.h"
@@ -390,6 +392,587 @@ TBWidget *ListViewItemSource::CreateItemWidget(int index, TBSelectItemViewer *vi
     return nullptr;
 }
 
+/// Number of rows kept beyond each edge of a virtualized list, so that short scrolls only rebind existing rows.
+static const int VIRTUAL_LIST_ROW_MARGIN = 2;
+/// Indent per tree level of a virtualized list in pixels.
+static const int VIRTUAL_LIST_INDENT = 6;
+
+class VirtualListRowWidget;
+
+/// Expanded item of a virtualized list.
+struct VirtualListRow
+{
+    /// Data source item.
+    unsigned item_;
+    /// Tree depth.
+    int depth_;
+    /// Whether the item has children.
+    bool expandable_;
+};
+
+/// Scrolled container of a virtualized UIListView. Keeps the expanded items as a flat row list and only creates row
+/// widgets for the rows in view, which are rebound to other items when scrolling.
+class VirtualListWidget : public TBWidget
+{
+    // For safe typecasting
+    TBOBJECT_SUBCLASS(VirtualListWidget, TBWidget)
+
+public:
+    VirtualListWidget(UIListView* listView);
+    virtual ~VirtualListWidget();
+
+    void InvalidateRows() { rowsInvalid_ = true; Invalidate(); }
+    void SetRowHeight(int height) { fixedRowHeight_ = height; rowHeight_ = height; UpdateRows(); }
+    int GetRowHeight() const { return rowHeight_; }
+
+    void SetExpanded(unsigned item, bool expanded, bool recursive = false);
+    bool GetExpanded(unsigned item) const { return expanded_.Contains(item); }
+    bool GetSelected(unsigned item) const { return selected_.Contains(item); }
+
+    void ClickRow(int row, int modifierKeys);
+    void SelectItem(unsigned item, bool selected);
+    void SelectAll(bool select);
+    void Move(SPECIAL_KEY key);
+    void ScrollToSelected();
+
+    String GetItemID(unsigned item) const;
+    unsigned GetFirstSelected() const;
+    unsigned GetRowItem(int row) const { return row >= 0 && row < (int)rows_.Size() ? rows_[row].item_ : M_MAX_UNSIGNED; }
+
+    virtual bool OnEvent(const TBWidgetEvent &ev);
+    virtual void OnProcess();
+    virtual void OnResized(int old_w, int old_h);
+    virtual void OnPaintChildren(const PaintProps &paint_props);
+
+private:
+    void ValidateRows();
+    void AddRows(unsigned parent, int depth);
+    void UpdateRows();
+    int FindRow(unsigned item) const;
+    void ScrollToRow(int row);
+    bool SetItemSelected(unsigned item, bool selected);
+    void SelectSingle(int row);
+
+    WeakPtr<UIListView> listView_;
+    TBScrollBar scrollbar_;
+    PODVector<VirtualListRow> rows_;
+    PODVector<VirtualListRowWidget*> rowWidgets_;
+    HashSet<unsigned> expanded_;
+    HashSet<unsigned> selected_;
+    int rowHeight_;
+    int fixedRowHeight_;
+    int pivotRow_;
+    bool rowsInvalid_;
+    bool updatingRows_;
+};
+
+/// Row widget of a virtualized list, rebound to another item when the list scrolls.
+class VirtualListRowWidget : public TBLayout
+{
+    // For safe typecasting
+    TBOBJECT_SUBCLASS(VirtualListRowWidget, TBLayout)
+
+public:
+    VirtualListRowWidget(VirtualListWidget* list);
+
+    void Bind(int row, const VirtualListRow& data, UIListViewDataSource* source, bool expanded, bool selected);
+    int GetRow() const { return row_; }
+
+    virtual bool OnEvent(const TBWidgetEvent &ev);
+
+private:
+    VirtualListWidget* list_;
+    TBWidget* indent_;
+    TBCheckBox* expandBox_;
+    TBWidget* expandSpacer_;
+    TBSkinImage* icon_;
+    TBTextField* textField_;
+    int row_;
+};
+
+VirtualListRowWidget::VirtualListRowWidget(VirtualListWidget* list)
+    : list_(list)
+    , row_(-1)
+{
+    SetLayoutDistribution(LAYOUT_DISTRIBUTION_GRAVITY);
+    SetLayoutDistributionPosition(LAYOUT_DISTRIBUTION_POSITION_LEFT_TOP);
+    SetPaintOverflowFadeout(false);
+    SetSkinBg(TBIDC("TBSelectItem"));
+
+    // All parts are created once and shown or hidden when binding an item
+    indent_ = new TBWidget();
+    GetContentRoot()->AddChild(indent_);
+
+    expandBox_ = new TBCheckBox();
+    expandBox_->SetSkinBg(TBIDC("TBCheckBox.uilistview"));
+    GetContentRoot()->AddChild(expandBox_);
+
+    LayoutParams lp;
+    lp.SetWidth(12);
+    lp.SetHeight(4);
+    expandSpacer_ = new TBWidget();
+    expandSpacer_->SetLayoutParams(lp);
+    GetContentRoot()->AddChild(expandSpacer_);
+
+    icon_ = new TBSkinImage();
+    icon_->SetIgnoreInput(true);
+    GetContentRoot()->AddChild(icon_);
+
+    TBFontDescription fd;
+    fd.SetID(TBIDC("Vera"));
+    fd.SetSize(11);
+
+    textField_ = new TBTextField();
+    textField_->SetIgnoreInput(true);
+    textField_->SetFontDescription(fd);
+    GetContentRoot()->AddChild(textField_);
+}
+
+void VirtualListRowWidget::Bind(int row, const VirtualListRow& data, UIListViewDataSource* source, bool expanded,
+    bool selected)
+{
+    row_ = row;
+
+    if (data.depth_)
+    {
+        LayoutParams lp;
+        lp.SetWidth(data.depth_ * VIRTUAL_LIST_INDENT);
+        lp.SetHeight(4);
+        indent_->SetLayoutParams(lp);
+        indent_->SetVisibilility(WIDGET_VISIBILITY_VISIBLE);
+    }
+    else
+        indent_->SetVisibilility(WIDGET_VISIBILITY_GONE);
+
+    expandBox_->SetVisibilility(data.expandable_ ? WIDGET_VISIBILITY_VISIBLE : WIDGET_VISIBILITY_GONE);
+    expandSpacer_->SetVisibilility(data.expandable_ ? WIDGET_VISIBILITY_GONE : WIDGET_VISIBILITY_VISIBLE);
+    if (data.expandable_)
+        expandBox_->SetValue(expanded ? 1 : 0);
+
+    String icon = source->GetIcon(data.item_);
+    if (icon.Length())
+    {
+        icon_->SetSkinBg(TBIDC(icon.CString()));
+        icon_->SetVisibilility(WIDGET_VISIBILITY_VISIBLE);
+    }
+    else
+        icon_->SetVisibilility(WIDGET_VISIBILITY_GONE);
+
+    String textSkin = source->GetTextSkin(data.item_);
+    textField_->SetSkinBg(textSkin.Length() ? TBIDC(textSkin.CString()) : TBIDC("Folder"));
+    textField_->SetText(source->GetText(data.item_).CString());
+
+    SetState(WIDGET_STATE_SELECTED, selected);
+    SetVisibilility(WIDGET_VISIBILITY_VISIBLE);
+}
+
+bool VirtualListRowWidget::OnEvent(const TBWidgetEvent &ev)
+{
+    if (ev.type == EVENT_TYPE_WHEEL)
+        return false;
+
+    if (ev.type == EVENT_TYPE_POINTER_DOWN && ev.target != expandBox_)
+    {
+        list_->SetFocus(WIDGET_FOCUS_REASON_POINTER);
+        list_->ClickRow(row_, ev.modifierkeys);
+        return true;
+    }
+
+    if (ev.type == EVENT_TYPE_RIGHT_POINTER_UP)
+    {
+        // Forward with the item ID, as the row widget itself is reused for other items
+        TBWidgetEvent nev = ev;
+        nev.ref_id = TBID(list_->GetItemID(list_->GetRowItem(row_)).CString());
+        list_->InvokeEvent(nev);
+        return true;
+    }
+
+    if (ev.type == EVENT_TYPE_CLICK && ev.target == expandBox_)
+    {
+        // If expanding with CTRL held down, expand all children too
+        unsigned item = list_->GetRowItem(row_);
+        bool expand = !list_->GetExpanded(item);
+        list_->SetExpanded(item, expand, expand && (ev.modifierkeys & TB_CTRL));
+        return true;
+    }
+
+    return TBLayout::OnEvent(ev);
+}
+
+VirtualListWidget::VirtualListWidget(UIListView* listView)
+    : listView_(listView)
+    , rowHeight_(0)
+    , fixedRowHeight_(0)
+    , pivotRow_(-1)
+    , rowsInvalid_(true)
+    , updatingRows_(false)
+{
+    SetIsFocusable(true);
+    SetSkinBg(TBIDC("TBSelectList"), WIDGET_INVOKE_INFO_NO_CALLBACKS);
+    scrollbar_.SetAxis(AXIS_Y);
+    AddChild(&scrollbar_);
+}
+
+VirtualListWidget::~VirtualListWidget()
+{
+    RemoveChild(&scrollbar_);
+
+    if (listView_ && listView_->virtualList_ == this)
+        listView_->virtualList_ = 0;
+}
+
+void VirtualListWidget::SetExpanded(unsigned item, bool expanded, bool recursive)
+{
+    UIListViewDataSource* source = listView_ ? listView_->GetDataSource() : 0;
+    if (!source)
+        return;
+
+    if (expanded)
+    {
+        expanded_.Insert(item);
+
+        // Expanding an item also expands its parents, like in the regular mode
+        for (unsigned parent = source->GetParent(item); parent != M_MAX_UNSIGNED; parent = source->GetParent(parent))
+            expanded_.Insert(parent);
+    }
+    else
+        expanded_.Erase(item);
+
+    if (recursive)
+    {
+        unsigned numChildren = source->GetNumChildren(item);
+        for (unsigned i = 0; i < numChildren; ++i)
+            SetExpanded(source->GetChild(item, i), expanded, true);
+    }
+
+    InvalidateRows();
+}
+
+void VirtualListWidget::ValidateRows()
+{
+    if (!rowsInvalid_)
+        return;
+    rowsInvalid_ = false;
+
+    rows_.Clear();
+    UIListViewDataSource* source = listView_ ? listView_->GetDataSource() : 0;
+    if (source)
+        AddRows(M_MAX_UNSIGNED, 0);
+
+    pivotRow_ = Min(pivotRow_, (int)rows_.Size() - 1);
+    UpdateRows();
+}
+
+void VirtualListWidget::AddRows(unsigned parent, int depth)
+{
+    UIListViewDataSource* source = listView_->GetDataSource();
+    unsigned numChildren = source->GetNumChildren(parent);
+
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        VirtualListRow row;
+        row.item_ = source->GetChild(parent, i);
+        row.depth_ = depth;
+        row.expandable_ = source->GetNumChildren(row.item_) > 0;
+        rows_.Push(row);
+
+        if (row.expandable_ && expanded_.Contains(row.item_))
+            AddRows(row.item_, depth + 1);
+    }
+}
+
+void VirtualListWidget::UpdateRows()
+{
+    // Setting the scrollbar limits may send a change event back to this function
+    if (updatingRows_)
+        return;
+
+    UIListViewDataSource* source = listView_ ? listView_->GetDataSource() : 0;
+    TBRect rect = GetPaddingRect();
+
+    if (!source || rows_.Empty() || rect.IsEmpty())
+    {
+        for (unsigned i = 0; i < rowWidgets_.Size(); ++i)
+            rowWidgets_[i]->SetVisibilility(WIDGET_VISIBILITY_GONE);
+        scrollbar_.SetVisibilility(WIDGET_VISIBILITY_GONE);
+        return;
+    }
+
+    updatingRows_ = true;
+
+    // Measure the row height from the first row, unless set
+    if (!rowHeight_)
+    {
+        if (rowWidgets_.Empty())
+        {
+            rowWidgets_.Push(new VirtualListRowWidget(this));
+            AddChild(rowWidgets_[0]);
+        }
+
+        rowWidgets_[0]->Bind(0, rows_[0], source, expanded_.Contains(rows_[0].item_), selected_.Contains(rows_[0].item_));
+        rowHeight_ = Max(rowWidgets_[0]->GetPreferredSize().pref_h, 1);
+    }
+
+    int contentHeight = (int)rows_.Size() * rowHeight_;
+    bool scrolling = contentHeight > rect.h;
+    int scrollbarWidth = scrolling ? scrollbar_.GetPreferredSize().pref_w : 0;
+
+    scrollbar_.SetVisibilility(scrolling ? WIDGET_VISIBILITY_VISIBLE : WIDGET_VISIBILITY_GONE);
+    scrollbar_.SetRect(TBRect(rect.x + rect.w - scrollbarWidth, rect.y, scrollbarWidth, rect.h));
+    scrollbar_.SetLimits(0, scrolling ? contentHeight - rect.h : 0, rect.h);
+
+    int scroll = scrolling ? scrollbar_.GetValue() : 0;
+    int firstRow = Max(scroll / rowHeight_ - VIRTUAL_LIST_ROW_MARGIN, 0);
+    int lastRow = Min((scroll + rect.h) / rowHeight_ + VIRTUAL_LIST_ROW_MARGIN, (int)rows_.Size() - 1);
+    int numRows = lastRow - firstRow + 1;
+
+    // Create row widgets as the view grows, and keep the unused ones hidden for reuse
+    while ((int)rowWidgets_.Size() < numRows)
+    {
+        rowWidgets_.Push(new VirtualListRowWidget(this));
+        AddChild(rowWidgets_.Back());
+    }
+
+    for (int i = 0; i < (int)rowWidgets_.Size(); ++i)
+    {
+        VirtualListRowWidget* widget = rowWidgets_[i];
+        if (i >= numRows)
+        {
+            widget->SetVisibilility(WIDGET_VISIBILITY_GONE);
+            continue;
+        }
+
+        int row = firstRow + i;
+        const VirtualListRow& data = rows_[row];
+        widget->Bind(row, data, source, expanded_.Contains(data.item_), selected_.Contains(data.item_));
+        widget->SetRect(TBRect(rect.x, rect.y + row * rowHeight_ - scroll, rect.w - scrollbarWidth, rowHeight_));
+    }
+
+    updatingRows_ = false;
+}
+
+int VirtualListWidget::FindRow(unsigned item) const
+{
+    for (unsigned i = 0; i < rows_.Size(); ++i)
+    {
+        if (rows_[i].item_ == item)
+            return (int)i;
+    }
+
+    return -1;
+}
+
+void VirtualListWidget::ScrollToRow(int row)
+{
+    if (row < 0 || !rowHeight_)
+        return;
+
+    int top = row * rowHeight_;
+    int visible = GetPaddingRect().h;
+    int scroll = scrollbar_.GetValue();
+
+    if (top < scroll)
+        scrollbar_.SetValue(top);
+    else if (top + rowHeight_ > scroll + visible)
+        scrollbar_.SetValue(top + rowHeight_ - visible);
+}
+
+void VirtualListWidget::ScrollToSelected()
+{
+    ValidateRows();
+
+    for (unsigned i = 0; i < rows_.Size(); ++i)
+    {
+        if (selected_.Contains(rows_[i].item_))
+        {
+            ScrollToRow((int)i);
+            return;
+        }
+    }
+}
+
+String VirtualListWidget::GetItemID(unsigned item) const
+{
+    UIListViewDataSource* source = listView_ ? listView_->GetDataSource() : 0;
+    return source && item != M_MAX_UNSIGNED ? source->GetID(item) : String::EMPTY;
+}
+
+unsigned VirtualListWidget::GetFirstSelected() const
+{
+    for (unsigned i = 0; i < rows_.Size(); ++i)
+    {
+        if (selected_.Contains(rows_[i].item_))
+            return rows_[i].item_;
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+bool VirtualListWidget::SetItemSelected(unsigned item, bool selected)
+{
+    if (selected_.Contains(item) == selected)
+        return false;
+
+    if (selected)
+        selected_.Insert(item);
+    else
+        selected_.Erase(item);
+
+    if (listView_)
+        listView_->SendSelectionChanged(GetItemID(item), selected);
+
+    return true;
+}
+
+void VirtualListWidget::SelectItem(unsigned item, bool selected)
+{
+    if (SetItemSelected(item, selected))
+        UpdateRows();
+}
+
+void VirtualListWidget::SelectSingle(int row)
+{
+    unsigned item = GetRowItem(row);
+    if (item == M_MAX_UNSIGNED)
+        return;
+
+    PODVector<unsigned> deselect;
+    for (HashSet<unsigned>::ConstIterator i = selected_.Begin(); i != selected_.End(); ++i)
+    {
+        if (*i != item)
+            deselect.Push(*i);
+    }
+
+    for (unsigned i = 0; i < deselect.Size(); ++i)
+        SetItemSelected(deselect[i], false);
+
+    SetItemSelected(item, true);
+    ScrollToRow(row);
+    UpdateRows();
+}
+
+void VirtualListWidget::SelectAll(bool select)
+{
+    if (!select)
+    {
+        selected_.Clear();
+        UpdateRows();
+        return;
+    }
+
+    // Only the expanded items are known without walking the whole model
+    ValidateRows();
+    for (unsigned i = 0; i < rows_.Size(); ++i)
+        selected_.Insert(rows_[i].item_);
+
+    UpdateRows();
+}
+
+void VirtualListWidget::ClickRow(int row, int modifierKeys)
+{
+    unsigned item = GetRowItem(row);
+    if (item == M_MAX_UNSIGNED || !listView_)
+        return;
+
+    bool multiSelect = listView_->GetMultiSelect();
+
+    if (multiSelect && (modifierKeys & TB_SHIFT) && pivotRow_ >= 0)
+    {
+        int first = Min(row, pivotRow_);
+        int last = Max(row, pivotRow_);
+        for (int i = first; i <= last; ++i)
+            SetItemSelected(rows_[i].item_, true);
+        UpdateRows();
+    }
+    else if (multiSelect && (modifierKeys & (TB_CTRL | TB_SUPER)))
+    {
+        SelectItem(item, !selected_.Contains(item));
+        pivotRow_ = row;
+    }
+    else
+    {
+        SelectSingle(row);
+        pivotRow_ = row;
+    }
+}
+
+void VirtualListWidget::Move(SPECIAL_KEY key)
+{
+    ValidateRows();
+
+    int row = FindRow(GetFirstSelected());
+    if (row < 0)
+        return;
+
+    const VirtualListRow& data = rows_[row];
+
+    if (key == TB_KEY_UP && row > 0)
+        SelectSingle(row - 1);
+    else if (key == TB_KEY_DOWN && row + 1 < (int)rows_.Size())
+        SelectSingle(row + 1);
+    else if (key == TB_KEY_LEFT)
+    {
+        if (data.expandable_ && expanded_.Contains(data.item_))
+            SetExpanded(data.item_, false);
+        else
+        {
+            // Select the parent, which is the nearest row above with a smaller depth
+            for (int i = row - 1; i >= 0; --i)
+            {
+                if (rows_[i].depth_ < data.depth_)
+                {
+                    SelectSingle(i);
+                    break;
+                }
+            }
+        }
+    }
+    else if (key == TB_KEY_RIGHT && data.expandable_)
+    {
+        if (!expanded_.Contains(data.item_))
+            SetExpanded(data.item_, true);
+        else if (row + 1 < (int)rows_.Size())
+            SelectSingle(row + 1);
+    }
+}
+
+bool VirtualListWidget::OnEvent(const TBWidgetEvent &ev)
+{
+    if (ev.type == EVENT_TYPE_CHANGED && ev.target == &scrollbar_)
+    {
+        UpdateRows();
+        return true;
+    }
+
+    if (ev.type == EVENT_TYPE_WHEEL && ev.modifierkeys == TB_MODIFIER_NONE)
+    {
+        int oldValue = scrollbar_.GetValue();
+        scrollbar_.SetValue(oldValue + ev.delta_y * TBSystem::GetPixelsPerLine());
+        return scrollbar_.GetValue() != oldValue;
+    }
+
+    return TBWidget::OnEvent(ev);
+}
+
+void VirtualListWidget::OnProcess()
+{
+    ValidateRows();
+}
+
+void VirtualListWidget::OnResized(int old_w, int old_h)
+{
+    TBWidget::OnResized(old_w, old_h);
+    UpdateRows();
+}
+
+void VirtualListWidget::OnPaintChildren(const PaintProps &paint_props)
+{
+    // Rows are positioned partly outside at the edges
+    TBRect old_clip_rect = g_renderer->SetClipRect(GetPaddingRect(), true);
+    TBWidget::OnPaintChildren(paint_props);
+    g_renderer->SetClipRect(old_clip_rect, false);
+}
+
 /*
 static int select_list_sort_cb(TBSelectItemSource *_source, const int *a, const int *b)
 {
@@ -415,7 +998,8 @@ static int select_list_sort_cb(TBSelectItemSource *_source, const int *a, const
 
 UIListView::UIListView(Context* context, bool createWidget) :
     UIWidget(context, createWidget),
-    source_(0), itemLookupId_(0), multiSelect_(false), moveDelta_(0.0f), pivot_(nullptr), pivotIndex_(0), startNewSelection_(true)
+    source_(0), itemLookupId_(0), multiSelect_(false), moveDelta_(0.0f), pivot_(nullptr), pivotIndex_(0), startNewSelection_(true),
+    virtualList_(0), rowHeight_(0)
 {
     rootList_ = new UISelectList(context);
     rootList_->SetUIListView(true);
@@ -550,6 +1134,12 @@ unsigned UIListView::AddChildItem(unsigned parentItemID, const String& text, con
 
 void UIListView::SetExpanded(unsigned itemID, bool value)
 {
+    if (virtualList_)
+    {
+        virtualList_->SetExpanded(itemID, value);
+        return;
+    }
+
     if (!itemLookup_.Contains(itemID))
         return;
 
@@ -559,6 +1149,9 @@ void UIListView::SetExpanded(unsigned itemID, bool value)
 
 bool UIListView::GetExpanded(unsigned itemID)
 {
+    if (virtualList_)
+        return virtualList_->GetExpanded(itemID);
+
     if (!itemLookup_.Contains(itemID))
         return false;
 
@@ -568,6 +1161,9 @@ bool UIListView::GetExpanded(unsigned itemID)
 
 bool UIListView::GetExpandable(unsigned itemID)
 {
+    if (virtualList_)
+        return dataSource_->GetNumChildren(itemID) > 0;
+
     if (!itemLookup_.Contains(itemID))
         return false;
 
@@ -584,6 +1180,23 @@ void UIListView::DeleteAllItems()
 
 void UIListView::SelectItemByID(const String& id, bool selected)
 {
+    if (virtualList_)
+    {
+        unsigned item = dataSource_->FindItem(id);
+        if (item == M_MAX_UNSIGNED || virtualList_->GetSelected(item) == selected)
+            return;
+
+        unsigned parent = dataSource_->GetParent(item);
+        if (selected && parent != M_MAX_UNSIGNED)
+            virtualList_->SetExpanded(parent, true);
+
+        virtualList_->SelectItem(item, selected);
+        if (selected)
+            virtualList_->ScrollToSelected();
+
+        return;
+    }
+
     TBID tid = TBIDC(id.CString());
 
     for (int i = 0; i < source_->GetNumItems(); i++)
@@ -622,6 +1235,12 @@ void UIListView::SelectItemByID(const String& id, bool selected)
 
 void UIListView::UpdateItemVisibility()
 {
+    if (virtualList_)
+    {
+        virtualList_->InvalidateRows();
+        return;
+    }
+
     for (int i = 0; i < source_->GetNumItems(); i++)
     {
         ListViewItem* item = source_->GetItem(i);
@@ -651,6 +1270,12 @@ void UIListView::UpdateItemVisibility()
 
 void UIListView::ScrollToSelectedItem()
 {
+    if (virtualList_)
+    {
+        virtualList_->ScrollToSelected();
+        return;
+    }
+
     if (rootList_.Null())
         return;
 
@@ -659,6 +1284,12 @@ void UIListView::ScrollToSelectedItem()
 
 void UIListView::SelectAllItems(bool select)
 {
+    if (virtualList_)
+    {
+        virtualList_->SelectAll(select);
+        return;
+    }
+
     for (int i = 0; i < source_->GetNumItems(); i++)
     {
         ListViewItem* item = source_->GetItem(i);
@@ -856,15 +1487,96 @@ void UIListView::SendItemSelectedChanged(ListViewItem* item)
 {
     UI* ui = GetSubsystem<UI>();
 
-    VariantMap eventData;
     String refid;
 
     ui->GetTBIDString(item->id, refid);
 
+    SendSelectionChanged(refid, item->GetSelected());
+}
+
+void UIListView::SendSelectionChanged(const String& refid, bool selected)
+{
+    VariantMap eventData;
+
     eventData[UIListViewSelectionChanged::P_REFID] = refid;
-    eventData[UIListViewSelectionChanged::P_SELECTED] = item->GetSelected();
+    eventData[UIListViewSelectionChanged::P_SELECTED] = selected;
     this->SendEvent(E_UILISTVIEWSELECTIONCHANGED, eventData);
+}
+
+String UIListView::GetHoverItemID()
+{
+    if (virtualList_)
+    {
+        // Find the row widget the hovered widget is part of
+        for (TBWidget* widget = TBWidget::hovered_widget; widget; widget = widget->GetParent())
+        {
+            if (widget->GetParent() == virtualList_ && widget->IsOfType<VirtualListRowWidget>())
+                return virtualList_->GetItemID(virtualList_->GetRowItem(static_cast<VirtualListRowWidget*>(widget)->GetRow()));
+        }
+
+        return String::EMPTY;
+    }
+
+    return rootList_.Null() ? "" : rootList_->GetHoverItemID();
+}
+
+String UIListView::GetSelectedItemID()
+{
+    if (virtualList_)
+        return virtualList_->GetItemID(virtualList_->GetFirstSelected());
+
+    return rootList_.Null() ? "" : rootList_->GetSelectedItemID();
+}
+
+void UIListView::SetDataSource(UIListViewDataSource* source)
+{
+    if (source == dataSource_)
+        return;
 
+    dataSource_ = source;
+
+    if (!widget_)
+        return;
+
+    // Expanded and selected items of the previous source are dropped with its rows
+    if (virtualList_)
+    {
+        widget_->RemoveChild(virtualList_);
+        delete virtualList_;
+    }
+
+    if (dataSource_)
+    {
+        virtualList_ = new VirtualListWidget(this);
+        virtualList_->SetGravity(WIDGET_GRAVITY_ALL);
+        virtualList_->SetRect(TBRect(0, 0, widget_->GetRect().w, widget_->GetRect().h));
+        if (rowHeight_)
+            virtualList_->SetRowHeight(rowHeight_);
+        widget_->AddChild(virtualList_);
+
+        rootList_->SetVisibility(UI_WIDGET_VISIBILITY_GONE);
+    }
+    else
+        rootList_->SetVisibility(UI_WIDGET_VISIBILITY_VISIBLE);
+}
+
+void UIListView::InvalidateDataSource()
+{
+    if (virtualList_)
+        virtualList_->InvalidateRows();
+}
+
+void UIListView::SetRowHeight(int height)
+{
+    rowHeight_ = Max(height, 0);
+
+    if (virtualList_)
+        virtualList_->SetRowHeight(rowHeight_);
+}
+
+int UIListView::GetRowHeight() const
+{
+    return virtualList_ ? virtualList_->GetRowHeight() : rowHeight_;
 }
 
 void UIListView::SelectItem(ListViewItem* item, bool select)
@@ -884,7 +1596,10 @@ bool UIListView::OnEvent(const tb::TBWidgetEvent &ev)
     {
         if (ev.special_key == TB_KEY_DOWN || ev.special_key == TB_KEY_UP || ev.special_key == TB_KEY_LEFT || ev.special_key == TB_KEY_RIGHT)
         {
-            Move(ev.special_key);
+            if (virtualList_)
+                virtualList_->Move(ev.special_key);
+            else
+                Move(ev.special_key);
             return true;
         }
     }
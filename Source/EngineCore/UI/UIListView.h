@@ -30,6 +30,38 @@ namespace Atomic
 
 class ListViewItemSource;
 class ListViewItem;
+class VirtualListWidget;
+
+/// Item model of a virtualized UIListView. Items are identified by numbers chosen by the data source and are only
+/// queried for expanded and visible rows, so a model may hold any number of items without a widget or wrapper object
+/// per item. M_MAX_UNSIGNED stands for the invisible root.
+class ATOMIC_API UIListViewDataSource : public RefCounted
+{
+    ATOMIC_REFCOUNTED(UIListViewDataSource)
+
+public:
+    /// Construct.
+    UIListViewDataSource() {}
+    /// Destruct.
+    virtual ~UIListViewDataSource() {}
+
+    /// Return number of children of an item.
+    virtual unsigned GetNumChildren(unsigned item) = 0;
+    /// Return child of an item by index.
+    virtual unsigned GetChild(unsigned item, unsigned index) = 0;
+    /// Return ID of an item, sent with selection events.
+    virtual String GetID(unsigned item) = 0;
+    /// Return text of an item.
+    virtual String GetText(unsigned item) = 0;
+    /// Return icon skin of an item, or empty for none.
+    virtual String GetIcon(unsigned item) { return String::EMPTY; }
+    /// Return text skin of an item, or empty for the default.
+    virtual String GetTextSkin(unsigned item) { return String::EMPTY; }
+    /// Return parent of an item. Needed for expanding the parents of an item selected by ID.
+    virtual unsigned GetParent(unsigned item) { return M_MAX_UNSIGNED; }
+    /// Return the item with an ID, or M_MAX_UNSIGNED if not found. Needed for selecting items by ID.
+    virtual unsigned FindItem(const String& id) { return M_MAX_UNSIGNED; }
+};
 
 class ATOMIC_API UIListView : public UIWidget
 {
@@ -64,8 +96,8 @@ public:
     void DeleteAllItems();
     void SelectItemByID(const String& id, bool selected = true);
 
-    String GetHoverItemID() { return rootList_.Null() ? "" : rootList_->GetHoverItemID(); }
-    String GetSelectedItemID() { return rootList_.Null() ? "" : rootList_->GetSelectedItemID(); }
+    String GetHoverItemID();
+    String GetSelectedItemID();
 
     UISelectList* GetRootList() { return rootList_; }
 
@@ -73,13 +105,29 @@ public:
 
     void SelectAllItems(bool select = true);
 
+    /// Show the items of a data source in virtualized mode, which only creates widgets for the rows in view and
+    /// reuses them while scrolling. Item IDs of the other functions are then data source items. Items added with
+    /// AddRootItem and AddChildItem are hidden meanwhile. Pass null to return to the regular mode.
+    void SetDataSource(UIListViewDataSource* source);
+    /// Return the data source of virtualized mode, or null.
+    UIListViewDataSource* GetDataSource() const { return dataSource_; }
+    /// Rebuild the rows of virtualized mode after items of the data source have changed.
+    void InvalidateDataSource();
+    /// Set row height of virtualized mode in pixels. 0 (default) measures the first row.
+    void SetRowHeight(int height);
+    /// Return row height of virtualized mode, or 0 if not known yet.
+    int GetRowHeight() const;
+
 protected:
 
     virtual bool OnEvent(const tb::TBWidgetEvent &ev);
 
 private:
 
+    friend class VirtualListWidget;
+
     void SendItemSelectedChanged(ListViewItem* item);
+    void SendSelectionChanged(const String& refid, bool selected);
 
     void SelectSingleItem(ListViewItem* item, bool expand = true);
     void SetValueFirstSelected();
@@ -102,6 +150,13 @@ private:
     int pivotIndex_;
     bool startNewSelection_;
 
+    /// Data source of virtualized mode.
+    SharedPtr<UIListViewDataSource> dataSource_;
+    /// Row widget container of virtualized mode, owned by the widget tree.
+    VirtualListWidget* virtualList_;
+    /// Row height of virtualized mode.
+    int rowHeight_;
+
 };
 
 }
@@ -60,7 +60,8 @@ TBUIBitmap::TBUIBitmap(UIRenderer *renderer)
 
 
 
-UIRenderer::UIRenderer(Context* context)
+UIRenderer::UIRenderer(Context* context) :
+    bitmapVersion_(0)
 {
     context_ = context;
     graphics_ = context->GetSubsystem<Graphics>();
@@ -139,6 +140,7 @@ TBUIBitmap::~TBUIBitmap()
 {
     // Must flush and unbind before we delete the texture
     renderer_->FlushBitmap(this);
+    renderer_->MarkBitmapsChanged();
 }
 
 bool TBUIBitmap::Init(int width, int height, tb::uint32 *data)
@@ -166,6 +168,7 @@ void TBUIBitmap::SetData(tb::uint32 *data)
 {
     renderer_->FlushBitmap(this);
     texture_->SetData(0, 0, 0, width_, height_, data);
+    renderer_->MarkBitmapsChanged();
 }
 
 }
@@ -58,11 +58,18 @@ public:
 
     Context* GetContext() { return context_; }
 
+    /// Return version number of the bitmaps, incremented when bitmap data is changed or a bitmap is destroyed.
+    /// Retained geometry built with an older version may refer to stale texture coordinates or textures.
+    unsigned GetBitmapVersion() const { return bitmapVersion_; }
+    /// Increment the bitmap version.
+    void MarkBitmapsChanged() { ++bitmapVersion_; }
+
 private:
     WeakPtr<Context> context_;
     PODVector<UIBatch>* batches_;
     PODVector<float>* vertexData_;
     IntRect currentScissor_;
+    unsigned bitmapVersion_;
 
     Graphics* graphics_;
 };
@@ -113,6 +113,8 @@ void UISceneView::OnResize(const IntVector2 &newSize)
 
         size_ = newSize;
 
+        // Repaint the view geometry with the new render texture
+        widget_->Invalidate();
     }
 }
 
@@ -215,6 +217,8 @@ void SceneViewWidget::OnPaint(const PaintProps &paint_props)
         sceneView_->SetResizeRequired();
         // early out here, responsible for flicker
         // https://github.com/AtomicGameEngine/AtomicGameEngine/issues/115
+        // The view retains its geometry, so paint again once resized
+        Invalidate();
         return;
     }
 
@@ -81,6 +81,9 @@ UITextureWidget::~UITextureWidget()
 void UITextureWidget::SetTexture(Texture *texture)
 {
     texture_ = texture;
+
+    // The texture is referenced by the retained geometry of the view
+    Invalidate();
 }
 
 Texture* UITextureWidget::GetTexture()
@@ -38,7 +38,27 @@ using namespace tb;
 namespace Atomic
 {
 
+/// Root widget of a UIView. Invalidating any widget also invalidates its ancestors, so the root learns about every
+/// change that needs repainting.
+class TBUIViewRoot : public TBWidget
+{
+public:
+    TBUIViewRoot(UIView* view) : view_(view) {}
+
+    virtual void OnInvalid()
+    {
+        if (view_)
+            view_->InvalidateGeometry();
+    }
+
+private:
+    WeakPtr<UIView> view_;
+};
+
 UIView::UIView(Context* context) : UIWidget(context, false),
+    geometryDirty_(true),
+    vertexDataDirty_(false),
+    bitmapVersion_(0),
     autoFocus_(true),
     mouseEnabled_(true),
     keyboardEnabled_(true)
@@ -52,7 +72,7 @@ UIView::UIView(Context* context) : UIWidget(context, false),
 
     renderer_ = ui_->GetRenderer();
 
-    widget_ = new TBWidget();
+    widget_ = new TBUIViewRoot(this);
     widget_->SetDelegate(this);
 
     // Set gravity all so we resize correctly
@@ -339,29 +359,48 @@ void UIView::SetVertexData(VertexBuffer* dest, const PODVector<float>& vertexDat
         return;
 
     // Update quad geometry into the vertex buffer
-    // Resize the vertex buffer first if too small or much too large
+    // Resize the vertex buffer first if too small or much too large. The buffer is not dynamic, as dynamic buffers
+    // lose their contents each frame on some backends, while the geometry is only uploaded when it changes
     unsigned numVertices = vertexData.Size() / UI_VERTEX_SIZE;
     if (dest->GetVertexCount() < numVertices || dest->GetVertexCount() > numVertices * 2)
-        dest->SetSize(numVertices, MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1, true);
+        dest->SetSize(numVertices, MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1, false);
 
-    dest->SetData(&vertexData[0]);
+    dest->SetDataRange(&vertexData[0], 0, numVertices);
 }
 
 
 void UIView::Render(bool resetRenderTargets)
 {
-    SetVertexData(vertexBuffer_, vertexData_);
+    if (vertexDataDirty_ || vertexBuffer_->IsDataLost())
+    {
+        SetVertexData(vertexBuffer_, vertexData_);
+        vertexBuffer_->ClearDataLost();
+        vertexDataDirty_ = false;
+    }
+
     Render(vertexBuffer_, batches_, 0, batches_.Size());
 }
 
 void UIView::UpdateUIBatches()
 {
+    // Keep the geometry of the previous frame unless a widget has been invalidated, or a bitmap the geometry may refer
+    // to has been changed or destroyed
+    if (!geometryDirty_ && bitmapVersion_ == renderer_->GetBitmapVersion())
+        return;
+
+    // Widgets invalidated while painting are rebuilt on the next update
+    geometryDirty_ = false;
+
     batches_.Clear();
     vertexData_.Clear();
 
     tb::TBRect rect = widget_->GetRect();
     IntRect currentScissor = IntRect(0, 0, rect.w, rect.h);
     GetBatches(batches_, vertexData_, currentScissor);
+
+    // Glyphs uploaded while painting are already included
+    bitmapVersion_ = renderer_->GetBitmapVersion();
+    vertexDataDirty_ = true;
 }
 
 void UIView::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor)
@@ -103,6 +103,10 @@ public:
     /// Low level vertex data submission
     void SubmitBatchVertexData(Texture* texture, const PODVector<float>& vertexData);
 
+    /// Mark the retained geometry for rebuilding on the next update. Called automatically when a widget in the view is
+    /// invalidated, which covers skin state, text and layout changes.
+    void InvalidateGeometry() { geometryDirty_ = true; }
+
 protected:
 
 private:
@@ -142,6 +146,13 @@ private:
 
     SharedPtr<RenderTexture> renderTexture_;
 
+    /// Whether the geometry needs rebuilding.
+    bool geometryDirty_;
+    /// Whether the vertex data has been rebuilt since the last upload.
+    bool vertexDataDirty_;
+    /// UI renderer bitmap version the geometry was built with.
+    unsigned bitmapVersion_;
+
     bool autoFocus_;
 
     bool mouseEnabled_;
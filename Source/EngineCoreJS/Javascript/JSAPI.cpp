@@ -100,6 +100,8 @@ namespace Atomic
         // pop heap stash
         duk_pop(ctx);
 
+        vm->ClearClassConstructor(uniqueClassID);
+
         // store the constructor
         duk_get_global_string(ctx, package);
         duk_push_c_function(ctx, constructor, DUK_VARARGS);
@@ -334,6 +336,95 @@ namespace Atomic
         return true;
     }
 
+    // returns the data of a Float32Array or Int32Array, or NULL for anything else
+    static void* js_get_typed_array_data(duk_context* ctx, duk_idx_t idx, bool& isFloat, unsigned& count)
+    {
+        if (!duk_is_object(ctx, idx) || !duk_is_buffer_data(ctx, idx))
+            return NULL;
+
+        JSVM* vm = JSVM::GetJSVM(ctx);
+
+        duk_get_prototype(ctx, idx);
+        void* prototype = duk_get_heapptr(ctx, -1);
+        duk_pop(ctx);
+
+        if (prototype == vm->GetFloat32ArrayPrototype())
+            isFloat = true;
+        else if (prototype == vm->GetInt32ArrayPrototype())
+            isFloat = false;
+        else
+            return NULL;
+
+        duk_size_t size;
+        void* data = duk_get_buffer_data(ctx, idx, &size);
+        count = (unsigned) (size / 4);
+        return data;
+    }
+
+    template<typename T>
+    static void js_push_number_array_impl(duk_context* ctx, const T* data, unsigned count, duk_uint_t bufferType)
+    {
+        if (!JSVM::GetJSVM(ctx)->GetTypedArrayMath())
+        {
+            duk_push_array(ctx);
+            for (unsigned i = 0; i < count; i++)
+            {
+                duk_push_number(ctx, data[i]);
+                duk_put_prop_index(ctx, -2, i);
+            }
+            return;
+        }
+
+        void* buffer = duk_push_fixed_buffer(ctx, count * sizeof(T));
+        memcpy(buffer, data, count * sizeof(T));
+        duk_push_buffer_object(ctx, -1, 0, count * sizeof(T), bufferType);
+        duk_remove(ctx, -2);
+    }
+
+    template<typename T>
+    static void js_to_number_array_impl(duk_context* ctx, duk_idx_t idx, T* data, unsigned count)
+    {
+        bool isFloat;
+        unsigned length;
+        const void* typed = js_get_typed_array_data(ctx, idx, isFloat, length);
+
+        if (typed && length >= count)
+        {
+            for (unsigned i = 0; i < count; i++)
+                data[i] = isFloat ? (T) ((const float*) typed)[i] : (T) ((const int*) typed)[i];
+            return;
+        }
+
+        idx = duk_normalize_index(ctx, idx);
+
+        for (unsigned i = 0; i < count; i++)
+        {
+            duk_get_prop_index(ctx, idx, i);
+            data[i] = (T) duk_to_number(ctx, -1);
+            duk_pop(ctx);
+        }
+    }
+
+    void js_push_number_array(duk_context* ctx, const float* data, unsigned count)
+    {
+        js_push_number_array_impl(ctx, data, count, DUK_BUFOBJ_FLOAT32ARRAY);
+    }
+
+    void js_push_number_array(duk_context* ctx, const int* data, unsigned count)
+    {
+        js_push_number_array_impl(ctx, data, count, DUK_BUFOBJ_INT32ARRAY);
+    }
+
+    void js_to_number_array(duk_context* ctx, duk_idx_t idx, float* data, unsigned count)
+    {
+        js_to_number_array_impl(ctx, idx, data, count);
+    }
+
+    void js_to_number_array(duk_context* ctx, duk_idx_t idx, int* data, unsigned count)
+    {
+        js_to_number_array_impl(ctx, idx, data, count);
+    }
+
     void js_get_default_variant(VariantType variantType, Variant& value)
     {
         value = Variant::EMPTY;
@@ -481,6 +572,73 @@ namespace Atomic
             return;
         }
 
+        // math values passed as typed arrays, as pushed by js_push_variant. Only converted when a math type is
+        // expected, otherwise a typed array is a buffer
+        {
+            unsigned count = 0;
+            switch (variantType)
+            {
+            case VAR_VECTOR2:
+            case VAR_INTVECTOR2:
+                count = 2;
+                break;
+            case VAR_VECTOR3:
+            case VAR_INTVECTOR3:
+            case VAR_QUATERNION:
+                count = 3;
+                break;
+            case VAR_VECTOR4:
+            case VAR_INTRECT:
+            case VAR_COLOR:
+                count = 4;
+                break;
+            default:
+                break;
+            }
+
+            bool isFloat;
+            unsigned length;
+            if (count && js_get_typed_array_data(ctx, variantIdx, isFloat, length) && length >= count)
+            {
+                float data[4];
+                int intData[4];
+                if (variantType == VAR_INTVECTOR2 || variantType == VAR_INTVECTOR3 || variantType == VAR_INTRECT)
+                    js_to_number_array(ctx, variantIdx, intData, count);
+                else
+                    js_to_number_array(ctx, variantIdx, data, count);
+
+                switch (variantType)
+                {
+                case VAR_VECTOR2:
+                    v = Vector2(data);
+                    break;
+                case VAR_INTVECTOR2:
+                    v = IntVector2(intData);
+                    break;
+                case VAR_VECTOR3:
+                    v = Vector3(data);
+                    break;
+                case VAR_INTVECTOR3:
+                    v = IntVector3(intData);
+                    break;
+                case VAR_QUATERNION:
+                    v = Quaternion(data[0], data[1], data[2]);
+                    break;
+                case VAR_VECTOR4:
+                    v = Vector4(data);
+                    break;
+                case VAR_INTRECT:
+                    v = IntRect(intData);
+                    break;
+                default:
+                    v = Color(data);
+                    break;
+                }
+
+                return;
+            }
+        }
+
         {
             void* bufferData;
             duk_size_t bufferSize;
@@ -580,13 +738,9 @@ namespace Atomic
     }
 
 
-    void js_push_variantmap(duk_context* ctx, const VariantMap &vmap)
+    void js_put_variantmap_values(duk_context* ctx, duk_idx_t objIdx, const VariantMap &vmap)
     {
-
-        // setup proxy so we can map string
-        duk_get_global_string(ctx, "Proxy");
-
-        duk_push_object(ctx);
+        objIdx = duk_normalize_index(ctx, objIdx);
 
         VariantMap::ConstIterator itr = vmap.Begin();
 
@@ -601,23 +755,53 @@ namespace Atomic
             }
             else
             {
-                duk_put_prop_index(ctx, -2, (unsigned)itr->first_.Value());
+                duk_put_prop_index(ctx, objIdx, (unsigned)itr->first_.Value());
             }
 
             itr++;
 
         }
 
-        // setup property handler
-        duk_push_object(ctx);
-        duk_push_c_function(ctx, variantmap_property_get, 3);
-        duk_put_prop_string(ctx, -2, "get");
-        duk_push_c_function(ctx, variantmap_property_deleteproperty, 2);
-        duk_put_prop_string(ctx, -2, "deleteProperty");
+    }
 
-        duk_new(ctx, 2);
+    void js_push_variantmap_proxy(duk_context* ctx, duk_idx_t targetIdx)
+    {
+        targetIdx = duk_normalize_index(ctx, targetIdx);
 
+        // setup proxy so we can map string
+        duk_get_global_string(ctx, "Proxy");
+
+        duk_dup(ctx, targetIdx);
+
+        // the property handler is shared by all variant map proxies
+        duk_push_global_stash(ctx);
+        duk_get_prop_index(ctx, -1, JS_GLOBALSTASH_VARIANTMAP_HANDLER);
+
+        if (!duk_is_object(ctx, -1))
+        {
+            duk_pop(ctx);
 
+            duk_push_object(ctx);
+            duk_push_c_function(ctx, variantmap_property_get, 3);
+            duk_put_prop_string(ctx, -2, "get");
+            duk_push_c_function(ctx, variantmap_property_deleteproperty, 2);
+            duk_put_prop_string(ctx, -2, "deleteProperty");
+
+            duk_dup(ctx, -1);
+            duk_put_prop_index(ctx, -3, JS_GLOBALSTASH_VARIANTMAP_HANDLER);
+        }
+
+        duk_remove(ctx, -2); // global stash
+
+        duk_new(ctx, 2);
+    }
+
+    void js_push_variantmap(duk_context* ctx, const VariantMap &vmap)
+    {
+        duk_push_object(ctx);
+        js_put_variantmap_values(ctx, -1, vmap);
+        js_push_variantmap_proxy(ctx, -1);
+        duk_remove(ctx, -2); // target
     }
 
     void js_push_variant(duk_context *ctx, const Variant& v, int arrayIndex)
@@ -644,18 +828,12 @@ namespace Atomic
             }
 
             // check that class is supported
-            duk_push_heap_stash(ctx);
-            duk_push_pointer(ctx, (void*)ref->GetClassID());
-            duk_get_prop(ctx, -2);
-
-            if (!duk_is_object(ctx, -1))
+            if (!JSVM::GetJSVM(ctx)->GetClassConstructor((const void*)ref->GetClassID()))
             {
-                duk_pop_2(ctx);
                 duk_push_undefined(ctx);
             }
             else
             {
-                duk_pop_2(ctx);
                 js_push_class_object_instance(ctx, ref);
             }
 
@@ -729,73 +907,49 @@ namespace Atomic
         case VAR_VECTOR2:
         {
             const Vector2& vector2(v.GetVector2());
-            duk_push_array(ctx);
-            duk_push_number(ctx, vector2.x_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, vector2.y_);
-            duk_put_prop_index(ctx, -2, 1);
+            js_push_number_array(ctx, vector2.Data(), 2);
         }   break;
 
         case VAR_INTVECTOR2:
         {
             const IntVector2& intVector2(v.GetIntVector2());
-            duk_push_array(ctx);
-            duk_push_number(ctx, intVector2.x_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, intVector2.y_);
-            duk_put_prop_index(ctx, -2, 1);
+            js_push_number_array(ctx, intVector2.Data(), 2);
         }   break;
 
         case VAR_VECTOR3:
         {
             const Vector3& vector3(v.GetVector3());
-            duk_push_array(ctx);
-            duk_push_number(ctx, vector3.x_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, vector3.y_);
-            duk_put_prop_index(ctx, -2, 1);
-            duk_push_number(ctx, vector3.z_);
-            duk_put_prop_index(ctx, -2, 2);
+            js_push_number_array(ctx, vector3.Data(), 3);
+        }   break;
+
+        case VAR_INTVECTOR3:
+        {
+            const IntVector3& intVector3(v.GetIntVector3());
+            js_push_number_array(ctx, intVector3.Data(), 3);
         }   break;
 
         case VAR_QUATERNION:
         {
             const Vector3& vector3(v.GetQuaternion().EulerAngles());
-            duk_push_array(ctx);
-            duk_push_number(ctx, vector3.x_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, vector3.y_);
-            duk_put_prop_index(ctx, -2, 1);
-            duk_push_number(ctx, vector3.z_);
-            duk_put_prop_index(ctx, -2, 2);
+            js_push_number_array(ctx, vector3.Data(), 3);
         }   break;
 
         case VAR_COLOR:
         {
             const Color& color(v.GetColor());
-            duk_push_array(ctx);
-            duk_push_number(ctx, color.r_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, color.g_);
-            duk_put_prop_index(ctx, -2, 1);
-            duk_push_number(ctx, color.b_);
-            duk_put_prop_index(ctx, -2, 2);
-            duk_push_number(ctx, color.a_);
-            duk_put_prop_index(ctx, -2, 3);
+            js_push_number_array(ctx, color.Data(), 4);
         }   break;
 
         case VAR_VECTOR4:
         {
             const Vector4& vector4(v.GetVector4());
-            duk_push_array(ctx);
-            duk_push_number(ctx, vector4.x_);
-            duk_put_prop_index(ctx, -2, 0);
-            duk_push_number(ctx, vector4.y_);
-            duk_put_prop_index(ctx, -2, 1);
-            duk_push_number(ctx, vector4.z_);
-            duk_put_prop_index(ctx, -2, 2);
-            duk_push_number(ctx, vector4.w_);
-            duk_put_prop_index(ctx, -2, 3);
+            js_push_number_array(ctx, vector4.Data(), 4);
+        }   break;
+
+        case VAR_INTRECT:
+        {
+            const IntRect& intRect(v.GetIntRect());
+            js_push_number_array(ctx, intRect.Data(), 4);
         }   break;
 
         case VAR_VARIANTVECTOR:
@@ -30,6 +30,9 @@ typedef void* JS_HEAP_PTR;
 
 #define JS_GLOBALSTASH_INDEX_REFCOUNTED_REGISTRY 0
 #define JS_GLOBALSTASH_VARIANTMAP_CACHE 1
+#define JS_GLOBALSTASH_VARIANTMAP_HANDLER 2
+#define JS_GLOBALSTASH_EVENT_OBJECTS 3
+#define JS_GLOBALSTASH_TYPEDARRAY_PROTOTYPES 4
 
 // indexers for instance objects
 #define JS_INSTANCE_INDEX_FINALIZED 0
@@ -61,6 +64,19 @@ void js_define_native_event(duk_context* ctx, const String& eventType, const Str
 void js_push_variant(duk_context* ctx, const Variant &v, int arrayIndex = -1);
 void js_push_variantmap(duk_context* ctx, const VariantMap &vmap);
 
+/// Sets the values of a variant map as index properties of the object at objIdx, keyed by StringHash value
+void js_put_variantmap_values(duk_context* ctx, duk_idx_t objIdx, const VariantMap &vmap);
+/// Pushes a Proxy of the object at targetIdx, which maps property names to StringHash index properties
+void js_push_variantmap_proxy(duk_context* ctx, duk_idx_t targetIdx);
+
+/// Pushes a math value (Vector3, Color, etc) as a Float32Array, or a plain array if typed array math is disabled
+void js_push_number_array(duk_context* ctx, const float* data, unsigned count);
+/// Pushes an integer math value (IntVector2, IntRect) as an Int32Array, or a plain array if typed array math is disabled
+void js_push_number_array(duk_context* ctx, const int* data, unsigned count);
+/// Reads a math value from a Float32Array, Int32Array or plain array, typed arrays are copied without property lookups
+void js_to_number_array(duk_context* ctx, duk_idx_t idx, float* data, unsigned count);
+void js_to_number_array(duk_context* ctx, duk_idx_t idx, int* data, unsigned count);
+
 // Get a default value for the given variant type and set variantOut
 void js_get_default_variant(VariantType variantType, Variant& variantOut);
 
@@ -24,6 +24,7 @@
 #include <EngineCore/IO/Log.h>
 #include <EngineCore/IO/FileSystem.h>
 #include <EngineCore/Core/Context.h>
+#include <EngineCore/Core/Timer.h>
 #include <EngineCore/Resource/ResourceCache.h>
 
 #ifdef ENGINE_PHYSICS
@@ -121,6 +122,8 @@ JSComponent::JSComponent(Context* context) :
     ScriptComponent(context),
     updateEventMask_(USE_UPDATE | USE_POSTUPDATE | USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE),
     currentEventMask_(0),
+    batchedEventMask_(0),
+    startFrame_(M_MAX_UNSIGNED),
     instanceInitialized_(false),
     started_(false),
     destroyed_(false),
@@ -128,11 +131,14 @@ JSComponent::JSComponent(Context* context) :
     delayedStartCalled_(false)
 {
     vm_ = JSVM::GetJSVM(NULL);
+
+    for (unsigned i = 0; i < MAX_JS_BATCH_EVENTS; i++)
+        batchIndices_[i] = M_MAX_UNSIGNED;
 }
 
 JSComponent::~JSComponent()
 {
-
+    SetBatchedEvents(0);
 }
 
 void JSComponent::RegisterObject(Context* context)
@@ -156,6 +162,19 @@ void JSComponent::SetUpdateEventMask(unsigned char mask)
     }
 }
 
+void JSComponent::SetComponentFile(JSComponentFile* cfile)
+{
+    if (componentFile_.Get() == cfile)
+        return;
+
+    // batches belong to the component file
+    SetBatchedEvents(0);
+
+    componentFile_ = cfile;
+
+    UpdateEventSubscription();
+}
+
 bool JSComponent::IsInstanceInitialized() {
     return instanceInitialized_;
 }
@@ -378,11 +397,13 @@ void JSComponent::OnSceneSet(Scene* scene)
     {
         UnsubscribeFromEvent(E_SCENEUPDATE);
         UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
-#ifdef ATOMIC_PHYSICS
+#ifdef ENGINE_PHYSICS
         UnsubscribeFromEvent(E_PHYSICSPRESTEP);
         UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
 #endif
         currentEventMask_ = 0;
+
+        SetBatchedEvents(0);
     }
 }
 
@@ -394,7 +415,19 @@ void JSComponent::UpdateEventSubscription()
 
     bool enabled = IsEnabledEffective();
 
-    bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
+    // events the script class handles with static batch methods, the update only once the delayed start has been called
+    unsigned char batchMask = 0;
+    if (enabled && scriptClassInstance_ && componentFile_.NotNull())
+        batchMask = componentFile_->GetBatchEventMask() & updateEventMask_;
+    if (!delayedStartCalled_)
+        batchMask &= ~USE_UPDATE;
+#ifndef ENGINE_PHYSICS
+    batchMask &= USE_UPDATE | USE_POSTUPDATE;
+#endif
+
+    SetBatchedEvents(batchMask);
+
+    bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_) && !(batchMask & USE_UPDATE);
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
         SubscribeToEvent(scene, E_SCENEUPDATE, ATOMIC_HANDLER(JSComponent, HandleSceneUpdate));
@@ -406,7 +439,7 @@ void JSComponent::UpdateEventSubscription()
         currentEventMask_ &= ~USE_UPDATE;
     }
 
-    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
+    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE) && !(batchMask & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
         SubscribeToEvent(scene, E_SCENEPOSTUPDATE, ATOMIC_HANDLER(JSComponent, HandleScenePostUpdate));
@@ -418,12 +451,12 @@ void JSComponent::UpdateEventSubscription()
         currentEventMask_ &= ~USE_POSTUPDATE;
     }
 
-#ifdef ATOMIC_PHYSICS
+#ifdef ENGINE_PHYSICS
     PhysicsWorld* world = scene->GetComponent<PhysicsWorld>();
     if (!world)
         return;
 
-    bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
+    bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE) && !(batchMask & USE_FIXEDUPDATE);
     if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
     {
         SubscribeToEvent(world, E_PHYSICSPRESTEP, ATOMIC_HANDLER(JSComponent, HandlePhysicsPreStep));
@@ -435,7 +468,7 @@ void JSComponent::UpdateEventSubscription()
         currentEventMask_ &= ~USE_FIXEDUPDATE;
     }
 
-    bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
+    bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE) && !(batchMask & USE_FIXEDPOSTUPDATE);
     if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
     {
         SubscribeToEvent(world, E_PHYSICSPOSTSTEP, ATOMIC_HANDLER(JSComponent, HandlePhysicsPostStep));
@@ -468,12 +501,58 @@ void JSComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
             currentEventMask_ &= ~USE_UPDATE;
             return;
         }
+
+        // The first update starts the instance, later ones may be batched with the other components of the class
+        if (componentFile_.NotNull() && (componentFile_->GetBatchEventMask() & USE_UPDATE))
+        {
+            Time* time = GetSubsystem<Time>();
+            startFrame_ = time ? time->GetFrameNumber() : 0;
+
+            Update(eventData[P_TIMESTEP].GetFloat());
+            UpdateEventSubscription();
+            return;
+        }
     }
 
     // Then execute user-defined update function
     Update(eventData[P_TIMESTEP].GetFloat());
 }
 
+void JSComponent::SetBatchedEvents(unsigned char mask)
+{
+    if (batchedEventMask_ == mask)
+        return;
+
+    if (batch_.Null())
+    {
+        Scene* scene = GetScene();
+        if (!scene || componentFile_.Null())
+            return;
+
+        batch_ = componentFile_->GetBatch(scene);
+    }
+
+    for (unsigned i = 0; i < MAX_JS_BATCH_EVENTS; i++)
+    {
+        unsigned char flag = (unsigned char) (1 << i);
+
+        if ((mask & flag) && !(batchedEventMask_ & flag))
+            batch_->AddComponent(this, (JSBatchEvent) i);
+        else if (!(mask & flag) && (batchedEventMask_ & flag))
+            batch_->RemoveComponent(this, (JSBatchEvent) i);
+    }
+
+    batchedEventMask_ = mask;
+
+    if (!batchedEventMask_)
+    {
+        if (batch_->IsEmpty() && componentFile_.NotNull())
+            componentFile_->RemoveBatch(batch_);
+
+        batch_.Reset();
+    }
+}
+
 void JSComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace ScenePostUpdate;
@@ -482,7 +561,7 @@ void JSComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventD
     PostUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-#ifdef ATOMIC_PHYSICS
+#ifdef ENGINE_PHYSICS
 void JSComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
 {
     using namespace PhysicsPreStep;
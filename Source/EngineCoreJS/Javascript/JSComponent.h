@@ -26,6 +26,7 @@
 #include <EngineCore/Script/ScriptComponent.h>
 
 #include "JSComponentFile.h"
+#include "JSComponentBatch.h"
 
 namespace Atomic
 {
@@ -37,6 +38,7 @@ class JSComponent : public ScriptComponent
 {
     friend class JSComponentFactory;
     friend class JSComponentFile;
+    friend class JSComponentBatch;
 
     ATOMIC_OBJECT(JSComponent, ScriptComponent);
 
@@ -82,7 +84,7 @@ public:
     ScriptComponentFile* GetComponentFile() const { return componentFile_; }
 
     /// Set script attribute.
-    void SetComponentFile(JSComponentFile* cfile) { componentFile_ = cfile; }
+    void SetComponentFile(JSComponentFile* cfile);
     void SetComponentFileAttr(const ResourceRef& value);
 
     // a JSComponentFile only holds one class, so no classname to look up in it
@@ -98,11 +100,13 @@ protected:
 private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
+    /// Add to or remove from the batches of the script class in the scene, one bit per JSBatchEvent.
+    void SetBatchedEvents(unsigned char mask);
     /// Handle scene update event.
     void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle scene post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#ifdef ATOMIC_PHYSICS
+#ifdef ENGINE_PHYSICS
     /// Handle physics pre-step event.
     void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
     /// Handle physics post-step event.
@@ -130,6 +134,14 @@ private:
     unsigned char updateEventMask_;
     /// Current event subscription mask.
     unsigned char currentEventMask_;
+    /// Events currently handled by the batches of the script class.
+    unsigned char batchedEventMask_;
+    /// Batch of the script class in the scene, while any events are batched.
+    SharedPtr<JSComponentBatch> batch_;
+    /// Position in the batch of each event.
+    unsigned batchIndices_[MAX_JS_BATCH_EVENTS];
+    /// Frame of the update before joining the update batch, which the batch skips.
+    unsigned startFrame_;
 
     bool instanceInitialized_;
     bool started_;
@@ -0,0 +1,258 @@
+//
+// Copyright (c) 2014-2015, THUNDERBEAST GAMES LLC All rights reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <EngineCore/Core/Profiler.h>
+#include <EngineCore/Core/Timer.h>
+
+#ifdef ENGINE_PHYSICS
+#include <EngineCore/Physics/PhysicsEvents.h>
+#include <EngineCore/Physics/PhysicsWorld.h>
+#endif
+#include <EngineCore/Scene/Scene.h>
+#include <EngineCore/Scene/SceneEvents.h>
+
+#include "JSVM.h"
+#include "JSComponent.h"
+#include "JSComponentBatch.h"
+
+namespace Atomic
+{
+
+static const char* batchMethodNames[MAX_JS_BATCH_EVENTS] =
+{
+    "batchUpdate",
+    "batchPostUpdate",
+    "batchFixedUpdate",
+    "batchFixedPostUpdate"
+};
+
+JSComponentBatch::JSComponentBatch(Context* context, Scene* scene) :
+    Object(context),
+    scene_(scene),
+    subscribed_(0)
+{
+
+}
+
+JSComponentBatch::~JSComponentBatch()
+{
+
+}
+
+const char* JSComponentBatch::GetMethodName(JSBatchEvent event)
+{
+    return batchMethodNames[event];
+}
+
+bool JSComponentBatch::IsEmpty() const
+{
+    for (unsigned i = 0; i < MAX_JS_BATCH_EVENTS; i++)
+    {
+        if (components_[i].Size())
+            return false;
+    }
+
+    return true;
+}
+
+void JSComponentBatch::AddComponent(JSComponent* component, JSBatchEvent event)
+{
+    PODVector<JSComponent*>& components = components_[event];
+
+    component->batchIndices_[event] = components.Size();
+    components.Push(component);
+
+    if (components.Size() == 1)
+        UpdateEventSubscription(event);
+}
+
+void JSComponentBatch::RemoveComponent(JSComponent* component, JSBatchEvent event)
+{
+    PODVector<JSComponent*>& components = components_[event];
+
+    unsigned index = component->batchIndices_[event];
+
+    if (index >= components.Size() || components[index] != component)
+        return;
+
+    // move the last component into the vacated slot
+    if (index < components.Size() - 1)
+    {
+        components[index] = components.Back();
+        components[index]->batchIndices_[event] = index;
+    }
+
+    components.Pop();
+    component->batchIndices_[event] = M_MAX_UNSIGNED;
+
+    if (components.Empty())
+        UpdateEventSubscription(event);
+}
+
+void JSComponentBatch::UpdateEventSubscription(JSBatchEvent event)
+{
+    Scene* scene = scene_;
+    if (!scene)
+        return;
+
+    unsigned char flag = (unsigned char) (1 << event);
+    bool need = !components_[event].Empty();
+
+    if (need == ((subscribed_ & flag) != 0))
+        return;
+
+    if (event == JS_BATCH_UPDATE)
+    {
+        if (need)
+            SubscribeToEvent(scene, E_SCENEUPDATE, ATOMIC_HANDLER(JSComponentBatch, HandleSceneUpdate));
+        else
+            UnsubscribeFromEvent(scene, E_SCENEUPDATE);
+    }
+    else if (event == JS_BATCH_POSTUPDATE)
+    {
+        if (need)
+            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, ATOMIC_HANDLER(JSComponentBatch, HandleScenePostUpdate));
+        else
+            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+    }
+#ifdef ENGINE_PHYSICS
+    else
+    {
+        PhysicsWorld* world = scene->GetComponent<PhysicsWorld>();
+        if (!world)
+            return;
+
+        if (event == JS_BATCH_FIXEDUPDATE)
+        {
+            if (need)
+                SubscribeToEvent(world, E_PHYSICSPRESTEP, ATOMIC_HANDLER(JSComponentBatch, HandlePhysicsPreStep));
+            else
+                UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
+        }
+        else
+        {
+            if (need)
+                SubscribeToEvent(world, E_PHYSICSPOSTSTEP, ATOMIC_HANDLER(JSComponentBatch, HandlePhysicsPostStep));
+            else
+                UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
+        }
+    }
+#endif
+
+    if (need)
+        subscribed_ |= flag;
+    else
+        subscribed_ &= ~flag;
+}
+
+void JSComponentBatch::CallBatchMethod(JSBatchEvent event, float timeStep)
+{
+    const PODVector<JSComponent*>& components = components_[event];
+
+    if (components.Empty())
+        return;
+
+    ATOMIC_PROFILE(JSComponentBatch_CallBatchMethod);
+
+    JSVM* vm = JSVM::GetJSVM(NULL);
+    duk_context* ctx = vm->GetJSContext();
+
+    duk_idx_t top = duk_get_top(ctx);
+
+    // all components share the class, so the static method is found through the first one
+    duk_push_heapptr(ctx, components[0]->JSGetHeapPtr());
+    duk_get_prop_string(ctx, -1, "constructor");
+    duk_get_prop_string(ctx, -1, batchMethodNames[event]);
+
+    if (!duk_is_function(ctx, -1))
+    {
+        duk_set_top(ctx, top);
+        return;
+    }
+
+    // call with the class as this
+    duk_dup(ctx, -2);
+
+    // components that joined the update batch during this frame's update have already been updated by themselves
+    Time* time = GetSubsystem<Time>();
+    unsigned frameNumber = event == JS_BATCH_UPDATE && time ? time->GetFrameNumber() : M_MAX_UNSIGNED;
+
+    // the array is filled before the call, components removed by the script stay in it until the next event
+    duk_push_array(ctx);
+
+    unsigned count = 0;
+    for (unsigned i = 0; i < components.Size(); i++)
+    {
+        JSComponent* component = components[i];
+
+        if (component->destroyed_ || !component->GetNode() || component->startFrame_ == frameNumber)
+            continue;
+
+        duk_push_heapptr(ctx, component->JSGetHeapPtr());
+        duk_put_prop_index(ctx, -2, count++);
+    }
+
+    if (!count)
+    {
+        duk_set_top(ctx, top);
+        return;
+    }
+
+    duk_push_number(ctx, timeStep);
+
+    if (duk_pcall_method(ctx, 2) != 0)
+        vm->SendJSErrorEvent();
+
+    duk_set_top(ctx, top);
+}
+
+void JSComponentBatch::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace SceneUpdate;
+
+    CallBatchMethod(JS_BATCH_UPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void JSComponentBatch::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ScenePostUpdate;
+
+    CallBatchMethod(JS_BATCH_POSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#ifdef ENGINE_PHYSICS
+void JSComponentBatch::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    CallBatchMethod(JS_BATCH_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void JSComponentBatch::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    CallBatchMethod(JS_BATCH_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+#endif
+
+}
@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2014-2015, THUNDERBEAST GAMES LLC All rights reserved
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <EngineCore/Core/Object.h>
+
+namespace Atomic
+{
+
+class JSComponent;
+class Scene;
+
+/// Update events a script class can handle in batches
+enum JSBatchEvent
+{
+    JS_BATCH_UPDATE = 0,
+    JS_BATCH_POSTUPDATE,
+    JS_BATCH_FIXEDUPDATE,
+    JS_BATCH_FIXEDPOSTUPDATE,
+    MAX_JS_BATCH_EVENTS
+};
+
+/// Update events of a scene for the components of one script class
+/// A script class opts in by declaring static batchUpdate, batchPostUpdate, batchFixedUpdate or batchFixedPostUpdate
+/// methods, which are called once per event with an array of the class's enabled components and the time step,
+/// instead of calling the instance method of each component
+class JSComponentBatch : public Object
+{
+    ATOMIC_OBJECT(JSComponentBatch, Object);
+
+public:
+
+    /// Construct.
+    JSComponentBatch(Context* context, Scene* scene);
+    /// Destruct.
+    virtual ~JSComponentBatch();
+
+    /// Add a component to the batch of an event
+    void AddComponent(JSComponent* component, JSBatchEvent event);
+    /// Remove a component from the batch of an event
+    void RemoveComponent(JSComponent* component, JSBatchEvent event);
+
+    /// Return the scene whose events are batched
+    Scene* GetScene() const { return scene_; }
+    /// Return the number of components batched for an event
+    unsigned GetNumComponents(JSBatchEvent event) const { return components_[event].Size(); }
+    /// Return whether no components are batched
+    bool IsEmpty() const;
+
+    /// Return the name of the static script method handling an event
+    static const char* GetMethodName(JSBatchEvent event);
+
+private:
+
+    /// Subscribe or unsubscribe an event depending on whether it has components
+    void UpdateEventSubscription(JSBatchEvent event);
+    /// Call the static script method of an event with the batched components
+    void CallBatchMethod(JSBatchEvent event, float timeStep);
+
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+#ifdef ENGINE_PHYSICS
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+
+    WeakPtr<Scene> scene_;
+
+    /// Components of each event, a component's position is kept in the component for removal
+    PODVector<JSComponent*> components_[MAX_JS_BATCH_EVENTS];
+
+    /// Events currently subscribed to
+    unsigned char subscribed_;
+
+};
+
+}
@@ -25,9 +25,11 @@
 #include <EngineCore/IO/Log.h>
 #include <EngineCore/Core/Profiler.h>
 #include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Scene/Scene.h>
 #include <EngineCore/IO/Serializer.h>
 
 #include "JSComponentFile.h"
+#include "JSComponentBatch.h"
 #include "JSComponent.h"
 #include "JSVM.h"
 
@@ -37,7 +39,8 @@ namespace Atomic
 JSComponentFile::JSComponentFile(Context* context) :
     ScriptComponentFile(context),
     scriptClass_(false),
-    typescriptClass_(false)
+    typescriptClass_(false),
+    batchEventMask_(0)
 {
 }
 
@@ -174,11 +177,54 @@ bool JSComponentFile::InitModule()
 
     }
 
+    // static batch methods of the class, the constructor is on top of the stack
+    batchEventMask_ = 0;
+
+    if (scriptClass_ && duk_is_function(ctx, -1))
+    {
+        for (unsigned i = 0; i < MAX_JS_BATCH_EVENTS; i++)
+        {
+            duk_get_prop_string(ctx, -1, JSComponentBatch::GetMethodName((JSBatchEvent) i));
+
+            if (duk_is_function(ctx, -1))
+                batchEventMask_ |= (unsigned char) (1 << i);
+
+            duk_pop(ctx);
+        }
+    }
+
     duk_set_top(ctx, top);
 
     return true;
 }
 
+JSComponentBatch* JSComponentFile::GetBatch(Scene* scene)
+{
+    HashMap<Scene*, SharedPtr<JSComponentBatch> >::Iterator itr = batches_.Find(scene);
+    if (itr != batches_.End())
+        return itr->second_;
+
+    SharedPtr<JSComponentBatch> batch(new JSComponentBatch(context_, scene));
+    batches_[scene] = batch;
+
+    return batch;
+}
+
+void JSComponentFile::RemoveBatch(JSComponentBatch* batch)
+{
+    HashMap<Scene*, SharedPtr<JSComponentBatch> >::Iterator itr = batches_.Begin();
+    while (itr != batches_.End())
+    {
+        if (itr->second_ == batch)
+        {
+            batches_.Erase(itr);
+            return;
+        }
+
+        itr++;
+    }
+}
+
 
 bool JSComponentFile::BeginLoad(Deserializer& source)
 {
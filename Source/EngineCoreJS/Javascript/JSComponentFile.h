@@ -31,6 +31,8 @@ namespace Atomic
 {
 
 class JSComponent;
+class JSComponentBatch;
+class Scene;
 
 /// Script document resource.
 class JSComponentFile : public ScriptComponentFile
@@ -59,6 +61,13 @@ public:
     SharedPtr<JSComponent> CreateJSComponent();
     bool PushModule();
 
+    /// Returns the update events the script class handles with static batch methods, one bit per JSBatchEvent
+    unsigned char GetBatchEventMask() const { return batchEventMask_; }
+    /// Returns the batch of the script class in a scene, creating it if needed
+    JSComponentBatch* GetBatch(Scene* scene);
+    /// Forget a batch once its last component has been removed
+    void RemoveBatch(JSComponentBatch* batch);
+
 private:
 
     bool InitModule();
@@ -66,6 +75,9 @@ private:
     bool scriptClass_;
     bool typescriptClass_;
 
+    unsigned char batchEventMask_;
+    HashMap<Scene*, SharedPtr<JSComponentBatch> > batches_;
+
 };
 
 }
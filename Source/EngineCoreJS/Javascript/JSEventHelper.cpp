@@ -101,6 +101,71 @@ void JSEventDispatcher::EndSendEvent(Context* context, Object* sender, StringHas
 
     duk_pop_3(ctx);
 
+    // the preallocated object is free for the next send
+    HashMap<StringHash, JSEventObject>::Iterator itr = eventObjects_.Find(eventType);
+    if (itr != eventObjects_.End() && itr->second_.eventData_ == &eventData)
+        itr->second_.eventData_ = 0;
+
+}
+
+void JSEventDispatcher::PushEventData(duk_context* ctx, StringHash eventType, VariantMap& eventData)
+{
+    // look in the variant map cache, all handlers of a send get the same object
+    duk_push_global_stash(ctx);
+    duk_get_prop_index(ctx, -1, JS_GLOBALSTASH_VARIANTMAP_CACHE);
+    duk_push_pointer(ctx, (void*) &eventData);
+    duk_get_prop(ctx, -2);
+
+    if (duk_is_object(ctx, -1))
+    {
+        duk_remove(ctx, -2); // vmap cache
+        duk_remove(ctx, -2); // global stash
+        return;
+    }
+
+    duk_pop(ctx);
+
+    JSEventObject& eventObject = eventObjects_[eventType];
+
+    if (!eventObject.proxy_)
+    {
+        // first send of the event type, keep the objects alive in the stash
+        duk_get_prop_index(ctx, -2, JS_GLOBALSTASH_EVENT_OBJECTS);
+        duk_push_array(ctx);
+
+        duk_push_object(ctx);
+        eventObject.target_ = duk_get_heapptr(ctx, -1);
+        js_push_variantmap_proxy(ctx, -1);
+        eventObject.proxy_ = duk_get_heapptr(ctx, -1);
+
+        duk_put_prop_index(ctx, -3, 0);
+        duk_put_prop_index(ctx, -2, 1);
+        duk_put_prop_index(ctx, -2, (unsigned) eventType.Value());
+        duk_pop(ctx);
+    }
+
+    if (!eventObject.eventData_)
+    {
+        // the values were deleted at the end of the previous send
+        eventObject.eventData_ = &eventData;
+        duk_push_heapptr(ctx, eventObject.target_);
+        js_put_variantmap_values(ctx, -1, eventData);
+        duk_pop(ctx);
+        duk_push_heapptr(ctx, eventObject.proxy_);
+    }
+    else
+    {
+        // nested send of the same event type
+        js_push_variantmap(ctx, eventData);
+    }
+
+    // store to cache, the cache object will be cleared at the send end in EndSendEvent
+    duk_push_pointer(ctx, (void*) &eventData);
+    duk_dup(ctx, -2);
+    duk_put_prop(ctx, -4);
+
+    duk_remove(ctx, -2); // vmap cache
+    duk_remove(ctx, -2); // global stash
 }
 
 JSEventHelper::JSEventHelper(Context* context, Object* object) :
@@ -163,29 +228,7 @@ void JSEventHelper::HandleEvent(StringHash eventType, VariantMap& eventData)
 
     if (duk_is_function(ctx, -1))
     {
-        // look in the variant map cache
-        duk_push_global_stash(ctx);
-        duk_get_prop_index(ctx, -1, JS_GLOBALSTASH_VARIANTMAP_CACHE);
-        duk_push_pointer(ctx, (void*) &eventData);
-        duk_get_prop(ctx, -2);
-
-        if (!duk_is_object(ctx, -1))
-        {
-            // pop result
-            duk_pop(ctx);
-
-            // we need to push a new variant map and store to cache
-            // the cache object will be cleared at the send end in  the
-            // global listener above
-            js_push_variantmap(ctx, eventData);
-            duk_push_pointer(ctx, (void*) &eventData);
-            duk_dup(ctx, -2);
-            duk_put_prop(ctx, -4);
-
-        }
-
-        duk_remove(ctx, -2); // vmap cache
-        duk_remove(ctx, -2); // global stash
+        GetSubsystem<JSEventDispatcher>()->PushEventData(ctx, eventType, eventData);
 
         if (duk_pcall(ctx, 1) != 0)
         {
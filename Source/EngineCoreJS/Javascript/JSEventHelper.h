@@ -40,13 +40,37 @@ public:
 
     void RegisterJSEvent(StringHash hash) { jsEvents_[hash] = true; }
 
+    /// Push the script object for event data, shared by all handlers of the event send.  Each event type keeps
+    /// a preallocated object that is refilled on every send, a new one is only created for nested sends
+    void PushEventData(duk_context* ctx, StringHash eventType, VariantMap& eventData);
+
 private:
 
+    /// Preallocated script object of an event type
+    struct JSEventObject
+    {
+        JSEventObject() :
+            proxy_(0),
+            target_(0),
+            eventData_(0)
+        {
+        }
+
+        /// Proxy passed to the handlers
+        void* proxy_;
+        /// Object holding the values
+        void* target_;
+        /// Event data of the send using the object, null when free
+        VariantMap* eventData_;
+    };
+
     void BeginSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData);
     void EndSendEvent(Context* context, Object* sender, StringHash eventType, VariantMap& eventData);
 
     HashMap<StringHash, bool> jsEvents_;
 
+    HashMap<StringHash, JSEventObject> eventObjects_;
+
 };
 
 class JSEventHelper : public Object
@@ -77,6 +77,18 @@ void JSMetrics::Dump()
 }
 
 
+void JSMetrics::DumpGC()
+{
+    const JSGCStats& stats = vm_->GetGCStats();
+
+    ATOMIC_LOGINFOF("Heap: %llu KB in %u allocations, Stash Count: %u", stats.heapSize_ / 1024, stats.numAllocations_,
+        vm_->GetStashCount());
+    ATOMIC_LOGINFOF("Collections: %u, Deferred: %u, Last: %.2f ms, Longest Pass: %.2f ms", stats.numCollections_,
+        stats.numDeferred_, stats.lastTime_, stats.maxTime_);
+    ATOMIC_LOGINFOF("Last Freed: %llu KB in %u allocations, Unstashed: %u", stats.lastFreedBytes_ / 1024,
+        stats.lastFreedAllocations_, stats.lastUnstashed_);
+}
+
 void JSMetrics::DumpNodes()
 {
     Vector<NodeMetric> sorted;
@@ -153,10 +165,8 @@ void JSMetrics::Capture()
     objectMetrics_.Clear();
     nodeMetrics_.Clear();
 
-    // run twice to call finalizers
-    // see duktape docs
-    duk_gc(vm_->GetJSContext(), 0);
-    duk_gc(vm_->GetJSContext(), 0);
+    // full collection, so that only live objects are counted
+    vm_->GC();
 
 
     HashMap<void*, RefCounted*>::ConstIterator itr = vm_->heapToObject_.Begin();
@@ -60,6 +60,8 @@ public:
     void Dump();
     void DumpNodes();
     void DumpJSComponents();
+    /// Log the garbage collection statistics
+    void DumpGC();
 
 private:
 
@@ -26,6 +26,7 @@
 
 #include <EngineCore/Core/Profiler.h>
 #include <EngineCore/Core/CoreEvents.h>
+#include <EngineCore/Core/Timer.h>
 
 #include <EngineCore/IO/File.h>
 #include <EngineCore/IO/Log.h>
@@ -47,12 +48,40 @@ namespace Atomic
 {
 
 JSVM* JSVM::instance_ = NULL;
+
+// size of the header in front of each script heap allocation, keeps the allocation aligned
+static const size_t JS_HEAP_HEADER_SIZE = 16;
+
+// growth below this never starts a collection, so that small heaps aren't collected every few frames
+static const unsigned long long JS_GC_MIN_GROWTH = 256 * 1024;
+
+// passes over smaller heaps are dominated by fixed costs and don't update the cost estimate
+static const unsigned long long JS_GC_MIN_ESTIMATE_HEAP = 64 * 1024;
+
+static const float DEFAULT_GC_BUDGET = 2.0f;
+static const float DEFAULT_GC_GROWTH_THRESHOLD = 0.5f;
+static const unsigned DEFAULT_GC_UNSTASH_THRESHOLD = 512;
+static const float DEFAULT_GC_INTERVAL = 5.0f;
 Vector<JSVM::JSAPIPackageRegistration*> JSVM::packageRegistrations_;
 
 JSVM::JSVM(Context* context) :
     Object(context),
     ctx_(0),
     gcTime_(0.0f),
+    gcPass_(0),
+    gcBudget_(DEFAULT_GC_BUDGET),
+    gcGrowthThreshold_(DEFAULT_GC_GROWTH_THRESHOLD),
+    gcUnstashThreshold_(DEFAULT_GC_UNSTASH_THRESHOLD),
+    gcInterval_(DEFAULT_GC_INTERVAL),
+    gcCostPerMB_(0.0f),
+    gcBaseHeapSize_(0),
+    gcBaseUnstashCount_(0),
+    gcStartHeapSize_(0),
+    gcStartAllocations_(0),
+    gcCollectionTime_(0.0f),
+    typedArrayMath_(false),
+    float32ArrayPrototype_(0),
+    int32ArrayPrototype_(0),
     stashCount_(0),
     totalStashCount_(0),
     totalUnstashCount_(0)
@@ -86,10 +115,27 @@ JSVM::~JSVM()
 
 void JSVM::InitJSContext()
 {
-    ctx_ = duk_create_heap_default();
+    // heap allocations go through the VM, so that heap growth can schedule collections
+    ctx_ = duk_create_heap(HeapAlloc, HeapRealloc, HeapFree, this, NULL);
     duk_logging_init(ctx_, 0);
     duk_module_duktape_init(ctx_);
 
+    // keep the typed array prototypes, math values passed as typed arrays are recognized by them
+    duk_push_global_stash(ctx_);
+    duk_push_array(ctx_);
+    duk_get_global_string(ctx_, "Float32Array");
+    duk_get_prop_string(ctx_, -1, "prototype");
+    float32ArrayPrototype_ = duk_get_heapptr(ctx_, -1);
+    duk_put_prop_index(ctx_, -3, 0);
+    duk_pop(ctx_);
+    duk_get_global_string(ctx_, "Int32Array");
+    duk_get_prop_string(ctx_, -1, "prototype");
+    int32ArrayPrototype_ = duk_get_heapptr(ctx_, -1);
+    duk_put_prop_index(ctx_, -3, 1);
+    duk_pop(ctx_);
+    duk_put_prop_index(ctx_, -2, JS_GLOBALSTASH_TYPEDARRAY_PROTOTYPES);
+    duk_pop(ctx_);
+
     jsapi_init_atomic(this);
 
     // register whether we are in the editor
@@ -105,6 +151,9 @@ void JSVM::InitJSContext()
 
     InitializePackages();
 
+    // growth is measured from the initialized heap
+    gcBaseHeapSize_ = gcStats_.heapSize_;
+
     // handle this elsewhere?
     SubscribeToEvents();
 
@@ -145,6 +194,65 @@ void JSVM::RegisterPackage(JSVMPackageRegistrationSettingsFunction regFunction,
 void JSVM::SubscribeToEvents()
 {
     SubscribeToEvent(E_UPDATE, ATOMIC_HANDLER(JSVM, HandleUpdate));
+    SubscribeToEvent(E_ENDFRAME, ATOMIC_HANDLER(JSVM, HandleEndFrame));
+}
+
+void* JSVM::HeapAlloc(void* udata, duk_size_t size)
+{
+    if (!size)
+        return NULL;
+
+    unsigned char* block = (unsigned char*) malloc(size + JS_HEAP_HEADER_SIZE);
+    if (!block)
+        return NULL;
+
+    *((duk_size_t*) block) = size;
+
+    JSGCStats& stats = ((JSVM*) udata)->gcStats_;
+    stats.heapSize_ += size;
+    stats.numAllocations_++;
+
+    return block + JS_HEAP_HEADER_SIZE;
+}
+
+void* JSVM::HeapRealloc(void* udata, void* ptr, duk_size_t size)
+{
+    if (!ptr)
+        return HeapAlloc(udata, size);
+
+    if (!size)
+    {
+        HeapFree(udata, ptr);
+        return NULL;
+    }
+
+    unsigned char* block = (unsigned char*) ptr - JS_HEAP_HEADER_SIZE;
+    duk_size_t oldSize = *((duk_size_t*) block);
+
+    block = (unsigned char*) realloc(block, size + JS_HEAP_HEADER_SIZE);
+    if (!block)
+        return NULL;
+
+    *((duk_size_t*) block) = size;
+
+    JSGCStats& stats = ((JSVM*) udata)->gcStats_;
+    stats.heapSize_ = stats.heapSize_ - oldSize + size;
+
+    return block + JS_HEAP_HEADER_SIZE;
+}
+
+void JSVM::HeapFree(void* udata, void* ptr)
+{
+    if (!ptr)
+        return;
+
+    unsigned char* block = (unsigned char*) ptr - JS_HEAP_HEADER_SIZE;
+
+    JSGCStats& stats = ((JSVM*) udata)->gcStats_;
+    stats.heapSize_ -= *((duk_size_t*) block);
+    stats.numAllocations_--;
+
+    free(block);
 }
 
 void JSVM::OnRefCountChanged(RefCounted* refCounted, int refCount)
@@ -221,6 +329,46 @@ void JSVM::Unstash(RefCounted* refCounted)
     duk_pop_2(ctx_);
 }
 
+void* JSVM::LookupClassConstructor(const void* classID)
+{
+    int top = duk_get_top(ctx_);
+
+    duk_push_heap_stash(ctx_);
+    duk_push_pointer(ctx_, (void*) classID);
+    duk_get_prop(ctx_, -2);
+
+    // not declared (yet), don't cache
+    if (!duk_is_object(ctx_, -1))
+    {
+        duk_set_top(ctx_, top);
+        return NULL;
+    }
+
+    duk_get_prop_index(ctx_, -1, 0);
+    const char* package = duk_require_string(ctx_, -1);
+    duk_get_prop_index(ctx_, -2, 1);
+    const char* classname = duk_require_string(ctx_, -1);
+
+    duk_get_global_string(ctx_, package);
+    duk_get_prop_string(ctx_, -1, classname);
+
+    void* constructor = NULL;
+
+    if (duk_is_function(ctx_, -1))
+    {
+        constructor = duk_get_heapptr(ctx_, -1);
+
+        // store with the class entry, so the cached heap pointer stays valid
+        duk_put_prop_index(ctx_, top + 1, 2);
+
+        classConstructors_[classID] = constructor;
+    }
+
+    duk_set_top(ctx_, top);
+
+    return constructor;
+}
+
 // Returns if the given object is stashed
 bool JSVM::GetStashed(RefCounted* refcounted) const
 {
@@ -247,23 +395,8 @@ void JSVM::HandleUpdate(StringHash eventType, VariantMap& eventData)
     // Take the frame time step, which is stored as a float
     float timeStep = eventData[P_TIMESTEP].GetFloat();
 
+    // collections run at the end of the frame, see HandleEndFrame
     gcTime_ += timeStep;
-    if (gcTime_ > 5.0f)
-    {
-        ATOMIC_PROFILE(JSVM_GC);
-
-        // run twice to call finalizers
-        // see duktape docs
-        // also ensure #define DUK_OPT_NO_VOLUNTARY_GC
-        // is enabled in duktape.h
-        duk_gc(ctx_, 0);
-        duk_gc(ctx_, 0);
-
-        gcTime_ = 0;
-
-        // DumpJavascriptObjects();
-
-    }
 
     duk_get_global_string(ctx_, "__js_atomic_main_update");
 
@@ -535,9 +668,103 @@ bool JSVM::ExecuteFile(File *file)
 
 void JSVM::GC()
 {
-    // run twice to ensure finalizers are run
-    duk_gc(ctx_, 0);
+    if (!gcPass_)
+        BeginGC();
+
+    // run both passes to ensure finalizers are run
+    while (gcPass_)
+        RunGCPass();
+}
+
+bool JSVM::IsGCDue() const
+{
+    if (gcUnstashThreshold_ && totalUnstashCount_ - gcBaseUnstashCount_ >= gcUnstashThreshold_)
+        return true;
+
+    if (gcGrowthThreshold_ <= 0.0f || gcStats_.heapSize_ <= gcBaseHeapSize_)
+        return false;
+
+    unsigned long long growth = gcStats_.heapSize_ - gcBaseHeapSize_;
+    return growth >= JS_GC_MIN_GROWTH && growth >= (unsigned long long) (gcBaseHeapSize_ * gcGrowthThreshold_);
+}
+
+void JSVM::BeginGC()
+{
+    gcPass_ = 1;
+    gcCollectionTime_ = 0.0f;
+    gcStartHeapSize_ = gcStats_.heapSize_;
+    gcStartAllocations_ = gcStats_.numAllocations_;
+    gcStats_.lastUnstashed_ = totalUnstashCount_ - gcBaseUnstashCount_;
+    gcBaseUnstashCount_ = totalUnstashCount_;
+}
+
+void JSVM::RunGCPass()
+{
+    ATOMIC_PROFILE(JSVM_GC);
+
+    unsigned long long heapSize = gcStats_.heapSize_;
+
+    HiresTimer timer;
     duk_gc(ctx_, 0);
+    float time = timer.GetUSec(false) / 1000.0f;
+
+    // the pass marks the whole heap, so its time is estimated per megabyte
+    if (heapSize >= JS_GC_MIN_ESTIMATE_HEAP)
+    {
+        float cost = time * 1048576.0f / (float) heapSize;
+        gcCostPerMB_ = gcCostPerMB_ > 0.0f ? Lerp(gcCostPerMB_, cost, 0.25f) : cost;
+    }
+
+    gcStats_.maxTime_ = Max(gcStats_.maxTime_, time);
+    gcCollectionTime_ += time;
+
+    // the second pass frees the objects rescued by finalizers in the first, see duktape docs
+    if (gcPass_++ < 2)
+        return;
+
+    gcPass_ = 0;
+    gcTime_ = 0.0f;
+
+    gcStats_.numCollections_++;
+    gcStats_.lastTime_ = gcCollectionTime_;
+    gcStats_.lastFreedBytes_ = gcStartHeapSize_ > gcStats_.heapSize_ ? gcStartHeapSize_ - gcStats_.heapSize_ : 0;
+    gcStats_.lastFreedAllocations_ = gcStartAllocations_ > gcStats_.numAllocations_ ?
+        gcStartAllocations_ - gcStats_.numAllocations_ : 0;
+
+    gcBaseHeapSize_ = gcStats_.heapSize_;
+
+    ATOMIC_PROFILE_PLOT("JSGCTime", (double) gcStats_.lastTime_);
+    ATOMIC_PROFILE_PLOT("JSGCFreedAllocations", (i64) gcStats_.lastFreedAllocations_);
+    ATOMIC_PROFILE_PLOT("JSGCFreedBytes", (i64) gcStats_.lastFreedBytes_);
+}
+
+void JSVM::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    if (!ctx_)
+        return;
+
+    // a duktape mark and sweep pass can't be split, instead a collection is started by heap growth or released
+    // native objects rather than on a fixed cadence, and its two passes run at the end of separate frames
+    // when they are estimated to fit the budget
+    bool overdue = gcTime_ >= gcInterval_;
+
+    if (gcPass_ || overdue || IsGCDue())
+    {
+        float estimate = gcCostPerMB_ * (float) gcStats_.heapSize_ / 1048576.0f;
+
+        if (estimate <= gcBudget_ || overdue)
+        {
+            if (!gcPass_)
+                BeginGC();
+
+            RunGCPass();
+        }
+        else
+            gcStats_.numDeferred_++;
+    }
+
+    ATOMIC_PROFILE_PLOT("JSHeapSize", (i64) gcStats_.heapSize_);
+    ATOMIC_PROFILE_PLOT("JSStashCount", (i64) stashCount_);
 }
 
 bool JSVM::ExecuteMain()
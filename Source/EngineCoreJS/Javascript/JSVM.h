@@ -43,6 +43,42 @@ class JSMetrics;
 class JSVM;
 
 
+/// Script garbage collection statistics
+struct JSGCStats
+{
+    JSGCStats() :
+        heapSize_(0),
+        numAllocations_(0),
+        numCollections_(0),
+        numDeferred_(0),
+        lastTime_(0.0f),
+        maxTime_(0.0f),
+        lastFreedBytes_(0),
+        lastFreedAllocations_(0),
+        lastUnstashed_(0)
+    {
+    }
+
+    /// Bytes currently allocated by the script heap
+    unsigned long long heapSize_;
+    /// Allocations currently held by the script heap
+    unsigned numAllocations_;
+    /// Number of finished collections
+    unsigned numCollections_;
+    /// Number of frames a due collection pass waited for budget
+    unsigned numDeferred_;
+    /// Time of the last collection in milliseconds, both passes
+    float lastTime_;
+    /// Longest single collection pass in milliseconds
+    float maxTime_;
+    /// Bytes freed by the last collection
+    unsigned long long lastFreedBytes_;
+    /// Allocations freed by the last collection
+    unsigned lastFreedAllocations_;
+    /// Native objects unstashed between the last two collections, left for script to collect
+    unsigned lastUnstashed_;
+};
+
 /// Registration signature for JSVM package registration
 typedef void(*JSVMPackageRegistrationFunction)(JSVM* vm);
 
@@ -88,6 +124,7 @@ public:
 
     inline duk_context* GetJSContext() { return ctx_; }
 
+    /// Run a full collection now, both passes
     void GC();
     JSMetrics* GetMetrics() { return metrics_; }
 
@@ -228,8 +265,51 @@ public:
     unsigned GetTotalStashCount() const { return totalStashCount_;  }
     unsigned GetTotalUnstashCount() const { return totalUnstashCount_; }
 
+    /// Returns the heap pointer of the script constructor for a class ID, or NULL if the class isn't scriptable
+    /// The lookup through the heap stash and package object is cached, the constructor is kept alive in the stash
+    inline void* GetClassConstructor(const void* classID)
+    {
+        HashMap<const void*, void*>::ConstIterator itr = classConstructors_.Find(classID);
+        if (itr != classConstructors_.End())
+            return itr->second_;
+
+        return LookupClassConstructor(classID);
+    }
+
+    /// Forget a cached constructor, when a class is declared again
+    void ClearClassConstructor(const void* classID) { classConstructors_.Erase(classID); }
+
+    /// Set whether math values are pushed to script as typed arrays (Float32Array, Int32Array) instead of plain arrays
+    /// Both are accepted from script either way. Off by default, as typed arrays lack the Array methods, are not
+    /// instanceof Array and stringify to JSON as objects
+    void SetTypedArrayMath(bool enabled) { typedArrayMath_ = enabled; }
+    bool GetTypedArrayMath() const { return typedArrayMath_; }
+
+    void* GetFloat32ArrayPrototype() const { return float32ArrayPrototype_; }
+    void* GetInt32ArrayPrototype() const { return int32ArrayPrototype_; }
+
+    /// Set the time in milliseconds a collection pass may take at the end of a frame
+    /// A due pass estimated to take longer waits for a later frame, until the collection interval forces it
+    void SetGCBudget(float msec) { gcBudget_ = Max(msec, 0.0f); }
+    /// Set the heap growth since the last collection, as a fraction of the heap left by it, that starts a collection
+    void SetGCGrowthThreshold(float fraction) { gcGrowthThreshold_ = Max(fraction, 0.0f); }
+    /// Set the number of native objects unstashed since the last collection that starts a collection
+    void SetGCUnstashThreshold(unsigned count) { gcUnstashThreshold_ = count; }
+    /// Set the longest time in seconds between collections, regardless of growth or budget
+    void SetGCInterval(float seconds) { gcInterval_ = Max(seconds, 0.0f); }
+
+    float GetGCBudget() const { return gcBudget_; }
+    float GetGCGrowthThreshold() const { return gcGrowthThreshold_; }
+    unsigned GetGCUnstashThreshold() const { return gcUnstashThreshold_; }
+    float GetGCInterval() const { return gcInterval_; }
+
+    /// Returns the garbage collection statistics
+    const JSGCStats& GetGCStats() const { return gcStats_; }
+
 private:
 
+    void* LookupClassConstructor(const void* classID);
+
     void Unstash(RefCounted* refCounted);
 
     struct JSAPIPackageRegistration
@@ -263,18 +343,53 @@ private:
 
     void SubscribeToEvents();
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Returns whether the heap has grown or released enough objects since the last collection to start one
+    bool IsGCDue() const;
+    /// Start a collection, its passes are then run by RunGCPass
+    void BeginGC();
+    /// Run the next mark and sweep pass of the collection in progress, finishing it after the last pass
+    void RunGCPass();
+
+    static void* HeapAlloc(void* udata, duk_size_t size);
+    static void* HeapRealloc(void* udata, void* ptr, duk_size_t size);
+    static void HeapFree(void* udata, void* ptr);
 
     duk_context* ctx_;
 
     HashMap<void*, RefCounted*> heapToObject_;
 
+    HashMap<const void*, void*> classConstructors_;
+
+    bool typedArrayMath_;
+    void* float32ArrayPrototype_;
+    void* int32ArrayPrototype_;
+
 #ifdef JSVM_DEBUG
     // Debugging
     HashMap<void*, void*> removedHeapPtr_;
 
 #endif
 
+    /// Seconds since the last collection
     float gcTime_;
+    /// Next collection pass, 0 when no collection is in progress
+    unsigned gcPass_;
+    float gcBudget_;
+    float gcGrowthThreshold_;
+    unsigned gcUnstashThreshold_;
+    float gcInterval_;
+    /// Estimated pass time in milliseconds per megabyte of heap, measured from previous passes
+    float gcCostPerMB_;
+    /// Heap size and unstash count after the last collection
+    unsigned long long gcBaseHeapSize_;
+    unsigned gcBaseUnstashCount_;
+    /// Heap size and allocation count before the collection in progress
+    unsigned long long gcStartHeapSize_;
+    unsigned gcStartAllocations_;
+    float gcCollectionTime_;
+    JSGCStats gcStats_;
 
     Vector<String> moduleSearchPath_;
     String lastModuleSearchFilename_;
@@ -328,13 +443,10 @@ inline bool js_push_class_object_instance(duk_context* ctx, const RefCounted *in
         return true;
     }
 
-    duk_push_heap_stash(ctx);
-    duk_push_pointer(ctx, (void*) instance->GetClassID());
-    duk_get_prop(ctx, -2);
+    void* constructor = JSVM::GetJSVM(ctx)->GetClassConstructor((const void*) instance->GetClassID());
 
-    // if not an object, this instance isn't not a scriptable class
-    // reset top and return false
-    if (!duk_is_object(ctx, -1))
+    // if there's no constructor, this instance isn't a scriptable class
+    if (!constructor)
     {
         if (instance->IsObject())
         {
@@ -345,25 +457,15 @@ inline bool js_push_class_object_instance(duk_context* ctx, const RefCounted *in
             ATOMIC_LOGERROR("Unable to push RefCounted instance due to missing ClassID");
         }
 
-        duk_set_top(ctx, top);
         return false;
     }
 
-    duk_get_prop_index(ctx, -1, 0);
-    const char* package = duk_require_string(ctx, -1);
-    duk_get_prop_index(ctx, -2, 1);
-    const char* jclassname = duk_require_string(ctx, -1);
-
-    duk_set_top(ctx, top);
-
-    duk_get_global_string(ctx, package);
-    duk_get_prop_string(ctx, -1, jclassname);
+    duk_push_heapptr(ctx, constructor);
 
     assert(duk_is_function(ctx, -1));
 
     duk_push_pointer(ctx, (void*) instance);
     duk_new(ctx, 1);
-    duk_remove(ctx, -2); // remove Atomic object
 
     assert(duk_is_object(ctx, -1));
 
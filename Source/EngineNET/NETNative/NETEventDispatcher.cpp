@@ -55,15 +55,29 @@ namespace Atomic
 
         if (eventType == E_NODECOLLISION)
         {
-            VariantMap ncEventData = eventData;
+            static const StringHash physicsNodeCollisionKey("PhysicsNodeCollision");
 
             SharedPtr<PhysicsNodeCollision> nodeCollison(new PhysicsNodeCollision());
             nodeCollison->SetFromNodeCollisionEvent(eventData);
-            ncEventData[StringHash("PhysicsNodeCollision")] = nodeCollison;
 
-            ncEventData[eventType] = ncEventData;
+            // Add the converted data in place instead of copying the event data, and remove it again before the
+            // event reaches the remaining receivers
+            eventData[physicsNodeCollisionKey] = nodeCollison;
 
-            NETCore::DispatchEvent(sender, eventType.Value(), &ncEventData);
+            // The nested copy of the event data is filled in place
+            Variant& nested = eventData[eventType];
+            nested = VariantMap();
+            VariantMap& nestedData = *nested.GetVariantMapPtr();
+            for (VariantMap::ConstIterator i = eventData.Begin(); i != eventData.End(); ++i)
+            {
+                if (i->first_ != eventType)
+                    nestedData[i->first_] = i->second_;
+            }
+
+            NETCore::DispatchEvent(sender, eventType.Value(), &eventData);
+
+            eventData.Erase(eventType);
+            eventData.Erase(physicsNodeCollisionKey);
 
             return;
 
@@ -23,6 +23,7 @@
 #include <EngineCore/IO/Log.h>
 #include <EngineCore/IO/File.h>
 #include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/IO/VectorBuffer.h>
 
 #include "../ToolSystem.h"
 #include "../Project/Project.h"
@@ -52,11 +53,28 @@
 namespace ToolCore
 {
 
+static const unsigned long long FNV64_OFFSET = 0xcbf29ce484222325ULL;
+static const unsigned long long FNV64_PRIME = 0x100000001b3ULL;
+
+static void HashBytes(unsigned long long& hash, const unsigned char* data, unsigned size)
+{
+    for (unsigned i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * FNV64_PRIME;
+}
+
+// 0 is reserved for unknown hashes of .asset files written before import hashes were stored
+static unsigned long long FinishHash(unsigned long long hash)
+{
+    return hash ? hash : 1;
+}
+
 Asset::Asset(Context* context) :
     Object(context),
     dirty_(false),
     isFolder_(false),
-    fileTimestamp_(0xffffffff)
+    fileTimestamp_(0xffffffff),
+    contentHash_(0),
+    settingsHash_(0)
 {
 
 }
@@ -76,6 +94,63 @@ void Asset::UpdateFileTimestamp()
     }
 }
 
+unsigned long long Asset::CalculateContentHash() const
+{
+    if (isFolder_)
+        return FinishHash(FNV64_OFFSET);
+
+    SharedPtr<File> file(new File(context_, path_));
+    if (!file->IsOpen())
+        return 0;
+
+    unsigned long long hash = FNV64_OFFSET;
+    unsigned char buffer[65536];
+
+    while (!file->IsEof())
+    {
+        unsigned size = file->Read(buffer, sizeof(buffer));
+        if (!size)
+            break;
+        HashBytes(hash, buffer, size);
+    }
+
+    return FinishHash(hash);
+}
+
+unsigned long long Asset::CalculateSettingsHash()
+{
+    if (importer_.Null())
+        return 0;
+
+    SharedPtr<JSONFile> json(new JSONFile(context_));
+    importer_->SaveSettings(json->GetRoot());
+
+    VectorBuffer buffer;
+    json->Save(buffer, String::EMPTY);
+
+    unsigned long long hash = FNV64_OFFSET;
+    HashBytes(hash, buffer.GetData(), buffer.GetSize());
+    return FinishHash(hash);
+}
+
+bool Asset::IsImportUpToDate()
+{
+    if (!contentHash_)
+        return false;
+
+    // .asset files from before settings hashes were stored count as matching
+    if (settingsHash_ && settingsHash_ != CalculateSettingsHash())
+        return false;
+
+    return contentHash_ == CalculateContentHash();
+}
+
+void Asset::SetImportHashes(unsigned long long contentHash, unsigned long long settingsHash)
+{
+    contentHash_ = contentHash;
+    settingsHash_ = settingsHash;
+}
+
 Asset* Asset::GetParent()
 {
     AssetDatabase* db = GetSubsystem<AssetDatabase>();
@@ -115,16 +190,35 @@ bool Asset::CheckCacheFile()
 
     unsigned modifiedTime = fs->GetLastModifiedTime(path_);
 
+    bool upToDate = true;
+
     if (importer_->RequiresCacheFile()) {
 
-        if (!fs->FileExists(cacheFile) || fs->GetLastModifiedTime(cacheFile) < modifiedTime)
+        if (!fs->FileExists(cacheFile))
             return false;
+
+        if (fs->GetLastModifiedTime(cacheFile) < modifiedTime)
+            upToDate = false;
     }
 
+    // settings changed outside of the editor, for example by a version control update
+    if (settingsHash_ && settingsHash_ != CalculateSettingsHash())
+        return false;
+
     if (fs->GetLastModifiedTime(GetDotAssetFilename()) < modifiedTime)
-    {
+        upToDate = false;
+
+    if (upToDate)
+        return true;
+
+    // a newer timestamp doesn't mean new contents, a touched file or fresh checkout keeps its import
+    if (!IsImportUpToDate())
         return false;
-    }
+
+    // bring the timestamps up to date, so the contents aren't hashed again on the next load
+    fs->SetLastModifiedTime(GetDotAssetFilename(), modifiedTime);
+    if (importer_->RequiresCacheFile())
+        fs->SetLastModifiedTime(cacheFile, modifiedTime);
 
     return true;
 }
@@ -138,6 +232,14 @@ bool Asset::Import()
     return importer_->Import();
 }
 
+bool Asset::FinishImport(bool success)
+{
+    if (importer_.Null())
+        return success;
+
+    return importer_->FinishImport(success);
+}
+
 bool Asset::Preload()
 {
     if (importer_.Null())
@@ -180,17 +282,20 @@ bool Asset::Load()
 
     db->RegisterGUID(guid_);
 
-    dirty_ = false;
-    if (!CheckCacheFile())
-    {
-        dirty_ = true;
-    }
+    contentHash_ = ToUInt64(root.Get("contentHash").GetString(), 16);
+    settingsHash_ = ToUInt64(root.Get("settingsHash").GetString(), 16);
 
     // handle import
 
     if (importer_.NotNull())
         importer_->LoadSettings(root);
 
+    dirty_ = false;
+    if (!CheckCacheFile())
+    {
+        dirty_ = true;
+    }
+
     json_ = 0;
 
     return true;
@@ -210,6 +315,12 @@ bool Asset::Save()
     root.Set("version", JSONValue(ASSET_VERSION));
     root.Set("guid", JSONValue(guid_));
 
+    if (contentHash_)
+    {
+        root.Set("contentHash", JSONValue(ToString("%016llx", contentHash_)));
+        root.Set("settingsHash", JSONValue(ToString("%016llx", settingsHash_)));
+    }
+
     // handle import
 
     if (importer_.NotNull())
@@ -48,6 +48,9 @@ public:
     virtual ~Asset();
 
     bool Import();
+    /// Finish an import on the main thread, after Import() may have run on a worker thread. Returns whether the import
+    /// succeeded
+    bool FinishImport(bool success);
     bool Preload();
 
     // the .fbx, .png, etc path, attempts to load .asset, creates missing .asset
@@ -84,6 +87,23 @@ public:
     /// Sets the time stamp to the asset files current time
     void UpdateFileTimestamp();
 
+    /// Get the hash of the asset file contents at the last import, 0 if unknown
+    unsigned long long GetContentHash() const { return contentHash_; }
+    /// Get the hash of the importer settings at the last import, 0 if unknown
+    unsigned long long GetSettingsHash() const { return settingsHash_; }
+
+    /// Calculate the hash of the asset file contents, 0 if the file can't be read.  Safe to call from worker threads
+    unsigned long long CalculateContentHash() const;
+    /// Calculate the hash of the importer settings as they are saved to the .asset file
+    unsigned long long CalculateSettingsHash();
+
+    /// Returns true if the asset file contents and importer settings match the last import, so that a changed
+    /// timestamp alone (touched file, fresh checkout) doesn't require a reimport
+    bool IsImportUpToDate();
+
+    /// Record the hashes of a finished import, saved with the .asset file
+    void SetImportHashes(unsigned long long contentHash, unsigned long long settingsHash);
+
     // get the .asset filename
     String GetDotAssetFilename();
 
@@ -128,6 +148,10 @@ private:
     // event when the resource is first added)
     unsigned fileTimestamp_;
 
+    // hashes of the asset file contents and importer settings at the last import
+    unsigned long long contentHash_;
+    unsigned long long settingsHash_;
+
     SharedPtr<JSONFile> json_;
     SharedPtr<AssetImporter> importer_;
 };
@@ -22,6 +22,8 @@
 
 #include <Poco/MD5Engine.h>
 
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Core/WorkQueue.h>
 #include <EngineCore/IO/Log.h>
 #include <EngineCore/IO/File.h>
 #include <EngineCore/IO/FileSystem.h>
@@ -30,17 +32,83 @@
 #include <EngineCore/Resource/ResourceCache.h>
 
 #include "../Import/ImportConfig.h"
+#include "../ToolEnvironment.h"
 #include "../ToolEvents.h"
 #include "../ToolSystem.h"
 #include "../Project/Project.h"
 #include "../Project/ProjectEvents.h"
 #include "AssetEvents.h"
 #include "AssetDatabase.h"
+#include "ImportCache.h"
 
 
 namespace ToolCore
 {
 
+/// Import of a dirty asset, a node in the import dependency graph
+struct AssetImportJob
+{
+    AssetImportJob() :
+        importCache_(0),
+        contentHash_(0),
+        settingsHash_(0),
+        numDependencies_(0),
+        success_(false),
+        fetched_(false),
+        finished_(false)
+    {
+    }
+
+    SharedPtr<Asset> asset_;
+    /// Shared import cache, null if the import isn't cacheable
+    ImportCache* importCache_;
+    /// Project cache folder
+    String cachePath_;
+    /// Import cache tag of the importer
+    String cacheTag_;
+    /// Work item when imported on a worker thread
+    SharedPtr<WorkItem> item_;
+    /// Jobs waiting for this import
+    PODVector<unsigned> dependents_;
+    unsigned long long contentHash_;
+    unsigned long long settingsHash_;
+    /// Number of dependencies not yet imported
+    unsigned numDependencies_;
+    bool success_;
+    /// Whether the outputs were fetched from the import cache
+    bool fetched_;
+    bool finished_;
+};
+
+static void RunAssetImport(AssetImportJob& job)
+{
+    job.contentHash_ = job.asset_->CalculateContentHash();
+
+    String key;
+
+    if (job.importCache_ && job.contentHash_)
+    {
+        key = ImportCache::GetKey(job.contentHash_, job.asset_->GetImporterType(), job.settingsHash_, job.cacheTag_);
+
+        if (job.importCache_->Fetch(key, job.asset_, job.cachePath_))
+        {
+            job.success_ = true;
+            job.fetched_ = true;
+            return;
+        }
+    }
+
+    job.success_ = job.asset_->Import();
+
+    if (job.success_ && key.Length())
+        job.importCache_->Store(key, job.asset_, job.cachePath_);
+}
+
+static void AssetImportWork(const WorkItem* item, unsigned threadIndex)
+{
+    RunAssetImport(*reinterpret_cast<AssetImportJob*>(item->aux_));
+}
+
 AssetDatabase::AssetDatabase(Context* context) : Object(context),
     assetScanDepth_(0),
     assetScanImport_(false),
@@ -297,17 +365,189 @@ bool AssetDatabase::ImportDirtyAssets()
     PODVector<Asset*> assets;
     GetDirtyAssets(assets);
 
+    if (assets.Empty())
+        return false;
+
+    assetScanImport_ = true;
+
+    Vector<AssetImportJob> jobs(assets.Size());
+    HashMap<Asset*, unsigned> jobIndices;
+
+    String cachePath = GetCachePath();
+
     for (unsigned i = 0; i < assets.Size(); i++)
     {
-        assetScanImport_ = true;
-        assets[i]->Import();
-        assets[i]->Save();
-        assets[i]->dirty_ = false;
-        assets[i]->UpdateFileTimestamp();
+        AssetImportJob& job = jobs[i];
+        AssetImporter* importer = assets[i]->GetImporter();
+
+        job.asset_ = assets[i];
+        job.settingsHash_ = assets[i]->CalculateSettingsHash();
+        jobIndices[assets[i]] = i;
+
+        if (importCache_ && importer && importer->IsImportCacheable())
+        {
+            job.importCache_ = importCache_;
+            job.cachePath_ = cachePath;
+            job.cacheTag_ = importer->GetImportCacheTag();
+        }
+    }
+
+    // link dirty assets to the dirty assets they depend on, up to date dependencies don't hold an import back
+    const String& resourcePath = project_->GetResourcePath();
+    Vector<String> dependencies;
+
+    for (unsigned i = 0; i < jobs.Size(); i++)
+    {
+        AssetImporter* importer = jobs[i].asset_->GetImporter();
+        if (!importer)
+            continue;
+
+        dependencies.Clear();
+        importer->GetImportDependencies(dependencies);
+
+        for (unsigned j = 0; j < dependencies.Size(); j++)
+        {
+            Asset* dependency = GetAssetByPath(dependencies[j]);
+            if (!dependency)
+                dependency = GetAssetByPath(resourcePath + dependencies[j]);
+
+            HashMap<Asset*, unsigned>::ConstIterator itr = jobIndices.Find(dependency);
+            if (itr == jobIndices.End() || itr->second_ == i)
+                continue;
+
+            jobs[itr->second_].dependents_.Push(i);
+            jobs[i].numDependencies_++;
+        }
+    }
+
+    PODVector<unsigned> ready;
+    PODVector<unsigned> running;
+
+    for (unsigned i = 0; i < jobs.Size(); i++)
+    {
+        if (!jobs[i].numDependencies_)
+            ready.Push(i);
     }
 
-    return assets.Size() != 0;
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    bool threaded = queue && queue->GetNumThreads();
+    unsigned numFinished = 0;
+
+    while (numFinished < jobs.Size())
+    {
+        // thread-safe imports go to the workers
+        for (unsigned i = 0; threaded && i < ready.Size();)
+        {
+            AssetImportJob& job = jobs[ready[i]];
+            AssetImporter* importer = job.asset_->GetImporter();
+
+            if (!importer || !importer->IsImportThreadSafe())
+            {
+                i++;
+                continue;
+            }
+
+            // not taken from the pool, so the queue can't reset or reuse the item while the job still polls it
+            job.item_ = new WorkItem();
+            job.item_->priority_ = M_MAX_UNSIGNED;
+            job.item_->workFunction_ = AssetImportWork;
+            job.item_->aux_ = &job;
+            queue->AddWorkItem(job.item_);
+
+            running.Push(ready[i]);
+            ready.EraseSwap(i);
+        }
+
+        unsigned numCompleted = 0;
 
+        for (unsigned i = 0; i < running.Size();)
+        {
+            if (!jobs[running[i]].item_->completed_)
+            {
+                i++;
+                continue;
+            }
+
+            FinishAssetImport(jobs, running[i], ready);
+            running.EraseSwap(i);
+            numCompleted++;
+        }
+
+        numFinished += numCompleted;
+
+        if (numCompleted)
+            continue;
+
+        // the rest run on the main thread while the workers are busy
+        if (ready.Size())
+        {
+            unsigned index = ready.Back();
+            ready.Pop();
+
+            RunAssetImport(jobs[index]);
+            FinishAssetImport(jobs, index, ready);
+            numFinished++;
+            continue;
+        }
+
+        if (running.Size())
+        {
+            Time::Sleep(1);
+            continue;
+        }
+
+        // only a dependency cycle is left, import the rest in any order
+        for (unsigned i = 0; i < jobs.Size(); i++)
+        {
+            if (!jobs[i].finished_)
+            {
+                jobs[i].numDependencies_ = 0;
+                ready.Push(i);
+            }
+        }
+    }
+
+    if (importCache_)
+    {
+        unsigned numFetched = 0;
+        for (unsigned i = 0; i < jobs.Size(); i++)
+            numFetched += jobs[i].fetched_ ? 1 : 0;
+
+        if (numFetched)
+            ATOMIC_LOGINFOF("Fetched %u of %u imports from the import cache", numFetched, jobs.Size());
+    }
+
+    return true;
+
+}
+
+void AssetDatabase::FinishAssetImport(Vector<AssetImportJob>& jobs, unsigned index, PODVector<unsigned>& ready)
+{
+    AssetImportJob& job = jobs[index];
+    Asset* asset = job.asset_;
+
+    job.success_ = asset->FinishImport(job.success_);
+
+    // worker threads can't send events, so their failures are reported here
+    if (!job.success_ && job.item_)
+        asset->PostImportError(ToString("Failed to import %s", asset->GetPath().CString()));
+
+    if (job.success_)
+        asset->SetImportHashes(job.contentHash_, job.settingsHash_);
+
+    asset->Save();
+    asset->dirty_ = false;
+    asset->UpdateFileTimestamp();
+
+    job.finished_ = true;
+    job.item_ = 0;
+
+    for (unsigned i = 0; i < job.dependents_.Size(); i++)
+    {
+        AssetImportJob& dependent = jobs[job.dependents_[i]];
+        if (dependent.numDependencies_ && !--dependent.numDependencies_)
+            ready.Push(job.dependents_[i]);
+    }
 }
 
 void AssetDatabase::PreloadAssets()
@@ -536,6 +776,11 @@ void AssetDatabase::HandleProjectLoaded(StringHash eventType, VariantMap& eventD
 
     ReadImportConfig();
 
+    ToolEnvironment* env = GetSubsystem<ToolEnvironment>();
+
+    if (importCache_.Null() && env)
+        SetImportCachePath(env->GetToolPrefs()->GetImportCachePath());
+
     if (cacheEnabled_)
     {
         InitCache();
@@ -628,6 +873,13 @@ void AssetDatabase::HandleFileChanged(StringHash eventType, VariantMap& eventDat
         {
             if (asset->GetFileTimestamp() != fs->GetLastModifiedTime(asset->GetPath()))
             {
+                // touching a file or saving it unchanged doesn't need a reimport
+                if (asset->IsImportUpToDate())
+                {
+                    asset->UpdateFileTimestamp();
+                    return;
+                }
+
                 asset->SetDirty(true);
                 Scan();
             }
@@ -771,6 +1023,23 @@ bool AssetDatabase::GenerateCache(bool clean)
 
 }
 
+bool AssetDatabase::SetImportCachePath(const String& path)
+{
+    if (path.Empty())
+    {
+        importCache_ = 0;
+        return true;
+    }
+
+    SharedPtr<ImportCache> importCache(new ImportCache(context_));
+
+    if (!importCache->SetPath(path))
+        return false;
+
+    importCache_ = importCache;
+    return true;
+}
+
 void AssetDatabase::SetCacheEnabled(bool cacheEnabled)
 {
     cacheEnabled_ = cacheEnabled;
@@ -31,7 +31,9 @@ using namespace Atomic;
 namespace ToolCore
 {
 
+class ImportCache;
 class Project;
+struct AssetImportJob;
 
 class AssetDatabase : public Object
 {
@@ -63,6 +65,11 @@ public:
     /// Regenerates the asset cache, clean removes the Cache folder before generating
     bool GenerateCache(bool clean = true);
 
+    /// Set the shared import cache directory that import outputs are fetched from and stored to, empty disables it
+    bool SetImportCachePath(const String& path);
+    /// Get the shared import cache, null if disabled
+    ImportCache* GetImportCache() const { return importCache_; }
+
     void DeleteAsset(Asset* asset);
 
     void Scan();
@@ -94,7 +101,10 @@ private:
     void ReadImportConfig();
     void Import(const String& path);
 
+    /// Import the dirty assets, those with thread-safe importers on the work queue, each after the assets it depends on
     bool ImportDirtyAssets();
+    /// Finish an import on the main thread and mark the dependents it was holding back as ready
+    void FinishAssetImport(Vector<AssetImportJob>& jobs, unsigned index, PODVector<unsigned>& ready);
     void PreloadAssets();
 
     // internal method that initializes project asset cache
@@ -119,6 +129,8 @@ private:
 
     bool cacheEnabled_;
 
+    SharedPtr<ImportCache> importCache_;
+
 };
 
 }
@@ -60,6 +60,22 @@ public:
 
     bool RequiresCacheFile() const { return requiresCacheFile_; }
 
+    /// Return whether Import() may run on a worker thread, concurrently with the imports of other assets
+    virtual bool IsImportThreadSafe() const { return false; }
+
+    /// Get the paths of assets that must be imported before this one, absolute or relative to the resource directory
+    virtual void GetImportDependencies(Vector<String>& paths) {}
+
+    /// Return whether import outputs may be fetched from the shared import cache instead of importing
+    virtual bool IsImportCacheable() const { return false; }
+
+    /// Get the files written by the last import, relative to the project cache folder
+    virtual void GetImportOutputs(Vector<String>& paths) {}
+
+    /// Return options that change the import outputs but aren't saved with the importer settings, such as the project
+    /// import config, to be included in the import cache key
+    virtual String GetImportCacheTag() const { return String::EMPTY; }
+
     /// Instantiate a node from the asset
     virtual Node* InstantiateNode(Node* parent, const String& name) { return 0; }
 
@@ -73,6 +89,10 @@ protected:
 
     virtual bool Import() { return true; }
 
+    /// Called on the main thread after Import(), for the parts of an import that are not thread-safe. Returns whether the
+    /// import succeeded
+    virtual bool FinishImport(bool success) { return success; }
+
     WeakPtr<Asset> asset_;
     bool requiresCacheFile_;
 
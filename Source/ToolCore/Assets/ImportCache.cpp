@@ -0,0 +1,312 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <EngineCore/Container/Sort.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/IO/Log.h>
+#include <EngineCore/Resource/JSONFile.h>
+
+#include "Asset.h"
+#include "ImportCache.h"
+
+namespace ToolCore
+{
+
+static const char* MANIFEST_NAME = "manifest.json";
+static const char* TEMP_SUFFIX = ".tmp";
+
+/// Seconds after which an unfinished store is considered abandoned
+static const unsigned ABANDONED_STORE_AGE = 24 * 60 * 60;
+
+/// Entry found while pruning
+struct ImportCacheEntry
+{
+    String path_;
+    unsigned lastUse_;
+    unsigned long long size_;
+};
+
+static bool CompareLastUse(const ImportCacheEntry& lhs, const ImportCacheEntry& rhs)
+{
+    return lhs.lastUse_ < rhs.lastUse_;
+}
+
+// output names are stored with the GUID and relative path of the asset replaced, so other projects can fetch them
+static String MakeOutputTemplate(const String& name, Asset* asset)
+{
+    String result = name;
+    result.Replace(asset->GetGUID(), "{guid}");
+    result.Replace(asset->GetRelativePath(), "{path}");
+    return result;
+}
+
+static String ResolveOutputTemplate(const String& name, Asset* asset)
+{
+    String result = name;
+    result.Replace("{guid}", asset->GetGUID());
+    result.Replace("{path}", asset->GetRelativePath());
+    return result;
+}
+
+ImportCache::ImportCache(Context* context) : Object(context)
+{
+
+}
+
+ImportCache::~ImportCache()
+{
+
+}
+
+bool ImportCache::SetPath(const String& path)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+
+    String cachePath = AddTrailingSlash(path);
+
+    if (!fileSystem->DirExists(cachePath) && !fileSystem->CreateDir(cachePath))
+    {
+        ATOMIC_LOGERRORF("Unable to create import cache directory %s", cachePath.CString());
+        return false;
+    }
+
+    path_ = cachePath;
+    return true;
+}
+
+String ImportCache::GetKey(unsigned long long contentHash, StringHash importerType, unsigned long long settingsHash,
+    const String& tag)
+{
+    // 64-bit FNV-1a of everything but the contents, which keep their own hash in the first half of the key
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+    unsigned long long values[3] = { importerType.Value(), settingsHash, IMPORT_CACHE_VERSION };
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+
+    for (unsigned i = 0; i < sizeof(values); i++)
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+
+    for (unsigned i = 0; i < tag.Length(); i++)
+        hash = (hash ^ (unsigned char)tag[i]) * 0x100000001b3ULL;
+
+    return ToString("%016llx%016llx", contentHash, hash);
+}
+
+String ImportCache::GetEntryPath(const String& key) const
+{
+    return path_ + key.Substring(0, 2) + "/" + key + "/";
+}
+
+bool ImportCache::Fetch(const String& key, Asset* asset, const String& projectCachePath)
+{
+    if (path_.Empty())
+        return false;
+
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+
+    String entryPath = GetEntryPath(key);
+    String manifestPath = entryPath + MANIFEST_NAME;
+
+    if (!fileSystem->FileExists(manifestPath))
+        return false;
+
+    SharedPtr<File> file(new File(context_, manifestPath));
+    SharedPtr<JSONFile> json(new JSONFile(context_));
+
+    if (!file->IsOpen() || !json->Load(*file))
+        return false;
+
+    file->Close();
+
+    const JSONArray& outputs = json->GetRoot().Get("outputs").GetArray();
+
+    if (outputs.Empty())
+        return false;
+
+    for (unsigned i = 0; i < outputs.Size(); i++)
+    {
+        String name = ResolveOutputTemplate(outputs[i].GetString(), asset);
+        String subdir = Atomic::GetPath(name);
+
+        if (subdir.Length())
+            fileSystem->CreateDirs(projectCachePath, subdir);
+
+        if (!fileSystem->Copy(entryPath + String(i), projectCachePath + name))
+            return false;
+    }
+
+    // record the use, pruning removes the least recently used entries first
+    fileSystem->SetLastModifiedTime(manifestPath, Time::GetTimeSinceEpoch());
+
+    return true;
+}
+
+bool ImportCache::Store(const String& key, Asset* asset, const String& projectCachePath)
+{
+    if (path_.Empty() || !asset->GetImporter())
+        return false;
+
+    Vector<String> outputs;
+    asset->GetImporter()->GetImportOutputs(outputs);
+
+    if (outputs.Empty())
+        return false;
+
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+
+    String entryPath = GetEntryPath(key);
+
+    // stored by another project or build agent with the same input
+    if (fileSystem->FileExists(entryPath + MANIFEST_NAME))
+        return true;
+
+    // write to a temporary directory renamed into place, so an entry is either complete or missing
+    String tempPath = RemoveTrailingSlash(entryPath) + ToString("_%u_%p", Time::GetSystemTime(), (void*)asset) + TEMP_SUFFIX + "/";
+
+    fileSystem->CreateDir(path_ + key.Substring(0, 2));
+
+    if (!fileSystem->CreateDir(tempPath))
+        return false;
+
+    JSONValue jOutputs(JSONValue::emptyArray);
+
+    for (unsigned i = 0; i < outputs.Size(); i++)
+    {
+        if (!fileSystem->Copy(projectCachePath + outputs[i], tempPath + String(i)))
+        {
+            fileSystem->RemoveDir(tempPath, true);
+            return false;
+        }
+
+        jOutputs.Push(JSONValue(MakeOutputTemplate(outputs[i], asset)));
+    }
+
+    SharedPtr<JSONFile> json(new JSONFile(context_));
+    JSONValue& root = json->GetRoot();
+    root.Set("version", JSONValue(IMPORT_CACHE_VERSION));
+    root.Set("importer", JSONValue(asset->GetImporterTypeName()));
+    root.Set("outputs", jOutputs);
+
+    bool saved = json->SaveFile(tempPath + MANIFEST_NAME);
+
+    if (!saved || !fileSystem->Rename(RemoveTrailingSlash(tempPath), RemoveTrailingSlash(entryPath)))
+    {
+        // lost a race with another store of the same entry
+        fileSystem->RemoveDir(tempPath, true);
+        return fileSystem->FileExists(entryPath + MANIFEST_NAME);
+    }
+
+    return true;
+}
+
+unsigned ImportCache::Prune(unsigned long long maxSize, unsigned maxAge)
+{
+    if (path_.Empty())
+        return 0;
+
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    unsigned now = Time::GetTimeSinceEpoch();
+
+    Vector<ImportCacheEntry> entries;
+    unsigned long long totalSize = 0;
+    unsigned numRemoved = 0;
+
+    Vector<String> prefixes;
+    fileSystem->ScanDir(prefixes, path_, "", SCAN_DIRS, false);
+
+    for (unsigned i = 0; i < prefixes.Size(); i++)
+    {
+        if (prefixes[i].StartsWith("."))
+            continue;
+
+        String prefixPath = path_ + prefixes[i] + "/";
+
+        Vector<String> entryNames;
+        fileSystem->ScanDir(entryNames, prefixPath, "", SCAN_DIRS, false);
+
+        for (unsigned j = 0; j < entryNames.Size(); j++)
+        {
+            if (entryNames[j].StartsWith("."))
+                continue;
+
+            String entryPath = prefixPath + entryNames[j] + "/";
+            String manifestPath = entryPath + MANIFEST_NAME;
+
+            // unfinished stores are left alone for a while, they may still be written to
+            if (entryNames[j].EndsWith(TEMP_SUFFIX) || !fileSystem->FileExists(manifestPath))
+            {
+                unsigned modified = fileSystem->GetLastModifiedTime(RemoveTrailingSlash(entryPath));
+                if (now > modified && now - modified > ABANDONED_STORE_AGE)
+                {
+                    fileSystem->RemoveDir(entryPath, true);
+                    numRemoved++;
+                }
+                continue;
+            }
+
+            ImportCacheEntry entry;
+            entry.path_ = entryPath;
+            entry.lastUse_ = fileSystem->GetLastModifiedTime(manifestPath);
+            entry.size_ = 0;
+
+            Vector<String> files;
+            fileSystem->ScanDir(files, entryPath, "", SCAN_FILES, false);
+
+            for (unsigned k = 0; k < files.Size(); k++)
+            {
+                File file(context_, entryPath + files[k]);
+                entry.size_ += file.GetSize();
+            }
+
+            if (maxAge && now > entry.lastUse_ && now - entry.lastUse_ > maxAge)
+            {
+                fileSystem->RemoveDir(entryPath, true);
+                numRemoved++;
+                continue;
+            }
+
+            totalSize += entry.size_;
+            entries.Push(entry);
+        }
+    }
+
+    if (maxSize && totalSize > maxSize)
+    {
+        Sort(entries.Begin(), entries.End(), CompareLastUse);
+
+        for (unsigned i = 0; i < entries.Size() && totalSize > maxSize; i++)
+        {
+            fileSystem->RemoveDir(entries[i].path_, true);
+            totalSize -= entries[i].size_;
+            numRemoved++;
+        }
+    }
+
+    ATOMIC_LOGINFOF("Pruned %u import cache entries, %s remaining", numRemoved, GetFileSizeString(totalSize).CString());
+
+    return numRemoved;
+}
+
+}
@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <EngineCore/Core/Object.h>
+
+using namespace Atomic;
+
+namespace ToolCore
+{
+
+class Asset;
+
+/// Version of the import outputs, part of every entry key. Bump when an importer changes its output for the same input
+static const unsigned IMPORT_CACHE_VERSION = 1;
+
+/// Content addressed store of import outputs, which can be shared between projects, checkouts and build agents.
+/// Entries are keyed by the source content hash, importer type, importer settings hash and IMPORT_CACHE_VERSION, and
+/// hold copies of the files an import wrote to the project Cache folder.  Only importers that declare IsImportCacheable()
+/// are stored, their outputs must not depend on the project the asset is in beyond its GUID and relative path
+class ImportCache : public Object
+{
+    ATOMIC_OBJECT(ImportCache, Object)
+
+public:
+
+    ImportCache(Context* context);
+    virtual ~ImportCache();
+
+    /// Set the cache directory, created if missing.  Returns false if the directory can't be created
+    bool SetPath(const String& path);
+    const String& GetPath() const { return path_; }
+
+    /// Copy the outputs of an entry into the project cache folder.  Returns false if there is no complete entry.
+    /// Safe to call from worker threads
+    bool Fetch(const String& key, Asset* asset, const String& projectCachePath);
+
+    /// Store the outputs of a finished import.  Safe to call from worker threads
+    bool Store(const String& key, Asset* asset, const String& projectCachePath);
+
+    /// Remove entries unused for more than maxAge seconds, then the least recently used ones until the cache is no
+    /// larger than maxSize bytes.  0 disables either limit.  Returns the number of entries removed
+    unsigned Prune(unsigned long long maxSize, unsigned maxAge);
+
+    /// Get the entry key of an import
+    static String GetKey(unsigned long long contentHash, StringHash importerType, unsigned long long settingsHash,
+        const String& tag);
+
+private:
+
+    String GetEntryPath(const String& key) const;
+
+    String path_;
+};
+
+}
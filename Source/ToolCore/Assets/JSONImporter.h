@@ -38,6 +38,8 @@ public:
 
     virtual void SetDefaults();
 
+    bool IsImportThreadSafe() const { return true; }
+
     Resource* GetResource(const String& typeName = String::EMPTY);
 
 protected:
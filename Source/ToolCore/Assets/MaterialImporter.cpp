@@ -21,7 +21,9 @@
 //
 
 #include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
 #include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Resource/XMLFile.h>
 #include <EngineCore/Graphics/Material.h>
 
 #include "Asset.h"
@@ -50,6 +52,28 @@ bool MaterialImporter::Import()
     return true;
 }
 
+void MaterialImporter::GetImportDependencies(Vector<String>& paths)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    if (!fileSystem->FileExists(asset_->GetPath()))
+        return;
+
+    SharedPtr<File> file(new File(context_, asset_->GetPath()));
+    SharedPtr<XMLFile> xml(new XMLFile(context_));
+    if (!xml->Load(*file))
+        return;
+
+    XMLElement textureElem = xml->GetRoot().GetChild("texture");
+    while (textureElem)
+    {
+        String name = textureElem.GetAttribute("name");
+        if (name.Length())
+            paths.Push(name);
+
+        textureElem = textureElem.GetNext("texture");
+    }
+}
+
 void MaterialImporter::SaveMaterial()
 {
     ResourceCache* cache = GetSubsystem<ResourceCache>();
@@ -42,6 +42,11 @@ public:
 
     Resource* GetResource(const String& typeName = String::EMPTY);
 
+    bool IsImportThreadSafe() const { return true; }
+
+    /// Get the textures the material refers to
+    void GetImportDependencies(Vector<String>& paths);
+
 protected:
 
     bool Import();
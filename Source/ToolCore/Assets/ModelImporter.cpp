@@ -21,6 +21,7 @@
 //
 
 #include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/Thread.h>
 #include <EngineCore/IO/Log.h>
 #include <EngineCore/IO/File.h>
 #include <EngineCore/IO/FileSystem.h>
@@ -70,30 +71,46 @@ void ModelImporter::SetDefaults()
 
 }
 
-bool ModelImporter::ImportModel()
+bool ModelImporter::LoadModel()
 {
-
-    ATOMIC_LOGDEBUGF("Importing Model: %s", asset_->GetPath().CString());
-
     SharedPtr<OpenAssetImporter> importer(new OpenAssetImporter(context_));
 
-    importer->SetVerboseLog(true);
+    // Assimp's verbose logger is a process global, which concurrent loads on worker threads can't share
+    importer->SetVerboseLog(Thread::IsMainThread());
 
     importer->SetScale(scale_);
     importer->SetExportAnimations(false);
-    importer->SetImportNode(importNode_);
     importer->SetImportMaterials(importMaterials_);
     importer->SetIncludeNonSkinningBones(includeNonSkinningBones_);
 
-    if (importer->Load(asset_->GetPath()))
+    if (!importer->Load(asset_->GetPath()))
+    {
+        loadError_ = importer->GetErrorMessage();
+        return false;
+    }
+
+    loadedImporter_ = importer;
+    return true;
+}
+
+bool ModelImporter::ImportModel()
+{
+
+    ATOMIC_LOGDEBUGF("Importing Model: %s", asset_->GetPath().CString());
+
+    SharedPtr<OpenAssetImporter> importer = loadedImporter_;
+    loadedImporter_ = 0;
+
+    if (importer)
     {
+        importer->SetImportNode(importNode_);
         importer->ExportModel(asset_->GetCachePath());
 
         return true;
     }
     else
     {
-        asset_->PostImportError(importer->GetErrorMessage());
+        asset_->PostImportError(loadError_);
     }
 
     return false;
@@ -227,6 +244,24 @@ bool ModelImporter::ImportAnimations()
 
 bool ModelImporter::Import()
 {
+    loadedImporter_ = 0;
+    loadError_.Clear();
+
+    // Parsing and post-processing the source file is the slow part of a model import, and may run on a worker thread.
+    // Exporting creates GPU buffers and goes through the resource cache, so FinishImport does it on the main thread
+    if (asset_->GetExtension() != ".mdl" && !asset_->GetPath().Contains("@"))
+        LoadModel();
+
+    return true;
+}
+
+bool ModelImporter::FinishImport(bool success)
+{
+    if (!success)
+    {
+        loadedImporter_ = 0;
+        return false;
+    }
 
     String ext = asset_->GetExtension();
     String modelAssetFilename = asset_->GetPath();
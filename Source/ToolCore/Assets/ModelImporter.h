@@ -35,6 +35,8 @@ using namespace Atomic;
 namespace ToolCore
 {
 
+class OpenAssetImporter;
+
 class AnimationImportInfo : public Object
 {
     friend class ModelImporter;
@@ -76,6 +78,9 @@ public:
 
     virtual void SetDefaults();
 
+    /// Loading the source file is thread-safe, building the model and node is done by FinishImport
+    bool IsImportThreadSafe() const { return true; }
+
     double GetScale() { return scale_; }
     void SetScale(double scale) {scale_ = scale; }
 
@@ -99,7 +104,10 @@ public:
 protected:
 
     bool Import();
+    bool FinishImport(bool success);
 
+    /// Parse the source file, safe on a worker thread
+    bool LoadModel();
     bool ImportModel();
     bool ImportAnimations();
     bool ImportAnimation(const String &filename, const String& name, float startTime=-1.0f, float endTime=-1.0f);
@@ -117,6 +125,11 @@ protected:
 
     SharedPtr<Node> importNode_;
 
+    /// Source file parsed by Import(), exported by FinishImport()
+    SharedPtr<OpenAssetImporter> loadedImporter_;
+    /// Error message of a failed load
+    String loadError_;
+
 };
 
 }
@@ -38,6 +38,8 @@ public:
 
     virtual void SetDefaults();
 
+    bool IsImportThreadSafe() const { return true; }
+
 protected:
 
     bool Import();
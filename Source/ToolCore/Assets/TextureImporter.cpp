@@ -37,7 +37,7 @@ namespace ToolCore
 {
 
     TextureImporter::TextureImporter(Context* context, Asset *asset) : AssetImporter(context, asset),
-        compressTextures_(false), compressedSize_(0)
+        compressTextures_(false), compressedSize_(0), sRGB_(false), alphaTestReference_(0.0f)
 {
     requiresCacheFile_ = true;
 
@@ -54,6 +54,8 @@ void TextureImporter::SetDefaults()
     AssetImporter::SetDefaults();
 
     compressedSize_ = 0;
+    sRGB_ = false;
+    alphaTestReference_ = 0.0f;
 
 }
 
@@ -64,11 +66,12 @@ bool TextureImporter::Import()
     String cachePath = db->GetCachePath();
 
     FileSystem* fileSystem = GetSubsystem<FileSystem>();
-    String compressedPath = cachePath + "DDS/" + asset_->GetRelativePath() + ".dds";
+    String compressedPath = GetCompressedPath();
     if (fileSystem->FileExists(compressedPath))
         fileSystem->Delete(compressedPath);
 
-    SharedPtr<Image> image = cache->GetTempResource<Image>(asset_->GetPath());
+    // May run on a worker thread, where load failure events can't be sent. The asset database reports the failure
+    SharedPtr<Image> image = cache->GetTempResource<Image>(asset_->GetPath(), false);
 
     if (image.Null())
         return false;
@@ -82,7 +85,7 @@ bool TextureImporter::Import()
         float width = image->GetWidth();
         float height = image->GetHeight();
 
-        if (width > compressedSize_ || height > compressedSize_)
+        if (compressedSize_ && (width > compressedSize_ || height > compressedSize_))
         {
             if (width >= height)
             {
@@ -96,12 +99,11 @@ bool TextureImporter::Import()
             image->Resize(width*resizefactor, height*resizefactor);
         }
 
-        if (image->SaveDDS(compressedPath))
-        {
-            Renderer* renderer = GetSubsystem<Renderer>();
-            if (renderer != NULL) // May be importing through headless process
-                renderer->ReloadTextures();
-        }
+        // Save the complete mip chain, so that the runtime never needs to generate it
+        image->SetSRGB(sRGB_);
+        image->GenerateLevels(alphaTestReference_);
+
+        image->SaveDDS(compressedPath, CF_NONE, true);
     }
 
     // todo, proper proportions
@@ -117,6 +119,46 @@ bool TextureImporter::Import()
     return true;
 }
 
+bool TextureImporter::FinishImport(bool success)
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    String compressedPath = GetCompressedPath();
+
+    if (!fileSystem->FileExists(compressedPath))
+        return success;
+
+    // outputs fetched from the import cache don't remove the compressed texture of an earlier import
+    if (!compressTextures_)
+    {
+        fileSystem->Delete(compressedPath);
+        return success;
+    }
+
+    if (!success)
+        return false;
+
+    Renderer* renderer = GetSubsystem<Renderer>();
+    if (renderer != NULL) // May be importing through headless process
+        renderer->ReloadTextures();
+
+    return true;
+}
+
+String TextureImporter::GetCompressedPath() const
+{
+    AssetDatabase* db = GetSubsystem<AssetDatabase>();
+    return db->GetCachePath() + "DDS/" + asset_->GetRelativePath() + ".dds";
+}
+
+void TextureImporter::GetImportOutputs(Vector<String>& paths)
+{
+    paths.Push(asset_->GetGUID());
+    paths.Push(asset_->GetGUID() + "_thumbnail.png");
+
+    if (compressTextures_ && GetSubsystem<FileSystem>()->FileExists(GetCompressedPath()))
+        paths.Push("DDS/" + asset_->GetRelativePath() + ".dds");
+}
+
 void TextureImporter::ApplyProjectImportConfig()
 {
     if (ImportConfig::IsLoaded())
@@ -145,6 +187,12 @@ bool TextureImporter::LoadSettingsInternal(JSONValue& jsonRoot)
     if (import.Get("compressionSize").IsNumber())
         compressedSize_ = (CompressedFormat)import.Get("compressionSize").GetInt();
 
+    if (import.Get("sRGB").IsBool())
+        sRGB_ = import.Get("sRGB").GetBool();
+
+    if (import.Get("alphaTestReference").IsNumber())
+        alphaTestReference_ = import.Get("alphaTestReference").GetFloat();
+
     return true;
 }
 
@@ -155,6 +203,8 @@ bool TextureImporter::SaveSettingsInternal(JSONValue& jsonRoot)
 
     JSONValue import(JSONValue::emptyObject);
     import.Set("compressionSize", compressedSize_);
+    import.Set("sRGB", sRGB_);
+    import.Set("alphaTestReference", alphaTestReference_);
 
     jsonRoot.Set("TextureImporter", import);
 
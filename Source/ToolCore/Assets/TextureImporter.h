@@ -41,20 +41,41 @@ public:
     Resource* GetResource(const String& typeName = String::EMPTY);
     Node* InstantiateNode(Node* parent, const String& name);
 
+    bool IsImportThreadSafe() const { return true; }
+
+    bool IsImportCacheable() const { return true; }
+    void GetImportOutputs(Vector<String>& paths);
+    String GetImportCacheTag() const { return compressTextures_ ? "compress" : String::EMPTY; }
+
     void SetCompressedImageSize(unsigned int compressedSize) { compressedSize_ = compressedSize; }
     unsigned int GetCompressedImageSize() { return compressedSize_; }
 
+    /// Set whether the texture color data is sRGB. Mip levels are then filtered in linear space and the compressed texture is saved with an sRGB format.
+    void SetSRGB(bool sRGB) { sRGB_ = sRGB; }
+    bool GetSRGB() const { return sRGB_; }
+
+    /// Set the alpha test reference whose coverage is preserved in the mip levels, or 0 to disable.
+    void SetAlphaTestReference(float alphaTestReference) { alphaTestReference_ = alphaTestReference; }
+    float GetAlphaTestReference() const { return alphaTestReference_; }
+
 protected:
 
     bool Import();
+    bool FinishImport(bool success);
     void ApplyProjectImportConfig();
 
+    // path of the compressed texture in the project cache folder
+    String GetCompressedPath() const;
+
     virtual bool LoadSettingsInternal(JSONValue& jsonRoot);
     virtual bool SaveSettingsInternal(JSONValue& jsonRoot);
 
     bool compressTextures_;
 
     unsigned int compressedSize_;
+
+    bool sRGB_;
+    float alphaTestReference_;
 };
 
 }
@@ -24,12 +24,8 @@
 //
 
 #include <EngineCore/Core/StringUtils.h>
-#include <EngineCore/IO/Log.h>
-#include <EngineCore/IO/FileSystem.h>
-#include <EngineCore/Container/ArrayPtr.h>
-
-#include <LZ4/lz4.h>
-#include <LZ4/lz4hc.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/IO/PackageWriter.h>
 
 #include "BuildBase.h"
 #include "ResourcePackager.h"
@@ -54,136 +50,44 @@ bool ResourcePackager::WritePackageFile(const String& destFilePath)
 {
     buildBase_->BuildLog("Writing package", false);
 
-    SharedPtr<File> dest(new File(context_, destFilePath, FILE_WRITE));
-    if (!dest->IsOpen())
-    {
-        buildBase_->FailBuild("Could not open output file " + destFilePath);
-        return false;
-    }
+    HiresTimer timer;
 
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader(dest);
+    // compressed on the work queue threads, unchanged entries are copied from the package being replaced
+    SharedPtr<PackageWriter> writer(new PackageWriter(context_));
 
     for (unsigned i = 0; i < resourceEntries_.Size(); i++)
-    {
-        BuildResourceEntry* entry = resourceEntries_[i];
-
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest->WriteString(entry->packagePath_);
-        dest->WriteUInt(entry->offset_);
-        dest->WriteUInt(entry->size_);
-        dest->WriteUInt(entry->checksum_);
-    }
+        writer->AddFile(resourceEntries_[i]->packagePath_, resourceEntries_[i]->absolutePath_);
 
-    unsigned totalDataSize = 0;
-
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < resourceEntries_.Size(); i++)
+    if (!writer->Write(destFilePath))
     {
-        BuildResourceEntry* entry = resourceEntries_[i];
-
-        entry->offset_ = dest->GetSize();
-
-        File srcFile(context_, entry->absolutePath_);
-        if (!srcFile.IsOpen())
-        {
-            buildBase_->FailBuild("Could not open input file " + entry->absolutePath_);
-            return false;
-        }
-
-        unsigned dataSize = entry->size_;
-        totalDataSize += dataSize;
-        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
-
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-        {
-            buildBase_->FailBuild("Could not read input file " + entry->absolutePath_);
-            return false;
-        }
-
-        srcFile.Close();
-
-        for (unsigned j = 0; j < dataSize; ++j)
-        {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entry->checksum_ = SDBMHash(entry->checksum_, buffer[j]);
-        }
-
-        // might not want to compress for WebGL
-        //if (!compress_)
-        //{
-        //    PrintLine(entries_[i].name_ + " size " + String(dataSize));
-        //    dest.Write(&buffer[0], entries_[i].size_);
-        //}
-        //else
-        //{
-
-        unsigned compressedBlockSize_ = 32768;
-
-        SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(compressedBlockSize_)]);
-
-        unsigned pos = 0;
-        unsigned totalPackedBytes = 0;
-
-        while (pos < dataSize)
-        {
-            unsigned unpackedSize = compressedBlockSize_;
-            if (pos + unpackedSize > dataSize)
-                unpackedSize = dataSize - pos;
-
-            unsigned packedSize = LZ4_compressHC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize);
-            if (!packedSize)
-            {
-                buildBase_->FailBuild(ToString("LZ4 compression failed for file %s at offset %u", entry->absolutePath_.CString(), pos));
-                return false;
-            }
-
-            dest->WriteUShort(unpackedSize);
-            dest->WriteUShort(packedSize);
-            dest->Write(compressBuffer.Get(), packedSize);
-            totalPackedBytes += 6 + packedSize;
-
-            pos += unpackedSize;
-        }
-
-        buildBase_->BuildLog(entry->absolutePath_ + " in " + String(dataSize) + " out " + String(totalPackedBytes), false);
-        }
-    //}
-
-    // Write package size to the end of file to allow finding it linked to an executable file
-    unsigned currentSize = dest->GetSize();
-    dest->WriteUInt(currentSize + sizeof(unsigned));
+        buildBase_->FailBuild(writer->GetError());
+        return false;
+    }
 
-    // Write header again with correct offsets & checksums
-    dest->Seek(0);
-    WriteHeader(dest);
+    const Vector<PackageWriterEntry>& entries = writer->GetEntries();
 
     for (unsigned i = 0; i < resourceEntries_.Size(); i++)
     {
         BuildResourceEntry* entry = resourceEntries_[i];
+        entry->offset_ = entries[i].offset_;
+        entry->size_ = entries[i].size_;
+        entry->checksum_ = entries[i].checksum_;
 
-        dest->WriteString(entry->packagePath_);
-        dest->WriteUInt(entry->offset_);
-        dest->WriteUInt(entry->size_);
-        dest->WriteUInt(entry->checksum_);
+        buildBase_->BuildLog(entry->absolutePath_ + " in " + String(entry->size_) + " out " + String(entries[i].packedSize_), false);
     }
 
+    checksum_ = writer->GetChecksum();
+
     buildBase_->BuildLog("Resource Package:");
     buildBase_->BuildLog("Number of files " + String(resourceEntries_.Size()));
-    buildBase_->BuildLog("File data size " + String(totalDataSize));
-    buildBase_->BuildLog("Package size " + String(dest->GetSize()));
+    buildBase_->BuildLog("Unchanged files reused " + String(writer->GetNumReused()));
+    buildBase_->BuildLog("File data size " + String(writer->GetTotalDataSize()));
+    buildBase_->BuildLog("Package size " + String(writer->GetPackageSize()));
+    buildBase_->BuildLog(ToString("Packaged in %.2f s", timer.GetUSec(false) / 1000000.0f));
 
     return true;
 }
 
-void ResourcePackager::WriteHeader(File* dest)
-{
-    dest->WriteFileID("RLZ4");
-    dest->WriteUInt(resourceEntries_.Size());
-    dest->WriteUInt(checksum_);
-}
-
-
 void ResourcePackager::GeneratePackage(const String& destFilePath)
 {
     for (unsigned i = 0; i < resourceEntries_.Size(); i++)
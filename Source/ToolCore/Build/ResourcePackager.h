@@ -50,7 +50,6 @@ public:
 
 private:
 
-    void WriteHeader(File* dest);
     bool WritePackageFile(const String& destFilePath);
 
     PODVector<BuildResourceEntry*> resourceEntries_;
@@ -25,6 +25,7 @@
 #include <EngineCore/IO/File.h>
 
 #include "../Assets/AssetDatabase.h"
+#include "../Assets/ImportCache.h"
 #include "../ToolSystem.h"
 #include "../ToolEnvironment.h"
 #include "../Project/Project.h"
@@ -38,7 +39,10 @@ namespace ToolCore
 
 CacheCmd::CacheCmd(Context* context) : Command(context),
     cleanCache_(false),
-    generateCache_(false)
+    generateCache_(false),
+    pruneImportCache_(false),
+    maxSize_(0),
+    maxAge_(0)
 {
     // We disable the AssetDatabase cache, as will be cleaning, regenerating, etc
     GetSubsystem<AssetDatabase>()->SetCacheEnabled(false);
@@ -63,6 +67,12 @@ bool CacheCmd::ParseInternal(const Vector<String>& arguments, unsigned startInde
                 continue;
             }
 
+            if (argument == "prune")
+            {
+                pruneImportCache_ = true;
+                continue;
+            }
+
             // process any argument/value pairs
             if (arguments[i][0] != '-')
                 continue;
@@ -77,6 +87,23 @@ bool CacheCmd::ParseInternal(const Vector<String>& arguments, unsigned startInde
 
             if (argument == "clean")
                 cleanCache_ = true;
+            else if (argument == "max-size" || argument == "max-age" || argument == "import-cache")
+            {
+                if (!value.Length() || value.StartsWith("-"))
+                {
+                    errorMsg = ToString("Missing value for --%s", argument.CString());
+                    return false;
+                }
+
+                if (argument == "max-size")
+                    maxSize_ = ToUInt(value);
+                else if (argument == "max-age")
+                    maxAge_ = ToUInt(value);
+                else
+                    importCachePath_ = value;
+
+                i++;
+            }
 
         }
     }
@@ -84,10 +111,42 @@ bool CacheCmd::ParseInternal(const Vector<String>& arguments, unsigned startInde
     return true;
 }
 
+bool CacheCmd::PruneImportCache() const
+{
+    String path = importCachePath_;
+
+    if (path.Empty())
+        path = GetSubsystem<ToolEnvironment>()->GetToolPrefs()->GetImportCachePath();
+
+    if (path.Empty())
+    {
+        ATOMIC_LOGERROR("CacheCmd::PruneImportCache - no import cache path given or set in the tool prefs");
+        return false;
+    }
+
+    SharedPtr<ImportCache> importCache(new ImportCache(context_));
+
+    if (!importCache->SetPath(path))
+        return false;
+
+    importCache->Prune((unsigned long long)maxSize_ * 1024 * 1024, maxAge_ * 24 * 60 * 60);
+
+    return true;
+}
+
 void CacheCmd::Run()
 {
     AssetDatabase* database = GetSubsystem<AssetDatabase>();
-    
+
+    if (pruneImportCache_)
+    {
+        if (!PruneImportCache())
+        {
+            Error("Failed to prune the import cache");
+            return;
+        }
+    }
+
     if (generateCache_)
     {
         database->GenerateCache(cleanCache_);
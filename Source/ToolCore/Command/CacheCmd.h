@@ -38,6 +38,8 @@ class CacheCmd: public Command
     /// AtomicTool cache --clean --project C:\Path\To\MyProject (cleans cache folder)
     /// AtomicTool cache generate --project C:\Path\To\MyProject (regenerates the project cache)
     /// AtomicTool cache generate --clean --project C:\Path\To\MyProject (cleans and then regenerates the project cache)
+    /// AtomicTool cache prune --max-size 2048 --max-age 30 (prunes the shared import cache to 2048 MB, dropping entries unused for 30 days)
+    /// AtomicTool cache prune --import-cache C:\Path\To\ImportCache (prunes an import cache other than the one in the tool prefs)
 
     ATOMIC_OBJECT(CacheCmd, Command)
 
@@ -50,6 +52,9 @@ public:
 
     bool RequiresNETService() { return true; }
 
+    // pruning the shared import cache on its own doesn't need a project
+    bool RequiresProjectLoad() { return generateCache_ || cleanCache_ || !pruneImportCache_; }
+
 protected:
 
     bool ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg);
@@ -63,8 +68,17 @@ private:
 
     bool GenerateCache() const;
 
+    bool PruneImportCache() const;
+
     bool cleanCache_;
     bool generateCache_;
+    bool pruneImportCache_;
+
+    String importCachePath_;
+    // in megabytes, 0 for no limit
+    unsigned maxSize_;
+    // in days, 0 for no limit
+    unsigned maxAge_;
 
 };
 
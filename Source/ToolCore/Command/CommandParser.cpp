@@ -31,6 +31,9 @@
 #include "NETCmd.h"
 #include "ProjectCmd.h"
 #include "CacheCmd.h"
+#include "SceneCmd.h"
+#include "HashCmd.h"
+#include "ShaderCmd.h"
 
 namespace ToolCore
 {
@@ -91,6 +94,18 @@ Command* CommandParser::Parse(const Vector<String>& arguments)
             {
                 cmd = new CacheCmd(context_);
             }
+            else if (argument == "scene")
+            {
+                cmd = new SceneCmd(context_);
+            }
+            else if (argument == "hash")
+            {
+                cmd = new HashCmd(context_);
+            }
+            else if (argument == "shader")
+            {
+                cmd = new ShaderCmd(context_);
+            }
 
         }
 
@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <EngineCore/Core/Context.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/IO/Log.h>
+
+// Event headers are included so that their parameter names are registered in this module, which is built with ENGINE_TOOLS
+#include <EngineCore/2D/Atomic2DEvents.h>
+#include <EngineCore/2D/PhysicsEvents2D.h>
+#include <EngineCore/Audio/AudioEvents.h>
+#include <EngineCore/Core/CoreEvents.h>
+#ifdef ENGINE_DATABASE
+#include <EngineCore/Database/DatabaseEvents.h>
+#endif
+#include <EngineCore/Engine/EngineEvents.h>
+#include <EngineCore/Graphics/DrawableEvents.h>
+#include <EngineCore/Graphics/GraphicsEvents.h>
+#include <EngineCore/IK/IKEvents.h>
+#include <EngineCore/IO/IOEvents.h>
+#include <EngineCore/IPC/IPCEvents.h>
+#include <EngineCore/Input/InputEvents.h>
+#include <EngineCore/Navigation/NavigationEvents.h>
+#include <EngineCore/Network/NetworkEvents.h>
+#include <EngineCore/Physics/PhysicsEvents.h>
+#include <EngineCore/Resource/ResourceEvents.h>
+#include <EngineCore/Scene/PrefabEvents.h>
+#include <EngineCore/Scene/SceneEvents.h>
+#include <EngineCore/UI/SystemUI/SystemUIEvents.h>
+#include <EngineCore/UI/UIEvents.h>
+#include <EngineCore/Web/WebEvents.h>
+
+#include "../Assets/AssetEvents.h"
+#include "../Build/BuildEvents.h"
+#include "../License/LicenseEvents.h"
+#include "../Project/ProjectEvents.h"
+#include "../ToolEvents.h"
+
+#include "HashCmd.h"
+
+namespace ToolCore
+{
+
+HashCmd::HashCmd(Context* context) : Command(context)
+{
+
+}
+
+HashCmd::~HashCmd()
+{
+
+}
+
+// usage: hash audit
+bool HashCmd::ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg)
+{
+    String argument = arguments[startIndex].ToLower();
+    String command = startIndex + 1 < arguments.Size() ? arguments[startIndex + 1].ToLower() : String::EMPTY;
+
+    if (argument != "hash" || command != "audit")
+    {
+        errorMsg = "Unable to parse hash command";
+        return false;
+    }
+
+    return true;
+}
+
+void HashCmd::Run()
+{
+    unsigned numStrings = 0;
+
+    // Register every name the engine knows as a significant string, which records hash collisions between them. Event
+    // parameter names were already registered during static initialization of the tool build
+    const HashMap<StringHash, String>& eventNames = EventNameRegistrar::GetEventNameMap();
+    for (HashMap<StringHash, String>::ConstIterator i = eventNames.Begin(); i != eventNames.End(); ++i)
+    {
+        StringHash::RegisterSignificantString(i->second_, i->first_);
+        ++numStrings;
+    }
+
+    const HashMap<StringHash, SharedPtr<ObjectFactory> >& factories = context_->GetObjectFactories();
+    for (HashMap<StringHash, SharedPtr<ObjectFactory> >::ConstIterator i = factories.Begin(); i != factories.End(); ++i)
+    {
+        StringHash::RegisterSignificantString(i->second_->GetFactoryTypeName());
+        ++numStrings;
+    }
+
+    const HashMap<String, Vector<StringHash> >& categories = context_->GetObjectCategories();
+    for (HashMap<String, Vector<StringHash> >::ConstIterator i = categories.Begin(); i != categories.End(); ++i)
+    {
+        StringHash::RegisterSignificantString(i->first_);
+        ++numStrings;
+    }
+
+    const HashMap<StringHash, Vector<AttributeInfo> >& attributes = context_->GetAllAttributes();
+    for (HashMap<StringHash, Vector<AttributeInfo> >::ConstIterator i = attributes.Begin(); i != attributes.End(); ++i)
+    {
+        for (unsigned j = 0; j < i->second_.Size(); ++j)
+        {
+            StringHash::RegisterSignificantString(i->second_[j].name_);
+            ++numStrings;
+        }
+    }
+
+    const Vector<String>& collisions = StringHash::GetSignificantStringCollisions();
+    for (unsigned i = 0; i < collisions.Size(); ++i)
+        ATOMIC_LOGRAWF("Hash collision: %s\n", collisions[i].CString());
+
+    if (collisions.Size())
+    {
+        Error(ToString("Found %u hash collisions", collisions.Size()));
+        return;
+    }
+
+    ATOMIC_LOGRAWF("Audited %u names, no hash collisions\n", numStrings);
+
+    Finished();
+}
+
+}
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/IO/Log.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/Scene/Scene.h>
+#include <EngineCore/Scene/SceneArchive.h>
+
+#include "SceneCmd.h"
+
+namespace ToolCore
+{
+
+SceneCmd::SceneCmd(Context* context) : Command(context),
+    format_("compact"),
+    compress_(true)
+{
+
+}
+
+SceneCmd::~SceneCmd()
+{
+
+}
+
+// usage: scene convert <input> <output> [--format compact|binary|xml|json] [--uncompressed]
+bool SceneCmd::ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg)
+{
+    String argument = arguments[startIndex].ToLower();
+    String command = startIndex + 1 < arguments.Size() ? arguments[startIndex + 1].ToLower() : String::EMPTY;
+
+    if (argument != "scene" || command != "convert")
+    {
+        errorMsg = "Unable to parse scene command";
+        return false;
+    }
+
+    for (unsigned i = startIndex + 2; i < arguments.Size(); i++)
+    {
+        if (arguments[i].Length() > 1 && arguments[i][0] == '-')
+        {
+            argument = arguments[i].ToLower();
+
+            // eat additonal argument '-'
+            while (argument.StartsWith("-"))
+            {
+                argument.Erase(0);
+            }
+
+            String value = i + 1 < arguments.Size() ? arguments[i + 1] : String::EMPTY;
+
+            if (argument == "format")
+            {
+                format_ = value.ToLower();
+                i++;
+            }
+            else if (argument == "uncompressed")
+            {
+                compress_ = false;
+            }
+        }
+        else if (!inputPath_.Length())
+        {
+            inputPath_ = arguments[i];
+        }
+        else if (!outputPath_.Length())
+        {
+            outputPath_ = arguments[i];
+        }
+    }
+
+    if (!inputPath_.Length() || !outputPath_.Length())
+    {
+        errorMsg = "Scene convert requires an input and an output path";
+        return false;
+    }
+
+    if (format_ != "compact" && format_ != "binary" && format_ != "xml" && format_ != "json")
+    {
+        errorMsg = ToString("Unknown scene format: %s", format_.CString());
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneCmd::ConvertScene(String& errorMsg) const
+{
+    SharedPtr<File> inFile(new File(context_, inputPath_));
+    if (!inFile->IsOpen())
+    {
+        errorMsg = ToString("Unable to open source scene: %s", inputPath_.CString());
+        return false;
+    }
+
+    SharedPtr<Scene> scene(new Scene(context_));
+
+    // Detect the source format from the content, as scene file extensions are not reliable
+    bool loaded = false;
+    String fileID = inFile->ReadFileID();
+    inFile->Seek(0);
+
+    if (fileID == "USCN" || SceneArchive::IsCompactScene(*inFile))
+    {
+        loaded = scene->Load(*inFile);
+    }
+    else
+    {
+        // Skip leading whitespace to tell JSON from XML
+        char first = 0;
+        while (!inFile->IsEof())
+        {
+            first = (char)inFile->ReadByte();
+            if (first != ' ' && first != '\t' && first != '\r' && first != '\n')
+                break;
+        }
+        inFile->Seek(0);
+
+        if (first == '{')
+            loaded = scene->LoadJSON(*inFile);
+        else
+            loaded = scene->LoadXML(*inFile);
+    }
+
+    if (!loaded)
+    {
+        errorMsg = ToString("Unable to load source scene: %s", inputPath_.CString());
+        return false;
+    }
+
+    SharedPtr<File> outFile(new File(context_, outputPath_, FILE_WRITE));
+    if (!outFile->IsOpen())
+    {
+        errorMsg = ToString("Unable to open destination scene: %s", outputPath_.CString());
+        return false;
+    }
+
+    bool saved = false;
+
+    if (format_ == "compact")
+        saved = scene->SaveCompact(*outFile, compress_);
+    else if (format_ == "binary")
+        saved = scene->Save(*outFile);
+    else if (format_ == "json")
+        saved = scene->SaveJSON(*outFile);
+    else
+        saved = scene->SaveXML(*outFile);
+
+    if (!saved)
+    {
+        errorMsg = ToString("Unable to save destination scene: %s", outputPath_.CString());
+        return false;
+    }
+
+    ATOMIC_LOGRAWF("Converted %s to %s (%s, %u bytes)\n", inputPath_.CString(), outputPath_.CString(),
+        format_.CString(), outFile->GetSize());
+
+    return true;
+}
+
+void SceneCmd::Run()
+{
+    String errorMsg;
+
+    if (!ConvertScene(errorMsg))
+    {
+        Error(errorMsg);
+        return;
+    }
+
+    Finished();
+}
+
+}
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "Command.h"
+
+using namespace Atomic;
+
+namespace ToolCore
+{
+
+/// Command for converting scenes between the XML, JSON, binary and compact binary formats
+class SceneCmd: public Command
+{
+
+    /// Example usage:
+    /// AtomicTool scene convert Scenes/Level.scene Scenes/Level.cscn (converts to the compact format)
+    /// AtomicTool scene convert Scenes/Level.cscn Scenes/Level.json --format json
+    /// AtomicTool scene convert Scenes/Level.bin Scenes/Level.cscn --uncompressed
+
+    ATOMIC_OBJECT(SceneCmd, Command)
+
+public:
+
+    SceneCmd(Context* context);
+    virtual ~SceneCmd();
+
+    void Run();
+
+    bool RequiresProjectLoad() { return false; }
+
+protected:
+
+    bool ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg);
+
+private:
+
+    bool ConvertScene(String& errorMsg) const;
+
+    String inputPath_;
+    String outputPath_;
+    String format_;
+    bool compress_;
+
+};
+
+}
@@ -0,0 +1,550 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Core/WorkQueue.h>
+#include <EngineCore/Graphics/RenderPath.h>
+#include <EngineCore/Graphics/Renderer.h>
+#include <EngineCore/Graphics/Shader.h>
+#include <EngineCore/Graphics/ShaderCacheArchive.h>
+#include <EngineCore/Graphics/ShaderVariation.h>
+#include <EngineCore/Graphics/Technique.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/IO/Log.h>
+#include <EngineCore/Resource/JSONFile.h>
+#include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Resource/XMLFile.h>
+
+#include "../ToolEnvironment.h"
+#include "../ToolSystem.h"
+#include "../Project/Project.h"
+
+#include "ShaderCmd.h"
+
+namespace ToolCore
+{
+
+/// Shader resource path and extension, as used by Graphics::GetShader().
+static const char* SHADER_PATH = "Shaders/SpirV/";
+static const char* SHADER_EXTENSION = ".glsl";
+
+/// Bake of one shader variation for one backend.
+struct ShaderBakeJob
+{
+    ShaderVariation* variation_;
+    GraphicsBackend backend_;
+    unsigned long long key_;
+    ea::shared_array<u8> data_;
+    u32 size_;
+    String error_;
+    bool success_;
+};
+
+static void BakeShaderWork(const WorkItem* item, unsigned threadIndex)
+{
+    ShaderBakeJob* job = reinterpret_cast<ShaderBakeJob*>(item->aux_);
+    job->success_ = job->variation_->Bake(job->backend_, job->key_, job->data_, job->size_, job->error_);
+}
+
+static String GetBackendName(GraphicsBackend backend)
+{
+    switch (backend)
+    {
+    case GraphicsBackend::Vulkan:
+        return "vulkan";
+    case GraphicsBackend::OpenGL:
+        return "opengl";
+    case GraphicsBackend::OpenGLES:
+        return "gles";
+    default:
+        return "d3d";
+    }
+}
+
+ShaderCmd::ShaderCmd(Context* context) : Command(context)
+{
+
+}
+
+ShaderCmd::~ShaderCmd()
+{
+
+}
+
+// usage: shader bake [--output <file>] [--backend vulkan|opengl|gles|all] [--precache <file>]
+bool ShaderCmd::ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg)
+{
+    String argument = arguments[startIndex].ToLower();
+    String command = startIndex + 1 < arguments.Size() ? arguments[startIndex + 1].ToLower() : String::EMPTY;
+
+    if (argument != "shader" || command != "bake")
+    {
+        errorMsg = "Unable to parse shader command";
+        return false;
+    }
+
+    String backend = "all";
+
+    for (unsigned i = startIndex + 2; i < arguments.Size(); i++)
+    {
+        if (arguments[i].Length() > 1 && arguments[i][0] == '-')
+        {
+            argument = arguments[i].ToLower();
+
+            // eat additonal argument '-'
+            while (argument.StartsWith("-"))
+            {
+                argument.Erase(0);
+            }
+
+            String value = i + 1 < arguments.Size() ? arguments[i + 1] : String::EMPTY;
+
+            if (argument == "output")
+            {
+                outputPath_ = value;
+                i++;
+            }
+            else if (argument == "backend")
+            {
+                backend = value.ToLower();
+                i++;
+            }
+            else if (argument == "precache")
+            {
+                precachePath_ = value;
+                i++;
+            }
+        }
+    }
+
+    // Direct3D bytecode is created by the graphics device, so only backends that load SPIR-V or GLSL can be baked
+    if (backend == "vulkan" || backend == "all")
+        backends_.Push(GraphicsBackend::Vulkan);
+    if (backend == "opengl" || backend == "all")
+        backends_.Push(GraphicsBackend::OpenGL);
+    if (backend == "gles" || backend == "all")
+        backends_.Push(GraphicsBackend::OpenGLES);
+
+    if (backends_.Empty())
+    {
+        errorMsg = ToString("Unknown shader backend: %s", backend.CString());
+        return false;
+    }
+
+    return true;
+}
+
+void ShaderCmd::Run()
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    ToolEnvironment* env = GetSubsystem<ToolEnvironment>();
+
+    // Engine shaders, techniques and renderpaths come from CoreData
+    if (env && env->GetCoreDataDir().Length())
+        cache->AddResourceDir(env->GetCoreDataDir());
+
+    if (outputPath_.Empty())
+    {
+        Project* project = GetSubsystem<ToolSystem>()->GetProject();
+        outputPath_ = AddTrailingSlash(project->GetResourcePath()) + "Shaders/ShaderCache.rsca";
+    }
+
+    CollectResources();
+
+    String errorMsg;
+    if (!Bake(errorMsg))
+    {
+        Error(errorMsg);
+        return;
+    }
+
+    Finished();
+}
+
+void ShaderCmd::CollectResources()
+{
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    Vector<String> resourceDirs = GetSubsystem<ResourceCache>()->GetResourceDirs();
+
+    for (unsigned i = 0; i < resourceDirs.Size(); ++i)
+    {
+        String dir = AddTrailingSlash(resourceDirs[i]);
+        Vector<String> files;
+
+        fileSystem->ScanDir(files, dir + "Techniques", "*.xml", SCAN_FILES, true);
+        for (unsigned j = 0; j < files.Size(); ++j)
+            techniques_.Insert("Techniques/" + files[j]);
+
+        fileSystem->ScanDir(files, dir + "RenderPaths", "*.xml", SCAN_FILES, true);
+        for (unsigned j = 0; j < files.Size(); ++j)
+            CollectRenderPath("RenderPaths/" + files[j]);
+
+        // Materials may live anywhere in the project, so check every candidate file
+        fileSystem->ScanDir(files, dir, "*", SCAN_FILES, true);
+        for (unsigned j = 0; j < files.Size(); ++j)
+        {
+            String extension = GetExtension(files[j]);
+            if (extension == ".material" || (files[j].StartsWith("Materials/") && (extension == ".xml" || extension == ".json")))
+                CollectMaterial(files[j]);
+        }
+    }
+
+    if (precachePath_.Length())
+        CollectPrecache(precachePath_);
+}
+
+void ShaderCmd::CollectMaterial(const String& fileName)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    SharedPtr<File> file = cache->GetFile(fileName, false);
+    if (!file)
+        return;
+
+    MaterialTechnique entry;
+    Vector<String> techniques;
+
+    if (GetExtension(fileName) == ".json")
+    {
+        SharedPtr<JSONFile> json(new JSONFile(context_));
+        if (!json->Load(*file))
+            return;
+
+        const JSONValue& root = json->GetRoot();
+        const JSONValue& shaderVal = root.Get("shader");
+        if (!shaderVal.IsNull())
+        {
+            entry.vsDefines_ = shaderVal.Get("vsdefines").GetString();
+            entry.psDefines_ = shaderVal.Get("psdefines").GetString();
+        }
+
+        const JSONArray& techniqueArray = root.Get("techniques").GetArray();
+        for (unsigned i = 0; i < techniqueArray.Size(); ++i)
+            techniques.Push(techniqueArray[i].Get("name").GetString());
+    }
+    else
+    {
+        SharedPtr<XMLFile> xml(new XMLFile(context_));
+        if (!xml->Load(*file))
+            return;
+
+        XMLElement root = xml->GetRoot("material");
+        if (!root)
+            return;
+
+        XMLElement shaderElem = root.GetChild("shader");
+        if (shaderElem)
+        {
+            entry.vsDefines_ = shaderElem.GetAttribute("vsdefines");
+            entry.psDefines_ = shaderElem.GetAttribute("psdefines");
+        }
+
+        for (XMLElement techniqueElem = root.GetChild("technique"); techniqueElem; techniqueElem = techniqueElem.GetNext("technique"))
+            techniques.Push(techniqueElem.GetAttribute("name"));
+    }
+
+    for (unsigned i = 0; i < techniques.Size(); ++i)
+    {
+        if (techniques[i].Empty())
+            continue;
+
+        techniques_.Insert(techniques[i]);
+        if (entry.vsDefines_.Length() || entry.psDefines_.Length())
+        {
+            entry.technique_ = techniques[i];
+            materialTechniques_.Push(entry);
+        }
+    }
+}
+
+void ShaderCmd::CollectRenderPath(const String& fileName)
+{
+    XMLFile* xml = GetSubsystem<ResourceCache>()->GetResource<XMLFile>(fileName);
+    if (!xml)
+        return;
+
+    SharedPtr<RenderPath> renderPath(new RenderPath());
+    if (!renderPath->Load(xml))
+        return;
+
+    for (unsigned i = 0; i < renderPath->GetNumCommands(); ++i)
+    {
+        const RenderPathCommand& command = *renderPath->GetCommand(i);
+
+        CommandShaders shaders;
+        shaders.vs_ = command.vertexShaderName_;
+        shaders.vsDefines_ = command.vertexShaderDefines_.Trimmed();
+        shaders.ps_ = command.pixelShaderName_;
+        shaders.psDefines_ = command.pixelShaderDefines_.Trimmed();
+
+        switch (command.type_)
+        {
+        case CMD_SCENEPASS:
+            AddPassExtraDefines(command.pass_, shaders.vsDefines_, shaders.psDefines_);
+            break;
+
+        case CMD_FORWARDLIGHTS:
+            // The forward lights command defines apply to the lit base passes and the light pass
+            AddPassExtraDefines(command.pass_.Empty() ? "light" : command.pass_, shaders.vsDefines_, shaders.psDefines_);
+            AddPassExtraDefines("litbase", shaders.vsDefines_, shaders.psDefines_);
+            AddPassExtraDefines("litalpha", shaders.vsDefines_, shaders.psDefines_);
+            break;
+
+        case CMD_QUAD:
+            fixedShaders_.Push(shaders);
+            break;
+
+        case CMD_LIGHTVOLUMES:
+            lightVolumeShaders_.Push(shaders);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+void ShaderCmd::CollectPrecache(const String& fileName)
+{
+    SharedPtr<File> file(new File(context_, fileName));
+    SharedPtr<XMLFile> xml(new XMLFile(context_));
+    if (!file->IsOpen() || !xml->Load(*file))
+    {
+        ATOMIC_LOGERROR("Unable to load shader precache file " + fileName);
+        return;
+    }
+
+    for (XMLElement shader = xml->GetRoot().GetChild("shader"); shader; shader = shader.GetNext("shader"))
+    {
+        CommandShaders shaders;
+        shaders.vs_ = shader.GetAttribute("vs");
+        shaders.vsDefines_ = shader.GetAttribute("vsdefines");
+        shaders.ps_ = shader.GetAttribute("ps");
+        shaders.psDefines_ = shader.GetAttribute("psdefines");
+        fixedShaders_.Push(shaders);
+    }
+}
+
+void ShaderCmd::AddPassExtraDefines(const String& passName, const String& vsDefines, const String& psDefines)
+{
+    Vector<Pair<String, String> >& defines = passExtraDefines_[passName.ToLower()];
+    Pair<String, String> pair(vsDefines, psDefines);
+    if (!defines.Contains(pair))
+        defines.Push(pair);
+}
+
+void ShaderCmd::CollectVariations(GraphicsBackend backend, PODVector<ShaderVariation*>& variations)
+{
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    HashSet<ShaderVariation*> unique;
+
+    // Shadow defines of every shadow quality, with and without hardware shadow support
+    Vector<Pair<String, bool> > shadowVariations;
+    for (int quality = SHADOWQUALITY_SIMPLE_16BIT; quality <= SHADOWQUALITY_BLUR_VSM; ++quality)
+    {
+        for (unsigned hardware = 0; hardware < 2; ++hardware)
+        {
+            Pair<String, bool> variation(Renderer::GetShadowVariations((ShadowQuality)quality, backend, hardware != 0),
+                quality == SHADOWQUALITY_VSM || quality == SHADOWQUALITY_BLUR_VSM);
+            if (!shadowVariations.Contains(variation))
+                shadowVariations.Push(variation);
+        }
+    }
+
+    for (HashSet<String>::ConstIterator i = techniques_.Begin(); i != techniques_.End(); ++i)
+    {
+        Technique* technique = cache->GetResource<Technique>(*i);
+        if (technique)
+            CollectTechnique(technique, shadowVariations, unique);
+    }
+
+    for (unsigned i = 0; i < materialTechniques_.Size(); ++i)
+    {
+        const MaterialTechnique& entry = materialTechniques_[i];
+        Technique* technique = cache->GetResource<Technique>(entry.technique_);
+        if (technique)
+        {
+            SharedPtr<Technique> clone = technique->CloneWithDefines(entry.vsDefines_, entry.psDefines_);
+            CollectTechnique(clone, shadowVariations, unique);
+        }
+    }
+
+    for (unsigned i = 0; i < lightVolumeShaders_.Size(); ++i)
+    {
+        const CommandShaders& shaders = lightVolumeShaders_[i];
+        for (unsigned j = 0; j < shadowVariations.Size(); ++j)
+        {
+            Vector<String> vsDefines;
+            Vector<String> psDefines;
+            Renderer::GetLightVolumeShaderDefines(shadowVariations[j].first_, vsDefines, psDefines);
+
+            for (unsigned k = 0; k < vsDefines.Size(); ++k)
+                AddVariation(VS, shaders.vs_, vsDefines[k] + shaders.vsDefines_, unique);
+            for (unsigned k = 0; k < psDefines.Size(); ++k)
+                AddVariation(PS, shaders.ps_, psDefines[k] + shaders.psDefines_, unique);
+        }
+    }
+
+    for (unsigned i = 0; i < fixedShaders_.Size(); ++i)
+    {
+        const CommandShaders& shaders = fixedShaders_[i];
+        AddVariation(VS, shaders.vs_, shaders.vsDefines_, unique);
+        AddVariation(PS, shaders.ps_, shaders.psDefines_, unique);
+    }
+
+    variations.Clear();
+    for (HashSet<ShaderVariation*>::ConstIterator i = unique.Begin(); i != unique.End(); ++i)
+        variations.Push(*i);
+}
+
+void ShaderCmd::CollectTechnique(Technique* technique, const Vector<Pair<String, bool> >& shadowVariations, HashSet<ShaderVariation*>& variations)
+{
+    static const Vector<Pair<String, String> > noExtraDefines(1);
+
+    PODVector<Pass*> passes = technique->GetPasses();
+    for (unsigned i = 0; i < passes.Size(); ++i)
+    {
+        Pass* pass = passes[i];
+
+        // Every pass may be rendered without extra defines, for example by a renderpath that does not define any
+        HashMap<String, Vector<Pair<String, String> > >::ConstIterator extra = passExtraDefines_.Find(pass->GetName());
+        Vector<Pair<String, String> > extraDefines = noExtraDefines;
+        if (extra != passExtraDefines_.End())
+        {
+            for (unsigned j = 0; j < extra->second_.Size(); ++j)
+            {
+                if (!extraDefines.Contains(extra->second_[j]))
+                    extraDefines.Push(extra->second_[j]);
+            }
+        }
+
+        // Only per-pixel lit passes and the shadow pass depend on the shadow quality
+        bool shadowDependent = pass->GetLightingMode() == LIGHTING_PERPIXEL || pass->GetName() == "shadow";
+        unsigned numShadowVariations = shadowDependent ? shadowVariations.Size() : 1;
+
+        for (unsigned j = 0; j < extraDefines.Size(); ++j)
+        {
+            for (unsigned k = 0; k < numShadowVariations; ++k)
+            {
+                Vector<String> vsDefines;
+                Vector<String> psDefines;
+                Renderer::GetPassShaderDefines(pass, extraDefines[j].first_, extraDefines[j].second_,
+                    shadowVariations[k].first_, shadowVariations[k].second_, vsDefines, psDefines);
+
+                for (unsigned l = 0; l < vsDefines.Size(); ++l)
+                    AddVariation(VS, pass->GetVertexShader(), vsDefines[l], variations);
+                for (unsigned l = 0; l < psDefines.Size(); ++l)
+                    AddVariation(PS, pass->GetPixelShader(), psDefines[l], variations);
+            }
+        }
+    }
+}
+
+void ShaderCmd::AddVariation(ShaderType type, const String& name, const String& defines, HashSet<ShaderVariation*>& variations)
+{
+    if (name.Empty())
+        return;
+
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Shader* shader = cache->GetResource<Shader>(SHADER_PATH + name + SHADER_EXTENSION);
+    if (shader)
+        variations.Insert(shader->GetVariation(type, defines));
+}
+
+bool ShaderCmd::Bake(String& errorMsg)
+{
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    HiresTimer timer;
+
+    // Variations are created on the main thread, as creating them touches the resource cache
+    Vector<ShaderBakeJob> jobs;
+    for (unsigned i = 0; i < backends_.Size(); ++i)
+    {
+        PODVector<ShaderVariation*> variations;
+        CollectVariations(backends_[i], variations);
+        ATOMIC_LOGRAWF("Baking %u shader variations for %s\n", variations.Size(), GetBackendName(backends_[i]).CString());
+
+        for (unsigned j = 0; j < variations.Size(); ++j)
+        {
+            ShaderBakeJob job;
+            job.variation_ = variations[j];
+            job.backend_ = backends_[i];
+            job.key_ = 0;
+            job.size_ = 0;
+            job.success_ = false;
+            jobs.Push(job);
+        }
+    }
+
+    // The jobs must not move while the work items refer to them
+    for (unsigned i = 0; i < jobs.Size(); ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = BakeShaderWork;
+        item->aux_ = &jobs[i];
+        queue->AddWorkItem(item);
+    }
+    queue->Complete(M_MAX_UNSIGNED);
+
+    SharedPtr<ShaderCacheArchive> archive(new ShaderCacheArchive());
+    unsigned numFailed = 0;
+    for (unsigned i = 0; i < jobs.Size(); ++i)
+    {
+        const ShaderBakeJob& job = jobs[i];
+        if (job.success_)
+            archive->AddEntry(job.key_, job.data_.get(), job.size_);
+        else
+        {
+            ++numFailed;
+            ATOMIC_LOGRAWF("Failed to bake %s for %s: %s\n", job.variation_->GetFullName().CString(),
+                GetBackendName(job.backend_).CString(), job.error_.CString());
+        }
+    }
+
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    String path = GetPath(outputPath_);
+    if (path.Length() && !fileSystem->DirExists(path))
+        fileSystem->CreateDirsRecursive(path);
+
+    SharedPtr<File> file(new File(context_, outputPath_, FILE_WRITE));
+    if (!file->IsOpen() || !archive->Save(*file))
+    {
+        errorMsg = ToString("Unable to write shader cache archive: %s", outputPath_.CString());
+        return false;
+    }
+
+    ATOMIC_LOGRAWF("Baked %u shaders (%u failed) into %s in %.2f s\n", archive->GetNumEntries(), numFailed,
+        outputPath_.CString(), timer.GetUSec(false) / 1000000.0f);
+
+    if (numFailed)
+    {
+        errorMsg = ToString("%u shader variations failed to bake", numFailed);
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2014-2017 THUNDERBEAST GAMES LLC
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <EngineCore/Container/HashMap.h>
+#include <EngineCore/Container/HashSet.h>
+#include <EngineCore/Graphics/GraphicsDefs.h>
+
+#include "Command.h"
+
+using namespace Atomic;
+
+namespace Atomic
+{
+class ShaderVariation;
+class Technique;
+}
+
+namespace ToolCore
+{
+
+/// Command for baking all shader variations a project can use into a shader cache archive
+class ShaderCmd: public Command
+{
+
+    /// Example usage:
+    /// AtomicTool shader bake --project C:\Path\To\MyProject
+    /// AtomicTool shader bake --backend vulkan --output C:\Path\To\ShaderCache.rsca --precache C:\Path\To\Shaders.xml
+
+    ATOMIC_OBJECT(ShaderCmd, Command)
+
+public:
+
+    ShaderCmd(Context* context);
+    virtual ~ShaderCmd();
+
+    void Run();
+
+    bool RequiresProjectLoad() { return true; }
+
+protected:
+
+    bool ParseInternal(const Vector<String>& arguments, unsigned startIndex, String& errorMsg);
+
+private:
+
+    /// Shader names and defines used by a renderpath command or the precache file.
+    struct CommandShaders
+    {
+        String vs_;
+        String vsDefines_;
+        String ps_;
+        String psDefines_;
+    };
+
+    /// Technique of a material with the material's shader defines.
+    struct MaterialTechnique
+    {
+        String technique_;
+        String vsDefines_;
+        String psDefines_;
+    };
+
+    void CollectResources();
+    void CollectMaterial(const String& fileName);
+    void CollectRenderPath(const String& fileName);
+    void CollectPrecache(const String& fileName);
+    void AddPassExtraDefines(const String& passName, const String& vsDefines, const String& psDefines);
+
+    void CollectVariations(GraphicsBackend backend, PODVector<ShaderVariation*>& variations);
+    void CollectTechnique(Technique* technique, const Vector<Pair<String, bool> >& shadowVariations, HashSet<ShaderVariation*>& variations);
+    void AddVariation(ShaderType type, const String& name, const String& defines, HashSet<ShaderVariation*>& variations);
+
+    bool Bake(String& errorMsg);
+
+    String outputPath_;
+    String precachePath_;
+    PODVector<GraphicsBackend> backends_;
+
+    /// Technique resource names.
+    HashSet<String> techniques_;
+    /// Material techniques with shader defines.
+    Vector<MaterialTechnique> materialTechniques_;
+    /// Extra defines from renderpath commands by pass name, as vertex/pixel define pairs.
+    HashMap<String, Vector<Pair<String, String> > > passExtraDefines_;
+    /// Quad and precached shaders.
+    Vector<CommandShaders> fixedShaders_;
+    /// Light volume shaders.
+    Vector<CommandShaders> lightVolumeShaders_;
+
+};
+
+}
@@ -98,13 +98,8 @@ void JSFunctionWriter::WriteParameterMarshal(String& source)
                         source.AppendWithFormat("if (duk_get_top(ctx) >= %i) {\n", cparam + 1);
                     }
 
-                    for (int j = 0; j < elements; j++)
-                    {
-                        source.AppendWithFormat("duk_get_prop_index(ctx, %i, %i);\n", cparam, j);
-                        source.AppendWithFormat("arrayData%i[%i] = (%s) duk_to_number(ctx, -1);\n", cparam, j, elementType.CString());
-                    }
-
-                    source.AppendWithFormat("duk_pop_n(ctx, %i);\n", elements);
+                    // reads typed arrays directly, and plain arrays by index
+                    source.AppendWithFormat("js_to_number_array(ctx, %i, arrayData%i, %i);\n", cparam, cparam, elements);
 
                     if (init.Length())
                     {
@@ -525,12 +520,7 @@ void JSFunctionWriter::WriteFunction(String& source)
                 returnDeclared = true;
                 String elementType = klassType->class_->GetArrayElementType();
                 source.AppendWithFormat("const %s* arrayData = retValue.Data();\n", elementType.CString());
-                source.Append("duk_push_array(ctx);\n");
-                for (int i = 0; i < klassType->class_->GetNumberArrayElements(); i++)
-                {
-                    source.AppendWithFormat("duk_push_number(ctx, arrayData[%i]);\n", i);
-                    source.AppendWithFormat("duk_put_prop_index(ctx, -2, %i);\n", i);
-                }
+                source.AppendWithFormat("js_push_number_array(ctx, arrayData, %i);\n", klassType->class_->GetNumberArrayElements());
             }
             else
             {
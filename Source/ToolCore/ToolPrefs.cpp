@@ -37,7 +37,8 @@ ToolPrefs::ToolPrefs(Context* context) : Object(context),
     antPath_(),
     releasePath_(),
     releaseCheck_(0),
-    ndkPath_()
+    ndkPath_(),
+    importCachePath_()
 {
 
 }
@@ -105,6 +106,11 @@ void ToolPrefs::Load()
         ndkPath_ = androidRoot.Get("ndkPath").GetString();
     }
 
+    JSONValue importCacheRoot = root.Get("importCache");
+
+    if (importCacheRoot.IsObject())
+        importCachePath_ = importCacheRoot.Get("path").GetString();
+
 }
 
 void ToolPrefs::Save()
@@ -124,6 +130,10 @@ void ToolPrefs::Save()
     androidRoot["ndkPath"] = ndkPath_;
     root["android"] = androidRoot;
 
+    JSONValue importCacheRoot;
+    importCacheRoot["path"] = importCachePath_;
+    root["importCache"] = importCacheRoot;
+
     SharedPtr<File> file(new File(context_, path, FILE_WRITE));
     jsonFile->Save(*file, "   ");
     file->Close();
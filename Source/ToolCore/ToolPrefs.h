@@ -44,6 +44,8 @@ public:
     const String& GetReleasePath() { return releasePath_; }
     const int GetReleaseCheck() { return releaseCheck_; }
     const String& GetNdkPath() { return ndkPath_; }
+    /// Shared import cache directory, empty if disabled
+    const String& GetImportCachePath() { return importCachePath_; }
 
     void SetAndroidSDKPath(const String& path) { androidSDKPath_ = path; }
     void SetJDKRootPath(const String& path) { jdkRootPath_ = path; }
@@ -51,6 +53,7 @@ public:
     void SetReleasePath(const String& path) { releasePath_ = path; }
     void SetReleaseCheck(const int value) { releaseCheck_ = value; }
     void SetNdkPath(const String& path) { ndkPath_ = path; }
+    void SetImportCachePath(const String& path) { importCachePath_ = path; }
 
     String GetPrefsPath();
     void Load();
@@ -64,6 +67,7 @@ private:
     String releasePath_;
     int releaseCheck_;
     String ndkPath_;
+    String importCachePath_;
 };
 
 }
@@ -0,0 +1,220 @@
+#include <EngineCore/Container/Allocator.h>
+#include <EngineCore/Container/Sort.h>
+#include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Graphics/Batch.h>
+#include <EngineCore/Math/Random.h>
+
+using namespace Atomic;
+
+/// Number of batches in each benchmarked queue.
+static const unsigned queueSizes[] = { 100, 1000, 5000, 20000, 100000 };
+
+/// Number of distinct render states the batches are drawn from.
+static const unsigned NUM_STATES = 256;
+
+/// Comparison sort of the state sort, as used before the radix sort.
+static bool CompareBatchesState(Batch* lhs, Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->sortKey_ != rhs->sortKey_)
+        return lhs->sortKey_ < rhs->sortKey_;
+    else
+        return lhs->distance_ < rhs->distance_;
+}
+
+/// Comparison sort of the front to back sort, as used before the radix sort.
+static bool CompareBatchesFrontToBack(Batch* lhs, Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ < rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+/// Comparison sort of the back to front sort, as used before the radix sort.
+static bool CompareBatchesBackToFront(Batch* lhs, Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ > rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+/// Desktop two-pass sort with comparison sorts, as BatchQueue::SortFrontToBack2Pass did before the radix sort.
+static void ComparisonSortFrontToBack2Pass(BatchQueue& queue, PODVector<Batch*>& batches)
+{
+    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+    Sort(batches.Begin(), batches.End(), CompareBatchesFrontToBack);
+
+    unsigned freeShaderID = 0;
+    unsigned short freeMaterialID = 0;
+    unsigned short freeGeometryID = 0;
+
+    for (PODVector<Batch*>::Iterator i = batches.Begin(); i != batches.End(); ++i)
+    {
+        Batch* batch = *i;
+
+        unsigned shaderID = (unsigned)(batch->sortKey_ >> 32);
+        HashMap<unsigned, unsigned>::ConstIterator j = queue.shaderRemapping_.Find(shaderID);
+        if (j != queue.shaderRemapping_.End())
+            shaderID = j->second_;
+        else
+        {
+            shaderID = queue.shaderRemapping_[shaderID] = freeShaderID | (shaderID & 0x80000000);
+            ++freeShaderID;
+        }
+
+        unsigned short materialID = (unsigned short)(batch->sortKey_ >> 16);
+        HashMap<unsigned short, unsigned short>::ConstIterator k = queue.materialRemapping_.Find(materialID);
+        if (k != queue.materialRemapping_.End())
+            materialID = k->second_;
+        else
+        {
+            materialID = queue.materialRemapping_[materialID] = freeMaterialID;
+            ++freeMaterialID;
+        }
+
+        unsigned short geometryID = (unsigned short)(batch->sortKey_ & 0xffff);
+        HashMap<unsigned short, unsigned short>::ConstIterator l = queue.geometryRemapping_.Find(geometryID);
+        if (l != queue.geometryRemapping_.End())
+            geometryID = l->second_;
+        else
+        {
+            geometryID = queue.geometryRemapping_[geometryID] = freeGeometryID;
+            ++freeGeometryID;
+        }
+
+        batch->sortKey_ = (((unsigned long long)shaderID) << 32) | (((unsigned long long)materialID) << 16) | geometryID;
+    }
+
+    queue.shaderRemapping_.Clear();
+    queue.materialRemapping_.Clear();
+    queue.geometryRemapping_.Clear();
+
+    Sort(batches.Begin(), batches.End(), CompareBatchesState);
+}
+
+/// Fill a queue with batches of random state, render order and distance. Return their state sort keys.
+static PODVector<unsigned long long> FillQueue(BatchQueue& queue, unsigned count)
+{
+    PODVector<unsigned long long> states(NUM_STATES);
+    for (unsigned i = 0; i < NUM_STATES; ++i)
+    {
+        unsigned shaderID = (unsigned)Rand() & 0xffff;
+        unsigned lightQueueID = (unsigned)Rand() & 0xff;
+        unsigned materialID = (unsigned)Rand() & 0xffff;
+        unsigned geometryID = (unsigned)Rand() & 0xffff;
+        states[i] = (((unsigned long long)shaderID) << 48) | (((unsigned long long)lightQueueID) << 32) |
+                    (((unsigned long long)materialID) << 16) | geometryID;
+    }
+
+    queue.Clear(0);
+    queue.batches_.Resize(count);
+    PODVector<unsigned long long> keys(count);
+    for (unsigned i = 0; i < count; ++i)
+    {
+        Batch& batch = queue.batches_[i];
+        batch.sortKey_ = keys[i] = states[(unsigned)Rand() % NUM_STATES];
+        batch.distance_ = (float)i * 0.01f;
+        batch.renderOrder_ = (unsigned char)(DEFAULT_RENDER_ORDER + Rand() % 3 - 1);
+    }
+
+    // Shuffle the distances, which are unique so that the order of the sorts is fully defined
+    for (unsigned i = count - 1; i > 0; --i)
+    {
+        unsigned j = (((unsigned)Rand() << 15) | (unsigned)Rand()) % (i + 1);
+        Swap(queue.batches_[i].distance_, queue.batches_[j].distance_);
+    }
+
+    return keys;
+}
+
+/// Restore the state sort keys rewritten by the two-pass sort.
+static void RestoreKeys(BatchQueue& queue, const PODVector<unsigned long long>& keys)
+{
+    for (unsigned i = 0; i < keys.Size(); ++i)
+        queue.batches_[i].sortKey_ = keys[i];
+}
+
+/// Return the time of a sort in microseconds, the best of a number of runs.
+template <class T> static long long TimeSort(unsigned runs, T sort)
+{
+    long long best = M_MAX_INT;
+    for (unsigned i = 0; i < runs; ++i)
+    {
+        HiresTimer timer;
+        sort();
+        best = Min(best, timer.GetUSec(false));
+        FrameArenaReset();
+    }
+    return best;
+}
+
+/// Time per queue of the batch queue radix sorts against the comparison sorts they replaced, for the desktop two-pass
+/// front to back sort and the back to front sort. Also checks that both produce the same order.
+int main(int argc, char** argv)
+{
+    SetRandomSeed(1);
+
+    int numMismatches = 0;
+    for (unsigned i = 0; i < sizeof(queueSizes) / sizeof(queueSizes[0]); ++i)
+    {
+        unsigned count = queueSizes[i];
+        unsigned runs = Max(1000000 / count, 5U);
+
+        BatchQueue queue;
+        PODVector<unsigned long long> keys = FillQueue(queue, count);
+        PODVector<Batch*> expected;
+        PODVector<Batch*> batches;
+
+        long long frontToBackComparison = TimeSort(runs, [&]()
+        {
+            RestoreKeys(queue, keys);
+            batches.Resize(count);
+            for (unsigned j = 0; j < count; ++j)
+                batches[j] = &queue.batches_[j];
+            ComparisonSortFrontToBack2Pass(queue, batches);
+        });
+        expected = batches;
+
+        long long frontToBackRadix = TimeSort(runs, [&]()
+        {
+            RestoreKeys(queue, keys);
+            queue.SortFrontToBack(GraphicsBackend::Vulkan);
+        });
+        if (queue.sortedBatches_ != expected)
+            ++numMismatches;
+
+        RestoreKeys(queue, keys);
+        long long backToFrontComparison = TimeSort(runs, [&]()
+        {
+            batches.Resize(count);
+            for (unsigned j = 0; j < count; ++j)
+                batches[j] = &queue.batches_[j];
+            Sort(batches.Begin(), batches.End(), CompareBatchesBackToFront);
+        });
+        expected = batches;
+
+        long long backToFrontRadix = TimeSort(runs, [&]()
+        {
+            queue.SortBackToFront();
+        });
+        if (queue.sortedBatches_ != expected)
+            ++numMismatches;
+
+        PrintLine(ToString("%7u batches  front to back: comparison %8lld us, radix %8lld us  back to front: comparison %8lld us, "
+            "radix %8lld us", count, frontToBackComparison, frontToBackRadix, backToFrontComparison, backToFrontRadix));
+    }
+
+    if (numMismatches)
+        PrintLine(ToString("%d sorts produced a different order than the comparison sorts", numMismatches), true);
+
+    return numMismatches;
+}
@@ -0,0 +1,304 @@
+#ifdef ENGINE_DATABASE_SQLITE
+
+#include <EngineCore/Database/Database.h>
+#include <EngineCore/Database/DatabaseEvents.h>
+#include <EngineCore/Database/DbConnection.h>
+
+#include <sqlite3.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+/// Collects the asynchronous query completion events of a connection.
+class DbQueryListener : public Object
+{
+    ATOMIC_OBJECT(DbQueryListener, Object);
+
+public:
+    /// Construct.
+    DbQueryListener(Context* context, DbConnection* connection) :
+        Object(context),
+        connection_(connection),
+        followUpID_(0)
+    {
+        SubscribeToEvent(connection, E_DBQUERYCOMPLETED, ATOMIC_HANDLER(DbQueryListener, HandleQueryCompleted));
+    }
+
+    /// Connection.
+    DbConnection* connection_;
+    /// Query IDs in the order their events were received.
+    PODVector<unsigned> queryIDs_;
+    /// Success flag of each event.
+    PODVector<bool> successes_;
+    /// Rows of each event.
+    Vector<VariantVector> rows_;
+    /// Statement to queue on the connection from the next event, or empty.
+    String followUpSql_;
+    /// ID of the statement queued from an event.
+    unsigned followUpID_;
+
+private:
+    /// Record a completion event.
+    void HandleQueryCompleted(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace DbQueryCompleted;
+
+        queryIDs_.Push(eventData[P_QUERYID].GetUInt());
+        successes_.Push(eventData[P_SUCCESS].GetBool());
+        rows_.Push(eventData[P_ROWS].GetVariantVector());
+
+        if (!followUpSql_.Empty())
+        {
+            followUpID_ = GetSubsystem<Database>()->ExecuteAsync(connection_, followUpSql_);
+            followUpSql_.Clear();
+        }
+    }
+};
+
+/// Return whether the connection holds a prepared statement of an SQL text. Statements not in use are only kept by the
+/// statement cache.
+static bool HasPreparedStatement(DbConnection* connection, const char* sql)
+{
+    sqlite3* db = const_cast<sqlite3*>(connection->GetConnectionImpl());
+    for (sqlite3_stmt* stmt = sqlite3_next_stmt(db, 0); stmt; stmt = sqlite3_next_stmt(db, stmt))
+    {
+        if (!strcmp(sqlite3_sql(stmt), sql))
+            return true;
+    }
+    return false;
+}
+
+/// Return number of rows in the test table.
+static int CountRows(DbConnection* connection)
+{
+    DbResult result = connection->Execute("SELECT COUNT(*) FROM items");
+    return result.GetNumRows() ? result.GetRows()[0][0].GetInt() : -1;
+}
+
+/// Connect to a new in-memory database with a test table.
+static DbConnection* ConnectTestDatabase(Context* context)
+{
+    DbConnection* connection = context->GetSubsystem<Database>()->Connect(":memory:");
+    if (connection && !connection->Execute("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT NOT NULL, data BLOB)").IsSuccess())
+        return 0;
+    return connection;
+}
+
+bool TestDatabaseStatementCache(Context* context)
+{
+    Database* database = context->GetSubsystem<Database>();
+    DbConnection* connection = ConnectTestDatabase(context);
+    ENGINE_TEST_CHECK(connection);
+
+    const char* insertSql = "INSERT INTO items (id, name) VALUES (?, ?)";
+    const char* selectSql = "SELECT name FROM items WHERE id = ?";
+    const char* countSql = "SELECT COUNT(*) FROM items";
+    const char* maxSql = "SELECT MAX(id) FROM items";
+
+    connection->SetStatementCacheSize(2);
+
+    // A cached statement is reused with new parameters
+    for (int i = 1; i <= 10; ++i)
+    {
+        VariantVector params;
+        params.Push(i);
+        params.Push("item" + String(i));
+        ENGINE_TEST_CHECK(connection->Execute(insertSql, params).GetNumAffectedRows() == 1);
+    }
+    ENGINE_TEST_CHECK(HasPreparedStatement(connection, insertSql));
+
+    VariantVector params;
+    params.Push(7);
+    DbResult result = connection->Execute(selectSql, params);
+    ENGINE_TEST_CHECK(result.GetNumRows() == 1);
+    ENGINE_TEST_CHECK(result.GetRows()[0][0].GetString() == "item7");
+
+    // Using the insert statement again makes the select the least recently used, so it is evicted next
+    params.Push("item11");
+    params[0] = 11;
+    ENGINE_TEST_CHECK(connection->Execute(insertSql, params).IsSuccess());
+    ENGINE_TEST_CHECK(connection->Execute(countSql).IsSuccess());
+    ENGINE_TEST_CHECK(connection->GetNumCachedStatements() == 2);
+    ENGINE_TEST_CHECK(HasPreparedStatement(connection, insertSql));
+    ENGINE_TEST_CHECK(HasPreparedStatement(connection, countSql));
+    ENGINE_TEST_CHECK(!HasPreparedStatement(connection, selectSql));
+
+    ENGINE_TEST_CHECK(connection->Execute(maxSql).GetRows()[0][0].GetInt() == 11);
+    ENGINE_TEST_CHECK(HasPreparedStatement(connection, maxSql));
+    ENGINE_TEST_CHECK(!HasPreparedStatement(connection, insertSql));
+
+    // A wrong parameter count fails without losing the statement
+    params.Resize(1);
+    ENGINE_TEST_CHECK(!connection->Execute(maxSql, params).IsSuccess());
+    ENGINE_TEST_CHECK(HasPreparedStatement(connection, maxSql));
+
+    connection->SetStatementCacheSize(0);
+    ENGINE_TEST_CHECK(connection->GetNumCachedStatements() == 0);
+
+    database->Disconnect(connection);
+    return true;
+}
+
+bool TestDatabaseCursor(Context* context)
+{
+    Database* database = context->GetSubsystem<Database>();
+    DbConnection* connection = ConnectTestDatabase(context);
+    ENGINE_TEST_CHECK(connection);
+
+    Vector<VariantVector> paramSets;
+    for (int i = 0; i < 100; ++i)
+    {
+        VariantVector params;
+        params.Push(i);
+        params.Push("item" + String(i));
+        PODVector<unsigned char> data(3);
+        data[0] = (unsigned char)i;
+        data[1] = 0;
+        data[2] = 255;
+        params.Push(data);
+        paramSets.Push(params);
+    }
+    ENGINE_TEST_CHECK(connection->ExecuteBatch("INSERT INTO items (id, name, data) VALUES (?, ?, ?)", paramSets).GetNumAffectedRows() == 100);
+
+    const char* selectSql = "SELECT id, name, data FROM items WHERE id >= ? ORDER BY id";
+    VariantVector params;
+    params.Push(40);
+    SharedPtr<DbRowCursor> cursor = connection->OpenCursor(selectSql, params);
+    ENGINE_TEST_CHECK(cursor);
+    ENGINE_TEST_CHECK(cursor->GetNumColumns() == 3);
+    ENGINE_TEST_CHECK(cursor->GetColumns()[1] == "name");
+
+    // A query of the same SQL text while the cursor is open must not disturb it
+    params[0] = 90;
+    ENGINE_TEST_CHECK(connection->Execute(selectSql, params).GetNumRows() == 10);
+
+    int expected = 40;
+    while (cursor->Next())
+    {
+        ENGINE_TEST_CHECK(cursor->GetInt(0) == expected);
+        ENGINE_TEST_CHECK(cursor->GetString(1) == "item" + String(expected));
+        Variant value = cursor->GetValue(2);
+        const PODVector<unsigned char>& data = value.GetBuffer();
+        ENGINE_TEST_CHECK(data.Size() == 3 && data[0] == expected && data[1] == 0 && data[2] == 255);
+        ++expected;
+    }
+    ENGINE_TEST_CHECK(expected == 100);
+
+    cursor->Close();
+    ENGINE_TEST_CHECK(!cursor->IsOpen());
+    ENGINE_TEST_CHECK(!cursor->Next());
+
+    // An invalid statement gives no cursor
+    ENGINE_TEST_CHECK(!connection->OpenCursor("SELECT missing FROM items"));
+
+    cursor.Reset();
+    database->Disconnect(connection);
+    return true;
+}
+
+bool TestDatabaseRollback(Context* context)
+{
+    Database* database = context->GetSubsystem<Database>();
+    DbConnection* connection = ConnectTestDatabase(context);
+    ENGINE_TEST_CHECK(connection);
+
+    const char* insertSql = "INSERT INTO items (id, name) VALUES (?, ?)";
+    VariantVector params;
+    params.Push(1);
+    params.Push("first");
+    ENGINE_TEST_CHECK(connection->Execute(insertSql, params).IsSuccess());
+
+    // An explicit transaction is rolled back
+    ENGINE_TEST_CHECK(connection->BeginTransaction());
+    ENGINE_TEST_CHECK(connection->IsInTransaction());
+    params[0] = 2;
+    ENGINE_TEST_CHECK(connection->Execute(insertSql, params).IsSuccess());
+    ENGINE_TEST_CHECK(CountRows(connection) == 2);
+    ENGINE_TEST_CHECK(connection->RollbackTransaction());
+    ENGINE_TEST_CHECK(!connection->IsInTransaction());
+    ENGINE_TEST_CHECK(CountRows(connection) == 1);
+
+    // A failing batch rolls back its own transaction, here on the NOT NULL constraint of the third set
+    Vector<VariantVector> paramSets;
+    for (int i = 10; i < 13; ++i)
+    {
+        VariantVector setParams;
+        setParams.Push(i);
+        setParams.Push(i == 12 ? Variant() : Variant("batch"));
+        paramSets.Push(setParams);
+    }
+    ENGINE_TEST_CHECK(!connection->ExecuteBatch(insertSql, paramSets).IsSuccess());
+    ENGINE_TEST_CHECK(!connection->IsInTransaction());
+    ENGINE_TEST_CHECK(CountRows(connection) == 1);
+
+    // Within the caller's transaction a failing batch leaves the rollback to the caller
+    ENGINE_TEST_CHECK(connection->BeginTransaction());
+    ENGINE_TEST_CHECK(!connection->ExecuteBatch(insertSql, paramSets).IsSuccess());
+    ENGINE_TEST_CHECK(connection->IsInTransaction());
+    ENGINE_TEST_CHECK(connection->RollbackTransaction());
+    ENGINE_TEST_CHECK(CountRows(connection) == 1);
+
+    paramSets.Pop();
+    ENGINE_TEST_CHECK(connection->ExecuteBatch(insertSql, paramSets).GetNumAffectedRows() == 2);
+    ENGINE_TEST_CHECK(CountRows(connection) == 3);
+
+    database->Disconnect(connection);
+    return true;
+}
+
+bool TestDatabaseAsync(Context* context)
+{
+    Database* database = context->GetSubsystem<Database>();
+    DbConnection* connection = ConnectTestDatabase(context);
+    ENGINE_TEST_CHECK(connection);
+
+    SharedPtr<DbQueryListener> listener(new DbQueryListener(context, connection));
+
+    PODVector<unsigned> queryIDs;
+    for (int i = 0; i < 20; ++i)
+    {
+        VariantVector params;
+        params.Push(i);
+        params.Push("async" + String(i));
+        queryIDs.Push(database->ExecuteAsync(connection, "INSERT INTO items (id, name) VALUES (?, ?)", params));
+    }
+    queryIDs.Push(database->ExecuteAsync(connection, "SELECT COUNT(*) FROM items"));
+    ENGINE_TEST_CHECK(database->GetNumPendingQueries() == 21);
+
+    // Completion events are sent on the frame after the queries have finished, in the order the queries were queued. The
+    // first handler queues another query on the same connection while the events are being sent
+    listener->followUpSql_ = "SELECT name FROM items WHERE id = 19";
+    for (unsigned frame = 0; frame < 10000 && database->GetNumPendingQueries(); ++frame)
+        RunFrame(context);
+
+    ENGINE_TEST_CHECK(!database->GetNumPendingQueries());
+    ENGINE_TEST_CHECK(listener->followUpID_);
+    ENGINE_TEST_CHECK(listener->queryIDs_.Size() == 22);
+    for (unsigned i = 0; i < queryIDs.Size(); ++i)
+    {
+        ENGINE_TEST_CHECK(listener->queryIDs_[i] == queryIDs[i]);
+        ENGINE_TEST_CHECK(listener->successes_[i]);
+    }
+    ENGINE_TEST_CHECK(listener->rows_[20].Size() == 1);
+    ENGINE_TEST_CHECK(listener->rows_[20][0].GetVariantVector()[0].GetInt() == 20);
+    ENGINE_TEST_CHECK(listener->queryIDs_[21] == listener->followUpID_);
+    ENGINE_TEST_CHECK(listener->rows_[21][0].GetVariantVector()[0].GetString() == "async19");
+
+    // A failing query reports failure, and waiting sends the events without running a frame
+    unsigned failedID = database->ExecuteAsync(connection, "INSERT INTO missing VALUES (1)");
+    ENGINE_TEST_CHECK(failedID);
+    database->WaitForQueries(connection);
+    ENGINE_TEST_CHECK(!database->GetNumPendingQueries());
+    ENGINE_TEST_CHECK(listener->queryIDs_.Back() == failedID);
+    ENGINE_TEST_CHECK(!listener->successes_.Back());
+
+    listener.Reset();
+    database->Disconnect(connection);
+    return true;
+}
+
+}
+
+#endif
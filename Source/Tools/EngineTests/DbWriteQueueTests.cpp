@@ -0,0 +1,248 @@
+#ifdef ENGINE_DATABASE_SQLITE
+
+#include <EngineCore/Database/Database.h>
+#include <EngineCore/Database/DatabaseEvents.h>
+#include <EngineCore/Database/DbConnection.h>
+#include <EngineCore/Database/DbWriteQueue.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+static const char* WRITE_SQL = "INSERT OR REPLACE INTO entities (id, name) VALUES (?, ?)";
+
+/// Collects the keys of writes given up by a write queue.
+class DbWriteFailedListener : public Object
+{
+    ATOMIC_OBJECT(DbWriteFailedListener, Object);
+
+public:
+    /// Construct.
+    DbWriteFailedListener(Context* context, DbWriteQueue* queue) :
+        Object(context)
+    {
+        SubscribeToEvent(queue, E_DBWRITEFAILED, ATOMIC_HANDLER(DbWriteFailedListener, HandleWriteFailed));
+    }
+
+    /// Keys of the failed writes.
+    StringVector keys_;
+
+private:
+    /// Record a failed write.
+    void HandleWriteFailed(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace DbWriteFailed;
+
+        keys_.Push(eventData[P_KEY].GetString());
+    }
+};
+
+/// Return a file name in the working directory, after deleting the file and the files of a journal by that name.
+static String GetTestFileName(Context* context, const String& name)
+{
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+    String fileName = fileSystem->GetCurrentDir() + name;
+    fileSystem->Delete(fileName);
+    fileSystem->Delete(fileName + ".flushing");
+    fileSystem->Delete(fileName + ".tmp");
+    fileSystem->Delete(fileName + ".failed");
+    return fileName;
+}
+
+/// Create the test table on a connection.
+static bool CreateEntityTable(DbConnection* connection)
+{
+    return connection->Execute("CREATE TABLE IF NOT EXISTS entities (id INTEGER PRIMARY KEY, name TEXT NOT NULL)").IsSuccess();
+}
+
+/// Queue a write of an entity row. A null name fails the NOT NULL constraint when flushed.
+static void WriteEntity(DbWriteQueue* queue, int id, const Variant& name)
+{
+    VariantVector params;
+    params.Push(id);
+    params.Push(name);
+    queue->Write(WRITE_SQL, String(id), params);
+}
+
+/// Return the name of an entity row, or "<missing>" if there is none.
+static String GetEntityName(DbConnection* connection, int id)
+{
+    VariantVector params;
+    params.Push(id);
+    DbResult result = connection->Execute("SELECT name FROM entities WHERE id = ?", params);
+    return result.GetNumRows() ? result.GetRows()[0][0].GetString() : String("<missing>");
+}
+
+bool TestDbWriteQueueCoalescing(Context* context)
+{
+    String journalName = GetTestFileName(context, "EngineTestsCoalescing.journal");
+
+    SharedPtr<DbWriteQueue> queue(new DbWriteQueue(context));
+    ENGINE_TEST_CHECK(queue->Open(":memory:", journalName));
+    ENGINE_TEST_CHECK(CreateEntityTable(queue->GetConnection()));
+    queue->SetFlushInterval(M_INFINITY);
+
+    // Only the latest write of each row is flushed, in the order the rows were last written
+    WriteEntity(queue, 1, "a");
+    WriteEntity(queue, 2, "b");
+    WriteEntity(queue, 1, "c");
+    WriteEntity(queue, 3, "d");
+    WriteEntity(queue, 1, "e");
+    ENGINE_TEST_CHECK(queue->GetNumPendingWrites() == 3);
+    ENGINE_TEST_CHECK(queue->GetStats().numWrites_ == 5);
+    ENGINE_TEST_CHECK(queue->GetStats().numCoalesced_ == 2);
+
+    // Nothing is flushed before the interval
+    RunFrame(context);
+    ENGINE_TEST_CHECK(!queue->IsFlushing());
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 1) == "<missing>");
+
+    ENGINE_TEST_CHECK(queue->FlushAndWait());
+    ENGINE_TEST_CHECK(queue->GetNumPendingWrites() == 0);
+    ENGINE_TEST_CHECK(queue->GetStats().numFlushes_ == 1);
+    ENGINE_TEST_CHECK(queue->GetStats().numFlushedWrites_ == 3);
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 1) == "e");
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 2) == "b");
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 3) == "d");
+
+    // Reaching the pending write limit starts a flush
+    queue->SetMaxPendingWrites(2);
+    WriteEntity(queue, 4, "f");
+    ENGINE_TEST_CHECK(!queue->IsFlushing());
+    WriteEntity(queue, 5, "g");
+    ENGINE_TEST_CHECK(queue->IsFlushing());
+    ENGINE_TEST_CHECK(queue->FlushAndWait());
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 5) == "g");
+
+    queue->Close();
+    ENGINE_TEST_CHECK(!context->GetSubsystem<FileSystem>()->FileExists(journalName));
+    return true;
+}
+
+bool TestDbWriteQueueJournalReplay(Context* context)
+{
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+    Database* database = context->GetSubsystem<Database>();
+
+    String databaseName = GetTestFileName(context, "EngineTestsReplay.db");
+    String journalName = GetTestFileName(context, "EngineTestsReplay.journal");
+    String firstName = GetTestFileName(context, "EngineTestsReplayFirst.journal");
+    String secondName = GetTestFileName(context, "EngineTestsReplaySecond.journal");
+
+    // Simulate a crash during a flush by taking the journals of two queues as they are on disk after a frame: the journal
+    // of the unfinished flush, and the journal of the writes queued after it
+    {
+        SharedPtr<DbWriteQueue> first(new DbWriteQueue(context));
+        SharedPtr<DbWriteQueue> second(new DbWriteQueue(context));
+        ENGINE_TEST_CHECK(first->Open(":memory:", firstName));
+        ENGINE_TEST_CHECK(second->Open(":memory:", secondName));
+        ENGINE_TEST_CHECK(CreateEntityTable(first->GetConnection()));
+        ENGINE_TEST_CHECK(CreateEntityTable(second->GetConnection()));
+        first->SetFlushInterval(M_INFINITY);
+        second->SetFlushInterval(M_INFINITY);
+
+        WriteEntity(first, 1, "old");
+        WriteEntity(first, 2, "kept");
+        WriteEntity(second, 1, "new");
+        WriteEntity(second, 3, "added");
+        RunFrame(context);
+
+        ENGINE_TEST_CHECK(fileSystem->Copy(firstName, journalName + ".flushing"));
+        ENGINE_TEST_CHECK(fileSystem->Copy(secondName, journalName));
+
+        first->Close();
+        second->Close();
+    }
+
+    // A record cut short by the crash is ignored
+    {
+        File journal(context, journalName, FILE_APPEND);
+        ENGINE_TEST_CHECK(journal.IsOpen());
+        journal.WriteUInt(1000);
+        journal.WriteString(WRITE_SQL);
+    }
+
+    DbConnection* connection = database->Connect(databaseName);
+    ENGINE_TEST_CHECK(connection);
+    ENGINE_TEST_CHECK(CreateEntityTable(connection));
+
+    SharedPtr<DbWriteQueue> queue(new DbWriteQueue(context));
+    ENGINE_TEST_CHECK(queue->Open(databaseName, journalName));
+    ENGINE_TEST_CHECK(queue->GetStats().numRecovered_ == 4);
+    ENGINE_TEST_CHECK(queue->IsFlushing());
+    ENGINE_TEST_CHECK(!fileSystem->FileExists(journalName + ".tmp"));
+    ENGINE_TEST_CHECK(queue->FlushAndWait());
+    ENGINE_TEST_CHECK(queue->GetStats().numFlushedWrites_ == 3);
+
+    ENGINE_TEST_CHECK(GetEntityName(connection, 1) == "new");
+    ENGINE_TEST_CHECK(GetEntityName(connection, 2) == "kept");
+    ENGINE_TEST_CHECK(GetEntityName(connection, 3) == "added");
+
+    queue->Close();
+    ENGINE_TEST_CHECK(!fileSystem->FileExists(journalName));
+    ENGINE_TEST_CHECK(!fileSystem->FileExists(journalName + ".flushing"));
+
+    database->Disconnect(connection);
+    fileSystem->Delete(databaseName);
+    return true;
+}
+
+bool TestDbWriteQueueFailureRetry(Context* context)
+{
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+    String journalName = GetTestFileName(context, "EngineTestsRetry.journal");
+
+    SharedPtr<DbWriteQueue> queue(new DbWriteQueue(context));
+    ENGINE_TEST_CHECK(queue->Open(":memory:", journalName));
+    ENGINE_TEST_CHECK(CreateEntityTable(queue->GetConnection()));
+    SharedPtr<DbWriteFailedListener> listener(new DbWriteFailedListener(context, queue));
+    queue->SetFlushInterval(0.0f);
+    queue->SetMaxFlushRetries(2);
+
+    // One write of the batch fails the NOT NULL constraint
+    for (int i = 0; i < 8; ++i)
+        WriteEntity(queue, i, i == 5 ? Variant() : Variant("entity" + String(i)));
+
+    // The batch is split until the failing write is alone, and the other writes are committed
+    for (unsigned frame = 0; frame < 100 && (queue->GetNumPendingWrites() || queue->GetNumRetryWrites() || queue->IsFlushing()); ++frame)
+        RunFrame(context);
+
+    ENGINE_TEST_CHECK(!queue->GetNumPendingWrites() && !queue->GetNumRetryWrites() && !queue->IsFlushing());
+    ENGINE_TEST_CHECK(queue->GetStats().numFailedWrites_ == 1);
+    ENGINE_TEST_CHECK(queue->GetStats().numFlushedWrites_ == 7);
+    ENGINE_TEST_CHECK(queue->GetStats().numFailedFlushes_ >= 4);
+    ENGINE_TEST_CHECK(listener->keys_.Size() == 1 && listener->keys_[0] == "5");
+    for (int i = 0; i < 8; ++i)
+        ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), i) == (i == 5 ? String("<missing>") : "entity" + String(i)));
+
+    // The failed write is kept in the journal record format
+    {
+        File failed(context, queue->GetFailedWritesFileName(), FILE_READ);
+        ENGINE_TEST_CHECK(failed.IsOpen());
+        unsigned size = failed.ReadUInt();
+        ENGINE_TEST_CHECK(size == failed.GetSize() - sizeof(unsigned));
+        ENGINE_TEST_CHECK(failed.ReadString() == WRITE_SQL);
+        ENGINE_TEST_CHECK(failed.ReadString() == "5");
+    }
+
+    // A failed write replaced by a later write is not retried, and the queue is not blocked by failures
+    WriteEntity(queue, 9, Variant());
+    ENGINE_TEST_CHECK(!queue->FlushAndWait());
+    ENGINE_TEST_CHECK(queue->GetNumRetryWrites() == 1);
+    WriteEntity(queue, 9, "fixed");
+    ENGINE_TEST_CHECK(queue->FlushAndWait());
+    ENGINE_TEST_CHECK(GetEntityName(queue->GetConnection(), 9) == "fixed");
+    ENGINE_TEST_CHECK(queue->GetStats().numFailedWrites_ == 1);
+
+    listener.Reset();
+    queue->Close();
+    fileSystem->Delete(queue->GetFailedWritesFileName());
+    return true;
+}
+
+}
+
+#endif
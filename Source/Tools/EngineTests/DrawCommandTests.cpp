@@ -0,0 +1,48 @@
+#include <EngineCore/Graphics/DrawCommand.h>
+#include <EngineCore/Graphics/Shader.h>
+#include <EngineCore/Graphics/ShaderVariation.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+bool TestDrawCommandShaderFallback(Context* context)
+{
+    SharedPtr<Shader> shader(new Shader(context));
+    SharedPtr<ShaderVariation> fallbackVS(new ShaderVariation(shader, VS));
+    SharedPtr<ShaderVariation> compilingVS(new ShaderVariation(shader, VS));
+    SharedPtr<ShaderVariation> oldPS(new ShaderVariation(shader, PS));
+    SharedPtr<ShaderVariation> newPS(new ShaderVariation(shader, PS));
+
+    // Draw with the fallback until the requested vertex shader is compiled, like the asynchronous compile path
+    bool compiled = false;
+    auto resolve = [&](ShaderType type, ShaderVariation* variation) -> ShaderVariation*
+    {
+        return variation == compilingVS && !compiled ? fallbackVS.Get() : variation;
+    };
+
+    // The vertex shader falls back to the variation already in the pipeline while the pixel shader changes. The pipeline
+    // must keep the fallback, not the variation that has no GPU object yet
+    ShaderVariation* pipelineShaders[MAX_SHADER_TYPES] = { fallbackVS, oldPS };
+    ShaderVariation* requested[MAX_SHADER_TYPES] = { compilingVS, newPS };
+    u32 changed = MergePipelineShaders(pipelineShaders, requested, resolve);
+    ENGINE_TEST_CHECK(changed == 1u << PS);
+    ENGINE_TEST_CHECK(pipelineShaders[VS] == fallbackVS);
+    ENGINE_TEST_CHECK(pipelineShaders[PS] == newPS);
+
+    // Nothing changes while the vertex shader is still compiling
+    changed = MergePipelineShaders(pipelineShaders, requested, resolve);
+    ENGINE_TEST_CHECK(changed == 0);
+
+    // The compiled variation replaces the fallback
+    compiled = true;
+    changed = MergePipelineShaders(pipelineShaders, requested, resolve);
+    ENGINE_TEST_CHECK(changed == 1u << VS);
+    ENGINE_TEST_CHECK(pipelineShaders[VS] == compilingVS);
+    ENGINE_TEST_CHECK(pipelineShaders[PS] == newPS);
+
+    return true;
+}
+
+}
@@ -0,0 +1,103 @@
+#include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Core/WorkQueue.h>
+#ifdef ENGINE_DATABASE
+#include <EngineCore/Database/Database.h>
+#endif
+#include <EngineCore/Graphics/Graphics.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Scene/Scene.h>
+
+#include "EngineTests.h"
+
+using namespace Atomic;
+
+/// Engine behavior checks that need no GPU or window. Run all tests, or those whose name contains one of the arguments.
+/// The exit code is the number of failed tests.
+static const EngineTest tests[] =
+{
+    { "SceneArchiveRoundTrip", TestSceneArchiveRoundTrip },
+    { "SceneArchiveAnimatedModel", TestSceneArchiveAnimatedModel },
+    { "SceneArchiveAsync", TestSceneArchiveAsync },
+    { "TransformHierarchyIncremental", TestTransformHierarchyIncremental },
+    { "TransformHierarchyListeners", TestTransformHierarchyListeners },
+    { "TransformHierarchyOctree", TestTransformHierarchyOctree },
+    { "DrawCommandShaderFallback", TestDrawCommandShaderFallback },
+#ifdef ENGINE_DATABASE_SQLITE
+    { "DatabaseStatementCache", TestDatabaseStatementCache },
+    { "DatabaseCursor", TestDatabaseCursor },
+    { "DatabaseRollback", TestDatabaseRollback },
+    { "DatabaseAsync", TestDatabaseAsync },
+    { "DbWriteQueueCoalescing", TestDbWriteQueueCoalescing },
+    { "DbWriteQueueJournalReplay", TestDbWriteQueueJournalReplay },
+    { "DbWriteQueueFailureRetry", TestDbWriteQueueFailureRetry },
+#endif
+#ifdef ENGINE_NETWORK
+    { "HttpClientBatch", TestHttpClientBatch },
+    { "HttpClientDestinations", TestHttpClientDestinations },
+    { "HttpClientRateLimit", TestHttpClientRateLimit },
+    { "HttpClientStaleConnection", TestHttpClientStaleConnection },
+#endif
+};
+
+namespace Atomic
+{
+
+void RunFrame(Context* context, float timeStep)
+{
+    Time* time = context->GetSubsystem<Time>();
+    time->BeginFrame(timeStep);
+    time->EndFrame();
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const Vector<String>& arguments = ParseArguments(argc, argv);
+
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    context->RegisterSubsystem(new Time(context));
+    context->RegisterSubsystem(new WorkQueue(context));
+    context->RegisterSubsystem(new ResourceCache(context));
+#ifdef ENGINE_DATABASE
+    // Pooling would share one in-memory database between the tests
+    Database* database = new Database(context);
+    database->SetPoolSize(0);
+    context->RegisterSubsystem(database);
+#endif
+    RegisterSceneLibrary(context);
+    RegisterGraphicsLibrary(context);
+    context->InitSubsystemCache();
+
+    context->GetSubsystem<Log>()->SetQuiet(false);
+    context->GetSubsystem<WorkQueue>()->CreateThreads(GetNumLogicalCPUs() - 1);
+
+    unsigned numRun = 0;
+    unsigned numFailed = 0;
+
+    for (unsigned i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+    {
+        String name(tests[i].name_);
+
+        bool selected = arguments.Empty();
+        for (unsigned j = 0; j < arguments.Size() && !selected; ++j)
+            selected = name.Contains(arguments[j], false);
+        if (!selected)
+            continue;
+
+        ++numRun;
+        PrintLine("Running " + name);
+        if (!tests[i].function_(context))
+        {
+            ++numFailed;
+            PrintLine("FAILED " + name, true);
+        }
+    }
+
+    PrintLine(String(numRun - numFailed) + " of " + String(numRun) + " tests passed");
+    return (int)numFailed;
+}
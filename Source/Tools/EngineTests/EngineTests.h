@@ -0,0 +1,58 @@
+#pragma once
+
+#include <EngineCore/Core/Context.h>
+#include <EngineCore/IO/Log.h>
+
+namespace Atomic
+{
+
+/// Test function. Return true if all checks passed.
+typedef bool (*EngineTestFunction)(Context* context);
+
+/// Test run by the EngineTests tool.
+struct EngineTest
+{
+    /// Test name.
+    const char* name_;
+    /// Test function.
+    EngineTestFunction function_;
+};
+
+/// Fail the current test with the location and expression if the expression is false.
+#define ENGINE_TEST_CHECK(expr) \
+    do \
+    { \
+        if (!(expr)) \
+        { \
+            ATOMIC_LOGERRORF("%s:%d: check failed: %s", __FILE__, __LINE__, #expr); \
+            return false; \
+        } \
+    } while (0)
+
+/// Run one frame of the Time subsystem, which sends the begin and end frame events.
+void RunFrame(Context* context, float timeStep = 1.0f / 60.0f);
+
+bool TestSceneArchiveRoundTrip(Context* context);
+bool TestSceneArchiveAnimatedModel(Context* context);
+bool TestSceneArchiveAsync(Context* context);
+bool TestTransformHierarchyIncremental(Context* context);
+bool TestTransformHierarchyListeners(Context* context);
+bool TestTransformHierarchyOctree(Context* context);
+bool TestDrawCommandShaderFallback(Context* context);
+#ifdef ENGINE_DATABASE_SQLITE
+bool TestDatabaseStatementCache(Context* context);
+bool TestDatabaseCursor(Context* context);
+bool TestDatabaseRollback(Context* context);
+bool TestDatabaseAsync(Context* context);
+bool TestDbWriteQueueCoalescing(Context* context);
+bool TestDbWriteQueueJournalReplay(Context* context);
+bool TestDbWriteQueueFailureRetry(Context* context);
+#endif
+#ifdef ENGINE_NETWORK
+bool TestHttpClientBatch(Context* context);
+bool TestHttpClientDestinations(Context* context);
+bool TestHttpClientRateLimit(Context* context);
+bool TestHttpClientStaleConnection(Context* context);
+#endif
+
+}
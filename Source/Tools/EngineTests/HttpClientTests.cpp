@@ -0,0 +1,330 @@
+#ifdef ENGINE_NETWORK
+
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/Network/HttpClient.h>
+#include <EngineCore/Network/NetworkEvents.h>
+
+#include <Civetweb/include/civetweb.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+/// First port tried for the test server.
+static const int FIRST_SERVER_PORT = 18300;
+/// Number of ports tried for the test server.
+static const int NUM_SERVER_PORTS = 100;
+
+/// Return the byte at an offset of a test response body.
+static unsigned char GetBodyByte(unsigned offset)
+{
+    return (unsigned char)(offset % 251);
+}
+
+/// Return whether data matches a test response body.
+static bool IsBodyValid(const unsigned char* data, unsigned size)
+{
+    for (unsigned i = 0; i < size; ++i)
+    {
+        if (data[i] != GetBodyByte(i))
+            return false;
+    }
+    return true;
+}
+
+/// Civetweb handler for /data/<size>, which reads any request body and responds with a body of the given size.
+static int HandleDataRequest(mg_connection* connection, void* userData)
+{
+    const mg_request_info* info = mg_get_request_info(connection);
+    unsigned size = ToUInt(String(info->uri).Substring(6));
+
+    char buffer[4096];
+    while (mg_read(connection, buffer, sizeof(buffer)) > 0)
+        ;
+
+    mg_printf(connection, "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %u\r\n\r\n", size);
+    for (unsigned offset = 0; offset < size;)
+    {
+        unsigned count = Min(size - offset, (unsigned)sizeof(buffer));
+        for (unsigned i = 0; i < count; ++i)
+            buffer[i] = (char)GetBodyByte(offset + i);
+        if (mg_write(connection, buffer, count) != (int)count)
+            break;
+        offset += count;
+    }
+
+    return 200;
+}
+
+/// Civetweb server on a local port that keeps connections alive, stopped on destruction.
+class TestHttpServer
+{
+public:
+    /// Construct.
+    TestHttpServer() :
+        context_(0),
+        port_(0)
+    {
+    }
+
+    /// Destruct.
+    ~TestHttpServer()
+    {
+        if (context_)
+            mg_stop(context_);
+    }
+
+    /// Start with the time in milliseconds after which the server closes an idle connection. Return whether started.
+    bool Start(unsigned idleTimeout)
+    {
+        String timeout(idleTimeout);
+        mg_callbacks callbacks;
+        memset(&callbacks, 0, sizeof(callbacks));
+
+        for (port_ = FIRST_SERVER_PORT; port_ < FIRST_SERVER_PORT + NUM_SERVER_PORTS; ++port_)
+        {
+            String ports = "127.0.0.1:" + String(port_);
+            const char* options[] = { "listening_ports", ports.CString(), "enable_keep_alive", "yes", "request_timeout_ms",
+                timeout.CString(), "num_threads", "8", 0 };
+            context_ = mg_start(&callbacks, 0, options);
+            if (context_)
+            {
+                mg_set_request_handler(context_, "/data/", HandleDataRequest, 0);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Return URL of a response body of the given size.
+    String GetDataURL(unsigned size) const { return "http://127.0.0.1:" + String(port_) + "/data/" + String(size); }
+
+private:
+    /// Civetweb context.
+    mg_context* context_;
+    /// Port.
+    int port_;
+};
+
+/// Records the completion events of an HTTP client.
+class HttpCompletionListener : public Object
+{
+    ATOMIC_OBJECT(HttpCompletionListener, Object);
+
+public:
+    /// Construct.
+    HttpCompletionListener(Context* context, HttpClient* client) :
+        Object(context),
+        numRequestEvents_(0),
+        numBatchEvents_(0),
+        batchID_(0),
+        batchRequests_(0),
+        batchFailed_(0)
+    {
+        SubscribeToEvent(client, E_HTTPREQUESTCOMPLETED, ATOMIC_HANDLER(HttpCompletionListener, HandleRequestCompleted));
+        SubscribeToEvent(client, E_HTTPBATCHCOMPLETED, ATOMIC_HANDLER(HttpCompletionListener, HandleBatchCompleted));
+    }
+
+    /// Number of request completion events.
+    unsigned numRequestEvents_;
+    /// Number of batch completion events.
+    unsigned numBatchEvents_;
+    /// ID of the last completed batch.
+    unsigned batchID_;
+    /// Number of requests of the last completed batch.
+    unsigned batchRequests_;
+    /// Number of failed requests of the last completed batch.
+    unsigned batchFailed_;
+
+private:
+    /// Count a completed request.
+    void HandleRequestCompleted(StringHash eventType, VariantMap& eventData)
+    {
+        ++numRequestEvents_;
+    }
+
+    /// Record a completed batch.
+    void HandleBatchCompleted(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace HttpBatchCompleted;
+
+        ++numBatchEvents_;
+        batchID_ = eventData[P_BATCHID].GetUInt();
+        batchRequests_ = eventData[P_NUMREQUESTS].GetUInt();
+        batchFailed_ = eventData[P_NUMFAILED].GetUInt();
+    }
+};
+
+bool TestHttpClientBatch(Context* context)
+{
+    TestHttpServer server;
+    ENGINE_TEST_CHECK(server.Start(30000));
+
+    SharedPtr<HttpClient> client(new HttpClient(context));
+    SharedPtr<HttpCompletionListener> listener(new HttpCompletionListener(context, client));
+    client->SetMaxConnectionsPerHost(2);
+
+    Vector<SharedPtr<HttpClientRequest> > requests;
+    for (unsigned i = 0; i < 16; ++i)
+        requests.Push(SharedPtr<HttpClientRequest>(new HttpClientRequest(server.GetDataURL(1000 * i))));
+
+    unsigned batchID = client->SendBatch(requests);
+    ENGINE_TEST_CHECK(batchID);
+    client->WaitForRequests();
+
+    // A single event is sent for the batch
+    ENGINE_TEST_CHECK(listener->numBatchEvents_ == 1);
+    ENGINE_TEST_CHECK(listener->numRequestEvents_ == 0);
+    ENGINE_TEST_CHECK(listener->batchID_ == batchID);
+    ENGINE_TEST_CHECK(listener->batchRequests_ == 16);
+    ENGINE_TEST_CHECK(listener->batchFailed_ == 0);
+
+    for (unsigned i = 0; i < requests.Size(); ++i)
+    {
+        HttpClientRequest* request = requests[i];
+        ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+        ENGINE_TEST_CHECK(request->GetStatusCode() == 200);
+        ENGINE_TEST_CHECK(request->GetResponseData().Size() == 1000 * i);
+        ENGINE_TEST_CHECK(request->GetResponseData().Empty() || IsBodyValid(&request->GetResponseData()[0], 1000 * i));
+    }
+
+    // The requests share the connections allowed for the host
+    HttpClientStats stats = client->GetStats();
+    ENGINE_TEST_CHECK(stats.numRequests_ == 16);
+    ENGINE_TEST_CHECK(stats.numFailed_ == 0);
+    ENGINE_TEST_CHECK(stats.numConnectionsOpened_ <= 2);
+    ENGINE_TEST_CHECK(stats.numConnectionsOpened_ + stats.numConnectionsReused_ == 16);
+    ENGINE_TEST_CHECK(stats.numPooledConnections_ == stats.numConnectionsOpened_);
+
+    // A single request sends its own event
+    SharedPtr<HttpClientRequest> request(new HttpClientRequest(server.GetDataURL(10)));
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(listener->numRequestEvents_ == 1);
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+    ENGINE_TEST_CHECK(client->GetStats().numConnectionsReused_ == stats.numConnectionsReused_ + 1);
+    return true;
+}
+
+bool TestHttpClientDestinations(Context* context)
+{
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+
+    TestHttpServer server;
+    ENGINE_TEST_CHECK(server.Start(30000));
+
+    SharedPtr<HttpClient> client(new HttpClient(context));
+    const unsigned size = 200000;
+
+    // File destination
+    String fileName = fileSystem->GetCurrentDir() + "EngineTestsHttp.bin";
+    {
+        SharedPtr<File> file(new File(context, fileName, FILE_WRITE));
+        ENGINE_TEST_CHECK(file->IsOpen());
+
+        SharedPtr<HttpClientRequest> request(new HttpClientRequest(server.GetDataURL(size)));
+        request->SetDestination(file);
+        client->Send(request);
+        client->WaitForRequests();
+        ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+        ENGINE_TEST_CHECK(request->GetNumBytesReceived() == size);
+        ENGINE_TEST_CHECK(request->GetResponseData().Empty());
+    }
+    {
+        File file(context, fileName, FILE_READ);
+        ENGINE_TEST_CHECK(file.GetSize() == size);
+        PODVector<unsigned char> data(size);
+        ENGINE_TEST_CHECK(file.Read(&data[0], size) == size);
+        ENGINE_TEST_CHECK(IsBodyValid(&data[0], size));
+    }
+    fileSystem->Delete(fileName);
+
+    // Memory destination
+    PODVector<unsigned char> memory(size);
+    SharedPtr<HttpClientRequest> request(new HttpClientRequest(server.GetDataURL(size)));
+    request->SetDestination(&memory[0], memory.Size());
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+    ENGINE_TEST_CHECK(request->GetNumBytesReceived() == size);
+    ENGINE_TEST_CHECK(IsBodyValid(&memory[0], size));
+
+    // A response that does not fit in the destination memory fails
+    request = new HttpClientRequest(server.GetDataURL(size + 1));
+    request->SetDestination(&memory[0], memory.Size());
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_ERROR);
+    ENGINE_TEST_CHECK(client->GetStats().numFailed_ == 1);
+    return true;
+}
+
+bool TestHttpClientRateLimit(Context* context)
+{
+    TestHttpServer server;
+    ENGINE_TEST_CHECK(server.Start(30000));
+
+    SharedPtr<HttpClient> client(new HttpClient(context));
+    client->SetMaxDownloadRate(100000);
+
+    // The limit is shared by the requests, and starts with nothing available
+    Vector<SharedPtr<HttpClientRequest> > requests;
+    for (unsigned i = 0; i < 3; ++i)
+        requests.Push(SharedPtr<HttpClientRequest>(new HttpClientRequest(server.GetDataURL(50000))));
+
+    HiresTimer timer;
+    client->SendBatch(requests);
+    client->WaitForRequests();
+    long long elapsed = timer.GetUSec(false);
+
+    for (unsigned i = 0; i < requests.Size(); ++i)
+        ENGINE_TEST_CHECK(requests[i]->GetState() == HTTP_CLOSED && requests[i]->GetNumBytesReceived() == 50000);
+    ENGINE_TEST_CHECK(elapsed >= 1400000);
+    ENGINE_TEST_CHECK(elapsed < 5000000);
+    return true;
+}
+
+bool TestHttpClientStaleConnection(Context* context)
+{
+    // The server closes idle connections after 100 ms
+    TestHttpServer server;
+    ENGINE_TEST_CHECK(server.Start(100));
+
+    SharedPtr<HttpClient> client(new HttpClient(context));
+    client->SetMaxConnectionsPerHost(1);
+
+    SharedPtr<HttpClientRequest> request(new HttpClientRequest(server.GetDataURL(10)));
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+    ENGINE_TEST_CHECK(client->GetStats().numPooledConnections_ == 1);
+
+    // An idempotent request on the closed connection is sent again on a new connection
+    Time::Sleep(400);
+    request = new HttpClientRequest(server.GetDataURL(10), "PUT");
+    request->SetBody(String("put"));
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_CLOSED);
+    ENGINE_TEST_CHECK(client->GetStats().numConnectionsOpened_ == 2);
+    ENGINE_TEST_CHECK(client->GetStats().numConnectionsReused_ == 0);
+
+    // Other requests are not sent again, as the server may have acted on them
+    Time::Sleep(400);
+    request = new HttpClientRequest(server.GetDataURL(10), "POST");
+    request->SetBody(String("post"));
+    client->Send(request);
+    client->WaitForRequests();
+    ENGINE_TEST_CHECK(request->GetState() == HTTP_ERROR);
+    ENGINE_TEST_CHECK(client->GetStats().numConnectionsOpened_ == 2);
+    ENGINE_TEST_CHECK(client->GetStats().numFailed_ == 1);
+    return true;
+}
+
+}
+
+#endif
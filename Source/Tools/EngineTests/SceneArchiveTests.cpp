@@ -0,0 +1,176 @@
+#include <EngineCore/Graphics/AnimatedModel.h>
+#include <EngineCore/Graphics/Light.h>
+#include <EngineCore/Graphics/Model.h>
+#include <EngineCore/IO/File.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/IO/VectorBuffer.h>
+#include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Scene/Scene.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+static const char* SKINNED_MODEL_NAME = "Models/EngineTestsSkinned.mdl";
+
+/// Save a scene in the compact format and load it into another scene.
+static bool CopyCompactScene(Scene* source, Scene* dest, bool compress)
+{
+    VectorBuffer buffer;
+    if (!source->SaveCompact(buffer, compress))
+        return false;
+
+    buffer.Seek(0);
+    return dest->Load(buffer);
+}
+
+/// Return a model with a three bone chain and no geometry, registered as a manual resource.
+static Model* GetSkinnedModel(Context* context)
+{
+    ResourceCache* cache = context->GetSubsystem<ResourceCache>();
+    Model* model = cache->GetExistingResource<Model>(SKINNED_MODEL_NAME);
+    if (model)
+        return model;
+
+    const char* boneNames[] = { "Root", "Spine", "Head" };
+
+    Skeleton skeleton;
+    Vector<Bone>& bones = skeleton.GetModifiableBones();
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        Bone bone;
+        bone.name_ = boneNames[i];
+        bone.nameHash_ = bone.name_;
+        bone.parentIndex_ = i ? i - 1 : 0;
+        bone.initialPosition_ = i ? Vector3::UP : Vector3::ZERO;
+        bones.Push(bone);
+    }
+    skeleton.SetRootBoneIndex(0);
+
+    model = new Model(context);
+    model->SetName(SKINNED_MODEL_NAME);
+    model->SetBoundingBox(BoundingBox(-1.0f, 1.0f));
+    model->SetSkeleton(skeleton);
+    cache->AddManualResource(model);
+    return model;
+}
+
+bool TestSceneArchiveRoundTrip(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    Node* parent = scene->CreateChild("Parent");
+    parent->SetPosition(Vector3(1.0f, 2.0f, 3.0f));
+    parent->SetVar("Health", 75);
+    Node* child = parent->CreateChild("Child");
+    Light* light = child->CreateComponent<Light>();
+    light->SetLightType(LIGHT_SPOT);
+    light->SetRange(42.0f);
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        SharedPtr<Scene> loaded(new Scene(context));
+        ENGINE_TEST_CHECK(CopyCompactScene(scene, loaded, i == 0));
+        ENGINE_TEST_CHECK(loaded->GetNumChildren(true) == scene->GetNumChildren(true));
+
+        Node* loadedParent = loaded->GetChild("Parent");
+        ENGINE_TEST_CHECK(loadedParent);
+        ENGINE_TEST_CHECK(loadedParent->GetID() == parent->GetID());
+        ENGINE_TEST_CHECK(loadedParent->GetPosition().Equals(parent->GetPosition()));
+        ENGINE_TEST_CHECK(loadedParent->GetVar("Health").GetInt() == 75);
+
+        Node* loadedChild = loadedParent->GetChild("Child");
+        ENGINE_TEST_CHECK(loadedChild);
+        Light* loadedLight = loadedChild->GetComponent<Light>();
+        ENGINE_TEST_CHECK(loadedLight);
+        ENGINE_TEST_CHECK(loadedLight->GetID() == light->GetID());
+        ENGINE_TEST_CHECK(loadedLight->GetLightType() == LIGHT_SPOT);
+        ENGINE_TEST_CHECK(loadedLight->GetRange() == 42.0f);
+    }
+
+    return true;
+}
+
+bool TestSceneArchiveAnimatedModel(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    Node* node = scene->CreateChild("Character");
+    AnimatedModel* animatedModel = node->CreateComponent<AnimatedModel>();
+    animatedModel->SetModel(GetSkinnedModel(context));
+
+    // The character node and one node for each bone
+    unsigned numNodes = scene->GetNumChildren(true);
+    ENGINE_TEST_CHECK(numNodes == 4);
+
+    // Loading must reuse the saved bone nodes instead of creating them again, also when loading the same data repeatedly
+    // and when saving a loaded scene again
+    SharedPtr<Scene> loaded(new Scene(context));
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        ENGINE_TEST_CHECK(CopyCompactScene(i < 2 ? scene.Get() : loaded.Get(), loaded, true));
+        ENGINE_TEST_CHECK(loaded->GetNumChildren(true) == numNodes);
+
+        Node* loadedNode = loaded->GetChild("Character");
+        ENGINE_TEST_CHECK(loadedNode);
+        ENGINE_TEST_CHECK(loadedNode->GetNumChildren(true) == 3);
+
+        AnimatedModel* loadedModel = loadedNode->GetComponent<AnimatedModel>();
+        ENGINE_TEST_CHECK(loadedModel);
+        ENGINE_TEST_CHECK(loadedModel->GetModel() == animatedModel->GetModel());
+
+        Bone* head = loadedModel->GetSkeleton().GetBone("Head");
+        ENGINE_TEST_CHECK(head);
+        ENGINE_TEST_CHECK(head->node_);
+        ENGINE_TEST_CHECK(head->node_.Get() == loadedNode->GetChild("Head", true));
+        ENGINE_TEST_CHECK(head->node_->GetParent() == loadedNode->GetChild("Spine", true));
+    }
+
+    return true;
+}
+
+bool TestSceneArchiveAsync(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        Node* node = scene->CreateChild("Node" + String(i));
+        node->CreateChild("Child")->CreateComponent<Light>()->SetRange(10.0f + i);
+    }
+
+    FileSystem* fileSystem = context->GetSubsystem<FileSystem>();
+    String fileName = fileSystem->GetCurrentDir() + "EngineTestsAsync.cscn";
+    {
+        File file(context, fileName, FILE_WRITE);
+        ENGINE_TEST_CHECK(scene->SaveCompact(file));
+    }
+
+    // The nodes are created over the updates and the attributes assigned when finishing
+    SharedPtr<Scene> loaded(new Scene(context));
+    SharedPtr<File> file(new File(context, fileName, FILE_READ));
+    ENGINE_TEST_CHECK(loaded->LoadAsync(file, LOAD_SCENE));
+    ENGINE_TEST_CHECK(loaded->IsAsyncLoading());
+    ENGINE_TEST_CHECK(loaded->GetAsyncProgress() < 1.0f);
+
+    for (unsigned i = 0; i < 100 && loaded->IsAsyncLoading(); ++i)
+        loaded->Update(0.0f);
+    file.Reset();
+    fileSystem->Delete(fileName);
+
+    ENGINE_TEST_CHECK(!loaded->IsAsyncLoading());
+    ENGINE_TEST_CHECK(loaded->GetNumChildren(true) == scene->GetNumChildren(true));
+    ENGINE_TEST_CHECK(loaded->GetFileName() == fileName);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        Node* node = loaded->GetChild("Node" + String(i));
+        ENGINE_TEST_CHECK(node);
+        Node* child = node->GetChild("Child");
+        ENGINE_TEST_CHECK(child);
+        Light* light = child->GetComponent<Light>();
+        ENGINE_TEST_CHECK(light);
+        ENGINE_TEST_CHECK(light->GetRange() == 10.0f + i);
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,205 @@
+#include <EngineCore/Graphics/Camera.h>
+#include <EngineCore/Graphics/Model.h>
+#include <EngineCore/Graphics/Octree.h>
+#include <EngineCore/Graphics/OctreeQuery.h>
+#include <EngineCore/Graphics/StaticModel.h>
+#include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Scene/Scene.h>
+#include <EngineCore/Scene/SceneEvents.h>
+#include <EngineCore/Scene/TransformHierarchy.h>
+
+#include "EngineTests.h"
+
+namespace Atomic
+{
+
+static const char* BOX_MODEL_NAME = "Models/EngineTestsBox.mdl";
+
+/// Moves a node when the drawables of its scene have been updated, like inverse kinematics would.
+class DrawableUpdateMover : public Object
+{
+    ATOMIC_OBJECT(DrawableUpdateMover, Object);
+
+public:
+    /// Construct.
+    DrawableUpdateMover(Context* context, Node* node, const Vector3& position) :
+        Object(context),
+        node_(node),
+        position_(position)
+    {
+        SubscribeToEvent(node->GetScene(), E_SCENEDRAWABLEUPDATEFINISHED, ATOMIC_HANDLER(DrawableUpdateMover,
+            HandleDrawableUpdateFinished));
+    }
+
+private:
+    /// Move the node.
+    void HandleDrawableUpdateFinished(StringHash eventType, VariantMap& eventData)
+    {
+        node_->SetPosition(position_);
+    }
+
+    /// Node to move.
+    Node* node_;
+    /// Position to move to.
+    Vector3 position_;
+};
+
+/// Return a model with a unit bounding box and no geometry, registered as a manual resource.
+static Model* GetBoxModel(Context* context)
+{
+    ResourceCache* cache = context->GetSubsystem<ResourceCache>();
+    Model* model = cache->GetExistingResource<Model>(BOX_MODEL_NAME);
+    if (model)
+        return model;
+
+    model = new Model(context);
+    model->SetName(BOX_MODEL_NAME);
+    model->SetBoundingBox(BoundingBox(-1.0f, 1.0f));
+    cache->AddManualResource(model);
+    return model;
+}
+
+/// Return whether a drawable sits in an octant that contains its bounding box.
+static bool IsInsideOctant(Drawable* drawable)
+{
+    Octant* octant = drawable->GetOctant();
+    return octant && octant->GetCullingBox().IsInside(drawable->GetWorldBoundingBox()) == INSIDE;
+}
+
+bool TestTransformHierarchyIncremental(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->SetFlatTransformsEnabled(true);
+    TransformHierarchy* hierarchy = scene->GetTransformHierarchy();
+
+    Node* a = scene->CreateChild("A");
+    a->SetPosition(Vector3(1.0f, 0.0f, 0.0f));
+    Node* b = a->CreateChild("B");
+    b->SetPosition(Vector3(0.0f, 1.0f, 0.0f));
+    Node* c = scene->CreateChild("C");
+    c->SetPosition(Vector3(0.0f, 0.0f, 1.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumNodes() == 4);
+
+    // Only the moved node and its children are updated
+    a->SetPosition(Vector3(2.0f, 0.0f, 0.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == 2);
+    ENGINE_TEST_CHECK(b->GetWorldPosition().Equals(Vector3(2.0f, 1.0f, 0.0f)));
+
+    // A node added below an indexed node is inserted into its parent's subtree
+    Node* d = b->CreateChild("D");
+    d->SetPosition(Vector3(0.0f, 0.0f, 1.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumNodes() == 5);
+    a->SetPosition(Vector3(3.0f, 0.0f, 0.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == 3);
+    ENGINE_TEST_CHECK(d->GetWorldPosition().Equals(Vector3(3.0f, 1.0f, 1.0f)));
+
+    // A node moved to another parent takes its subtree along
+    c->AddChild(b);
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(d->GetWorldPosition().Equals(Vector3(0.0f, 1.0f, 2.0f)));
+    c->SetPosition(Vector3(0.0f, 0.0f, 2.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == 3);
+    ENGINE_TEST_CHECK(d->GetWorldPosition().Equals(Vector3(0.0f, 1.0f, 3.0f)));
+    a->SetPosition(Vector3::ZERO);
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == 1);
+
+    // Removed nodes leave the index
+    c->RemoveChild(b);
+    c->SetPosition(Vector3::ZERO);
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == 1);
+
+    // Enough dirty nodes to split the update across worker threads
+    PODVector<Node*> leaves;
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        Node* parent = scene->CreateChild();
+        for (unsigned j = 0; j < 64; ++j)
+            leaves.Push(parent->CreateChild());
+    }
+    scene->UpdateTransforms();
+    scene->SetPosition(Vector3(100.0f, 0.0f, 0.0f));
+    const Vector<SharedPtr<Node> >& children = scene->GetChildren();
+    for (unsigned i = 0; i < children.Size(); ++i)
+        children[i]->SetPosition(Vector3(0.0f, (float)i, 0.0f));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(hierarchy->GetNumUpdated() == hierarchy->GetNumNodes());
+    ENGINE_TEST_CHECK(leaves.Back()->GetWorldPosition().Equals(Vector3(0.0f, (float)(children.Size() - 1), 0.0f)));
+
+    return true;
+}
+
+bool TestTransformHierarchyListeners(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->SetFlatTransformsEnabled(true);
+
+    Node* parent = scene->CreateChild("Parent");
+    Node* node = parent->CreateChild("Camera");
+    Camera* camera = node->CreateComponent<Camera>();
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(camera->GetView().Translation().Equals(Vector3::ZERO));
+
+    // The camera is notified when its parent is moved, not only when the transforms are updated
+    parent->SetPosition(Vector3(1.0f, 2.0f, 3.0f));
+    ENGINE_TEST_CHECK(camera->GetView().Translation().Equals(Vector3(-1.0f, -2.0f, -3.0f)));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(camera->GetView().Translation().Equals(Vector3(-1.0f, -2.0f, -3.0f)));
+
+    // Also when moved again before the update
+    node->SetPosition(Vector3(1.0f, 0.0f, 0.0f));
+    parent->SetPosition(Vector3::ZERO);
+    ENGINE_TEST_CHECK(camera->GetView().Translation().Equals(Vector3(-1.0f, 0.0f, 0.0f)));
+    scene->UpdateTransforms();
+    ENGINE_TEST_CHECK(node->GetWorldPosition().Equals(Vector3(1.0f, 0.0f, 0.0f)));
+
+    return true;
+}
+
+bool TestTransformHierarchyOctree(Context* context)
+{
+    SharedPtr<Scene> scene(new Scene(context));
+    scene->SetFlatTransformsEnabled(true);
+    Octree* octree = scene->CreateComponent<Octree>();
+
+    Node* node = scene->CreateChild("Model");
+    node->SetPosition(Vector3(100.0f, 100.0f, 100.0f));
+    StaticModel* model = node->CreateComponent<StaticModel>();
+    model->SetModel(GetBoxModel(context));
+
+    FrameInfo frame;
+    frame.frameNumber_ = 1;
+    frame.timeStep_ = 1.0f / 60.0f;
+    frame.viewSize_ = IntVector2(1, 1);
+    frame.camera_ = 0;
+    octree->Update(frame);
+    ENGINE_TEST_CHECK(model->GetWorldBoundingBox().Center().Equals(Vector3(100.0f, 100.0f, 100.0f)));
+    ENGINE_TEST_CHECK(IsInsideOctant(model));
+
+    // A query sees the moved bounds before the next octree update
+    node->SetPosition(Vector3(-100.0f, -100.0f, -100.0f));
+    PODVector<Drawable*> result;
+    PointOctreeQuery query(result, Vector3(-100.0f, -100.0f, -100.0f));
+    octree->GetDrawables(query);
+    ENGINE_TEST_CHECK(model->GetWorldBoundingBox().Center().Equals(Vector3(-100.0f, -100.0f, -100.0f)));
+    octree->Update(frame);
+    ENGINE_TEST_CHECK(IsInsideOctant(model));
+    octree->GetDrawables(query);
+    ENGINE_TEST_CHECK(result.Size() == 1 && result[0] == model);
+
+    // A drawable moved after the drawable update is reinserted by the same octree update
+    SharedPtr<DrawableUpdateMover> mover(new DrawableUpdateMover(context, node, Vector3(100.0f, -100.0f, 100.0f)));
+    octree->Update(frame);
+    ENGINE_TEST_CHECK(model->GetWorldBoundingBox().Center().Equals(Vector3(100.0f, -100.0f, 100.0f)));
+    ENGINE_TEST_CHECK(IsInsideOctant(model));
+
+    return true;
+}
+
+}
@@ -0,0 +1,128 @@
+#include <EngineCore/Container/FlatHashMap.h>
+#include <EngineCore/Container/FlatHashSet.h>
+#include <EngineCore/Container/HashMap.h>
+#include <EngineCore/Container/HashSet.h>
+#include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Math/Random.h>
+
+using namespace Atomic;
+
+/// Number of elements in each benchmarked table.
+static const unsigned tableSizes[] = { 1000, 10000, 100000, 1000000, 10000000 };
+
+/// Time per operation of a table benchmark, in nanoseconds.
+struct HashBenchmarkResult
+{
+    /// Insert time.
+    double insert_;
+    /// Find time, half of the keys present and half missing.
+    double find_;
+    /// Erase time.
+    double erase_;
+};
+
+/// Insert a key into a map.
+template <class T> static void InsertKey(T& map, unsigned key, unsigned value) { map[key] = value; }
+/// Insert a key into a hash set.
+static void InsertKey(HashSet<unsigned>& set, unsigned key, unsigned value) { set.Insert(key); }
+/// Insert a key into a flat hash set.
+static void InsertKey(FlatHashSet<unsigned>& set, unsigned key, unsigned value) { set.Insert(key); }
+
+/// Return the time in nanoseconds per operation since a timer was reset.
+static double GetNsPerOperation(HiresTimer& timer, unsigned count)
+{
+    return timer.GetUSec(false) * 1000.0 / count;
+}
+
+/// Insert, find and erase keys in an empty table. Return false if a lookup returned a wrong result.
+template <class T> static bool RunTable(const PODVector<unsigned>& keys, const PODVector<unsigned>& missingKeys,
+    HashBenchmarkResult& result)
+{
+    unsigned count = keys.Size();
+    T table;
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < count; ++i)
+        InsertKey(table, keys[i], i);
+    result.insert_ = GetNsPerOperation(timer, count);
+
+    unsigned numFound = 0;
+    timer.Reset();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (table.Contains(keys[i]))
+            ++numFound;
+        if (table.Contains(missingKeys[i]))
+            ++numFound;
+    }
+    result.find_ = GetNsPerOperation(timer, count * 2);
+
+    unsigned numErased = 0;
+    timer.Reset();
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (table.Erase(keys[i]))
+            ++numErased;
+    }
+    result.erase_ = GetNsPerOperation(timer, count);
+
+    return numFound == count && numErased == count && table.Empty();
+}
+
+/// Print the results of a table.
+static void PrintResult(const char* name, unsigned count, const HashBenchmarkResult& result)
+{
+    PrintLine(ToString("%-12s %9u   insert %7.1f ns   find %7.1f ns   erase %7.1f ns", name, count, result.insert_,
+        result.find_, result.erase_));
+}
+
+/// Time per operation of inserting, finding and erasing random unsigned keys in HashMap and HashSet against FlatHashMap
+/// and FlatHashSet, from a thousand up to ten million elements. An optional argument sets the largest table size.
+int main(int argc, char** argv)
+{
+    const Vector<String>& arguments = ParseArguments(argc, argv);
+    unsigned maxCount = arguments.Size() ? ToUInt(arguments[0]) : M_MAX_UNSIGNED;
+
+    SetRandomSeed(1);
+
+    int numFailed = 0;
+    for (unsigned i = 0; i < sizeof(tableSizes) / sizeof(tableSizes[0]); ++i)
+    {
+        unsigned count = tableSizes[i];
+        if (count > maxCount)
+            break;
+
+        // Odd keys are inserted and even keys are looked up as missing. Multiplying by an odd number is a bijection of the
+        // low 31 bits, so the keys are unique
+        unsigned seed = ((unsigned)Rand() << 15) | (unsigned)Rand();
+        PODVector<unsigned> keys(count);
+        PODVector<unsigned> missingKeys(count);
+        for (unsigned j = 0; j < count; ++j)
+        {
+            unsigned hash = ((j + seed) * 2654435761U) & 0x7fffffff;
+            keys[j] = hash * 2 + 1;
+            missingKeys[j] = hash * 2;
+        }
+
+        HashBenchmarkResult result;
+        if (!RunTable<HashMap<unsigned, unsigned> >(keys, missingKeys, result))
+            ++numFailed;
+        PrintResult("HashMap", count, result);
+        if (!RunTable<FlatHashMap<unsigned, unsigned> >(keys, missingKeys, result))
+            ++numFailed;
+        PrintResult("FlatHashMap", count, result);
+        if (!RunTable<HashSet<unsigned> >(keys, missingKeys, result))
+            ++numFailed;
+        PrintResult("HashSet", count, result);
+        if (!RunTable<FlatHashSet<unsigned> >(keys, missingKeys, result))
+            ++numFailed;
+        PrintResult("FlatHashSet", count, result);
+    }
+
+    if (numFailed)
+        PrintLine(ToString("%d tables returned wrong lookup results", numFailed), true);
+
+    return numFailed;
+}
@@ -0,0 +1,291 @@
+#include <EngineCore/Core/Context.h>
+#include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/IPC/IPCMessage.h>
+
+#include <signal.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Atomic;
+
+/// Benchmark run by both processes in the same order.
+struct IPCBenchmarkCase
+{
+    /// Message size in bytes.
+    unsigned size_;
+    /// Number of messages for throughput, or round trips for latency.
+    unsigned count_;
+    /// Whether to measure round trip latency instead of throughput.
+    bool latency_;
+};
+
+static const IPCBenchmarkCase cases[] =
+{
+    { 64, 200000, false },
+    { 4096, 50000, false },
+    { 65536, 5000, false },
+    { 2 * 1024 * 1024, 100, false },
+    { 64, 20000, true },
+    { 4096, 20000, true },
+};
+
+/// Message and fragment framing of the two transports, as used by IPCChannel.
+class IPCBenchmarkTransport
+{
+public:
+    /// Construct.
+    IPCBenchmarkTransport(PipeTransport& pipe, RingTransport* ring) :
+        pipe_(pipe),
+        ring_(ring)
+    {
+    }
+
+    /// Send a message.
+    bool Send(const unsigned char* data, unsigned size)
+    {
+        if (ring_)
+        {
+            unsigned maxSize = ring_->GetMaxMessageSize();
+            while (size > maxSize)
+            {
+                if (!ring_->Write(IPC_MESSAGE_FRAGMENT, data, maxSize))
+                    return false;
+                data += maxSize;
+                size -= maxSize;
+            }
+            return ring_->Write(IPC_MESSAGE_EVENT, data, size);
+        }
+
+        IPCMessageHeader header;
+        header.messageType_ = IPC_MESSAGE_EVENT;
+        header.messageSize_ = size;
+        return pipe_.Write(&header, sizeof(IPCMessageHeader)) && pipe_.Write(data, size);
+    }
+
+    /// Receive a message, waiting for it. Return its size, or M_MAX_UNSIGNED if the other process has gone.
+    unsigned Receive()
+    {
+        if (ring_)
+        {
+            unsigned total = 0;
+            for (;;)
+            {
+                unsigned type;
+                const char* data;
+                unsigned size;
+                while (!ring_->Peek(type, data, size))
+                {
+                    if (!ring_->IsPeerAttached())
+                        return M_MAX_UNSIGNED;
+                    ring_->Wait(100);
+                }
+
+                total += size;
+                ring_->Pop();
+                if (type == IPC_MESSAGE_EVENT)
+                    return total;
+            }
+        }
+
+        IPCMessageHeader header;
+        if (!ReadPipe(&header, sizeof(IPCMessageHeader)))
+            return M_MAX_UNSIGNED;
+
+        buffer_.Resize(header.messageSize_);
+        if (header.messageSize_ && !ReadPipe(&buffer_[0], header.messageSize_))
+            return M_MAX_UNSIGNED;
+        return header.messageSize_;
+    }
+
+private:
+    /// Read exactly the requested number of bytes from the pipe.
+    bool ReadPipe(void* dest, unsigned size)
+    {
+        unsigned char* bytes = static_cast<unsigned char*>(dest);
+        unsigned idle = 0;
+        while (size)
+        {
+            size_t read = size;
+            if (!pipe_.Read(bytes, &read))
+                return false;
+
+            // Each read waits up to 100 ms, so the other process is considered gone after 10 seconds without data
+            if (!read && ++idle == 100)
+                return false;
+            bytes += read;
+            size -= (unsigned)read;
+        }
+        return true;
+    }
+
+    /// Pipe transport.
+    PipeTransport& pipe_;
+    /// Ring transport, or null to use the pipe.
+    RingTransport* ring_;
+    /// Pipe receive buffer.
+    PODVector<unsigned char> buffer_;
+};
+
+/// Run the benchmark cases as the process that sends and measures. Return false if the other process stopped responding.
+static bool RunSender(IPCBenchmarkTransport& transport, const char* name)
+{
+    PODVector<unsigned char> message;
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const IPCBenchmarkCase& benchmark = cases[i];
+        message.Resize(benchmark.size_);
+        memset(&message[0], (int)i, benchmark.size_);
+
+        HiresTimer timer;
+        for (unsigned j = 0; j < benchmark.count_; ++j)
+        {
+            if (!transport.Send(&message[0], benchmark.size_))
+                return false;
+            if (benchmark.latency_ && transport.Receive() != benchmark.size_)
+                return false;
+        }
+
+        // Throughput includes the acknowledgement of the last message
+        if (!benchmark.latency_ && transport.Receive() != 1)
+            return false;
+
+        double seconds = Max(timer.GetUSec(false), 1LL) / 1000000.0;
+        if (benchmark.latency_)
+        {
+            PrintLine(ToString("%-5s latency     %8u bytes: %10.2f us per round trip", name, benchmark.size_,
+                seconds * 1000000.0 / benchmark.count_));
+        }
+        else
+        {
+            double megabytes = (double)benchmark.size_ * benchmark.count_ / (1024.0 * 1024.0);
+            PrintLine(ToString("%-5s throughput  %8u bytes: %10.1f MB/s %12.0f messages/s", name, benchmark.size_,
+                megabytes / seconds, benchmark.count_ / seconds));
+        }
+    }
+
+    return true;
+}
+
+/// Run the benchmark cases as the process that receives and replies.
+static bool RunReceiver(IPCBenchmarkTransport& transport)
+{
+    PODVector<unsigned char> message;
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const IPCBenchmarkCase& benchmark = cases[i];
+        message.Resize(benchmark.size_);
+        memset(&message[0], (int)i, benchmark.size_);
+
+        for (unsigned j = 0; j < benchmark.count_; ++j)
+        {
+            if (transport.Receive() != benchmark.size_)
+                return false;
+            if (benchmark.latency_ && !transport.Send(&message[0], benchmark.size_))
+                return false;
+        }
+
+        if (!benchmark.latency_ && !transport.Send(&message[0], 1))
+            return false;
+    }
+
+    return true;
+}
+
+/// Run the benchmark cases between this process and a forked one. Return true if successful.
+static bool RunBenchmark(bool useRing)
+{
+    PipePair pipes;
+    if (pipes.fd1() == -1)
+        return false;
+
+    // The ring is created before forking, as the broker creates it before launching the worker
+    RingTransport parentRing;
+    int sharedFD = -1;
+    if (useRing)
+    {
+        sharedFD = parentRing.Create();
+        if (sharedFD == -1)
+        {
+            PrintLine("Shared memory is not available", true);
+            return false;
+        }
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+        return false;
+
+    if (!pid)
+    {
+        close(pipes.fd1());
+        parentRing.Close();
+
+        PipeTransport pipe;
+        pipe.OpenClient(pipes.fd2());
+        RingTransport ring;
+        if (useRing)
+        {
+            ring.Open(sharedFD);
+            ring.SetPeerSocket(pipes.fd2());
+            close(sharedFD);
+        }
+
+        IPCBenchmarkTransport transport(pipe, useRing ? &ring : 0);
+        _exit(RunReceiver(transport) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(pipes.fd2());
+    if (sharedFD != -1)
+        close(sharedFD);
+
+    PipeTransport pipe;
+    pipe.OpenServer(pipes.fd1());
+    if (useRing)
+    {
+        parentRing.SetPeerSocket(pipes.fd1());
+        while (!parentRing.IsPeerAttached())
+            Time::Sleep(1);
+    }
+
+    IPCBenchmarkTransport transport(pipe, useRing ? &parentRing : 0);
+    bool success = RunSender(transport, useRing ? "ring" : "pipe");
+
+    if (!success)
+        kill(pid, SIGTERM);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(pipes.fd1());
+
+    return success && WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS;
+}
+
+/// Two-process throughput and latency of the IPC pipe and shared memory ring transports. Run both, or those given as
+/// arguments ("pipe", "ring").
+int main(int argc, char** argv)
+{
+    const Vector<String>& arguments = ParseArguments(argc, argv);
+
+    // The timer frequency is set up by the Time subsystem
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new Time(context));
+
+    int numFailed = 0;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        bool useRing = i == 1;
+        String name = useRing ? "ring" : "pipe";
+        if (!arguments.Empty() && !arguments.Contains(name))
+            continue;
+
+        if (!RunBenchmark(useRing))
+        {
+            PrintLine("FAILED " + name, true);
+            ++numFailed;
+        }
+    }
+
+    return numFailed;
+}
@@ -23,41 +23,31 @@
 #include <EngineCore/EngineCore.h>
 
 #include <EngineCore/Core/Context.h>
-#include <EngineCore/Container/ArrayPtr.h>
 #include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/Core/WorkQueue.h>
 #include <EngineCore/IO/File.h>
 #include <EngineCore/IO/FileSystem.h>
 #include <EngineCore/IO/PackageFile.h>
+#include <EngineCore/IO/PackageWriter.h>
 
 #ifdef WIN32
 #include <windows.h>
 #endif
 
-#include <lz4.h>
-#include <lz4hc.h>
-
 #include <EngineCore/DebugNew.h>
 
 using namespace Atomic;
 
-static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
-
-struct FileEntry
-{
-    String name_;
-    unsigned offset_;
-    unsigned size_;
-    unsigned checksum_;
-};
-
 SharedPtr<Context> context_(new Context());
 SharedPtr<FileSystem> fileSystem_(new FileSystem(context_));
+SharedPtr<WorkQueue> workQueue_(new WorkQueue(context_));
+SharedPtr<PackageWriter> packageWriter_(new PackageWriter(context_));
 String basePath_;
-Vector<FileEntry> entries_;
-unsigned checksum_ = 0;
 bool compress_ = false;
+bool fastChecksums_ = false;
 bool quiet_ = false;
-unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
 
 String ignoreExtensions_[] = {
     ".bak",
@@ -68,8 +58,7 @@ String ignoreExtensions_[] = {
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
 void ProcessFile(const String& fileName, const String& rootDir);
-void WritePackageFile(const String& fileName, const String& rootDir);
-void WriteHeader(File& dest);
+void WritePackageFile(const String& fileName);
 
 int main(int argc, char** argv)
 {
@@ -93,9 +82,11 @@ void Run(const Vector<String>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-f      Write a version 2 package with fast checksums\n"
             "-q      Enable quiet mode\n"
             "\n"
-            "Basepath is an optional prefix that will be added to the file entries.\n\n"
+            "Basepath is an optional prefix that will be added to the file entries.\n"
+            "Compressed version 2 packages reuse unchanged files from the package they replace.\n\n"
             "Alternative output usage: PackageTool <output option> <package name>\n"
             "Output option:\n"
             "-i      Output package file information\n"
@@ -121,6 +112,9 @@ void Run(const Vector<String>& arguments)
                     case 'c':
                         compress_ = true;
                         break;
+                    case 'f':
+                        fastChecksums_ = true;
+                        break;
                     case 'q':
                         quiet_ = true;
                         break;
@@ -160,7 +154,7 @@ void Run(const Vector<String>& arguments)
         for (unsigned i = 0; i < fileNames.Size(); ++i)
             ProcessFile(fileNames[i], dirName);
 
-        WritePackageFile(packageName, dirName);
+        WritePackageFile(packageName);
     }
     else
     {
@@ -174,6 +168,7 @@ void Run(const Vector<String>& arguments)
             PrintLine("Package size: " + String(packageFile->GetTotalSize()));
             PrintLine("Checksum: " + String(packageFile->GetChecksum()));
             PrintLine("Compressed: " + String(packageFile->IsCompressed() ? "yes" : "no"));
+            PrintLine("Version: " + String(packageFile->GetVersion()));
             break;
         case 'L':
             if (!packageFile->IsCompressed())
@@ -214,134 +209,52 @@ void ProcessFile(const String& fileName, const String& rootDir)
     if (!file.GetSize())
         return;
 
-    FileEntry newEntry;
-    newEntry.name_ = fileName;
-    newEntry.offset_ = 0; // Offset not yet known
-    newEntry.size_ = file.GetSize();
-    newEntry.checksum_ = 0; // Will be calculated later
-    entries_.Push(newEntry);
+    packageWriter_->AddFile(basePath_ + fileName, fullPath);
 }
 
-void WritePackageFile(const String& fileName, const String& rootDir)
+void WritePackageFile(const String& fileName)
 {
     if (!quiet_)
         PrintLine("Writing package");
 
-    File dest(context_);
-    if (!dest.Open(fileName, FILE_WRITE))
-        ErrorExit("Could not open output file " + fileName);
+    HiresTimer timer;
 
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader(dest);
+    // Compress on all cores, the main thread reads files and compresses chunks no worker has started on
+    context_->RegisterSubsystem(fileSystem_);
+    context_->RegisterSubsystem(workQueue_);
+    if (compress_)
+        workQueue_->CreateThreads(Max(GetNumLogicalCPUs(), 2U) - 1);
 
-    for (unsigned i = 0; i < entries_.Size(); ++i)
-    {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
+    packageWriter_->SetCompressed(compress_);
+    packageWriter_->SetFastChecksums(fastChecksums_);
+    if (!packageWriter_->Write(fileName))
+        ErrorExit(packageWriter_->GetError());
 
-    unsigned totalDataSize = 0;
-    unsigned lastOffset;
-
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < entries_.Size(); ++i)
+    if (!quiet_)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        String fileFullPath = rootDir + "/" + entries_[i].name_;
-
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
-
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
-
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
-
-        for (unsigned j = 0; j < dataSize; ++j)
-        {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
-        }
-
-        if (!compress_)
+        const Vector<PackageWriterEntry>& entries = packageWriter_->GetEntries();
+        for (unsigned i = 0; i < entries.Size(); ++i)
         {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + String(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
-        }
-        else
-        {
-            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
-
-            unsigned pos = 0;
-
-            while (pos < dataSize)
-            {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
-
-                unsigned packedSize = (unsigned)LZ4_compressHC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize);
-                if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
-
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.Get(), packedSize);
-
-                pos += unpackedSize;
-            }
-
-            if (!quiet_)
+            const PackageWriterEntry& entry = entries[i];
+            if (!compress_)
+                PrintLine(entry.name_ + " size " + String(entry.size_));
+            else
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                String fileEntry(entries_[i].name_);
-                fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
+                String fileEntry(entry.name_);
+                fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", entry.size_, entry.packedSize_,
+                    entry.packedSize_ ? 1.f * entry.size_ / entry.packedSize_ : 0.f);
                 PrintLine(fileEntry);
             }
         }
-    }
-
-    // Write package size to the end of file to allow finding it linked to an executable file
-    unsigned currentSize = dest.GetSize();
-    dest.WriteUInt(currentSize + sizeof(unsigned));
 
-    // Write header again with correct offsets & checksums
-    dest.Seek(0);
-    WriteHeader(dest);
-
-    for (unsigned i = 0; i < entries_.Size(); ++i)
-    {
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
-
-    if (!quiet_)
-    {
-        PrintLine("Number of files: " + String(entries_.Size()));
-        PrintLine("File data size: " + String(totalDataSize));
-        PrintLine("Package size: " + String(dest.GetSize()));
-        PrintLine("Checksum: " + String(checksum_));
+        PrintLine("Number of files: " + String(entries.Size()));
+        if (compress_ && fastChecksums_)
+            PrintLine("Unchanged files reused: " + String(packageWriter_->GetNumReused()));
+        PrintLine("File data size: " + String(packageWriter_->GetTotalDataSize()));
+        PrintLine("Package size: " + String(packageWriter_->GetPackageSize()));
+        PrintLine("Checksum: " + String(packageWriter_->GetChecksum()));
         PrintLine("Compressed: " + String(compress_ ? "yes" : "no"));
+        PrintLine("Version: " + String(fastChecksums_ ? 2 : 1));
+        PrintLine(ToString("Time: %.2f s", timer.GetUSec(false) / 1000000.0f));
     }
 }
-
-void WriteHeader(File& dest)
-{
-    if (!compress_)
-        dest.WriteFileID("RPAK");
-    else
-        dest.WriteFileID("RLZ4");
-    dest.WriteUInt(entries_.Size());
-    dest.WriteUInt(checksum_);
-}
@@ -0,0 +1,121 @@
+#include <EngineCore/Core/Context.h>
+#include <EngineCore/Core/ProcessUtils.h>
+#include <EngineCore/Core/StringUtils.h>
+#include <EngineCore/Core/Timer.h>
+#include <EngineCore/IO/FileSystem.h>
+#include <EngineCore/IO/Log.h>
+#include <EngineCore/Resource/ResourceCache.h>
+#include <EngineCore/Scene/Scene.h>
+#include <EngineCoreJS/Javascript/Javascript.h>
+#include <EngineCoreJS/Javascript/JSVM.h>
+
+using namespace Atomic;
+
+/// Script side of the benchmarks. Each function runs the measured operation the given number of times.
+static const char* BENCHMARK_SCRIPT =
+    "var node = new EngineCore.Node();\n"
+    "var received = 0;\n"
+    "node.subscribeToEvent(node, 'ScriptBenchmark', function(ev) { received += ev.value; });\n"
+    "function construct(n) { for (var i = 0; i < n; i++) new EngineCore.Node(); }\n"
+    "function getVector(n) { var sum = 0; for (var i = 0; i < n; i++) sum += node.position[1]; return sum; }\n"
+    "function setVectorArray(n) { var p = [1, 2, 3]; for (var i = 0; i < n; i++) node.position = p; }\n"
+    "function setVectorTyped(n) { var p = new Float32Array([1, 2, 3]); for (var i = 0; i < n; i++) node.position = p; }\n"
+    "function copyVector(n) { for (var i = 0; i < n; i++) node.position = node.position; }\n"
+    "function sendEvent(n) { for (var i = 0; i < n; i++) node.sendEvent('ScriptBenchmark', { value: i }); }\n";
+
+/// Benchmark of a script function.
+struct ScriptBenchmarkCase
+{
+    /// Name of the script function.
+    const char* function_;
+    /// Number of calls.
+    unsigned count_;
+    /// Whether math values are passed as typed arrays.
+    bool typedArrayMath_;
+};
+
+static const ScriptBenchmarkCase cases[] =
+{
+    { "construct", 100000, true },
+    { "getVector", 1000000, true },
+    { "getVector", 1000000, false },
+    { "setVectorArray", 1000000, true },
+    { "setVectorTyped", 1000000, true },
+    { "copyVector", 1000000, true },
+    { "copyVector", 1000000, false },
+    { "sendEvent", 200000, true },
+};
+
+/// Call a script function with a count. Return false and print the error if it throws.
+static bool CallScript(duk_context* ctx, const char* function, unsigned count)
+{
+    duk_get_global_string(ctx, function);
+    duk_push_uint(ctx, count);
+    bool success = duk_pcall(ctx, 1) == DUK_EXEC_SUCCESS;
+    if (!success)
+        PrintLine(String(function) + ": " + duk_safe_to_string(ctx, -1), true);
+    duk_pop(ctx);
+    return success;
+}
+
+/// Time per call of script to native calls: wrapper construction, math value marshaling with typed and plain arrays,
+/// and events sent to script handlers. Run all, or those whose function name is given as an argument.
+int main(int argc, char** argv)
+{
+    const Vector<String>& arguments = ParseArguments(argc, argv);
+
+    SharedPtr<Context> context(new Context());
+    context->RegisterSubsystem(new FileSystem(context));
+    context->RegisterSubsystem(new Log(context));
+    context->RegisterSubsystem(new Time(context));
+    context->RegisterSubsystem(new ResourceCache(context));
+    RegisterSceneLibrary(context);
+    context->InitSubsystemCache();
+    context->GetSubsystem<Log>()->SetQuiet(false);
+
+    Javascript* javascript = new Javascript(context);
+    context->RegisterSubsystem(javascript);
+    JSVM* vm = javascript->InstantiateVM("BenchmarkVM");
+    vm->InitJSContext();
+
+    duk_context* ctx = vm->GetJSContext();
+    if (duk_peval_string(ctx, BENCHMARK_SCRIPT) != DUK_EXEC_SUCCESS)
+    {
+        PrintLine(String("Benchmark script failed: ") + duk_safe_to_string(ctx, -1), true);
+        return EXIT_FAILURE;
+    }
+    duk_pop(ctx);
+
+    int numFailed = 0;
+    for (unsigned i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        const ScriptBenchmarkCase& benchmark = cases[i];
+        if (!arguments.Empty() && !arguments.Contains(String(benchmark.function_)))
+            continue;
+
+        vm->SetTypedArrayMath(benchmark.typedArrayMath_);
+
+        // Warm up, then collect garbage so that earlier cases do not add collections to the measurement
+        if (!CallScript(ctx, benchmark.function_, benchmark.count_ / 10))
+        {
+            ++numFailed;
+            continue;
+        }
+        vm->GC();
+
+        HiresTimer timer;
+        if (!CallScript(ctx, benchmark.function_, benchmark.count_))
+        {
+            ++numFailed;
+            continue;
+        }
+        long long elapsed = timer.GetUSec(false);
+
+        PrintLine(ToString("%-16s %-12s %10.1f ns per call", benchmark.function_, benchmark.typedArrayMath_ ? "typed" :
+            "plain", elapsed * 1000.0 / benchmark.count_));
+    }
+
+    vm->SetTypedArrayMath(false);
+    javascript->ShutdownVM("BenchmarkVM");
+    return numFailed;
+}